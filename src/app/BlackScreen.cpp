@@ -0,0 +1,245 @@
+#include "BlackScreen.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ColorHandler.hpp"
+#include "Topology.hpp"
+
+#ifdef _WIN32
+#include "WindowInitiator.hpp"
+using PlatformInitiator = WindowInitiator;
+#else
+#include "X11WindowInitiator.hpp"
+using PlatformInitiator = X11WindowInitiator;
+#endif
+
+// The initiator's session API behind the C calls. With an internal thread,
+// calls are queued to it and waited for; with BS_THREAD_CALLER they run
+// directly on the opening thread.
+namespace {
+    // Black on every monitor, like a bare black_screen_app
+    InitiatorOptions SessionOptions(uint32_t flags) {
+        InitiatorOptions options;
+        options.disableKeyExit = (flags & BS_KEY_UNBLANKS) == 0;
+        return options;
+    }
+}
+
+struct bs_session {
+    explicit bs_session(uint32_t flags)
+        : initiator(SessionOptions(flags)),
+        internal((flags & BS_THREAD_CALLER) == 0),
+        owner(std::this_thread::get_id()) {
+    }
+
+    PlatformInitiator initiator;
+    const bool internal;
+    std::thread::id owner;              // the thread the windows belong to
+    std::thread thread;
+    std::mutex mutex;
+    std::vector<std::function<void()>> calls;
+    bool stopping = false;              // UI thread only
+    std::string lastError;
+};
+
+namespace {
+    // Window classes, the wake pipe and the unblank bookkeeping are per process
+    std::atomic<bool> g_sessionOpen{ false };
+
+    // Runs fn on the session's UI thread and returns its status
+    int Call(bs_session* session, const std::function<int()>& fn) {
+        if (!session->internal) {
+            if (std::this_thread::get_id() != session->owner) {
+                session->lastError = "BS_THREAD_CALLER session used from another thread";
+                return BS_ERROR_THREAD;
+            }
+            return fn();
+        }
+
+        std::packaged_task<int()> task(fn);
+        std::future<int> result = task.get_future();
+        {
+            std::lock_guard lock(session->mutex);
+            session->calls.emplace_back([&task] { task(); });
+        }
+        session->initiator.wakeSession();
+        return result.get();
+    }
+
+    void RunSessionThread(bs_session* session, std::promise<bool>& opened) {
+        session->owner = std::this_thread::get_id();
+        const bool ok = session->initiator.openSession();
+        opened.set_value(ok);
+        if (!ok) return;
+
+        std::vector<std::function<void()>> calls;
+        while (!session->stopping) {
+            session->initiator.pumpSession(-1);
+            {
+                std::lock_guard lock(session->mutex);
+                calls.swap(session->calls);
+            }
+            for (const auto& call : calls) call();
+            calls.clear();
+        }
+        session->initiator.closeSession();
+    }
+}
+
+extern "C" {
+
+uint32_t bs_api_version(void) {
+    return BLACKSCREEN_API_VERSION;
+}
+
+int bs_enumerate(bs_monitor* monitors, size_t capacity, size_t* count) {
+    if (!count || (capacity > 0 && !monitors)) return BS_ERROR_ARGUMENT;
+
+    TopologyStore::refresh();
+    const TopologySnapshot topology = TopologyStore::current();
+    const size_t total = topology ? topology->monitors.size() : 0;
+    for (size_t k = 0; k < (std::min)(total, capacity); ++k) {
+        const MonitorData& monitor = topology->monitors[k];
+        bs_monitor& out = monitors[k];
+        out = {};
+        out.index = static_cast<int32_t>(k + 1);
+        out.left = static_cast<int32_t>(monitor.rect.left);
+        out.top = static_cast<int32_t>(monitor.rect.top);
+        out.right = static_cast<int32_t>(monitor.rect.right);
+        out.bottom = static_cast<int32_t>(monitor.rect.bottom);
+        out.primary = monitor.primary ? 1 : 0;
+        out.adapter = monitor.adapter;
+        std::strncpy(out.name, monitor.name.c_str(), sizeof(out.name) - 1);
+    }
+    *count = total;
+    return BS_OK;
+}
+
+int bs_open(uint32_t flags, bs_session** session) {
+    if (!session) return BS_ERROR_ARGUMENT;
+    *session = nullptr;
+    if (g_sessionOpen.exchange(true)) return BS_ERROR_BUSY;
+
+    auto created = std::make_unique<bs_session>(flags);
+    bool ok = false;
+    if (created->internal) {
+        std::promise<bool> opened;
+        std::future<bool> result = opened.get_future();
+        created->thread = std::thread(RunSessionThread, created.get(), std::ref(opened));
+        ok = result.get();
+        if (!ok) created->thread.join();
+    }
+    else {
+        ok = created->initiator.openSession();
+    }
+    if (!ok) {
+        g_sessionOpen = false;
+        return BS_ERROR_DISPLAY;
+    }
+    *session = created.release();
+    return BS_OK;
+}
+
+int bs_close(bs_session* session) {
+    if (!session) return BS_ERROR_ARGUMENT;
+    if (session->internal) {
+        Call(session, [session] {
+            session->stopping = true;
+            return BS_OK;
+        });
+        session->thread.join();
+    }
+    else {
+        // The windows can only be destroyed on their own thread; the session stays open
+        const int status = Call(session, [session] {
+            session->initiator.closeSession();
+            return BS_OK;
+        });
+        if (status != BS_OK) return status;
+    }
+    delete session;
+    g_sessionOpen = false;
+    return BS_OK;
+}
+
+int bs_select(bs_session* session, const char* query) {
+    if (!session) return BS_ERROR_ARGUMENT;
+    std::vector<MonitorQuery> queries;
+    if (query && *query) {
+        try {
+            queries.push_back(MonitorQuery::compile(query));
+        }
+        catch (const std::invalid_argument& e) {
+            session->lastError = e.what();
+            return BS_ERROR_ARGUMENT;
+        }
+    }
+    return Call(session, [session, &queries] {
+        session->initiator.setMonitorQueries(std::move(queries));
+        session->initiator.refreshSession();
+        return BS_OK;
+    });
+}
+
+int bs_set_color(bs_session* session, const char* color) {
+    if (!session || !color) return BS_ERROR_ARGUMENT;
+    std::tuple<int, int, int> rgb;
+    if (!ColorHandler::parseColor(color, rgb)) {
+        session->lastError = std::string("Invalid color '") + color + "'";
+        return BS_ERROR_ARGUMENT;
+    }
+    return Call(session, [session, rgb] {
+        session->initiator.setColor(rgb);
+        session->initiator.refreshSession();
+        return BS_OK;
+    });
+}
+
+int bs_blank(bs_session* session) {
+    if (!session) return BS_ERROR_ARGUMENT;
+    return Call(session, [session] {
+        session->initiator.setSessionBlanked(true);
+        return BS_OK;
+    });
+}
+
+int bs_unblank(bs_session* session) {
+    if (!session) return BS_ERROR_ARGUMENT;
+    return Call(session, [session] {
+        session->initiator.setSessionBlanked(false);
+        return BS_OK;
+    });
+}
+
+int bs_is_blanked(bs_session* session, int* blanked) {
+    if (!session || !blanked) return BS_ERROR_ARGUMENT;
+    return Call(session, [session, blanked] {
+        *blanked = session->initiator.sessionBlanked() ? 1 : 0;
+        return BS_OK;
+    });
+}
+
+int bs_pump(bs_session* session, int timeout_ms) {
+    if (!session || timeout_ms < 0) return BS_ERROR_ARGUMENT;
+    if (session->internal) return BS_OK;
+    return Call(session, [session, timeout_ms] {
+        session->initiator.pumpSession(timeout_ms);
+        return BS_OK;
+    });
+}
+
+const char* bs_last_error(const bs_session* session) {
+    return session ? session->lastError.c_str() : "";
+}
+
+}
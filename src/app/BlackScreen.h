@@ -0,0 +1,96 @@
+/*
+ * Embeddable blanking: the C interface of the black_screen library, for
+ * hosts that blank in-process instead of starting the executable. Only
+ * plain C types cross it, so it stays stable across compilers and releases;
+ * BLACKSCREEN_API_VERSION changes only when existing calls or structs do.
+ *
+ * One session per process. Every call returns BS_OK or a bs_status, and
+ * bs_last_error() describes the last failure of a session.
+ */
+#ifndef BLACKSCREEN_H
+#define BLACKSCREEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(BLACKSCREEN_BUILDING)
+#    define BLACKSCREEN_API __declspec(dllexport)
+#  else
+#    define BLACKSCREEN_API __declspec(dllimport)
+#  endif
+#else
+#  define BLACKSCREEN_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 2: bs_close returns a status */
+#define BLACKSCREEN_API_VERSION 2
+
+typedef struct bs_session bs_session;
+
+typedef enum bs_status {
+    BS_OK = 0,
+    BS_ERROR_ARGUMENT = 1,      /* null pointer, bad query or color */
+    BS_ERROR_BUSY = 2,          /* another session is open in this process */
+    BS_ERROR_DISPLAY = 3,       /* no display to blank */
+    BS_ERROR_THREAD = 4         /* a BS_THREAD_CALLER session used from another thread */
+} bs_status;
+
+/* bs_open flags */
+#define BS_THREAD_INTERNAL  0u  /* the library runs its own UI thread; calls from any thread */
+#define BS_THREAD_CALLER    1u  /* windows live on the opening thread, which calls bs_pump */
+#define BS_KEY_UNBLANKS     2u  /* a key press or close unblanks, as with --resident */
+
+typedef struct bs_monitor {
+    int32_t index;              /* 1-based, as in -m and the monitor list */
+    int32_t left;               /* desktop coordinates */
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+    int32_t primary;            /* nonzero for the primary monitor */
+    int32_t adapter;            /* 1-based adapter ordinal, 0 when unknown */
+    char name[128];             /* UTF-8, truncated */
+} bs_monitor;
+
+BLACKSCREEN_API uint32_t bs_api_version(void);
+
+/* Enumerates now. Fills up to capacity entries and stores the total in
+ * *count, so capacity 0 asks for the size. Needs no session. */
+BLACKSCREEN_API int bs_enumerate(bs_monitor* monitors, size_t capacity, size_t* count);
+
+/* Creates the session's hidden windows for every monitor, unblanked and
+ * black, selecting all monitors. */
+BLACKSCREEN_API int bs_open(uint32_t flags, bs_session** session);
+/* Destroys the windows and frees the session. A BS_THREAD_CALLER session
+ * must be closed on its opening thread: from any other, BS_ERROR_THREAD
+ * and the session stays open. */
+BLACKSCREEN_API int bs_close(bs_session* session);
+
+/* Monitors to blank, in -q syntax ("primary", "2 | name:Dell"); NULL or ""
+ * selects all. Applies immediately when blanked. */
+BLACKSCREEN_API int bs_select(bs_session* session, const char* query);
+/* A color name or #RRGGBB, as with -c */
+BLACKSCREEN_API int bs_set_color(bs_session* session, const char* color);
+
+/* Both return once the windows are shown or hidden */
+BLACKSCREEN_API int bs_blank(bs_session* session);
+BLACKSCREEN_API int bs_unblank(bs_session* session);
+BLACKSCREEN_API int bs_is_blanked(bs_session* session, int* blanked);
+
+/* BS_THREAD_CALLER only: handles window messages, key unblanking and
+ * monitor changes for up to timeout_ms (0 = only what is queued). Hosts
+ * with their own message loop call it with 0 after each message. */
+BLACKSCREEN_API int bs_pump(bs_session* session, int timeout_ms);
+
+/* Valid until the next call on the session */
+BLACKSCREEN_API const char* bs_last_error(const bs_session* session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLACKSCREEN_H */
@@ -4,6 +4,8 @@
 
 #include "ColorHandler.hpp"
 
+#include <cctype>
+
 std::unordered_map<std::string, std::string> ColorHandler::colorMap = {
     {"blue", "#0000FF"},
     {"white", "#FFFFFF"},
@@ -41,3 +43,32 @@ std::tuple<int, int, int> ColorHandler::convertHextoRGB(std::string& hexCode) {
 
     return std::make_tuple(red, green, blue);
 }
+
+bool ColorHandler::parseColor(const std::string& color, std::tuple<int, int, int>& rgb) {
+    std::string lower = color;
+    for (auto& c : lower) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    if (lower == "black") {
+        rgb = std::make_tuple(0, 0, 0);
+        return true;
+    }
+    if (colorMap.contains(lower)) {
+        lower = colorMap[lower];
+    }
+
+    if (lower.empty() || lower.front() != '#') return false;
+    std::string hexCode = lower.substr(1);
+    if (hexCode.size() != 3 && hexCode.size() != 6) return false;
+    for (const char c : hexCode) {
+        if (!std::isxdigit(static_cast<unsigned char>(c))) return false;
+    }
+
+    // Expand the #RGB shorthand to #RRGGBB
+    if (hexCode.size() == 3) {
+        hexCode = { hexCode[0], hexCode[0], hexCode[1], hexCode[1], hexCode[2], hexCode[2] };
+    }
+    rgb = convertHextoRGB(hexCode);
+    return true;
+}
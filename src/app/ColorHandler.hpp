@@ -14,6 +14,9 @@ public:
     static std::unordered_map<std::string, std::string> colorMap;
 
     static std::tuple<int, int, int> convertHextoRGB(std::string& hexCode);
+
+    // Accepts a color name, #RGB or #RRGGBB (case-insensitive); false if invalid
+    static bool parseColor(const std::string& color, std::tuple<int, int, int>& rgb);
 };
 
 
@@ -0,0 +1,765 @@
+#include "CommandLine.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "ColorHandler.hpp"
+#include "Socket.hpp"
+
+// Helper: split string by delimiters
+static std::vector<std::string> split(const std::string& s, const std::string& delims = " \t\n\r") {
+    std::vector<std::string> tokens;
+    size_t start = 0, end = 0;
+
+    while ((end = s.find_first_of(delims, start)) != std::string::npos) {
+        if (end != start) {
+            tokens.push_back(s.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+
+    if (start < s.length()) {
+        tokens.push_back(s.substr(start));
+    }
+
+    return tokens;
+}
+
+// Helper: parse "x,y,w,h" into a rect; negative x/y allowed, w/h must not be negative
+static bool parseRectArgument(const std::string& text, Rect& rect) {
+    std::vector<std::string> parts = split(text, ",");
+    if (parts.size() != 4) return false;
+
+    long values[4];
+    for (size_t k = 0; k < 4; ++k) {
+        try {
+            size_t pos;
+            values[k] = std::stol(parts[k], &pos);
+            if (pos != parts[k].size()) return false;
+        }
+        catch (...) {
+            return false;
+        }
+    }
+    if (values[2] < 0 || values[3] < 0) return false;
+
+    rect = { values[0], values[1], values[0] + values[2], values[1] + values[3] };
+    return true;
+}
+
+// Helper: parse an opacity percentage (0-100)
+static bool parseOpacity(const std::string& text, int& opacity) {
+    try {
+        size_t pos;
+        int value = std::stoi(text, &pos);
+        if (pos != text.size() || value < 0 || value > 100) return false;
+        opacity = value;
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+// Helper: parse an integer within [low, high]
+static bool parseBounded(const std::string& text, int low, int high, int& value) {
+    try {
+        size_t pos;
+        int parsed = std::stoi(text, &pos);
+        if (pos != text.size() || parsed < low || parsed > high) return false;
+        value = parsed;
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+InitiatorOptions CommandLineOptions::initiator() const {
+    InitiatorOptions options;
+    // Validated while parsing, so a failed parse here just stays black
+    ColorHandler::parseColor(color, options.color);
+    options.disableKeyExit = disableKeyExit;
+    options.monitorIndices = monitorIndices;
+    options.monitorPatterns = monitorPatterns;
+    options.monitorQueries = monitorQueries;
+    options.mask = mask;
+    options.styles = styles;
+    options.patterns = patterns;
+    options.opacity = opacity;
+    options.resident = resident;
+    options.overlay = overlay;
+    options.image = image;
+    options.spotlight = spotlight;
+    return options;
+}
+
+bool ParseCommandLine(const std::vector<std::string>& args, size_t monitorCount,
+    CommandLineOptions& options, std::string& error) {
+    const size_t argc = args.size();
+
+    // First pass: check for --list, --help
+    for (const std::string& currentArg : args) {
+        if (currentArg == "-l" || currentArg == "--list") {
+            options.action = CommandLineOptions::Action::List;
+            return true;
+        }
+        if (currentArg == "-h" || currentArg == "--help") {
+            options.action = CommandLineOptions::Action::Help;
+            return true;
+        }
+    }
+
+    auto isValue = [&args, argc](size_t i) {
+        return i < argc && !(!args[i].empty() && args[i][0] == '-');
+    };
+
+    // -m leaves monitorIndices at { 0 } for "-m 1", same as the default, so
+    // whether it was given is tracked on its own
+    bool monitorGiven = false;
+
+    // Second pass: parse arguments
+    for (size_t i = 0; i < argc; ++i) {
+        const std::string& currentArg = args[i];
+
+        if (currentArg == "-m" || currentArg == "--monitor") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --monitor";
+                return false;
+            }
+            if (!options.monitorPatterns.empty() || !options.monitorQueries.empty()) {
+                error = "Error: Cannot combine -m with -M or -q";
+                return false;
+            }
+
+            monitorGiven = true;
+            options.monitorIndices.clear();
+
+            // Consume all following tokens until next flag
+            while (isValue(i + 1)) {
+                for (const std::string& part : split(args[i + 1], ",")) {
+                    size_t first = part.find_first_not_of(" \t");
+                    size_t last = part.find_last_not_of(" \t");
+                    if (first == std::string::npos) continue;
+                    std::string token = part.substr(first, (last - first + 1));
+
+                    try {
+                        size_t pos;
+                        int idx = std::stoi(token, &pos);
+                        if (pos != token.size()) {
+                            throw std::invalid_argument("Trailing characters");
+                        }
+                        options.monitorIndices.push_back(idx);
+                    }
+                    catch (...) {
+                        error = "Error: Invalid monitor index: '" + token + "'";
+                        return false;
+                    }
+                }
+
+                ++i;
+            }
+
+            if (options.monitorIndices.empty()) {
+                error = "Error: No monitor indices provided after --monitor";
+                return false;
+            }
+
+            std::vector<int> validatedIndices;
+            bool useAll = true;
+
+            for (int userIndex : options.monitorIndices) {
+                if (userIndex == 0) {
+                    // keep useAll = true
+                }
+                else if (userIndex >= 1 && userIndex <= static_cast<int>(monitorCount)) {
+                    useAll = false;
+                    validatedIndices.push_back(userIndex - 1);
+                }
+                else {
+                    error = "Error: Monitor index " + std::to_string(userIndex) +
+                        " is out of range. Valid: 1 to " + std::to_string(monitorCount) + " (or 0 for all).";
+                    return false;
+                }
+            }
+
+            if (useAll) {
+                options.monitorIndices = { -1 };
+            }
+            else {
+                options.monitorIndices = validatedIndices;
+            }
+        }
+        else if (currentArg == "-M" || currentArg == "--monitor-name") {
+            if (monitorGiven || !options.monitorQueries.empty()) {
+                error = "Error: Cannot combine -M with -m or -q";
+                return false;
+            }
+
+            // Parse string patterns
+            options.monitorIndices.clear();
+            options.monitorPatterns.clear();
+            while (isValue(i + 1)) {
+                options.monitorPatterns.push_back(args[++i]);
+            }
+            if (options.monitorPatterns.empty()) {
+                error = "Error: No monitor names provided after -M";
+                return false;
+            }
+        }
+        else if (currentArg == "-q" || currentArg == "--query") {
+            if (monitorGiven || !options.monitorPatterns.empty()) {
+                error = "Error: Cannot combine -q with -m or -M";
+                return false;
+            }
+
+            // Following tokens form one expression, so unquoted "left & primary" works too
+            options.monitorIndices.clear();
+            std::string expression;
+            while (isValue(i + 1)) {
+                if (!expression.empty()) expression += ' ';
+                expression += args[++i];
+            }
+            if (expression.empty()) {
+                error = "Error: No expression provided after -q";
+                return false;
+            }
+
+            try {
+                options.monitorQueries.push_back(MonitorQuery::compile(expression));
+            }
+            catch (const std::invalid_argument& e) {
+                error = std::string("Error: ") + e.what();
+                return false;
+            }
+        }
+        else if (currentArg == "-r" || currentArg == "--region" ||
+                 currentArg == "-R" || currentArg == "--monitor-region" ||
+                 currentArg == "-x" || currentArg == "--except") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for " + currentArg;
+                return false;
+            }
+
+            const std::string& value = args[++i];
+            Rect rect;
+            if (!parseRectArgument(value, rect)) {
+                error = "Error: Invalid rectangle '" + value + "'. Expected x,y,w,h";
+                return false;
+            }
+
+            if (currentArg == "-r" || currentArg == "--region") {
+                options.mask.regions.push_back(rect);
+            }
+            else if (currentArg == "-R" || currentArg == "--monitor-region") {
+                options.mask.monitorRegions.push_back(rect);
+            }
+            else {
+                options.mask.exceptions.push_back(rect);
+            }
+        }
+        else if (currentArg == "-c" || currentArg == "--color") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --color";
+                return false;
+            }
+            options.color = args[++i];
+            std::tuple<int, int, int> rgb;
+            if (!ColorHandler::parseColor(options.color, rgb)) {
+                error = "Error: Invalid color '" + options.color + "'. Expected a hex color code or color name.";
+                return false;
+            }
+        }
+        else if (currentArg == "-o" || currentArg == "--opacity") {
+            if (i + 1 >= argc || !parseOpacity(args[i + 1], options.opacity)) {
+                error = "Error: --opacity expects a value from 0 to 100";
+                return false;
+            }
+            ++i;
+        }
+        else if (currentArg == "-s" || currentArg == "--style") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --style";
+                return false;
+            }
+
+            // <selector>=<color>[@<opacity>]
+            const std::string& value = args[++i];
+            size_t equals = value.rfind('=');
+            if (equals == std::string::npos) {
+                error = "Error: Invalid style '" + value + "'. Expected <selector>=<color>[@<opacity>]";
+                return false;
+            }
+
+            std::string colorPart = value.substr(equals + 1);
+            MonitorStyle style;
+            size_t at = colorPart.find('@');
+            if (at != std::string::npos) {
+                if (!parseOpacity(colorPart.substr(at + 1), style.opacity)) {
+                    error = "Error: Style opacity must be a value from 0 to 100";
+                    return false;
+                }
+                colorPart.resize(at);
+            }
+            if (!ColorHandler::parseColor(colorPart, style.color)) {
+                error = "Error: Invalid color '" + colorPart + "' in style.";
+                return false;
+            }
+
+            try {
+                style.selector = MonitorQuery::compile(value.substr(0, equals));
+            }
+            catch (const std::invalid_argument& e) {
+                error = std::string("Error: ") + e.what();
+                return false;
+            }
+            options.styles.push_back(std::move(style));
+        }
+        else if (currentArg == "--pattern") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --pattern";
+                return false;
+            }
+
+            // [<selector>=]<name>; without a selector every selected monitor gets it
+            const std::string& value = args[++i];
+            const size_t equals = value.rfind('=');
+            const std::string name = equals == std::string::npos ? value : value.substr(equals + 1);
+            MonitorPattern pattern;
+            if (!ParseTestPattern(name, pattern.pattern)) {
+                error = "Error: Unknown pattern '" + name + "'. Expected grid, checker, gradient, ramp or solid-cycle";
+                return false;
+            }
+            try {
+                pattern.selector = MonitorQuery::compile(equals == std::string::npos ? "all" : value.substr(0, equals));
+            }
+            catch (const std::invalid_argument& e) {
+                error = std::string("Error: ") + e.what();
+                return false;
+            }
+            options.patterns.push_back(std::move(pattern));
+        }
+        else if (currentArg == "--resident") {
+            options.resident.enabled = true;
+        }
+        else if (currentArg == "--pool") {
+            const std::string value = i + 1 < argc ? args[i + 1] : "";
+            if (value == "all") {
+                options.resident.pool.mostUsed = 0;
+            }
+            else {
+                try {
+                    size_t pos;
+                    int count = std::stoi(value, &pos);
+                    if (pos != value.size() || count < 1) {
+                        throw std::invalid_argument("Not a positive count");
+                    }
+                    options.resident.pool.mostUsed = static_cast<size_t>(count);
+                }
+                catch (...) {
+                    error = "Error: --pool expects 'all' or a positive monitor count";
+                    return false;
+                }
+            }
+            ++i;
+        }
+        else if (currentArg == "--text") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --text";
+                return false;
+            }
+            options.overlay.text = args[++i];
+        }
+        else if (currentArg == "--clock") {
+            // The format is optional; strftime formats never start with '-'
+            options.overlay.clockFormat = isValue(i + 1) ? args[++i] : "%H:%M";
+            if (options.overlay.clockFormat.empty()) {
+                error = "Error: --clock format must not be empty";
+                return false;
+            }
+        }
+        else if (currentArg == "--text-color") {
+            if (i + 1 >= argc || !ColorHandler::parseColor(args[i + 1], options.overlay.color)) {
+                error = "Error: --text-color expects a hex color code or color name";
+                return false;
+            }
+            ++i;
+        }
+        else if (currentArg == "--text-size") {
+            try {
+                size_t pos;
+                const std::string value = i + 1 < argc ? args[i + 1] : "";
+                int size = std::stoi(value, &pos);
+                if (pos != value.size() || size < 4 || size > 400) {
+                    throw std::invalid_argument("Out of range");
+                }
+                options.overlay.pointSize = size;
+            }
+            catch (...) {
+                error = "Error: --text-size expects a point size from 4 to 400";
+                return false;
+            }
+            ++i;
+        }
+        else if (currentArg == "--image") {
+            if (i + 1 >= argc || args[i + 1].empty()) {
+                error = "Error: Missing value for --image";
+                return false;
+            }
+            options.image.path = args[++i];
+        }
+        else if (currentArg == "--image-fit") {
+            const std::string value = i + 1 < argc ? args[i + 1] : "";
+            if (value == "fill") {
+                options.image.fit = ImageFit::Fill;
+            }
+            else if (value == "fit") {
+                options.image.fit = ImageFit::Fit;
+            }
+            else if (value == "stretch") {
+                options.image.fit = ImageFit::Stretch;
+            }
+            else {
+                error = "Error: --image-fit expects fill, fit or stretch";
+                return false;
+            }
+            ++i;
+        }
+        else if (currentArg == "--listen") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --listen";
+                return false;
+            }
+            options.resident.listen = args[++i];
+        }
+        else if (currentArg == "--token") {
+            if (i + 1 >= argc || args[i + 1].empty()) {
+                error = "Error: Missing value for --token";
+                return false;
+            }
+            options.resident.token = args[++i];
+            options.fleet.token = options.resident.token;
+        }
+        else if (currentArg == "--control") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --control";
+                return false;
+            }
+            options.action = CommandLineOptions::Action::Control;
+            options.fleet.commands = split(args[++i], ",");
+            for (const std::string& command : options.fleet.commands) {
+                if (!IsFleetCommand(command)) {
+                    error = "Error: Unknown --control command '" + command + "'. Expected ping, status, list, blank, unblank or toggle";
+                    return false;
+                }
+            }
+            if (options.fleet.commands.empty()) {
+                error = "Error: Missing value for --control";
+                return false;
+            }
+        }
+        else if (currentArg == "--target") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --target";
+                return false;
+            }
+            for (std::string& target : split(args[++i], ",")) {
+                options.fleet.targets.push_back(std::move(target));
+            }
+        }
+        else if (currentArg == "--targets-file") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --targets-file";
+                return false;
+            }
+            // One endpoint per line; blank lines and # comments are skipped
+            std::ifstream file(args[++i]);
+            if (!file) {
+                error = "Error: Cannot read targets file '" + args[i] + "'";
+                return false;
+            }
+            std::string line;
+            while (std::getline(file, line)) {
+                line = line.substr(0, line.find('#'));
+                for (std::string& target : split(line)) {
+                    options.fleet.targets.push_back(std::move(target));
+                }
+            }
+        }
+        else if (currentArg == "--timeout") {
+            if (i + 1 >= argc || !parseBounded(args[i + 1], 1, 600000, options.fleet.timeoutMs)) {
+                error = "Error: --timeout expects milliseconds from 1 to 600000";
+                return false;
+            }
+            ++i;
+        }
+        else if (currentArg == "--parallel") {
+            int parallel = 0;
+            if (i + 1 >= argc || !parseBounded(args[i + 1], 1, 4096, parallel)) {
+                error = "Error: --parallel expects a connection count from 1 to 4096";
+                return false;
+            }
+            options.fleet.parallel = static_cast<size_t>(parallel);
+            ++i;
+        }
+        else if (currentArg == "--stress-input") {
+            // The event count is optional
+            options.action = CommandLineOptions::Action::Stress;
+            if (isValue(i + 1)) {
+                int events = 0;
+                if (!parseBounded(args[i + 1], 1, 100000000, events)) {
+                    error = "Error: --stress-input expects an event count from 1 to 100000000";
+                    return false;
+                }
+                options.stress.events = static_cast<size_t>(events);
+                ++i;
+            }
+        }
+        else if (currentArg == "--stress-spotlight") {
+            // The move count is optional
+            options.action = CommandLineOptions::Action::SpotlightStress;
+            if (isValue(i + 1)) {
+                int moves = 0;
+                if (!parseBounded(args[i + 1], 1, 100000000, moves)) {
+                    error = "Error: --stress-spotlight expects a move count from 1 to 100000000";
+                    return false;
+                }
+                options.spotlightStress.moves = static_cast<size_t>(moves);
+                ++i;
+            }
+        }
+        else if (currentArg == "--stress-occlusion") {
+            // The simulated duration is optional
+            options.action = CommandLineOptions::Action::OcclusionStress;
+            if (isValue(i + 1)) {
+                int minutes = 0;
+                if (!parseBounded(args[i + 1], 1, 10080, minutes)) {
+                    error = "Error: --stress-occlusion expects a duration from 1 to 10080 minutes";
+                    return false;
+                }
+                options.occlusionStress.minutes = static_cast<size_t>(minutes);
+                ++i;
+            }
+        }
+        else if (currentArg == "--spotlight") {
+            // Window sides only make sense with windows kept around, so it implies --resident
+            options.spotlight.enabled = true;
+            options.resident.enabled = true;
+            if (isValue(i + 1)) {
+                options.spotlight.title = args[++i];
+            }
+        }
+        else if (currentArg == "--decode-recorder") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --decode-recorder";
+                return false;
+            }
+            options.action = CommandLineOptions::Action::DecodeRecorder;
+            options.recorderFile = args[++i];
+        }
+        else if (currentArg == "--dump-topology") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --dump-topology";
+                return false;
+            }
+            options.action = CommandLineOptions::Action::DumpTopology;
+            options.topologyFile = args[++i];
+        }
+        else if (currentArg == "--replay-topology") {
+            // A capture or a directory of them, then an optional iteration count
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --replay-topology";
+                return false;
+            }
+            options.action = CommandLineOptions::Action::ReplayTopology;
+            options.topologyReplay.path = args[++i];
+            if (isValue(i + 1)) {
+                int iterations = 0;
+                if (!parseBounded(args[i + 1], 1, 10000000, iterations)) {
+                    error = "Error: --replay-topology expects an iteration count from 1 to 10000000";
+                    return false;
+                }
+                options.topologyReplay.iterations = static_cast<size_t>(iterations);
+                ++i;
+            }
+        }
+        else if (currentArg == "--metrics") {
+            options.publishMetrics = true;
+        }
+        else if (currentArg == "--metrics-file") {
+            if (i + 1 >= argc) {
+                error = "Error: Missing value for --metrics-file";
+                return false;
+            }
+            options.publishMetrics = true;
+            options.metricsFile = args[++i];
+        }
+        else if (currentArg == "-dke" || currentArg == "--disable-key-exit") {
+            options.disableKeyExit = true;
+        }
+        else {
+            error = "Error: Unknown argument: " + currentArg + "\nUse --help for usage.";
+            return false;
+        }
+    }
+
+    if (options.action == CommandLineOptions::Action::Control && options.fleet.targets.empty()) {
+        error = "Error: --control needs --target or --targets-file";
+        return false;
+    }
+    if (!options.resident.listen.empty() && !options.resident.enabled) {
+        error = "Error: --listen only works with --resident";
+        return false;
+    }
+    if (!options.resident.listen.empty()) {
+        Endpoint endpoint;
+        std::string endpointError;
+        if (!ParseEndpoint(options.resident.listen, endpoint, endpointError)) {
+            error = "Error: " + endpointError;
+            return false;
+        }
+        if (!endpoint.loopback() && options.resident.token.empty()) {
+            error = "Error: --listen on a network address needs --token; only loopback and unix: endpoints may go without one";
+            return false;
+        }
+    }
+    if (options.spotlight.enabled && (options.image.enabled() || !options.patterns.empty())) {
+        // Side windows change size on every move; a backdrop per size would be scaled each time
+        error = "Error: --spotlight cannot be combined with --image or --pattern";
+        return false;
+    }
+
+    return true;
+}
+
+std::string HelpText(const std::string& program) {
+#ifdef _WIN32
+    const std::string metricsName = "Local\\BlackScreenAppMetrics.<pid>";
+    const std::string recorderPath = "%TEMP%\\black_screen_app.<pid>.flight";
+    const std::string unixEndpoint;
+#else
+    const std::string unixEndpoint = " or unix:/path";
+    const std::string metricsName = "/black_screen_app_metrics.<pid>";
+    const std::string recorderPath = "/tmp/black_screen_app.<pid>.flight";
+#endif
+    const std::string p = "  " + program;
+    return
+        "Black Screen Application - Turn monitors black (emulate off)\n"
+        "\n"
+        "Usage:\n"
+        + p + " [OPTIONS]\n"
+        "\n"
+        "Options:\n"
+        "  -m, --monitor <indices>     Specify monitor indices to turn off (1-based).\n"
+        "                              Examples: -m 1 2, -m 2,3,4, -m 0 (all)\n"
+        "  -M, --monitor-name <names>  Specify monitor names to turn off (substring match).\n"
+        "                              Examples: -M \"Dell\" \"HP\", -M \"Laptop\"\n"
+        "  -q, --query <expr>          Select monitors with a query expression.\n"
+        "                              Selectors: all, primary, left, right, top, bottom,\n"
+        "                              <n>, name:<text>, adapter:<n>, rect:x,y,w,h,\n"
+        "                              point:x,y, adjacent(<expr>)\n"
+        "                              Operators: & (and), | (or), ! (not), ( )\n"
+        "  -r, --region <x,y,w,h>      Blank only this desktop area (repeatable).\n"
+        "  -R, --monitor-region <x,y,w,h>\n"
+        "                              Blank this area of each selected monitor. Negative\n"
+        "                              x/y count from the right/bottom, 0 w/h runs to the edge.\n"
+        "  -x, --except <x,y,w,h>      Keep this desktop area visible (repeatable).\n"
+        "  -c, --color <color>         Background color (e.g., #FF0000).\n"
+        "  -o, --opacity <0-100>       Window opacity in percent (default 100).\n"
+        "  -s, --style <sel>=<color>[@<opacity>]\n"
+        "                              Color/opacity for monitors matching a -q style\n"
+        "                              selector (repeatable, later styles win).\n"
+        "  --pattern [<sel>=]<name>    Show a calibration pattern instead of the color:\n"
+        "                              grid, checker, gradient, ramp or solid-cycle\n"
+        "                              (repeatable; <sel> as for -s, later ones win).\n"
+        "  --text <message>            Show a message on every blanked window (\\n breaks lines).\n"
+        "  --clock [format]            Show a clock (strftime format, default %H:%M).\n"
+        "  --text-color <color>        Message/clock color (default #606060).\n"
+        "  --text-size <points>        Message/clock size in points (default 24).\n"
+        "  --image <file>              Show an image on every blanked window (PNG, JPEG,\n"
+        "                              BMP, ... on Windows; BMP or PPM elsewhere).\n"
+        "  --image-fit <fill|fit|stretch>\n"
+        "                              Crop to fill (default), letterbox, or stretch.\n"
+        "  -dke, --disable-key-exit    Disable exiting with any key press.\n"
+        "  --resident                  Stay running with pre-created hidden windows.\n"
+        "                              Ctrl+Alt+B toggles blanking, Ctrl+Alt+Q quits.\n"
+        "  --pool <all|N>              Resident windows kept warm: every monitor (default)\n"
+        "                              or the N most blanked ones.\n"
+        "  --listen <endpoint>         With --resident, accept --control commands on\n"
+        "                              host:port" + unixEndpoint + ".\n"
+        "  --token <secret>            Shared secret required by --listen / sent by --control;\n"
+        "                              --listen needs one unless it is loopback-only.\n"
+        "  --control <cmd>[,<cmd>...]  Send commands to resident instances and report:\n"
+        "                              blank, unblank, toggle, status, list, ping.\n"
+        "  --target <endpoint>[,...]   Instance to control (repeatable).\n"
+        "  --targets-file <path>       Instances to control, one endpoint per line.\n"
+        "  --timeout <ms>              Per-instance deadline for --control (default 2000).\n"
+        "  --parallel <n>              Instances contacted at once (default 256).\n"
+        "  --spotlight [title]         Blank everything but one window and follow it as it\n"
+        "                              moves: the first whose title contains <title>, else\n"
+        "                              the active one. Implies --resident.\n"
+        "  --stress-input [events]     Replay a mouse/paint flood and key presses through\n"
+        "                              in-memory windows and report dispatch and\n"
+        "                              key-to-unblank percentiles (default 1000000 events).\n"
+        "  --stress-spotlight [moves]  Drag a spotlight window across in-memory monitors and\n"
+        "                              report per-move latency (default 100000 moves).\n"
+        "  --stress-occlusion [minutes]\n"
+        "                              Simulate other windows coming forward over blanked\n"
+        "                              monitors and compare the occlusion guard's wakeups\n"
+        "                              with polling (default 60 minutes).\n"
+        "  --decode-recorder <file>    Print a flight recording kept after a crash or hang\n"
+        "                              (" + recorderPath + ").\n"
+        "  --dump-topology <file>      Save what display enumeration reports (paths, modes,\n"
+        "                              names, monitors) for replay elsewhere.\n"
+        "  --replay-topology <file|dir> [iterations]\n"
+        "                              Replay saved topologies (every *.topology in a\n"
+        "                              directory) through monitor matching, check them\n"
+        "                              against the saved result and time them (default 1000).\n"
+        "  --metrics                   Publish counters and latency histograms to shared\n"
+        "                              memory (" + metricsName + ") every 5s.\n"
+        "  --metrics-file <path>       Also write them as a Prometheus text file.\n"
+        "  -l, --list                  List all detected monitors.\n"
+        "  -h, --help                  Show this help message.\n"
+        "\n"
+        "Examples:\n"
+        + p + " -m 0        \xE2\x86\x92 All monitors\n"
+        + p + " -m 1 2      \xE2\x86\x92 Monitors 1 and 2\n"
+        + p + " -M \"Dell\"   \xE2\x86\x92 Monitor with 'Dell' in name\n"
+        + p + " -M \"Dell\" \"HP\" \xE2\x86\x92 Multiple monitors by name\n"
+        + p + " -q \"left | adjacent(primary)\" \xE2\x86\x92 Left column and primary's neighbours\n"
+        + p + " -q \"adapter:1 & !primary\" \xE2\x86\x92 Adapter 1 except the primary\n"
+        + p + " -c \"#00FF00\" \xE2\x86\x92 Green background\n"
+        + p + " -m 0 -s \"2=gray@40\" \xE2\x86\x92 All black, monitor 2 dimmed gray\n"
+        + p + " -m 0 -x 560,240,800,600 \xE2\x86\x92 All but an 800x600 area\n"
+        + p + " -m 0 --pattern grid --pattern 2=ramp \xE2\x86\x92 Grid everywhere, ramp on monitor 2\n"
+        + p + " -m 0 -R 0,-200,0,200 \xE2\x86\x92 Bottom 200px of every monitor\n"
+        + p + " -m 0 --text \"Station locked\" --clock \xE2\x86\x92 Message and a dim clock\n"
+        + p + " -m 0 --image wall.png --image-fit fit \xE2\x86\x92 Letterboxed picture\n"
+        + p + " -m 0 --spotlight \"Slides\" \xE2\x86\x92 All but the window with Slides in its title\n"
+        + p + " -m 0 --resident --listen 0.0.0.0:7070 --token s3cret \xE2\x86\x92 Remotely controlled station\n"
+        + p + " --control blank --targets-file stations.txt --token s3cret \xE2\x86\x92 Blank every station\n";
+}
+
+std::string FormatMonitorList(const std::vector<MonitorData>& monitors) {
+    std::string listText = "Detected Monitors:\n";
+    listText += "====================\n\n";
+    listText += "Idx  Left    Top     Right   Bottom  Name\n";
+    listText += "---  ------  ------  ------  ------  ----\n";
+
+    for (size_t idx = 0; idx < monitors.size(); ++idx) {
+        const auto& m = monitors[idx];
+        char buffer[1256];
+        snprintf(buffer, sizeof(buffer), "%-3zu  %-6ld  %-6ld  %-6ld  %-6ld  (%d) %s\n",
+            idx + 1,
+            static_cast<long>(m.rect.left),
+            static_cast<long>(m.rect.top),
+            static_cast<long>(m.rect.right),
+            static_cast<long>(m.rect.bottom),
+            m.index,
+            m.name.c_str());
+
+        listText += buffer;
+    }
+    return listText;
+}
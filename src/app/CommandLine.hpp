@@ -0,0 +1,90 @@
+#pragma once
+#ifndef COMMANDLINE_HPP
+#define COMMANDLINE_HPP
+
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "DisplayCapture.hpp"
+#include "MonitorDetection.hpp"
+#include "MonitorSelector.hpp"
+#include "OcclusionGuard.hpp"
+#include "FleetController.hpp"
+#include "ImageBackdrop.hpp"
+#include "InputStress.hpp"
+#include "Selection.hpp"
+#include "Spotlight.hpp"
+#include "TextOverlay.hpp"
+#include "WindowPool.hpp"
+
+// --resident keeps the process alive with a pool of hidden windows:
+// Ctrl+Alt+B toggles blanking, Ctrl+Alt+Q quits, a key press unblanks
+struct ResidentOptions {
+    bool enabled = false;
+    PoolPolicy pool;
+    std::string listen;     // --listen endpoint for --control, empty for none
+    std::string token;      // --token controllers must present, empty for none
+};
+
+// What a window initiator blanks and how: the blanking part of the command
+// line, and what a BlackScreen.h session starts from
+struct InitiatorOptions {
+    std::tuple<int, int, int> color = { 0, 0, 0 };
+    bool disableKeyExit = false;
+    std::vector<int> monitorIndices = { -1 };   // 0-based, { -1 } for all
+    std::vector<std::string> monitorPatterns;
+    std::vector<MonitorQuery> monitorQueries;
+    BlankMask mask;
+    std::vector<MonitorStyle> styles;
+    std::vector<MonitorPattern> patterns;
+    int opacity = 100;
+    ResidentOptions resident;
+    OverlayOptions overlay;
+    ImageOptions image;
+    SpotlightOptions spotlight;
+};
+
+// Everything the command line asks for, shared by the Win32 and X11 front ends
+struct CommandLineOptions {
+    enum class Action { Blank, List, Help, Control, Stress, SpotlightStress, DecodeRecorder, DumpTopology, ReplayTopology, OcclusionStress };
+
+    Action action = Action::Blank;
+    std::string color = "black";
+    bool disableKeyExit = false;
+    std::vector<int> monitorIndices = { 0 };    // 0-based after parsing, { -1 } for all
+    std::vector<std::string> monitorPatterns;   // for -M
+    std::vector<MonitorQuery> monitorQueries;   // for -q
+    BlankMask mask;                             // for --region, --monitor-region, --except
+    std::vector<MonitorStyle> styles;           // for -s
+    std::vector<MonitorPattern> patterns;       // for --pattern
+    int opacity = 100;                          // for -o
+    ResidentOptions resident;                   // for --resident, --pool
+    OverlayOptions overlay;                     // for --text, --clock, --text-color, --text-size
+    ImageOptions image;                         // for --image, --image-fit
+    FleetOptions fleet;                         // for --control, --target(s-file), --timeout, --parallel
+    StressOptions stress;                       // for --stress-input
+    SpotlightOptions spotlight;                 // for --spotlight
+    SpotlightStressOptions spotlightStress;     // for --stress-spotlight
+    OcclusionStressOptions occlusionStress;     // for --stress-occlusion
+    std::string recorderFile;                   // for --decode-recorder
+    std::string topologyFile;                   // for --dump-topology
+    TopologyReplayOptions topologyReplay;       // for --replay-topology
+    bool publishMetrics = false;                // for --metrics, --metrics-file
+    std::string metricsFile;
+
+    // The blanking options, color parsed
+    InitiatorOptions initiator() const;
+};
+
+// Parses UTF-8 arguments without the program name. -l and -h win over
+// everything else; monitorCount bounds -m. On invalid input returns false
+// with a user-facing message in error.
+bool ParseCommandLine(const std::vector<std::string>& args, size_t monitorCount,
+    CommandLineOptions& options, std::string& error);
+
+std::string HelpText(const std::string& program);
+std::string FormatMonitorList(const std::vector<MonitorData>& monitors);
+
+#endif // COMMANDLINE_HPP
@@ -0,0 +1,381 @@
+#include "DisplayCapture.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "MappedFile.hpp"
+#include "MonitorSelector.hpp"
+
+std::vector<MonitorData> MatchDisplayCapture(const DisplayCapture& capture) {
+    std::vector<MonitorData> result;
+
+    // Step 1: names, adapters and source positions of the active paths
+    std::vector<std::string> friendlyNames;
+    std::vector<POINT> configPositions;
+    std::vector<int> configAdapters;
+    std::vector<uint64_t> adapterIds;
+
+    const std::vector<DisplayCapture::Mode>& modes = capture.modes;
+    for (const DisplayCapture::Path& path : capture.paths) {
+        if (!(path.flags & DisplayCapture::kPathActive)) continue;
+        friendlyNames.push_back(path.targetName);
+
+        // Number adapters in the order QueryDisplayConfig reports them
+        auto adapter = std::find(adapterIds.begin(), adapterIds.end(), path.adapter);
+        if (adapter == adapterIds.end()) {
+            adapterIds.push_back(path.adapter);
+            adapter = adapterIds.end() - 1;
+        }
+        configAdapters.push_back(static_cast<int>(adapter - adapterIds.begin()) + 1);
+
+        // The source mode the path points at, if it belongs to the same adapter
+        const DisplayCapture::Mode* sourceMode = nullptr;
+        if (path.sourceModeIndex < modes.size() &&
+            modes[path.sourceModeIndex].infoType == DisplayCapture::kModeSource &&
+            modes[path.sourceModeIndex].adapter == path.adapter) {
+            sourceMode = &modes[path.sourceModeIndex];
+        }
+        else {
+            // Fallback - match by source ID, not by modeInfoIdx
+            for (const DisplayCapture::Mode& mode : modes) {
+                if (mode.infoType == DisplayCapture::kModeSource && mode.adapter == path.adapter && mode.id == path.sourceId) {
+                    sourceMode = &mode;
+                    break;
+                }
+            }
+        }
+
+        // Final fallback - use dummy position (this should be rare)
+        configPositions.push_back(sourceMode ? POINT{ sourceMode->x, sourceMode->y } : POINT{ 0, 0 });
+    }
+
+    // Step 2: name the active monitors by top-left position. Monitors sharing
+    // an origin (X11 clones, overlapping --setmonitor) each take the next
+    // unclaimed path there, so they keep their own RandR names; a Windows clone
+    // is one monitor over several paths and still takes the first.
+    std::vector<char> claimed(configPositions.size(), 0);
+    for (const DisplayCapture::Monitor& monitor : capture.monitors) {
+        std::string monitorName = "Monitor " + std::to_string(result.size() + 1);
+        int adapter = 0;
+        size_t match = configPositions.size();
+        for (size_t i = 0; i < configPositions.size(); i++) {
+            if (configPositions[i].x == monitor.rect.left && configPositions[i].y == monitor.rect.top) {
+                if (match == configPositions.size()) match = i;
+                if (!claimed[i]) {
+                    match = i;
+                    break;
+                }
+            }
+        }
+        if (match < configPositions.size()) {
+            claimed[match] = 1;
+            monitorName = friendlyNames[match];
+            adapter = configAdapters[match];
+        }
+        result.push_back({ monitor.handle, monitor.rect, static_cast<int>(result.size()), monitorName,
+            monitor.primary, adapter });
+    }
+    return result;
+}
+
+namespace {
+    // Start of a capture file; paths, modes, monitors and the recorded result
+    // follow as packed little records, strings as a 32-bit length and UTF-8
+    struct CaptureHeader {
+        static constexpr uint32_t kMagic = 0x43544242;     // "BBTC"
+        static constexpr uint32_t kVersion = 1;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t paths;
+        uint32_t modes;
+        uint32_t monitors;
+        uint32_t recorded;
+    };
+
+    class Writer {
+    public:
+        template <typename T>
+        void put(T value) {
+            const size_t at = m_bytes.size();
+            m_bytes.resize(at + sizeof(value));
+            std::memcpy(m_bytes.data() + at, &value, sizeof(value));
+        }
+        void putString(const std::string& text) {
+            put(static_cast<uint32_t>(text.size()));
+            m_bytes += text;
+        }
+        void putRect(const RECT& rect) {
+            put(static_cast<int32_t>(rect.left));
+            put(static_cast<int32_t>(rect.top));
+            put(static_cast<int32_t>(rect.right));
+            put(static_cast<int32_t>(rect.bottom));
+        }
+
+        const std::string& bytes() const { return m_bytes; }
+
+    private:
+        std::string m_bytes;
+    };
+
+    // Reads past the end turn ok() false and return zeros
+    class Reader {
+    public:
+        Reader(const uint8_t* data, size_t size) : m_at(data), m_end(data + size) {}
+
+        template <typename T>
+        T get() {
+            T value{};
+            if (static_cast<size_t>(m_end - m_at) < sizeof(value)) {
+                m_ok = false;
+                return value;
+            }
+            std::memcpy(&value, m_at, sizeof(value));
+            m_at += sizeof(value);
+            return value;
+        }
+        std::string getString() {
+            const uint32_t size = get<uint32_t>();
+            if (!m_ok || static_cast<size_t>(m_end - m_at) < size) {
+                m_ok = false;
+                return {};
+            }
+            std::string text(reinterpret_cast<const char*>(m_at), size);
+            m_at += size;
+            return text;
+        }
+        RECT getRect() {
+            RECT rect = {};
+            rect.left = get<int32_t>();
+            rect.top = get<int32_t>();
+            rect.right = get<int32_t>();
+            rect.bottom = get<int32_t>();
+            return rect;
+        }
+
+        bool ok() const { return m_ok; }
+
+    private:
+        const uint8_t* m_at;
+        const uint8_t* m_end;
+        bool m_ok = true;
+    };
+}
+
+bool SaveDisplayCapture(const std::string& path, const DisplayCapture& capture, std::string& error) {
+    Writer writer;
+    writer.put(CaptureHeader{ CaptureHeader::kMagic, CaptureHeader::kVersion, static_cast<uint32_t>(capture.paths.size()),
+        static_cast<uint32_t>(capture.modes.size()), static_cast<uint32_t>(capture.monitors.size()),
+        static_cast<uint32_t>(capture.recorded.size()) });
+    for (const DisplayCapture::Path& p : capture.paths) {
+        writer.put(p.adapter);
+        writer.put(p.targetId);
+        writer.put(p.sourceId);
+        writer.put(p.sourceModeIndex);
+        writer.put(p.flags);
+        writer.putString(p.targetName);
+    }
+    for (const DisplayCapture::Mode& m : capture.modes) {
+        writer.put(m.infoType);
+        writer.put(m.id);
+        writer.put(m.adapter);
+        writer.put(m.x);
+        writer.put(m.y);
+        writer.put(m.width);
+        writer.put(m.height);
+    }
+    for (const DisplayCapture::Monitor& m : capture.monitors) {
+        writer.putRect(m.rect);
+        writer.put(static_cast<uint8_t>(m.primary));
+    }
+    for (const MonitorData& m : capture.recorded) {
+        writer.putRect(m.rect);
+        writer.put(static_cast<uint8_t>(m.primary));
+        writer.put(static_cast<int32_t>(m.adapter));
+        writer.putString(m.name);
+    }
+
+    std::ofstream file(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+    file.write(writer.bytes().data(), static_cast<std::streamsize>(writer.bytes().size()));
+    if (!file) {
+        error = "Cannot write topology capture '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+bool LoadDisplayCapture(const std::string& path, DisplayCapture& capture, std::string& error) {
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "Cannot read topology capture '" + path + "'";
+        return false;
+    }
+    Reader reader(file.data(), file.size());
+    const CaptureHeader header = reader.get<CaptureHeader>();
+    if (!reader.ok() || header.magic != CaptureHeader::kMagic) {
+        error = "'" + path + "' is not a topology capture";
+        return false;
+    }
+    if (header.version != CaptureHeader::kVersion) {
+        error = "'" + path + "' is not a topology capture this version can read";
+        return false;
+    }
+
+    // Counts come from the file, so stop at the first short read instead of reserving
+    capture = {};
+    for (uint32_t k = 0; k < header.paths && reader.ok(); ++k) {
+        DisplayCapture::Path p;
+        p.adapter = reader.get<uint64_t>();
+        p.targetId = reader.get<uint32_t>();
+        p.sourceId = reader.get<uint32_t>();
+        p.sourceModeIndex = reader.get<uint32_t>();
+        p.flags = reader.get<uint32_t>();
+        p.targetName = reader.getString();
+        capture.paths.push_back(std::move(p));
+    }
+    for (uint32_t k = 0; k < header.modes && reader.ok(); ++k) {
+        DisplayCapture::Mode m;
+        m.infoType = reader.get<uint32_t>();
+        m.id = reader.get<uint32_t>();
+        m.adapter = reader.get<uint64_t>();
+        m.x = reader.get<int32_t>();
+        m.y = reader.get<int32_t>();
+        m.width = reader.get<uint32_t>();
+        m.height = reader.get<uint32_t>();
+        capture.modes.push_back(m);
+    }
+    for (uint32_t k = 0; k < header.monitors && reader.ok(); ++k) {
+        DisplayCapture::Monitor m;
+        m.rect = reader.getRect();
+        m.primary = reader.get<uint8_t>() != 0;
+        capture.monitors.push_back(m);
+    }
+    for (uint32_t k = 0; k < header.recorded && reader.ok(); ++k) {
+        MonitorData m = {};
+        m.rect = reader.getRect();
+        m.primary = reader.get<uint8_t>() != 0;
+        m.adapter = reader.get<int32_t>();
+        m.name = reader.getString();
+        m.index = static_cast<int>(k);
+        capture.recorded.push_back(std::move(m));
+    }
+    if (!reader.ok()) {
+        error = "'" + path + "' is truncated";
+        return false;
+    }
+    return true;
+}
+
+namespace {
+    std::string Describe(const MonitorData& m) {
+        char text[64];
+        snprintf(text, sizeof(text), " %ld,%ld-%ld,%ld adapter %d%s", static_cast<long>(m.rect.left),
+            static_cast<long>(m.rect.top), static_cast<long>(m.rect.right), static_cast<long>(m.rect.bottom),
+            m.adapter, m.primary ? " primary" : "");
+        return "'" + m.name + "'" + text;
+    }
+
+    // The first difference, or empty when the lists are the same
+    std::string Compare(const std::vector<MonitorData>& recorded, const std::vector<MonitorData>& replayed) {
+        for (size_t k = 0; k < (std::min)(recorded.size(), replayed.size()); ++k) {
+            const MonitorData& a = recorded[k];
+            const MonitorData& b = replayed[k];
+            if (a.name != b.name || a.primary != b.primary || a.adapter != b.adapter || a.rect.left != b.rect.left ||
+                a.rect.top != b.rect.top || a.rect.right != b.rect.right || a.rect.bottom != b.rect.bottom) {
+                return "monitor " + std::to_string(k + 1) + ": recorded " + Describe(a) + ", replayed " + Describe(b);
+            }
+        }
+        if (recorded.size() != replayed.size()) {
+            return "recorded " + std::to_string(recorded.size()) + " monitors, replayed " + std::to_string(replayed.size());
+        }
+        return {};
+    }
+
+    std::string Microseconds(uint64_t nanos) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.2f us", static_cast<double>(nanos) / 1e3);
+        return text;
+    }
+
+    std::string Percentiles(const LatencyHistogram::Summary& s) {
+        return "p50 " + Microseconds(s.p50) + ", p99 " + Microseconds(s.p99) + ", max " + Microseconds(s.max);
+    }
+
+    TopologyReplayResult Replay(const std::string& path, size_t iterations) {
+        TopologyReplayResult result;
+        result.file = path;
+        DisplayCapture capture;
+        if (!LoadDisplayCapture(path, capture, result.error)) return result;
+        result.paths = capture.paths.size();
+        result.modes = capture.modes.size();
+        result.monitors = capture.monitors.size();
+
+        LatencyHistogram match;
+        LatencyHistogram index;
+        std::vector<MonitorData> monitors;
+        for (size_t k = 0; k < iterations; ++k) {
+            const uint64_t start = MetricsClock();
+            monitors = MatchDisplayCapture(capture);
+            const uint64_t matched = MetricsClock();
+            const SpatialIndex spatial(monitors);
+            index.record(MetricsClock() - matched);
+            match.record(matched - start);
+        }
+        result.mismatch = Compare(capture.recorded, monitors);
+        result.match = match.summarize();
+        result.index = index.summarize();
+        return result;
+    }
+}
+
+std::vector<TopologyReplayResult> RunTopologyReplay(const TopologyReplayOptions& options) {
+    std::error_code ignored;
+    const std::filesystem::path root(options.path);
+    if (!std::filesystem::is_directory(root, ignored)) return { Replay(options.path, options.iterations) };
+
+    // A corpus directory: every capture in it, in name order so reports diff cleanly
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator(root, ignored)) {
+        if (entry.path().extension() == ".topology") files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<TopologyReplayResult> results;
+    for (const std::string& file : files) results.push_back(Replay(file, options.iterations));
+    if (results.empty()) {
+        TopologyReplayResult none;
+        none.file = options.path;
+        none.error = "No .topology files in '" + options.path + "'";
+        results.push_back(none);
+    }
+    return results;
+}
+
+std::string FormatTopologyReplayReport(const std::vector<TopologyReplayResult>& results) {
+    std::string text = "Topology replay: " + std::to_string(results.size()) + " capture(s)\n";
+    size_t passed = 0;
+    for (const TopologyReplayResult& r : results) {
+        if (!r.error.empty()) {
+            text += "ERROR     " + r.error + "\n";
+            continue;
+        }
+        const std::string name = std::filesystem::path(r.file).filename().string();
+        text += (r.mismatch.empty() ? "ok        " : "MISMATCH  ") + name + ": " + std::to_string(r.paths) + " paths, " +
+            std::to_string(r.modes) + " modes, " + std::to_string(r.monitors) + " monitors\n";
+        if (!r.mismatch.empty()) text += "          " + r.mismatch + "\n";
+        else ++passed;
+        text += "          match " + Percentiles(r.match) + "\n";
+        text += "          index " + Percentiles(r.index) + "\n";
+    }
+    text += std::to_string(passed) + " of " + std::to_string(results.size()) + " replayed to their recorded result\n";
+    return text;
+}
+
+bool TopologyReplayPassed(const std::vector<TopologyReplayResult>& results) {
+    return std::ranges::all_of(results, [](const TopologyReplayResult& r) {
+        return r.error.empty() && r.mismatch.empty();
+    });
+}
@@ -0,0 +1,92 @@
+#pragma once
+#ifndef DISPLAYCAPTURE_HPP
+#define DISPLAYCAPTURE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Metrics.hpp"
+#include "MonitorDetection.hpp"
+
+// What the OS reported while enumerating, before any matching: the
+// QueryDisplayConfig(QDC_ALL_PATHS) paths and modes, target names and the
+// EnumDisplayMonitors results. On X11 every RandR monitor is recorded as one
+// active path with a source mode at its origin, so both platforms share the
+// matching below.
+struct DisplayCapture {
+    // Values of the DisplayConfig constants the matching looks at
+    static constexpr uint32_t kPathActive = 0x1;        // DISPLAYCONFIG_PATH_ACTIVE
+    static constexpr uint32_t kModeSource = 1;          // DISPLAYCONFIG_MODE_INFO_TYPE_SOURCE
+
+    struct Path {
+        uint64_t adapter;           // target adapter LUID, HighPart << 32 | LowPart
+        uint32_t targetId;
+        uint32_t sourceId;
+        uint32_t sourceModeIndex;   // sourceInfo.modeInfoIdx, may be out of range
+        uint32_t flags;
+        std::string targetName;     // friendly name, UTF-8; only read for active paths
+    };
+
+    struct Mode {
+        uint32_t infoType;
+        uint32_t id;
+        uint64_t adapter;
+        int32_t x;                  // source modes only: desktop position and size
+        int32_t y;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct Monitor {
+        RECT rect;
+        bool primary;
+        HMONITOR handle = nullptr;  // live captures only, never saved
+    };
+
+    std::vector<Path> paths;
+    std::vector<Mode> modes;
+    std::vector<Monitor> monitors;  // in EnumDisplayMonitors order
+    std::vector<MonitorData> recorded;  // what matching produced when the capture was taken
+};
+
+// Implemented per platform, next to EnumerateMonitorsWithNames
+DisplayCapture CaptureDisplay();
+
+// Names the captured monitors from the paths whose source sits at the same
+// top-left corner. EnumerateMonitorsWithNames is CaptureDisplay() fed
+// through this, so a replayed capture takes exactly the live code path.
+std::vector<MonitorData> MatchDisplayCapture(const DisplayCapture& capture);
+
+// --dump-topology: a compact binary file, paths are UTF-8
+bool SaveDisplayCapture(const std::string& path, const DisplayCapture& capture, std::string& error);
+bool LoadDisplayCapture(const std::string& path, DisplayCapture& capture, std::string& error);
+
+// --replay-topology: one capture file, or every *.topology file in a directory
+struct TopologyReplayOptions {
+    std::string path;
+    size_t iterations = 1000;
+};
+
+struct TopologyReplayResult {
+    std::string file;
+    std::string error;              // unreadable file; nothing else is set
+    size_t paths = 0;
+    size_t modes = 0;
+    size_t monitors = 0;
+    std::string mismatch;           // how the replay differs from the recorded result, empty if it matches
+    LatencyHistogram::Summary match;    // MatchDisplayCapture
+    LatencyHistogram::Summary index;    // SpatialIndex over the result
+};
+
+// Replays every capture through the matching and the spatial index, checks
+// the result against the recorded one and times both
+std::vector<TopologyReplayResult> RunTopologyReplay(const TopologyReplayOptions& options);
+
+std::string FormatTopologyReplayReport(const std::vector<TopologyReplayResult>& results);
+
+// True when every capture was readable and replayed to its recorded result
+bool TopologyReplayPassed(const std::vector<TopologyReplayResult>& results);
+
+#endif // DISPLAYCAPTURE_HPP
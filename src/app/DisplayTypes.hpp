@@ -0,0 +1,25 @@
+#pragma once
+#ifndef DISPLAYTYPES_HPP
+#define DISPLAYTYPES_HPP
+
+// Win32 geometry types used by the topology and selection code. Other
+// platforms get layout-compatible stand-ins so that code is shared.
+#ifdef _WIN32
+#include <windows.h>
+#else
+struct RECT {
+    long left;
+    long top;
+    long right;
+    long bottom;
+};
+
+struct POINT {
+    long x;
+    long y;
+};
+
+using HMONITOR = void*;     // platform output handle, unused outside Win32
+#endif
+
+#endif // DISPLAYTYPES_HPP
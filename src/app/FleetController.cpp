@@ -0,0 +1,226 @@
+#include "FleetController.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+
+#include "Metrics.hpp"
+#include "Socket.hpp"
+
+namespace {
+    // One target between connect and its last response
+    struct Flight {
+        size_t index = 0;
+        SocketHandle socket = kInvalidSocket;
+        bool connected = false;
+        size_t sent = 0;
+        size_t answered = 0;
+        uint64_t start = 0;
+        uint64_t deadline = 0;
+        LineBuffer input;
+    };
+
+    const char* StatusName(FleetResult::Status status) {
+        switch (status) {
+            case FleetResult::Status::Ok: return "ok";
+            case FleetResult::Status::Failed: return "failed";
+            case FleetResult::Status::TimedOut: return "timed out";
+            case FleetResult::Status::Unreachable: return "unreachable";
+        }
+        return "?";
+    }
+
+    std::string Milliseconds(uint64_t nanos) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.1f ms", static_cast<double>(nanos) / 1e6);
+        return text;
+    }
+}
+
+std::vector<FleetResult> RunFleet(const FleetOptions& options) {
+    const size_t targetCount = options.targets.size();
+    const size_t commandCount = options.commands.size();
+    std::vector<FleetResult> results(targetCount);
+
+    // The same bytes go to every target: auth as id 0, then command k as id k + 1
+    std::string script;
+    if (!options.token.empty()) script += EncodeRequest({ 0, "auth", options.token });
+    for (size_t k = 0; k < commandCount; ++k) {
+        script += EncodeRequest({ static_cast<uint32_t>(k + 1), options.commands[k], {} });
+    }
+
+    const uint64_t timeout = static_cast<uint64_t>(options.timeoutMs) * 1'000'000;
+    const size_t parallel = (std::max)(options.parallel, size_t{ 1 });
+    std::vector<Flight> flights;
+    std::vector<SocketPoll> polls;
+    std::vector<char> buffer(64 * 1024);
+    size_t next = 0;
+
+    auto finish = [&results](Flight& flight, FleetResult::Status status, std::string error) {
+        FleetResult& result = results[flight.index];
+        result.status = status;
+        result.error = std::move(error);
+        result.latency = MetricsClock() - flight.start;
+        CloseSocket(flight.socket);
+        flight.socket = kInvalidSocket;
+    };
+
+    while (next < targetCount || !flights.empty()) {
+        while (flights.size() < parallel && next < targetCount) {
+            FleetResult& result = results[next];
+            result.target = options.targets[next];
+            result.responses.resize(commandCount);
+
+            Endpoint endpoint;
+            std::string error;
+            const SocketHandle socket = ParseEndpoint(result.target, endpoint, error) ? Connect(endpoint, error) : kInvalidSocket;
+            if (socket == kInvalidSocket) {
+                result.error = error;
+                ++next;
+                continue;
+            }
+            Flight& flight = flights.emplace_back();
+            flight.index = next++;
+            flight.socket = socket;
+            flight.start = MetricsClock();
+            flight.deadline = flight.start + timeout;
+        }
+        if (flights.empty()) continue;
+
+        polls.clear();
+        uint64_t earliest = UINT64_MAX;
+        for (const Flight& flight : flights) {
+            polls.push_back({ .socket = flight.socket, .wantRead = flight.connected,
+                              .wantWrite = !flight.connected || flight.sent < script.size() });
+            earliest = (std::min)(earliest, flight.deadline);
+        }
+        const uint64_t now = MetricsClock();
+        const int wait = earliest <= now ? 0 : static_cast<int>((std::min)((earliest - now + 999'999) / 1'000'000, uint64_t{ 1000 }));
+        PollSockets(polls, wait);
+
+        const uint64_t polledAt = MetricsClock();
+        for (size_t k = 0; k < flights.size(); ++k) {
+            Flight& flight = flights[k];
+            const SocketPoll& poll = polls[k];
+            FleetResult& result = results[flight.index];
+
+            if (!flight.connected && (poll.writable || poll.failed)) {
+                std::string error;
+                if (!ConnectFinished(flight.socket, error)) {
+                    finish(flight, FleetResult::Status::Unreachable, error);
+                    continue;
+                }
+                flight.connected = true;
+            }
+
+            if (flight.connected && flight.sent < script.size()) {
+                const long sent = SendSome(flight.socket, script.data() + flight.sent, script.size() - flight.sent);
+                if (sent == -1) {
+                    finish(flight, FleetResult::Status::Failed, "connection lost while sending");
+                    continue;
+                }
+                if (sent > 0) flight.sent += static_cast<size_t>(sent);
+            }
+
+            if (flight.connected && (poll.readable || poll.failed)) {
+                bool closed = false;
+                for (;;) {
+                    const long received = ReceiveSome(flight.socket, buffer.data(), buffer.size());
+                    if (received == kSocketWouldBlock) break;
+                    if (received <= 0) {
+                        closed = true;
+                        break;
+                    }
+                    flight.input.append(buffer.data(), static_cast<size_t>(received));
+                }
+
+                std::string line;
+                FleetResponse response;
+                while (flight.socket != kInvalidSocket && flight.input.next(line)) {
+                    if (!ParseResponse(line, response)) {
+                        finish(flight, FleetResult::Status::Failed, "malformed response");
+                    }
+                    else if (response.id == 0) {
+                        // auth, or the server rejecting a line it could not parse
+                        if (!response.ok) finish(flight, FleetResult::Status::Failed, response.text);
+                    }
+                    else if (response.id <= commandCount) {
+                        FleetResponse& slot = result.responses[response.id - 1];
+                        if (slot.id == 0) ++flight.answered;
+                        slot = std::move(response);
+                    }
+                }
+                if (flight.socket == kInvalidSocket) continue;
+
+                if (flight.answered == commandCount) {
+                    auto failed = std::ranges::find(result.responses, false, &FleetResponse::ok);
+                    if (failed == result.responses.end()) {
+                        finish(flight, FleetResult::Status::Ok, {});
+                    }
+                    else {
+                        const std::string& command = options.commands[static_cast<size_t>(failed - result.responses.begin())];
+                        finish(flight, FleetResult::Status::Failed, command + ": " + failed->text);
+                    }
+                    continue;
+                }
+                if (closed || flight.input.overflowed()) {
+                    finish(flight, FleetResult::Status::Failed, "connection closed after " + std::to_string(flight.answered) +
+                        " of " + std::to_string(commandCount) + " responses");
+                    continue;
+                }
+            }
+
+            if (polledAt >= flight.deadline) {
+                finish(flight, FleetResult::Status::TimedOut, flight.connected
+                    ? "after " + std::to_string(flight.answered) + " of " + std::to_string(commandCount) + " responses"
+                    : "while connecting");
+            }
+        }
+        std::erase_if(flights, [](const Flight& flight) { return flight.socket == kInvalidSocket; });
+    }
+    return results;
+}
+
+std::string FormatFleetReport(const FleetOptions& options, const std::vector<FleetResult>& results, uint64_t elapsed) {
+    std::string report;
+    std::array<size_t, 4> counts = {};
+    LatencyHistogram latencies;
+
+    for (const FleetResult& result : results) {
+        ++counts[static_cast<size_t>(result.status)];
+        report += result.target + ": " + StatusName(result.status);
+        if (result.status != FleetResult::Status::Ok) {
+            if (!result.error.empty()) report += " (" + result.error + ")";
+            report += "\n";
+            continue;
+        }
+        latencies.record(result.latency);
+
+        // Single-line answers share the target's line; listings go underneath, indented
+        std::string details;
+        for (size_t k = 0; k < result.responses.size(); ++k) {
+            const std::string& text = result.responses[k].text;
+            if (text.empty()) continue;
+            if (text.find('\n') == std::string::npos) {
+                report += ", " + options.commands[k] + " " + text;
+                continue;
+            }
+            for (size_t start = 0; start < text.size();) {
+                const size_t end = (std::min)(text.find('\n', start), text.size());
+                details += "    " + text.substr(start, end - start) + "\n";
+                start = end + 1;
+            }
+        }
+        report += "\n" + details;
+    }
+
+    const LatencyHistogram::Summary summary = latencies.summarize();
+    report += "\n" + std::to_string(results.size()) + " targets in " + Milliseconds(elapsed) + ": " +
+        std::to_string(counts[0]) + " ok, " + std::to_string(counts[1]) + " failed, " +
+        std::to_string(counts[2]) + " timed out, " + std::to_string(counts[3]) + " unreachable\n";
+    if (summary.count > 0) {
+        report += "Latency p50 " + Milliseconds(summary.p50) + ", p90 " + Milliseconds(summary.p90) +
+            ", p99 " + Milliseconds(summary.p99) + ", max " + Milliseconds(summary.max) + "\n";
+    }
+    return report;
+}
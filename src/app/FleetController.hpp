@@ -0,0 +1,40 @@
+#pragma once
+#ifndef FLEETCONTROLLER_HPP
+#define FLEETCONTROLLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FleetProtocol.hpp"
+
+// --control: what to send, and to whom
+struct FleetOptions {
+    std::vector<std::string> targets;       // endpoints, see ParseEndpoint
+    std::vector<std::string> commands;      // verbs, pipelined in this order on every connection
+    std::string token;                      // sent first as "auth" when not empty
+    int timeoutMs = 2000;                   // per target, from connect to the last response
+    size_t parallel = 256;                  // connections open at once
+};
+
+struct FleetResult {
+    enum class Status { Ok, Failed, TimedOut, Unreachable };
+
+    std::string target;
+    Status status = Status::Unreachable;
+    std::string error;                      // why it was not Ok
+    std::vector<FleetResponse> responses;   // one per command, in command order
+    uint64_t latency = 0;                   // ns from connect to the last response
+};
+
+// Drives every target from one thread: non-blocking connects, all commands
+// written at once, responses matched by id. At most options.parallel
+// targets are in flight; each one has its own deadline.
+std::vector<FleetResult> RunFleet(const FleetOptions& options);
+
+// Per-target lines for failures and command output, then a summary with
+// latency percentiles
+std::string FormatFleetReport(const FleetOptions& options, const std::vector<FleetResult>& results, uint64_t elapsed);
+
+#endif // FLEETCONTROLLER_HPP
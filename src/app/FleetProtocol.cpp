@@ -0,0 +1,111 @@
+#include "FleetProtocol.hpp"
+
+#include <charconv>
+
+namespace {
+    std::string Escape(std::string_view text) {
+        std::string result;
+        result.reserve(text.size());
+        for (char c : text) {
+            if (c == '\\') result += "\\\\";
+            else if (c == '\n') result += "\\n";
+            else if (c == '\r') result += "\\r";
+            else result += c;
+        }
+        return result;
+    }
+
+    std::string Unescape(std::string_view text) {
+        std::string result;
+        result.reserve(text.size());
+        for (size_t k = 0; k < text.size(); ++k) {
+            if (text[k] != '\\' || k + 1 == text.size()) {
+                result += text[k];
+                continue;
+            }
+            const char next = text[++k];
+            result += next == 'n' ? '\n' : next == 'r' ? '\r' : next;
+        }
+        return result;
+    }
+
+    // "<id> <rest>"; rest may be empty when there is no space
+    bool SplitId(std::string_view line, uint32_t& id, std::string_view& rest) {
+        const size_t space = line.find(' ');
+        const std::string_view digits = line.substr(0, space);
+        const auto [end, code] = std::from_chars(digits.data(), digits.data() + digits.size(), id);
+        if (digits.empty() || code != std::errc() || end != digits.data() + digits.size()) return false;
+        rest = space == std::string_view::npos ? std::string_view() : line.substr(space + 1);
+        return true;
+    }
+}
+
+std::string EncodeRequest(const FleetRequest& request) {
+    std::string line = std::to_string(request.id) + ' ' + request.verb;
+    if (!request.argument.empty()) line += ' ' + Escape(request.argument);
+    return line + '\n';
+}
+
+std::string EncodeResponse(const FleetResponse& response) {
+    std::string line = std::to_string(response.id) + (response.ok ? " ok" : " err");
+    if (!response.text.empty()) line += ' ' + Escape(response.text);
+    return line + '\n';
+}
+
+bool ParseRequest(std::string_view line, FleetRequest& request) {
+    std::string_view rest;
+    if (!SplitId(line, request.id, rest)) return false;
+
+    const size_t space = rest.find(' ');
+    request.verb = std::string(rest.substr(0, space));
+    request.argument = space == std::string_view::npos ? std::string() : Unescape(rest.substr(space + 1));
+    return !request.verb.empty() && request.verb.find_first_not_of("abcdefghijklmnopqrstuvwxyz") == std::string::npos;
+}
+
+bool ParseResponse(std::string_view line, FleetResponse& response) {
+    std::string_view rest;
+    if (!SplitId(line, response.id, rest)) return false;
+
+    const size_t space = rest.find(' ');
+    const std::string_view status = rest.substr(0, space);
+    if (status != "ok" && status != "err") return false;
+    response.ok = status == "ok";
+    response.text = space == std::string_view::npos ? std::string() : Unescape(rest.substr(space + 1));
+    return true;
+}
+
+bool IsFleetCommand(std::string_view verb) {
+    for (std::string_view known : { "ping", "status", "list", "blank", "unblank", "toggle" }) {
+        if (verb == known) return true;
+    }
+    return false;
+}
+
+void LineBuffer::append(const char* data, size_t size) {
+    if (m_overflow) return;
+    // Drop consumed lines before growing, so the buffer holds at most one partial line plus the new data
+    if (m_start > 0) {
+        m_data.erase(0, m_start);
+        m_start = 0;
+    }
+    m_data.append(data, size);
+}
+
+bool LineBuffer::next(std::string& line) {
+    if (m_overflow) return false;
+    const size_t end = m_data.find('\n', m_start);
+    if (end == std::string::npos) {
+        m_overflow = m_data.size() - m_start > m_maxLine;
+        return false;
+    }
+    if (end - m_start > m_maxLine) {
+        m_overflow = true;
+        return false;
+    }
+
+    size_t length = end - m_start;
+    if (length > 0 && m_data[m_start + length - 1] == '\r') --length;     // tolerate CRLF from hand-typed sessions
+    line.assign(m_data, m_start, length);
+    m_start = end + 1;
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#ifndef FLEETPROTOCOL_HPP
+#define FLEETPROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Line protocol between --control and a --listen instance. A request is
+// "<id> <verb>[ <argument>]\n", a response "<id> ok[ <text>]\n" or
+// "<id> err <message>\n". Clients may pipeline any number of requests on a
+// connection; responses echo the id and may arrive out of order. Text and
+// arguments escape '\\', '\n' and '\r' so every message stays on one line.
+//
+// Verbs: ping, auth <token>, status, list, blank, unblank, toggle. With a
+// token configured, everything but ping and auth is refused until auth.
+struct FleetRequest {
+    uint32_t id = 0;
+    std::string verb;
+    std::string argument;
+};
+
+struct FleetResponse {
+    uint32_t id = 0;
+    bool ok = false;
+    std::string text;
+};
+
+std::string EncodeRequest(const FleetRequest& request);
+std::string EncodeResponse(const FleetResponse& response);
+bool ParseRequest(std::string_view line, FleetRequest& request);
+bool ParseResponse(std::string_view line, FleetResponse& response);
+
+// The verbs a controller may send to blank, unblank or query instances
+bool IsFleetCommand(std::string_view verb);
+
+// Splits a byte stream into lines without the terminator. Input is kept
+// only until its line is complete; a line longer than the limit poisons
+// the buffer, since the peer is not speaking the protocol.
+class LineBuffer {
+public:
+    LineBuffer() = default;
+    explicit LineBuffer(size_t maxLine) : m_maxLine(maxLine) {}
+
+    void append(const char* data, size_t size);
+    bool next(std::string& line);
+    bool overflowed() const { return m_overflow; }
+
+private:
+    std::string m_data;
+    size_t m_start = 0;
+    size_t m_maxLine = 64 * 1024;
+    bool m_overflow = false;
+};
+
+#endif // FLEETPROTOCOL_HPP
@@ -0,0 +1,212 @@
+#include "FleetServer.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+#include "CommandLine.hpp"
+#include "Topology.hpp"
+
+namespace {
+    // Compares every byte, so response timing does not reveal the matching prefix
+    bool TokensEqual(const std::string& a, const std::string& b) {
+        unsigned char difference = a.size() == b.size() ? 0 : 1;
+        for (size_t k = 0; k < a.size(); ++k) {
+            difference |= static_cast<unsigned char>(a[k] ^ (k < b.size() ? b[k] : 0));
+        }
+        return difference == 0;
+    }
+}
+
+bool FleetServer::start(const std::string& endpoint, const std::string& token, std::string& error) {
+    Endpoint parsed;
+    if (!ParseEndpoint(endpoint, parsed, error)) {
+        return false;
+    }
+    // Anyone who can reach the port could blank the screens
+    if (!parsed.loopback() && token.empty()) {
+        error = "Listening on " + endpoint + " needs a token: only loopback and Unix socket endpoints may go without one";
+        return false;
+    }
+    if (!m_waker.open(error)) {
+        return false;
+    }
+    m_listener = Listen(parsed, error);
+    if (m_listener == kInvalidSocket) {
+        m_waker.close();
+        return false;
+    }
+
+    m_token = token;
+    m_unixPath = parsed.path;
+    m_stopping = false;
+    m_thread = std::thread(&FleetServer::run, this);
+    return true;
+}
+
+void FleetServer::stop() {
+    if (!m_thread.joinable()) return;
+    m_stopping = true;
+    m_waker.wake();
+    m_thread.join();
+
+    for (const Connection& connection : m_connections) CloseSocket(connection.socket);
+    m_connections.clear();
+    CloseSocket(m_listener);
+    m_listener = kInvalidSocket;
+    m_waker.close();
+    if (!m_unixPath.empty()) {
+        std::error_code ignored;
+        std::filesystem::remove(m_unixPath, ignored);
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_calls.clear();
+    m_replies.clear();
+}
+
+bool FleetServer::takeCall(FleetCall& call) {
+    std::lock_guard lock(m_mutex);
+    if (m_calls.empty()) return false;
+    call = std::move(m_calls.front());
+    m_calls.pop_front();
+    return true;
+}
+
+void FleetServer::reply(uint64_t connection, const FleetResponse& response) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_replies.emplace_back(connection, EncodeResponse(response));
+    }
+    m_waker.wake();
+}
+
+void FleetServer::run() {
+    std::vector<SocketPoll> polls;
+    std::vector<char> buffer(64 * 1024);
+
+    while (!m_stopping) {
+        // Answers the UI thread produced since the last pass; closed connections just drop theirs
+        {
+            std::lock_guard lock(m_mutex);
+            for (auto& [id, text] : m_replies) {
+                auto it = std::ranges::find(m_connections, id, &Connection::id);
+                if (it == m_connections.end()) continue;
+                it->output += text;
+                --it->pending;
+            }
+            m_replies.clear();
+        }
+
+        polls.clear();
+        polls.push_back({ .socket = m_waker.handle(), .wantRead = true });
+        polls.push_back({ .socket = m_listener, .wantRead = m_connections.size() < kMaxConnections });
+        for (const Connection& connection : m_connections) {
+            polls.push_back({ .socket = connection.socket, .wantRead = !connection.readClosed, .wantWrite = !connection.output.empty() });
+        }
+        PollSockets(polls, -1);
+        if (m_stopping) break;
+
+        if (polls[0].readable) m_waker.drain();
+
+        // Connections accepted now are polled from the next pass on
+        const size_t polled = m_connections.size();
+        if (polls[1].readable) {
+            SocketHandle socket;
+            while (m_connections.size() < kMaxConnections && (socket = Accept(m_listener)) != kInvalidSocket) {
+                Connection& connection = m_connections.emplace_back();
+                connection.id = m_nextConnection++;
+                connection.socket = socket;
+                connection.authorized = m_token.empty();
+            }
+        }
+
+        bool queued = false;
+        for (size_t k = 0; k < polled; ++k) {
+            Connection& connection = m_connections[k];
+            const SocketPoll& poll = polls[k + 2];
+
+            if (poll.readable && !connection.readClosed) {
+                // Lines are taken out after every read, so a sender that never
+                // ends one is cut off once it passes the line limit rather than
+                // buffered whole; what is left over waits for the next pass
+                std::string line;
+                for (size_t taken = 0; taken < kMaxInputPerPass && !connection.input.overflowed();) {
+                    const long received = ReceiveSome(connection.socket, buffer.data(), buffer.size());
+                    if (received == kSocketWouldBlock) break;
+                    if (received <= 0) {
+                        // A half-closed controller still gets the answers it is owed
+                        connection.readClosed = true;
+                        connection.broken = received < 0;
+                        break;
+                    }
+                    connection.input.append(buffer.data(), static_cast<size_t>(received));
+                    taken += static_cast<size_t>(received);
+                    while (connection.input.next(line)) handleLine(connection, line, queued);
+                }
+                connection.broken = connection.broken || connection.input.overflowed();
+            }
+
+            if (!connection.broken && !connection.output.empty()) {
+                const long sent = SendSome(connection.socket, connection.output.data(), connection.output.size());
+                if (sent > 0) connection.output.erase(0, static_cast<size_t>(sent));
+                connection.broken = sent == -1;
+            }
+            connection.broken = connection.broken || poll.failed || connection.output.size() > kMaxPendingOutput;
+        }
+
+        std::erase_if(m_connections, [](const Connection& connection) {
+            const bool done = connection.broken || (connection.readClosed && connection.pending == 0 && connection.output.empty());
+            if (done) CloseSocket(connection.socket);
+            return done;
+        });
+
+        if (queued) m_notify();
+    }
+}
+
+void FleetServer::handleLine(Connection& connection, const std::string& line, bool& queued) {
+    FleetRequest request;
+    if (!ParseRequest(line, request)) {
+        connection.output += EncodeResponse({ 0, false, "malformed request" });
+        return;
+    }
+    if (request.verb == "ping") {
+        connection.output += EncodeResponse({ request.id, true, "pong" });
+        return;
+    }
+    if (request.verb == "auth") {
+        connection.authorized = m_token.empty() || TokensEqual(request.argument, m_token);
+        connection.output += EncodeResponse({ request.id, connection.authorized, connection.authorized ? "" : "bad token" });
+        return;
+    }
+    if (!connection.authorized) {
+        connection.output += EncodeResponse({ request.id, false, "unauthorized" });
+        return;
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_calls.push_back({ connection.id, std::move(request) });
+    ++connection.pending;
+    queued = true;
+}
+
+FleetResponse AnswerFleetRequest(const FleetRequest& request, const FleetActions& actions) {
+    if (request.verb == "list") {
+        const TopologySnapshot topology = TopologyStore::current();
+        return { request.id, true, topology ? FormatMonitorList(topology->monitors) : std::string() };
+    }
+
+    if (request.verb == "blank") {
+        actions.setBlanked(true);
+    }
+    else if (request.verb == "unblank") {
+        actions.setBlanked(false);
+    }
+    else if (request.verb == "toggle") {
+        actions.setBlanked(!actions.blanked());
+    }
+    else if (request.verb != "status") {
+        return { request.id, false, "unknown command '" + request.verb + "'" };
+    }
+    return { request.id, true, actions.blanked() ? "blanked" : "unblanked" };
+}
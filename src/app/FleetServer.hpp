@@ -0,0 +1,86 @@
+#pragma once
+#ifndef FLEETSERVER_HPP
+#define FLEETSERVER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "FleetProtocol.hpp"
+#include "Socket.hpp"
+
+// A request the UI thread has to act on, and the connection to answer
+struct FleetCall {
+    uint64_t connection;
+    FleetRequest request;
+};
+
+// --listen: accepts controller connections on its own thread. ping and auth
+// are answered there; every other request is queued as a FleetCall and
+// notify() is called, so the UI thread can take it, act, and reply().
+class FleetServer {
+public:
+    explicit FleetServer(std::function<void()> notify) : m_notify(std::move(notify)) {}
+    FleetServer(const FleetServer&) = delete;
+    FleetServer& operator=(const FleetServer&) = delete;
+    ~FleetServer() { stop(); }
+
+    // token empty for none
+    bool start(const std::string& endpoint, const std::string& token, std::string& error);
+    void stop();
+
+    // Both thread-safe
+    bool takeCall(FleetCall& call);
+    void reply(uint64_t connection, const FleetResponse& response);
+
+private:
+    static constexpr size_t kMaxConnections = 256;
+    static constexpr size_t kMaxPendingOutput = 1 << 20;    // a controller that stops reading is dropped
+    static constexpr size_t kMaxInputPerPass = 256 * 1024;  // then the other connections get their turn
+
+    struct Connection {
+        uint64_t id = 0;
+        SocketHandle socket = kInvalidSocket;
+        LineBuffer input;
+        std::string output;
+        bool authorized = false;
+        size_t pending = 0;         // calls still with the UI thread
+        bool readClosed = false;
+        bool broken = false;
+    };
+
+    void run();
+    void handleLine(Connection& connection, const std::string& line, bool& queued);
+
+    std::function<void()> m_notify;
+    std::string m_token;
+    std::string m_unixPath;                 // removed again on stop
+    SocketHandle m_listener = kInvalidSocket;
+    SocketWaker m_waker;
+    std::thread m_thread;
+    std::atomic<bool> m_stopping{ false };
+
+    std::mutex m_mutex;                     // guards the two queues
+    std::deque<FleetCall> m_calls;
+    std::vector<std::pair<uint64_t, std::string>> m_replies;
+
+    std::vector<Connection> m_connections;  // server thread only
+    uint64_t m_nextConnection = 1;
+};
+
+// What a resident instance does for each verb; shared by the Win32 and X11 loops
+struct FleetActions {
+    std::function<bool()> blanked;
+    std::function<void(bool)> setBlanked;
+};
+
+FleetResponse AnswerFleetRequest(const FleetRequest& request, const FleetActions& actions);
+
+#endif // FLEETSERVER_HPP
@@ -0,0 +1,358 @@
+#include "FlightRecorder.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <filesystem>
+
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+FlightRecorder g_flightRecorder;
+
+namespace {
+    // Where records go until open() maps the file, and after close(); laid
+    // out like the file so the records always follow the header
+    struct StaticRing {
+        FlightHeader header;
+        FlightRecord records[FlightRecorder::kCapacity];
+    };
+    static_assert(offsetof(StaticRing, records) == sizeof(FlightHeader));
+    StaticRing g_staticRing;
+    FlightHeader& g_staticHeader = g_staticRing.header;
+
+    constexpr size_t kFileSize = sizeof(FlightHeader) + sizeof(FlightRecord) * FlightRecorder::kCapacity;
+
+    uint64_t ProcessId() {
+#ifdef _WIN32
+        return GetCurrentProcessId();
+#else
+        return static_cast<uint64_t>(getpid());
+#endif
+    }
+
+    [[noreturn]] void HandleTerminate() {
+        // Unhandled C++ exception: keep what it said, then die as before
+        if (std::exception_ptr current = std::current_exception()) {
+            try {
+                std::rethrow_exception(current);
+            }
+            catch (const std::exception& exception) {
+                g_flightRecorder.recordText(FlightEvent::Error, exception.what());
+            }
+            catch (...) {
+            }
+        }
+        g_flightRecorder.dump(FlightEvent::Crash, 0, 0);
+        std::abort();
+    }
+
+#ifdef _WIN32
+    LONG WINAPI HandleCrash(EXCEPTION_POINTERS* exception) {
+        g_flightRecorder.dump(FlightEvent::Crash, exception->ExceptionRecord->ExceptionCode,
+            reinterpret_cast<uintptr_t>(exception->ExceptionRecord->ExceptionAddress));
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+#else
+    void HandleCrashSignal(int signal, siginfo_t* info, void*) {
+        g_flightRecorder.dump(FlightEvent::Crash, static_cast<uint64_t>(signal), reinterpret_cast<uintptr_t>(info->si_addr));
+        // SA_RESETHAND put the default action back, so this terminates as it would have
+        raise(signal);
+    }
+#endif
+
+    void InstallCrashHandlers() {
+        std::set_terminate(HandleTerminate);
+#ifdef _WIN32
+        SetUnhandledExceptionFilter(HandleCrash);
+#else
+        struct sigaction action = {};
+        action.sa_sigaction = HandleCrashSignal;
+        action.sa_flags = SA_SIGINFO | SA_RESETHAND;
+        for (int signal : { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT }) {
+            sigaction(signal, &action, nullptr);
+        }
+#endif
+    }
+
+    const char* EventName(uint16_t type) {
+        switch (static_cast<FlightEvent>(type)) {
+            case FlightEvent::Start: return "start";
+            case FlightEvent::Enumeration: return "enumeration";
+            case FlightEvent::Selection: return "selection";
+            case FlightEvent::WindowCreated: return "window";
+            case FlightEvent::Message: return "message";
+            case FlightEvent::Blank: return "blank";
+            case FlightEvent::Unblank: return "unblank";
+            case FlightEvent::Error: return "error";
+            case FlightEvent::Hang: return "hang";
+            case FlightEvent::Crash: return "crash";
+            case FlightEvent::Reassert: return "reassert";
+        }
+        return "?";
+    }
+
+    std::string Details(const FlightRecord& record) {
+        char text[96] = {};
+        switch (static_cast<FlightEvent>(record.type)) {
+            case FlightEvent::Start:
+                snprintf(text, sizeof(text), "pid %" PRIu64, record.a);
+                break;
+            case FlightEvent::Enumeration:
+                snprintf(text, sizeof(text), "%" PRIu64 " monitors in %.3f ms", record.a, static_cast<double>(record.b) / 1e6);
+                break;
+            case FlightEvent::Selection:
+                snprintf(text, sizeof(text), "%" PRIu64 " of %" PRIu64 " monitors", record.a, record.b);
+                break;
+            case FlightEvent::WindowCreated:
+                snprintf(text, sizeof(text), "monitor %" PRId64 " at %d,%d %ux%u", static_cast<int64_t>(record.a),
+                    static_cast<int16_t>(record.b), static_cast<int16_t>(record.b >> 16),
+                    static_cast<unsigned>(static_cast<uint16_t>(record.b >> 32)), static_cast<unsigned>(static_cast<uint16_t>(record.b >> 48)));
+                break;
+            case FlightEvent::Message:
+                snprintf(text, sizeof(text), "0x%04" PRIx64 " window 0x%" PRIx64, record.a, record.b);
+                break;
+            case FlightEvent::Blank:
+                snprintf(text, sizeof(text), "%" PRIu64 " windows", record.a);
+                break;
+            case FlightEvent::Error: {
+                char message[17] = {};
+                std::memcpy(message, &record.a, 8);
+                std::memcpy(message + 8, &record.b, 8);
+                snprintf(text, sizeof(text), "\"%s\"", message);
+                break;
+            }
+            case FlightEvent::Hang:
+                snprintf(text, sizeof(text), "UI thread busy for %.1f s", static_cast<double>(record.a) / 1e9);
+                break;
+            case FlightEvent::Crash:
+                if (record.a == 0) snprintf(text, sizeof(text), "unhandled exception");
+                else snprintf(text, sizeof(text), "code 0x%" PRIx64 " at 0x%" PRIx64, record.a, record.b);
+                break;
+            case FlightEvent::Reassert:
+                snprintf(text, sizeof(text), "%" PRIu64 " of %" PRIu64 " windows", record.a, record.b);
+                break;
+            default:
+                snprintf(text, sizeof(text), "%" PRIu64 " %" PRIu64, record.a, record.b);
+                break;
+        }
+        return text;
+    }
+}
+
+FlightRecorder::FlightRecorder() : m_header(&g_staticHeader) {
+    g_staticHeader.magic = FlightHeader::kMagic;
+    g_staticHeader.version = FlightHeader::kVersion;
+    g_staticHeader.capacity = kCapacity;
+    g_staticHeader.recordSize = sizeof(FlightRecord);
+    g_staticHeader.pid = ProcessId();
+    g_staticHeader.startWallNanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    g_staticHeader.startNanos = MetricsClock();
+    record(FlightEvent::Start, g_staticHeader.pid);
+}
+
+FlightRecorder::~FlightRecorder() {
+    stopWatchdog();
+}
+
+bool FlightRecorder::open() {
+    if (m_view) return true;
+    std::error_code ignored;
+    const std::filesystem::path path = std::filesystem::temp_directory_path(ignored) /
+        ("black_screen_app." + std::to_string(ProcessId()) + ".flight");
+
+#ifdef _WIN32
+    // The name is predictable, so the file is only ever created, never opened
+    // through whatever sits there. A plain file left by an earlier process
+    // with the same id is replaced; a link or junction fails the open.
+    auto create = [&] {
+        return CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+    };
+    HANDLE file = create();
+    if (file == INVALID_HANDLE_VALUE && GetLastError() == ERROR_FILE_EXISTS) {
+        const DWORD attributes = GetFileAttributesW(path.c_str());
+        if (attributes != INVALID_FILE_ATTRIBUTES && !(attributes & (FILE_ATTRIBUTE_REPARSE_POINT | FILE_ATTRIBUTE_DIRECTORY)) &&
+            DeleteFileW(path.c_str())) {
+            file = create();
+        }
+    }
+    if (file == INVALID_HANDLE_VALUE) return false;
+    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(kFileSize), nullptr);
+    CloseHandle(file);
+    if (!mapping) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, kFileSize);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+#else
+    // The name is predictable and the temp directory shared, so the file is
+    // only ever created, never opened through whatever sits there. A regular
+    // file of ours left by an earlier process with the same pid is replaced;
+    // a symlink or anyone else's file fails the open.
+    auto create = [&] { return ::open(path.c_str(), O_CREAT | O_EXCL | O_NOFOLLOW | O_RDWR | O_CLOEXEC, 0600); };
+    int fd = create();
+    struct stat existing;
+    if (fd < 0 && errno == EEXIST && lstat(path.c_str(), &existing) == 0 && S_ISREG(existing.st_mode) &&
+        existing.st_uid == geteuid() && unlink(path.c_str()) == 0) {
+        fd = create();
+    }
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(kFileSize)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, kFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+#endif
+
+    // Carry over what happened before the file existed (startup enumeration, parsing)
+    std::memcpy(view, &g_staticRing, sizeof(StaticRing));
+    m_view = view;
+    m_path = path.string();
+    m_header.store(static_cast<FlightHeader*>(view), std::memory_order_release);
+
+    InstallCrashHandlers();
+    m_stopping = false;
+    m_watchdog = std::thread(&FlightRecorder::watch, this);
+    return true;
+}
+
+void FlightRecorder::close() {
+    if (!m_view) return;
+    stopWatchdog();
+
+    FlightHeader* mapped = m_header.load(std::memory_order_relaxed);
+    const bool keep = std::atomic_ref<uint32_t>(mapped->dumpReason).load(std::memory_order_acquire) != 0;
+    std::memcpy(&g_staticRing, mapped, sizeof(StaticRing));
+    m_header.store(&g_staticHeader, std::memory_order_release);
+    flush();
+#ifdef _WIN32
+    UnmapViewOfFile(m_view);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+    m_mapping = nullptr;
+#else
+    munmap(m_view, kFileSize);
+#endif
+    m_view = nullptr;
+
+    if (!keep) {
+        std::error_code ignored;
+        std::filesystem::remove(m_path, ignored);
+    }
+}
+
+void FlightRecorder::recordText(FlightEvent type, std::string_view text) {
+    uint64_t words[2] = {};
+    std::memcpy(words, text.data(), (std::min)(text.size(), sizeof(words)));
+    record(type, words[0], words[1]);
+}
+
+void FlightRecorder::dump(FlightEvent reason, uint64_t code, uint64_t address) {
+    record(reason, code, address);
+    FlightHeader* header = m_header.load(std::memory_order_acquire);
+    uint32_t none = 0;
+    if (std::atomic_ref<uint32_t>(header->dumpReason).compare_exchange_strong(none, static_cast<uint32_t>(reason))) {
+        header->dumpDetail = code;
+    }
+}
+
+void FlightRecorder::flush() {
+    if (!m_view) return;
+#ifdef _WIN32
+    FlushViewOfFile(m_view, kFileSize);
+#else
+    msync(m_view, kFileSize, MS_ASYNC);
+#endif
+}
+
+void FlightRecorder::stopWatchdog() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_watchdog.joinable()) m_watchdog.join();
+}
+
+void FlightRecorder::watch() {
+    const auto limit = static_cast<uint64_t>(std::chrono::nanoseconds(kHangLimit).count());
+    uint64_t flagged = 0;
+    std::unique_lock lock(m_mutex);
+    while (!m_wake.wait_for(lock, kHangLimit / 10, [this] { return m_stopping; })) {
+        // One report per stuck message; the busy stamp changes once the UI thread moves on
+        const uint64_t since = std::atomic_ref<uint64_t>(m_header.load(std::memory_order_acquire)->busySince).load(std::memory_order_relaxed);
+        const uint64_t now = MetricsClock();
+        if (since == 0 || since == flagged || now - since < limit) continue;
+        flagged = since;
+        dump(FlightEvent::Hang, now - since, 0);
+        flush();
+    }
+}
+
+bool DecodeFlightRecording(const std::string& path, std::string& text, std::string& error) {
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "Cannot read flight recording '" + path + "'";
+        return false;
+    }
+    FlightHeader header;
+    if (file.size() < sizeof(header)) {
+        error = "'" + path + "' is not a flight recording";
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != FlightHeader::kMagic || header.version != FlightHeader::kVersion ||
+        header.recordSize != sizeof(FlightRecord) || header.capacity == 0 || (header.capacity & (header.capacity - 1)) != 0 ||
+        file.size() < sizeof(header) + static_cast<size_t>(header.capacity) * sizeof(FlightRecord)) {
+        error = "'" + path + "' is not a flight recording this version can read";
+        return false;
+    }
+
+    char line[160];
+    const std::time_t started = static_cast<std::time_t>(header.startWallNanos / 1'000'000'000);
+    char when[32] = "?";
+    if (const std::tm* utc = std::gmtime(&started)) std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S UTC", utc);
+    snprintf(line, sizeof(line), "Flight recording of pid %" PRIu64 ", started %s, %s\n", header.pid, when,
+        header.dumpReason == static_cast<uint32_t>(FlightEvent::Hang) ? "kept after a hang"
+        : header.dumpReason == static_cast<uint32_t>(FlightEvent::Crash) ? "kept after a crash" : "no dump flagged");
+    text = line;
+
+    // Walk the last capacity write indices in order; a slot whose sequence does not
+    // match was overwritten later or torn by the crash
+    const uint64_t first = header.head > header.capacity ? header.head - header.capacity : 0;
+    size_t torn = 0;
+    std::string events;
+    for (uint64_t index = first; index < header.head; ++index) {
+        FlightRecord record;
+        std::memcpy(&record, file.data() + sizeof(header) + (index & (header.capacity - 1)) * sizeof(FlightRecord), sizeof(record));
+        if (record.sequence != static_cast<uint32_t>(index + 1)) {
+            ++torn;
+            continue;
+        }
+        const double offset = static_cast<double>(static_cast<int64_t>(record.nanos - header.startNanos)) / 1e6;
+        snprintf(line, sizeof(line), "%+12.3f ms  %-12s %s\n", offset, EventName(record.type), Details(record).c_str());
+        events += line;
+    }
+    snprintf(line, sizeof(line), "%" PRIu64 " events written, %" PRIu64 " kept, %zu unreadable\n",
+        header.head, header.head - first - torn, torn);
+    text += line + events;
+    return true;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#ifndef FLIGHTRECORDER_HPP
+#define FLIGHTRECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "Metrics.hpp"
+
+// What a record means; the values are part of the file format
+enum class FlightEvent : uint16_t {
+    Start = 1,          // a = pid
+    Enumeration,        // a = monitors found, b = ns taken
+    Selection,          // a = monitors selected (0 on failure), b = monitors present
+    WindowCreated,      // a = monitor, b = PackFlightRect
+    Message,            // a = message (WM_* or X event type), b = window
+    Blank,              // a = windows shown
+    Unblank,
+    Error,              // a, b = first 16 bytes of the message
+    Hang,               // a = ns the UI thread had been busy
+    Crash,              // a = signal or exception code, b = faulting address
+    Reassert,           // a = blanking windows put back on top, b = windows the settled events touched
+};
+
+// One event, 32 bytes. sequence is the low half of write index + 1 and is
+// stored last, so a record torn by a crash mid-write is recognisable.
+struct FlightRecord {
+    uint64_t nanos;         // MetricsClock
+    uint32_t sequence;      // 0 while being written or never written
+    uint16_t type;          // FlightEvent
+    uint16_t reserved;
+    uint64_t a;
+    uint64_t b;
+};
+
+// Start of the recording file; the ring of records follows
+struct FlightHeader {
+    static constexpr uint32_t kMagic = 0x52464242;     // "BBFR"
+    static constexpr uint32_t kVersion = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t recordSize;
+    uint64_t pid;
+    uint64_t startWallNanos;    // system clock at open, for decoding times
+    uint64_t startNanos;        // MetricsClock at open
+    uint64_t head;              // next write index, atomic
+    uint64_t busySince;         // MetricsClock when the UI thread took its message, 0 while waiting; atomic
+    uint32_t dumpReason;        // FlightEvent::Hang or Crash once the recording must be kept, atomic
+    uint32_t reserved;
+    uint64_t dumpDetail;
+};
+
+// Window rect squeezed into one field: left, top, width, height as 16 bits each
+inline uint64_t PackFlightRect(long left, long top, long width, long height) {
+    return static_cast<uint64_t>(static_cast<uint16_t>(left)) | static_cast<uint64_t>(static_cast<uint16_t>(top)) << 16 |
+        static_cast<uint64_t>(static_cast<uint16_t>(width)) << 32 | static_cast<uint64_t>(static_cast<uint16_t>(height)) << 48;
+}
+
+// Always-on record of what the process did, for stations that failed to
+// blank. Events land in a fixed ring inside a memory-mapped file, so they
+// survive a crash without being written out. record() is an acquire load,
+// a relaxed fetch_add and four stores, safe from any thread and signal
+// handlers, and never allocates; before open() (or if the file cannot be
+// created) the ring lives in static memory. The header and its ring are
+// published through one atomic pointer, with the records right after the
+// header in both places. The file is deleted by close() on a clean exit and
+// kept after a crash, an unhandled exception, or a hang the watchdog saw.
+//
+// open() and close() must run while no other thread records: open() early
+// in main, close() once every worker thread has been joined. Neither runs
+// from static construction or destruction.
+class FlightRecorder {
+public:
+    static constexpr uint32_t kCapacity = 16384;       // power of two, 512 KiB of records
+    static constexpr std::chrono::milliseconds kHangLimit{ 5000 };
+
+    FlightRecorder();
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+    // Only stops the watchdog: an open file stays mapped and on disk, since
+    // threads may still record during static destruction. close() is explicit.
+    ~FlightRecorder();
+
+    // Creates and maps <temp>/black_screen_app.<pid>.flight, copies what was
+    // recorded so far, installs the crash handlers and starts the hang
+    // watchdog. False if something other than our own stale file holds the name.
+    bool open();
+    // Deletes the file unless a dump was flagged
+    void close();
+
+    void record(FlightEvent type, uint64_t a = 0, uint64_t b = 0) {
+        FlightHeader* header = m_header.load(std::memory_order_acquire);
+        const uint64_t index = std::atomic_ref<uint64_t>(header->head).fetch_add(1, std::memory_order_relaxed);
+        FlightRecord& slot = recordsOf(header)[index & (kCapacity - 1)];
+        std::atomic_ref<uint32_t> sequence(slot.sequence);
+        sequence.store(0, std::memory_order_relaxed);
+        slot.nanos = MetricsClock();
+        slot.type = static_cast<uint16_t>(type);
+        slot.a = a;
+        slot.b = b;
+        sequence.store(static_cast<uint32_t>(index + 1), std::memory_order_release);
+    }
+    // Keeps the first 16 bytes of text
+    void recordText(FlightEvent type, std::string_view text);
+
+    // Bracket the UI thread's work on one message; the watchdog flags a hang
+    // when busy() is not followed by idle() within kHangLimit
+    void busy() { std::atomic_ref<uint64_t>(m_header.load(std::memory_order_acquire)->busySince).store(MetricsClock(), std::memory_order_relaxed); }
+    void idle() { std::atomic_ref<uint64_t>(m_header.load(std::memory_order_acquire)->busySince).store(0, std::memory_order_relaxed); }
+
+    // Records the event and keeps the file; the first reason wins. Signal-safe.
+    void dump(FlightEvent reason, uint64_t code, uint64_t address);
+
+    const std::string& path() const { return m_path; }
+
+private:
+    static FlightRecord* recordsOf(FlightHeader* header) { return reinterpret_cast<FlightRecord*>(header + 1); }
+
+    void watch();
+    void stopWatchdog();
+    void flush();
+
+    std::atomic<FlightHeader*> m_header;
+    void* m_view = nullptr;
+    void* m_mapping = nullptr;          // file mapping handle on Windows
+    std::string m_path;
+    std::thread m_watchdog;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+};
+
+extern FlightRecorder g_flightRecorder;
+
+// --decode-recorder: the recording at path as text, oldest event first
+bool DecodeFlightRecording(const std::string& path, std::string& text, std::string& error);
+
+#endif // FLIGHTRECORDER_HPP
@@ -0,0 +1,466 @@
+#include "ImageBackdrop.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+#if !defined(BLACKSCREEN_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define BACKDROP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#include <wincodec.h>
+#include <wrl/client.h>
+#endif
+
+namespace {
+    constexpr int kWeightBits = 14;             // filter weights sum to 1 << kWeightBits
+    constexpr int kRowFractionBits = 7;         // extra precision kept between the passes
+    constexpr long kStripRows = 16;             // rows decoded per read
+
+    uint32_t ReadU16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+    uint32_t ReadU32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24); }
+
+    // Uncompressed 24/32-bit BMP, bottom-up or top-down
+    class BmpSource : public ImageSource {
+    public:
+        bool open(const uint8_t* data, size_t size, std::string& error) {
+            if (size < 54) {
+                error = "Truncated BMP header";
+                return false;
+            }
+            const uint32_t offset = ReadU32(data + 10);
+            const auto width = static_cast<int32_t>(ReadU32(data + 18));
+            const auto height = static_cast<int32_t>(ReadU32(data + 22));
+            m_bytesPerPixel = ReadU16(data + 28) / 8;
+            const uint32_t compression = ReadU32(data + 30);
+
+            // BI_RGB, or BI_BITFIELDS with the usual 32-bit BGRX layout
+            if ((m_bytesPerPixel != 3 && m_bytesPerPixel != 4) || (compression != 0 && !(compression == 3 && m_bytesPerPixel == 4))) {
+                error = "Only uncompressed 24/32-bit BMP images are supported";
+                return false;
+            }
+            if (width <= 0 || height == 0 || height == INT32_MIN) {
+                error = "Invalid BMP dimensions";
+                return false;
+            }
+
+            m_width = width;
+            m_height = height < 0 ? -static_cast<long>(height) : height;
+            m_topDown = height < 0;
+            m_stride = (static_cast<size_t>(width) * m_bytesPerPixel + 3) & ~size_t{ 3 };
+            if (offset > size || (size - offset) / m_stride < static_cast<size_t>(m_height)) {
+                error = "Truncated BMP pixel data";
+                return false;
+            }
+            m_pixels = data + offset;
+            return true;
+        }
+
+        bool readRows(long count, uint32_t* out) override {
+            for (long k = 0; k < count && m_next < m_height; ++k, ++m_next) {
+                const long row = m_topDown ? m_next : m_height - 1 - m_next;
+                const uint8_t* p = m_pixels + static_cast<size_t>(row) * m_stride;
+                for (long x = 0; x < m_width; ++x, p += m_bytesPerPixel, ++out) {
+                    *out = p[0] | (p[1] << 8) | (p[2] << 16);
+                }
+            }
+            return true;
+        }
+
+    private:
+        const uint8_t* m_pixels = nullptr;
+        size_t m_stride = 0;
+        uint32_t m_bytesPerPixel = 0;
+        bool m_topDown = false;
+        long m_next = 0;
+    };
+
+    // Binary PPM (P6) with up to 8 bits per channel
+    class PpmSource : public ImageSource {
+    public:
+        bool open(const uint8_t* data, size_t size, std::string& error) {
+            size_t pos = 2;
+            auto readNumber = [&](long& value) {
+                // Whitespace and # comments may separate header fields
+                while (pos < size && (std::isspace(data[pos]) || data[pos] == '#')) {
+                    if (data[pos] == '#') {
+                        while (pos < size && data[pos] != '\n') ++pos;
+                    }
+                    else {
+                        ++pos;
+                    }
+                }
+                if (pos >= size || !std::isdigit(data[pos])) return false;
+                value = 0;
+                while (pos < size && std::isdigit(data[pos]) && value < 1'000'000) {
+                    value = value * 10 + (data[pos++] - '0');
+                }
+                return true;
+            };
+
+            long maxValue = 0;
+            if (!readNumber(m_width) || !readNumber(m_height) || !readNumber(maxValue) || pos >= size) {
+                error = "Invalid PPM header";
+                return false;
+            }
+            ++pos;  // single whitespace before the samples
+            if (m_width <= 0 || m_height <= 0 || maxValue <= 0 || maxValue > 255) {
+                error = "Only 8-bit binary PPM images are supported";
+                return false;
+            }
+            if ((size - pos) / 3 / static_cast<size_t>(m_width) < static_cast<size_t>(m_height)) {
+                error = "Truncated PPM pixel data";
+                return false;
+            }
+            m_pixels = data + pos;
+            m_maxValue = static_cast<uint32_t>(maxValue);
+            return true;
+        }
+
+        bool readRows(long count, uint32_t* out) override {
+            const size_t samples = static_cast<size_t>(std::min(count, m_height - m_next)) * m_width;
+            for (size_t k = 0; k < samples; ++k, m_pixels += 3) {
+                uint32_t r = m_pixels[0], g = m_pixels[1], b = m_pixels[2];
+                if (m_maxValue != 255) {
+                    r = r * 255 / m_maxValue;
+                    g = g * 255 / m_maxValue;
+                    b = b * 255 / m_maxValue;
+                }
+                out[k] = (r << 16) | (g << 8) | b;
+            }
+            m_next += count;
+            return true;
+        }
+
+    private:
+        const uint8_t* m_pixels = nullptr;
+        uint32_t m_maxValue = 255;
+        long m_next = 0;
+    };
+
+#ifdef _WIN32
+    // WIC decoder reading straight from the mapped bytes, converted to
+    // premultiplied BGRA so transparent areas come out black
+    class WicSource : public ImageSource {
+    public:
+        ~WicSource() override {
+            m_converter.Reset();
+            m_stream.Reset();
+            m_factory.Reset();
+            if (m_comInitialized) CoUninitialize();
+        }
+
+        bool open(const uint8_t* data, size_t size) {
+            m_comInitialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED));
+
+            Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
+            Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
+            UINT width = 0, height = 0;
+            if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&m_factory))) ||
+                FAILED(m_factory->CreateStream(&m_stream)) ||
+                FAILED(m_stream->InitializeFromMemory(const_cast<BYTE*>(data), static_cast<DWORD>(size))) ||
+                FAILED(m_factory->CreateDecoderFromStream(m_stream.Get(), nullptr, WICDecodeMetadataCacheOnDemand, &decoder)) ||
+                FAILED(decoder->GetFrame(0, &frame)) ||
+                FAILED(WICConvertBitmapSource(GUID_WICPixelFormat32bppPBGRA, frame.Get(), &m_converter)) ||
+                FAILED(m_converter->GetSize(&width, &height))) {
+                return false;
+            }
+            m_width = static_cast<long>(width);
+            m_height = static_cast<long>(height);
+            return true;
+        }
+
+        bool readRows(long count, uint32_t* out) override {
+            count = (std::min)(count, m_height - m_next);
+            const WICRect rect = { 0, static_cast<INT>(m_next), static_cast<INT>(m_width), static_cast<INT>(count) };
+            const UINT stride = static_cast<UINT>(m_width) * 4;
+            if (FAILED(m_converter->CopyPixels(&rect, stride, stride * static_cast<UINT>(count), reinterpret_cast<BYTE*>(out)))) {
+                return false;
+            }
+            for (size_t k = 0; k < static_cast<size_t>(count) * m_width; ++k) out[k] &= 0x00FFFFFF;
+            m_next += count;
+            return true;
+        }
+
+    private:
+        bool m_comInitialized = false;
+        Microsoft::WRL::ComPtr<IWICImagingFactory> m_factory;
+        Microsoft::WRL::ComPtr<IWICStream> m_stream;
+        Microsoft::WRL::ComPtr<IWICBitmapSource> m_converter;
+        long m_next = 0;
+    };
+#endif
+}
+
+std::unique_ptr<ImageSource> OpenImage(const MappedFile& file, std::string& error) {
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+
+#ifdef _WIN32
+    auto wic = std::make_unique<WicSource>();
+    if (wic->open(data, size)) return wic;
+#endif
+    if (size >= 2 && data[0] == 'B' && data[1] == 'M') {
+        auto bmp = std::make_unique<BmpSource>();
+        if (bmp->open(data, size, error)) return bmp;
+        return nullptr;
+    }
+    if (size >= 2 && data[0] == 'P' && data[1] == '6') {
+        auto ppm = std::make_unique<PpmSource>();
+        if (ppm->open(data, size, error)) return ppm;
+        return nullptr;
+    }
+#ifdef _WIN32
+    error = "Unsupported or corrupt image";
+#else
+    error = "Unsupported image format; use an uncompressed BMP or binary PPM";
+#endif
+    return nullptr;
+}
+
+ImageScaler::ImageScaler(const Rect& crop, long width, long height, bool simd)
+    : m_crop(crop), m_width(width), m_height(height), m_simd(simd) {
+    m_horizontal = makeAxis(crop.width(), width);
+    m_vertical = makeAxis(crop.height(), height);
+    m_scratch.assign(static_cast<size_t>(crop.width() + m_horizontal.taps), 0);
+    m_ringRows = m_vertical.taps;
+    m_rows.assign(static_cast<size_t>(m_ringRows) * width * 4, 0);
+    m_zeroRow.assign(static_cast<size_t>(width) * 4, 0);
+    m_output.assign(static_cast<size_t>(width) * height, 0);
+}
+
+ImageScaler::Axis ImageScaler::makeAxis(long sourceLength, long outputLength) {
+    const double scale = static_cast<double>(outputLength) / sourceLength;
+    const double radius = scale < 1.0 ? 1.0 / scale : 1.0;     // wider triangle averages the area when shrinking
+
+    std::vector<std::vector<int>> entries(static_cast<size_t>(outputLength));
+    Axis axis;
+    axis.first.resize(static_cast<size_t>(outputLength));
+    for (long i = 0; i < outputLength; ++i) {
+        const double center = (i + 0.5) / scale - 0.5;
+        long lo = (std::max)(0L, static_cast<long>(std::ceil(center - radius)));
+        long hi = (std::min)(sourceLength - 1, static_cast<long>(std::floor(center + radius)));
+        if (lo > hi) lo = hi = std::clamp(std::lround(center), 0L, sourceLength - 1);
+
+        std::vector<double> weights;
+        double sum = 0;
+        for (long j = lo; j <= hi; ++j) {
+            weights.push_back((std::max)(0.0, 1.0 - std::abs(j - center) / radius));
+            sum += weights.back();
+        }
+        // Zero-weight ends only cost taps
+        while (weights.size() > 1 && weights.back() == 0.0) { weights.pop_back(); --hi; }
+        while (weights.size() > 1 && weights.front() == 0.0) { weights.erase(weights.begin()); ++lo; }
+        if (sum == 0.0) {
+            weights.assign(1, 1.0);
+            hi = lo;
+            sum = 1.0;
+        }
+
+        // Fixed point, with the rounding remainder on the largest weight so they sum exactly
+        auto& fixed = entries[static_cast<size_t>(i)];
+        int total = 0;
+        for (double w : weights) {
+            fixed.push_back(static_cast<int>(std::lround(w / sum * (1 << kWeightBits))));
+            total += fixed.back();
+        }
+        *std::ranges::max_element(fixed) += (1 << kWeightBits) - total;
+
+        axis.first[static_cast<size_t>(i)] = lo;
+        axis.taps = (std::max)(axis.taps, static_cast<long>(fixed.size()));
+    }
+
+    axis.taps += axis.taps & 1;     // pairs for the multiply-add
+    axis.weights.assign(static_cast<size_t>(outputLength * axis.taps), 0);
+    for (long i = 0; i < outputLength; ++i) {
+        std::ranges::transform(entries[static_cast<size_t>(i)], axis.weights.begin() + i * axis.taps,
+            [](int w) { return static_cast<int16_t>(w); });
+    }
+    return axis;
+}
+
+void ImageScaler::pushRow(long y, const uint32_t* row) {
+    if (y < m_crop.top || y >= m_crop.bottom || finished()) return;
+
+    std::memcpy(m_scratch.data(), row + m_crop.left, static_cast<size_t>(m_crop.width()) * sizeof(uint32_t));
+    scaleRow(m_scratch.data(), m_rows.data() + static_cast<size_t>(m_received % m_ringRows) * m_width * 4);
+    ++m_received;
+
+    // Emit every output row whose source rows have all arrived
+    const long cropHeight = m_crop.height();
+    while (!finished() && m_received >= (std::min)(m_vertical.first[m_nextOutput] + m_vertical.taps, cropHeight)) {
+        emitRow(m_nextOutput++);
+    }
+}
+
+void ImageScaler::scaleRow(const uint32_t* source, int16_t* out) const {
+    const long taps = m_horizontal.taps;
+    for (long x = 0; x < m_width; ++x) {
+        const uint32_t* pixels = source + m_horizontal.first[x];
+        const int16_t* weights = m_horizontal.weights.data() + x * taps;
+#ifdef BACKDROP_SSE2
+        if (m_simd) {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i sum = zero;
+            for (long t = 0; t < taps; t += 2) {
+                // b0 b1 g0 g1 r0 r1 a0 a1 as 16-bit lanes, times w0 w1 pairs
+                __m128i pair = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(pixels[t])), _mm_cvtsi32_si128(static_cast<int>(pixels[t + 1])));
+                pair = _mm_unpacklo_epi8(pair, zero);
+                const __m128i w = _mm_set1_epi32(static_cast<int>(static_cast<uint16_t>(weights[t]) | (static_cast<uint32_t>(weights[t + 1]) << 16)));
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(pair, w));
+            }
+            constexpr int shift = kWeightBits - kRowFractionBits;
+            sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << (shift - 1))), shift);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packs_epi32(sum, sum));
+            continue;
+        }
+#endif
+        int sum[4] = {};
+        for (long t = 0; t < taps; ++t) {
+            for (int c = 0; c < 4; ++c) {
+                sum[c] += static_cast<int>((pixels[t] >> (8 * c)) & 0xFF) * weights[t];
+            }
+        }
+        constexpr int shift = kWeightBits - kRowFractionBits;
+        for (int c = 0; c < 4; ++c) {
+            out[x * 4 + c] = static_cast<int16_t>((sum[c] + (1 << (shift - 1))) >> shift);
+        }
+    }
+}
+
+void ImageScaler::emitRow(long y) {
+    const long taps = m_vertical.taps;
+    const long first = m_vertical.first[y];
+    const int16_t* weights = m_vertical.weights.data() + y * taps;
+
+    std::vector<const int16_t*> rows(static_cast<size_t>(taps));
+    for (long t = 0; t < taps; ++t) {
+        const long source = first + t;
+        rows[t] = source < m_crop.height()
+            ? m_rows.data() + static_cast<size_t>(source % m_ringRows) * m_width * 4
+            : m_zeroRow.data();
+    }
+
+    constexpr int shift = kWeightBits + kRowFractionBits;
+    const long lanes = m_width * 4;
+    uint32_t* out = m_output.data() + static_cast<size_t>(y) * m_width;
+    long i = 0;
+#ifdef BACKDROP_SSE2
+    if (m_simd) {
+        const __m128i round = _mm_set1_epi32(1 << (shift - 1));
+        const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+        for (; i + 8 <= lanes; i += 8) {
+            __m128i low = _mm_setzero_si128(), high = _mm_setzero_si128();
+            for (long t = 0; t < taps; t += 2) {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t] + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t + 1] + i));
+                const __m128i w = _mm_set1_epi32(static_cast<int>(static_cast<uint16_t>(weights[t]) | (static_cast<uint32_t>(weights[t + 1]) << 16)));
+                low = _mm_add_epi32(low, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+                high = _mm_add_epi32(high, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+            }
+            low = _mm_srai_epi32(_mm_add_epi32(low, round), shift);
+            high = _mm_srai_epi32(_mm_add_epi32(high, round), shift);
+            const __m128i packed = _mm_packs_epi32(low, high);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i / 4), _mm_and_si128(_mm_packus_epi16(packed, packed), colorMask));
+        }
+    }
+#endif
+    for (; i < lanes; i += 4) {
+        uint32_t pixel = 0;
+        for (int c = 0; c < 3; ++c) {
+            int sum = 0;
+            for (long t = 0; t < taps; ++t) sum += rows[t][i + c] * weights[t];
+            pixel |= static_cast<uint32_t>(std::clamp((sum + (1 << (shift - 1))) >> shift, 0, 255)) << (8 * c);
+        }
+        out[i / 4] = pixel;
+    }
+}
+
+bool BackdropCache::open(const ImageOptions& options, std::string& error) {
+    m_options = options;
+    m_backdrops.clear();
+    if (!m_file.open(options.path)) {
+        error = "Cannot open image '" + options.path + "'";
+        return false;
+    }
+    return true;
+}
+
+bool BackdropCache::prepare(const std::vector<std::pair<long, long>>& windowSizes, std::string& error) {
+    std::vector<std::pair<long, long>> missing;
+    for (const auto& size : windowSizes) {
+        if (size.first <= 0 || size.second <= 0 || find(size.first, size.second)) continue;
+        if (std::ranges::find(missing, size) == missing.end()) missing.push_back(size);
+    }
+    if (missing.empty()) return true;
+
+    std::unique_ptr<ImageSource> source = OpenImage(m_file, error);
+    if (!source) {
+        error = "Cannot decode image '" + m_options.path + "': " + error;
+        return false;
+    }
+    const long sourceWidth = source->width();
+    const long sourceHeight = source->height();
+
+    std::vector<std::unique_ptr<ImageScaler>> scalers;
+    for (const auto& [windowWidth, windowHeight] : missing) {
+        Rect crop = { 0, 0, sourceWidth, sourceHeight };
+        long width = windowWidth, height = windowHeight;
+        const bool sourceWider = static_cast<long long>(sourceWidth) * windowHeight > static_cast<long long>(windowWidth) * sourceHeight;
+        if (m_options.fit == ImageFit::Fill) {
+            // Crop the overhanging dimension, centred
+            if (sourceWider) {
+                const long cropWidth = (std::max)(1L, static_cast<long>(static_cast<long long>(sourceHeight) * windowWidth / windowHeight));
+                crop.left = (sourceWidth - cropWidth) / 2;
+                crop.right = crop.left + cropWidth;
+            }
+            else {
+                const long cropHeight = (std::max)(1L, static_cast<long>(static_cast<long long>(sourceWidth) * windowHeight / windowWidth));
+                crop.top = (sourceHeight - cropHeight) / 2;
+                crop.bottom = crop.top + cropHeight;
+            }
+        }
+        else if (m_options.fit == ImageFit::Fit) {
+            if (sourceWider) {
+                height = (std::max)(1L, static_cast<long>(static_cast<long long>(sourceHeight) * windowWidth / sourceWidth));
+            }
+            else {
+                width = (std::max)(1L, static_cast<long>(static_cast<long long>(sourceWidth) * windowHeight / sourceHeight));
+            }
+        }
+        scalers.push_back(std::make_unique<ImageScaler>(crop, width, height));
+    }
+
+    // One decode pass feeds every size; only a strip of source rows is held at a time
+    std::vector<uint32_t> strip(static_cast<size_t>(sourceWidth) * kStripRows);
+    for (long y = 0; y < sourceHeight; y += kStripRows) {
+        const long count = (std::min)(kStripRows, sourceHeight - y);
+        if (!source->readRows(count, strip.data())) {
+            error = "Cannot decode image '" + m_options.path + "'";
+            return false;
+        }
+        for (long k = 0; k < count; ++k) {
+            for (const auto& scaler : scalers) scaler->pushRow(y + k, strip.data() + k * sourceWidth);
+        }
+    }
+
+    for (size_t k = 0; k < missing.size(); ++k) {
+        auto backdrop = std::make_unique<Backdrop>();
+        backdrop->width = scalers[k]->width();
+        backdrop->height = scalers[k]->height();
+        backdrop->pixels = scalers[k]->take();
+        m_backdrops.emplace_back(missing[k], std::move(backdrop));
+    }
+    return true;
+}
+
+const Backdrop* BackdropCache::find(long windowWidth, long windowHeight) const {
+    for (const auto& [size, backdrop] : m_backdrops) {
+        if (size.first == windowWidth && size.second == windowHeight) return backdrop.get();
+    }
+    return nullptr;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#ifndef IMAGEBACKDROP_HPP
+#define IMAGEBACKDROP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "RectSet.hpp"
+
+// How --image covers a window: crop to fill it, letterbox to fit, or stretch
+enum class ImageFit { Fill, Fit, Stretch };
+
+struct ImageOptions {
+    std::string path;                   // --image, UTF-8; empty for none
+    ImageFit fit = ImageFit::Fill;      // --image-fit
+
+    bool enabled() const { return !path.empty(); }
+};
+
+// Decoded image rows, delivered top to bottom as 0x00RRGGBB (transparency
+// is composited onto black)
+class ImageSource {
+public:
+    virtual ~ImageSource() = default;
+
+    long width() const { return m_width; }
+    long height() const { return m_height; }
+
+    // Reads the next count rows of width() pixels; false on a decode error
+    virtual bool readRows(long count, uint32_t* out) = 0;
+
+protected:
+    long m_width = 0;
+    long m_height = 0;
+};
+
+// Decodes straight from the mapped bytes: any WIC format on Windows, plus
+// uncompressed BMP and binary PPM everywhere. file must outlive the source.
+std::unique_ptr<ImageSource> OpenImage(const MappedFile& file, std::string& error);
+
+// Separable triangle-filter resampler for one output size, area averaging
+// when shrinking. Source rows are pushed top to bottom; only the horizontally
+// scaled rows the vertical filter still needs are kept, so memory is bounded
+// by the output rather than the source. Inner loops use SSE2 when available.
+class ImageScaler {
+public:
+    // crop selects the part of the source that is scaled to width x height;
+    // simd false keeps to the scalar loops, which produce the same pixels
+    ImageScaler(const Rect& crop, long width, long height, bool simd = true);
+
+    void pushRow(long y, const uint32_t* row);
+    bool finished() const { return m_nextOutput == m_height; }
+    long width() const { return m_width; }
+    long height() const { return m_height; }
+    std::vector<uint32_t> take() { return std::move(m_output); }
+
+private:
+    // Filter taps per output coordinate, padded to an even count with zero weights
+    struct Axis {
+        std::vector<long> first;
+        std::vector<int16_t> weights;   // taps per entry
+        long taps = 0;
+    };
+
+    static Axis makeAxis(long sourceLength, long outputLength);
+    void scaleRow(const uint32_t* source, int16_t* out) const;
+    void emitRow(long y);
+
+    Rect m_crop;
+    long m_width;
+    long m_height;
+    bool m_simd;
+    Axis m_horizontal;
+    Axis m_vertical;
+    std::vector<uint32_t> m_scratch;        // cropped source row plus zero padding for the taps
+    std::vector<int16_t> m_rows;            // ring of horizontally scaled rows, 7 fraction bits
+    std::vector<int16_t> m_zeroRow;
+    long m_ringRows = 0;
+    long m_received = 0;                    // crop rows scaled so far
+    long m_nextOutput = 0;
+    std::vector<uint32_t> m_output;
+};
+
+// A scaled image, centred in windows of the size it was made for
+struct Backdrop {
+    long width = 0;
+    long height = 0;
+    std::vector<uint32_t> pixels;           // top-down rows, 0x00RRGGBB
+};
+
+// One backdrop per distinct window size. The file stays mapped; every
+// prepare() decodes it once and feeds all missing sizes from that pass.
+class BackdropCache {
+public:
+    bool open(const ImageOptions& options, std::string& error);
+    bool prepare(const std::vector<std::pair<long, long>>& windowSizes, std::string& error);
+    const Backdrop* find(long windowWidth, long windowHeight) const;
+
+private:
+    ImageOptions m_options;
+    MappedFile m_file;
+    std::vector<std::pair<std::pair<long, long>, std::unique_ptr<Backdrop>>> m_backdrops;
+};
+
+#endif // IMAGEBACKDROP_HPP
@@ -0,0 +1,286 @@
+#include "InputStress.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <memory>
+
+#include "SoftwareRenderer.hpp"
+#include "WindowBackend.hpp"
+#include "WindowInput.hpp"
+#include "WindowPool.hpp"
+
+namespace {
+    struct MockWindow {
+        explicit MockWindow(const Rect& rect) : surface(rect.width(), rect.height()) {}
+
+        bool visible = false;
+        SoftwareRenderer surface;
+        RectSet invalid;            // pending WM_PAINT region, empty if none
+    };
+
+    // Windows that only exist in memory; notes when the last visible one goes
+    class StressBackend : public WindowBackend {
+    public:
+        Handle create(const WindowTarget& target) override {
+            m_windows.push_back(std::make_unique<MockWindow>(target.rect));
+            return m_windows.back().get();
+        }
+        void destroy(Handle window) override {
+            setVisible(window, false);
+            std::erase_if(m_windows, [window](const std::unique_ptr<MockWindow>& owned) { return owned.get() == window; });
+        }
+        void move(Handle, const Rect&) override {}
+        void show(Handle window) override { setVisible(window, true); }
+        void hide(Handle window) override { setVisible(window, false); }
+
+        const std::vector<std::unique_ptr<MockWindow>>& windows() const { return m_windows; }
+        size_t visible() const { return m_visible; }
+        uint64_t goneAt() const { return m_goneAt; }
+
+    private:
+        void setVisible(Handle window, bool visible) {
+            auto* mock = static_cast<MockWindow*>(window);
+            if (mock->visible == visible) return;
+            mock->visible = visible;
+            if (visible) {
+                ++m_visible;
+                mock->invalid = RectSet({ 0, 0, mock->surface.frame().width, mock->surface.frame().height });
+            }
+            else if (--m_visible == 0) {
+                m_goneAt = MetricsClock();
+            }
+        }
+
+        std::vector<std::unique_ptr<MockWindow>> m_windows;
+        size_t m_visible = 0;
+        uint64_t m_goneAt = 0;
+    };
+
+    struct Input {
+        MockWindow* window;
+        WindowMessage message;
+    };
+
+    // xorshift64: the same stream on every run
+    class Random {
+    public:
+        uint64_t next() {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 7;
+            m_state ^= m_state << 17;
+            return m_state;
+        }
+        long below(long bound) { return static_cast<long>(next() % static_cast<uint64_t>(bound)); }
+
+    private:
+        uint64_t m_state = 0x9E3779B97F4A7C15;
+    };
+
+    std::string Milliseconds(uint64_t nanos) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.3f ms", static_cast<double>(nanos) / 1e6);
+        return text;
+    }
+
+    std::string Percentiles(const LatencyHistogram::Summary& s) {
+        return "p50 " + Milliseconds(s.p50) + ", p90 " + Milliseconds(s.p90) + ", p99 " + Milliseconds(s.p99) +
+            ", p99.9 " + Milliseconds(s.p999) + ", max " + Milliseconds(s.max);
+    }
+
+    class Harness {
+    public:
+        explicit Harness(const StressOptions& options) : m_options(options), m_pool(m_backend, {}) {
+            std::vector<Rect> rects = options.windows;
+            if (rects.empty()) {
+                for (long k = 0; k < 4; ++k) rects.push_back({ k * 1920, 0, (k + 1) * 1920, 1080 });
+            }
+            for (size_t k = 0; k < rects.size(); ++k) {
+                m_targets.push_back({ static_cast<int>(k), rects[k], static_cast<int>(k), { 0, 0, 0 } });
+            }
+            if (options.resident) m_pool.sync(m_targets);
+        }
+
+        void blank() {
+            if (m_options.resident) {
+                m_pool.blankAll();
+                return;
+            }
+            std::vector<WindowBackend::Handle> windows;
+            for (const WindowTarget& target : m_targets) windows.push_back(m_backend.create(target));
+            m_backend.reveal(windows);
+        }
+
+        // A jittery mouse over one window, now and then invalidating a cursor-sized area
+        void inject(Random& random) {
+            MockWindow* window = m_backend.windows()[static_cast<size_t>(random.below(static_cast<long>(m_backend.windows().size())))].get();
+            ++m_events;
+            if (random.below(10) != 0) {
+                // Consecutive moves merge into one WM_MOUSEMOVE, as the system queue does
+                if (m_input.empty() || m_input.back().message != WindowMessage::MouseMove || m_input.back().window != window) {
+                    m_input.push_back({ window, WindowMessage::MouseMove });
+                }
+                return;
+            }
+            const Frame& frame = window->surface.frame();
+            const long x = random.below(frame.width), y = random.below(frame.height);
+            const Rect area = { x, y, (std::min)(x + 32, frame.width), (std::min)(y + 32, frame.height) };
+            window->invalid = window->invalid.unite(RectSet(area));
+        }
+
+        void pressKey(Random& random) {
+            MockWindow* window = m_backend.windows()[static_cast<size_t>(random.below(static_cast<long>(m_backend.windows().size())))].get();
+            m_input.push_back({ window, WindowMessage::KeyDown });
+        }
+
+        // Drains the queue; false once a posted unblank/quit has taken every window down
+        bool pump() {
+            for (;;) {
+                if (m_posted != WindowResponse::Ignore) {
+                    const WindowResponse posted = m_posted;
+                    m_posted = WindowResponse::Ignore;
+                    unblank(posted);
+                    return false;
+                }
+                const uint64_t start = MetricsClock();
+                if (!m_input.empty()) {
+                    const Input input = m_input.front();
+                    m_input.pop_front();
+                    dispatch(*input.window, input.message);
+                }
+                else if (MockWindow* window = nextPaint()) {
+                    dispatch(*window, WindowMessage::Paint);
+                }
+                else {
+                    return true;
+                }
+                m_dispatch.record(MetricsClock() - start);
+                ++m_dispatched;
+            }
+        }
+
+        uint64_t goneAt() const { return m_backend.goneAt(); }
+        uint64_t events() const { return m_events; }
+        uint64_t dispatched() const { return m_dispatched; }
+        const LatencyHistogram& dispatchTimes() const { return m_dispatch; }
+
+        void surfaceStats(uint64_t& paints, uint64_t& bytes) const {
+            paints = m_paints;
+            bytes = m_bytes;
+        }
+
+    private:
+        void dispatch(MockWindow& window, WindowMessage message) {
+            const WindowResponse response = RespondTo(message, true, m_options.resident);
+            switch (response) {
+                case WindowResponse::Repaint: {
+                    // One WM_PAINT covers the whole update region
+                    const RectSet dirty = std::move(window.invalid);
+                    window.invalid = {};
+                    const SoftwareRenderer::Stats before = window.surface.stats();
+                    for (const Rect& r : dirty.rects()) window.surface.paint({ 0, 0, 0, nullptr, nullptr }, r);
+                    ++m_paints;
+                    m_bytes += window.surface.stats().bytes - before.bytes;
+                    break;
+                }
+                case WindowResponse::Unblank:
+                case WindowResponse::Quit:
+                    m_posted = response;      // PostQuitMessage / WM_APP_UNBLANK
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        MockWindow* nextPaint() {
+            for (const auto& window : m_backend.windows()) {
+                if (window->visible && !window->invalid.empty()) return window.get();
+            }
+            return nullptr;
+        }
+
+        // The resident pool hides its windows; otherwise the cleanup loop destroys each one
+        void unblank(WindowResponse response) {
+            m_input.clear();
+            if (response == WindowResponse::Unblank) {
+                m_pool.unblank();
+                return;
+            }
+            while (!m_backend.windows().empty()) m_backend.destroy(m_backend.windows().back().get());
+        }
+
+        const StressOptions& m_options;
+        StressBackend m_backend;
+        WindowPool m_pool;
+        std::vector<WindowTarget> m_targets;
+        std::deque<Input> m_input;
+        WindowResponse m_posted = WindowResponse::Ignore;
+        LatencyHistogram m_dispatch;
+        uint64_t m_events = 0;
+        uint64_t m_dispatched = 0;
+        uint64_t m_paints = 0;
+        uint64_t m_bytes = 0;
+    };
+}
+
+StressReport RunInputStress(const StressOptions& options) {
+    Harness harness(options);
+    Random random;
+    StressReport report;
+    report.resident = options.resident;
+    report.rounds = options.rounds;
+    report.backlog = options.backlog;
+
+    // Flood: events arrive in small bursts and the loop keeps up between them
+    harness.blank();
+    harness.pump();
+    const uint64_t floodStart = MetricsClock();
+    for (size_t sent = 0; sent < options.events;) {
+        const size_t burst = (std::min)(static_cast<size_t>(random.below(16) + 1), options.events - sent);
+        for (size_t k = 0; k < burst; ++k) harness.inject(random);
+        sent += burst;
+        harness.pump();
+    }
+    report.floodNanos = MetricsClock() - floodStart;
+    report.events = harness.events();
+    report.dispatched = harness.dispatched();
+    report.dispatch = harness.dispatchTimes().summarize();
+    harness.surfaceStats(report.paints, report.bytes);
+    report.windows = options.windows.empty() ? 4 : options.windows.size();
+
+    // Key to unblank, with a backlog already queued ahead of the key
+    LatencyHistogram keyToGone;
+    harness.pressKey(random);
+    harness.pump();
+    for (int round = 0; round < options.rounds; ++round) {
+        harness.blank();
+        harness.pump();
+        const long backlog = options.backlog ? random.below(static_cast<long>(options.backlog) + 1) : 0;
+        for (long k = 0; k < backlog; ++k) harness.inject(random);
+        harness.pressKey(random);
+        const uint64_t pressed = MetricsClock();
+        while (harness.pump()) {
+        }
+        keyToGone.record(harness.goneAt() - pressed);
+    }
+    report.keyToGone = keyToGone.summarize();
+    return report;
+}
+
+std::string FormatStressReport(const StressReport& report) {
+    char line[256];
+    std::string text = "Input stress: " + std::to_string(report.windows) + " windows, " +
+        (report.resident ? "resident (unblank hides)" : "one-shot (unblank destroys)") + "\n";
+
+    const double seconds = static_cast<double>(report.floodNanos) / 1e9;
+    snprintf(line, sizeof(line), "Flood: %llu events in %s (%.2f M/s), %llu dispatched after coalescing, %llu paints, %.1f MB painted\n",
+        static_cast<unsigned long long>(report.events), Milliseconds(report.floodNanos).c_str(),
+        seconds > 0 ? static_cast<double>(report.events) / seconds / 1e6 : 0.0,
+        static_cast<unsigned long long>(report.dispatched), static_cast<unsigned long long>(report.paints),
+        static_cast<double>(report.bytes) / 1e6);
+    text += line;
+    text += "Dispatch: " + Percentiles(report.dispatch) + "\n";
+    text += "Key to all windows gone (" + std::to_string(report.rounds) + " rounds, up to " + std::to_string(report.backlog) +
+        " events queued ahead): " + Percentiles(report.keyToGone) + "\n";
+    return text;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef INPUTSTRESS_HPP
+#define INPUTSTRESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Metrics.hpp"
+#include "RectSet.hpp"
+
+// --stress-input: what to replay and against how many windows
+struct StressOptions {
+    size_t events = 1'000'000;      // flood length
+    int rounds = 200;               // key-to-unblank measurements
+    size_t backlog = 256;           // most events queued ahead of each key press
+    bool resident = false;          // unblank hides pool windows instead of destroying them
+    std::vector<Rect> windows;      // desktop rects of the blanking windows; empty for four 1080p ones
+};
+
+struct StressReport {
+    size_t windows = 0;
+    bool resident = false;
+    uint64_t events = 0;            // injected
+    uint64_t dispatched = 0;        // reached the window procedure after coalescing
+    uint64_t paints = 0;
+    uint64_t bytes = 0;             // surface bytes the paints wrote
+    uint64_t floodNanos = 0;
+    LatencyHistogram::Summary dispatch;
+    int rounds = 0;
+    size_t backlog = 0;
+    LatencyHistogram::Summary keyToGone;
+};
+
+// Replays synthetic message streams (jittery mouse moves, invalidations, a
+// key press) through the window procedure's decisions and paint path against
+// in-memory windows. The queue is drained in GetMessage order: posted
+// messages, then input with consecutive mouse moves coalesced, then paints.
+// Runs anywhere; nothing touches a display.
+StressReport RunInputStress(const StressOptions& options);
+
+std::string FormatStressReport(const StressReport& report);
+
+#endif // INPUTSTRESS_HPP
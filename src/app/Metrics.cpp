@@ -0,0 +1,248 @@
+#include "Metrics.hpp"
+
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+Metrics g_metrics;
+
+size_t LatencyHistogram::bucketOf(uint64_t nanos) {
+    if (nanos < kSubBuckets) return static_cast<size_t>(nanos);
+
+    // Keep the top 5 bits (leading 1 + 4 sub-bucket bits); the shift picks the power of two
+    const size_t shift = static_cast<size_t>(std::bit_width(nanos)) - 5;
+    const size_t bucket = (shift + 1) * kSubBuckets + static_cast<size_t>((nanos >> shift) & (kSubBuckets - 1));
+    return (std::min)(bucket, kBuckets - 1);
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t bucket) {
+    const size_t exponent = bucket / kSubBuckets;
+    const uint64_t sub = bucket % kSubBuckets;
+    return exponent == 0 ? sub : (kSubBuckets + sub) << (exponent - 1);
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+    m_buckets[bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(nanos, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (nanos > max && !m_max.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize() const {
+    // Buckets are read one by one, so a concurrent record may be half counted; fine for monitoring
+    std::array<uint64_t, kBuckets> counts;
+    uint64_t total = 0;
+    for (size_t b = 0; b < kBuckets; ++b) {
+        counts[b] = m_buckets[b].load(std::memory_order_relaxed);
+        total += counts[b];
+    }
+
+    Summary summary = {};
+    summary.count = total;
+    summary.sum = m_sum.load(std::memory_order_relaxed);
+    summary.max = m_max.load(std::memory_order_relaxed);
+    if (total == 0) return summary;
+
+    // Report the middle of the bucket holding each quantile
+    auto quantile = [&counts, total](double q) -> uint64_t {
+        const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < kBuckets; ++b) {
+            seen += counts[b];
+            if (seen >= rank) {
+                const uint64_t low = bucketLowerBound(b);
+                const uint64_t high = b + 1 < kBuckets ? bucketLowerBound(b + 1) : low;
+                return low + (high - low) / 2;
+            }
+        }
+        return 0;
+    };
+    summary.p50 = quantile(0.50);
+    summary.p90 = quantile(0.90);
+    summary.p99 = quantile(0.99);
+    summary.p999 = quantile(0.999);
+    return summary;
+}
+
+MetricsSnapshot TakeMetricsSnapshot() {
+    MetricsSnapshot snapshot = {};
+    snapshot.magic = MetricsSnapshot::kMagic;
+    snapshot.version = MetricsSnapshot::kVersion;
+    snapshot.timestampNanos = MetricsClock();
+    snapshot.blanks = g_metrics.blanks.load(std::memory_order_relaxed);
+    snapshot.unblanks = g_metrics.unblanks.load(std::memory_order_relaxed);
+    snapshot.paints = g_metrics.paints.load(std::memory_order_relaxed);
+    snapshot.topologyChanges = g_metrics.topologyChanges.load(std::memory_order_relaxed);
+    snapshot.enumerations = g_metrics.enumerations.load(std::memory_order_relaxed);
+    snapshot.timeToBlack = g_metrics.timeToBlack.summarize();
+    snapshot.timeToUnblank = g_metrics.timeToUnblank.summarize();
+    snapshot.enumerationTime = g_metrics.enumerationTime.summarize();
+    for (size_t k = 0; k < Metrics::kMaxWindows; ++k) {
+        snapshot.windowPaints[k] = g_metrics.windowPaints[k].load(std::memory_order_relaxed);
+    }
+    snapshot.revealSkew = g_metrics.revealSkew.summarize();
+    snapshot.poolFlips = g_metrics.poolFlips.load(std::memory_order_relaxed);
+    snapshot.poolCreates = g_metrics.poolCreates.load(std::memory_order_relaxed);
+    snapshot.poolCreateTime = g_metrics.poolCreateTime.summarize();
+    snapshot.poolRevealTime = g_metrics.poolRevealTime.summarize();
+    return snapshot;
+}
+
+std::string FormatPrometheus(const MetricsSnapshot& snapshot) {
+    std::ostringstream out;
+
+    auto counter = [&out](const char* name, const char* help, uint64_t value) {
+        out << "# HELP " << name << ' ' << help << '\n'
+            << "# TYPE " << name << " counter\n"
+            << name << ' ' << value << '\n';
+    };
+    auto summary = [&out](const char* name, const char* help, const LatencyHistogram::Summary& s) {
+        out << "# HELP " << name << ' ' << help << '\n'
+            << "# TYPE " << name << " summary\n"
+            << name << "{quantile=\"0.5\"} " << s.p50 / 1e9 << '\n'
+            << name << "{quantile=\"0.9\"} " << s.p90 / 1e9 << '\n'
+            << name << "{quantile=\"0.99\"} " << s.p99 / 1e9 << '\n'
+            << name << "{quantile=\"0.999\"} " << s.p999 / 1e9 << '\n'
+            << name << "_sum " << s.sum / 1e9 << '\n'
+            << name << "_count " << s.count << '\n';
+    };
+
+    counter("black_screen_blanks_total", "Blank requests served.", snapshot.blanks);
+    counter("black_screen_unblanks_total", "Unblank requests served.", snapshot.unblanks);
+    counter("black_screen_paints_total", "Background paints across all windows.", snapshot.paints);
+    counter("black_screen_topology_changes_total", "Display topology changes observed.", snapshot.topologyChanges);
+    counter("black_screen_enumerations_total", "Monitor enumerations run.", snapshot.enumerations);
+    summary("black_screen_time_to_black_seconds", "Blank request to all windows painted.", snapshot.timeToBlack);
+    summary("black_screen_time_to_unblank_seconds", "Unblank request to all windows gone.", snapshot.timeToUnblank);
+    summary("black_screen_enumeration_seconds", "Monitor enumeration duration.", snapshot.enumerationTime);
+    summary("black_screen_reveal_skew_seconds", "First to last window of a blank turning black.", snapshot.revealSkew);
+    counter("black_screen_pool_flips_total", "Blank windows served warm from the pool.", snapshot.poolFlips);
+    counter("black_screen_pool_creates_total", "Blank windows created on demand.", snapshot.poolCreates);
+    summary("black_screen_pool_create_seconds", "Creating one window for a blank.", snapshot.poolCreateTime);
+    summary("black_screen_pool_reveal_seconds", "Batched show call of one blank.", snapshot.poolRevealTime);
+
+    out << "# HELP black_screen_window_paints_total Background paints per monitor.\n"
+        << "# TYPE black_screen_window_paints_total counter\n";
+    for (size_t k = 0; k < Metrics::kMaxWindows; ++k) {
+        if (snapshot.windowPaints[k] == 0) continue;
+        out << "black_screen_window_paints_total{monitor=\"" << k + 1 << "\"} " << snapshot.windowPaints[k] << '\n';
+    }
+    return out.str();
+}
+
+MetricsPublisher::~MetricsPublisher() {
+    stop();
+}
+
+void MetricsPublisher::start(std::string textFile, std::chrono::milliseconds interval) {
+    if (m_thread.joinable()) return;
+
+    m_textFile = std::move(textFile);
+    m_interval = interval;
+    m_stopping = false;
+    openSharedMemory();
+
+    m_thread = std::thread([this] {
+        std::unique_lock lock(m_mutex);
+        while (!m_wake.wait_for(lock, m_interval, [this] { return m_stopping; })) {
+            lock.unlock();
+            publish();
+            lock.lock();
+        }
+    });
+}
+
+void MetricsPublisher::stop() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    publish();
+    closeSharedMemory();
+}
+
+void MetricsPublisher::publish() {
+    MetricsSnapshot snapshot = TakeMetricsSnapshot();
+
+    if (m_shared) {
+        // Seqlock write: odd sequence while the body is in flux
+        std::atomic_ref<uint64_t> sequence(m_shared->sequence);
+        sequence.store(++m_sequence, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        snapshot.sequence = m_sequence;
+        std::memcpy(m_shared, &snapshot, sizeof(snapshot));
+        sequence.store(++m_sequence, std::memory_order_release);
+    }
+
+    if (!m_textFile.empty()) {
+        // Write beside the target and rename so scrapers never see a partial file
+        const std::filesystem::path target(m_textFile);
+        std::filesystem::path temporary = target;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file) return;
+            file << FormatPrometheus(snapshot);
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, target, error);
+    }
+}
+
+bool MetricsPublisher::openSharedMemory() {
+#ifdef _WIN32
+    const std::wstring name = L"Local\\BlackScreenAppMetrics." + std::to_wstring(GetCurrentProcessId());
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(MetricsSnapshot), name.c_str());
+    if (!mapping) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(MetricsSnapshot));
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_shared = static_cast<MetricsSnapshot*>(view);
+#else
+    const std::string name = "/black_screen_app_metrics." + std::to_string(getpid());
+    const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, sizeof(MetricsSnapshot)) != 0) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, sizeof(MetricsSnapshot), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+    m_shared = static_cast<MetricsSnapshot*>(view);
+#endif
+    return true;
+}
+
+void MetricsPublisher::closeSharedMemory() {
+    if (!m_shared) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_shared);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+    m_mapping = nullptr;
+#else
+    munmap(m_shared, sizeof(MetricsSnapshot));
+    shm_unlink(("/black_screen_app_metrics." + std::to_string(getpid())).c_str());
+#endif
+    m_shared = nullptr;
+}
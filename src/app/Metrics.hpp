@@ -0,0 +1,142 @@
+#pragma once
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Log-linear latency histogram in nanoseconds: 16 linear sub-buckets per
+// power of two (about 6% relative error), covering up to ~2^40 ns. Recording
+// is a few relaxed atomic adds, safe from any thread.
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBuckets = 16;
+    static constexpr size_t kExponents = 40;
+    static constexpr size_t kBuckets = kSubBuckets * kExponents;
+
+    struct Summary {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        uint64_t p50;
+        uint64_t p90;
+        uint64_t p99;
+        uint64_t p999;
+    };
+
+    void record(uint64_t nanos);
+    Summary summarize() const;
+
+    static size_t bucketOf(uint64_t nanos);
+    static uint64_t bucketLowerBound(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> m_buckets{};
+    std::atomic<uint64_t> m_count{ 0 };
+    std::atomic<uint64_t> m_sum{ 0 };
+    std::atomic<uint64_t> m_max{ 0 };
+};
+
+// Process-wide operational counters, updated from the window procedure and
+// the startup/blanking paths
+struct Metrics {
+    static constexpr size_t kMaxWindows = 64;  // per-monitor paint slots; higher positions share the last
+
+    std::atomic<uint64_t> blanks{ 0 };
+    std::atomic<uint64_t> unblanks{ 0 };
+    std::atomic<uint64_t> paints{ 0 };
+    std::atomic<uint64_t> topologyChanges{ 0 };
+    std::atomic<uint64_t> enumerations{ 0 };
+    std::atomic<uint64_t> poolFlips{ 0 };      // blank served by a warm window
+    std::atomic<uint64_t> poolCreates{ 0 };    // blank that had to create its window first
+    LatencyHistogram timeToBlack;
+    LatencyHistogram timeToUnblank;
+    LatencyHistogram enumerationTime;
+    LatencyHistogram revealSkew;        // first to last window of one blank turning black
+    LatencyHistogram poolCreateTime;    // one window created for a blank
+    LatencyHistogram poolRevealTime;    // the batched show call of one blank
+    std::array<std::atomic<uint64_t>, kMaxWindows> windowPaints{};
+
+    void recordPaint(int monitor) {
+        paints.fetch_add(1, std::memory_order_relaxed);
+        const size_t slot = monitor < 0 ? kMaxWindows - 1 : (std::min)(static_cast<size_t>(monitor), kMaxWindows - 1);
+        windowPaints[slot].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+extern Metrics g_metrics;
+
+inline uint64_t MetricsClock() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Flat copy of the registry; also the layout of the shared-memory block.
+// sequence is odd while the publisher writes, readers retry until it is even
+// and unchanged across their copy.
+struct MetricsSnapshot {
+    static constexpr uint32_t kMagic = 0x4D534242;     // "BBSM"
+    static constexpr uint32_t kVersion = 3;
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sequence;
+    uint64_t timestampNanos;
+    uint64_t blanks;
+    uint64_t unblanks;
+    uint64_t paints;
+    uint64_t topologyChanges;
+    uint64_t enumerations;
+    LatencyHistogram::Summary timeToBlack;
+    LatencyHistogram::Summary timeToUnblank;
+    LatencyHistogram::Summary enumerationTime;
+    uint64_t windowPaints[Metrics::kMaxWindows];
+    LatencyHistogram::Summary revealSkew;
+    uint64_t poolFlips;
+    uint64_t poolCreates;
+    LatencyHistogram::Summary poolCreateTime;
+    LatencyHistogram::Summary poolRevealTime;
+};
+
+MetricsSnapshot TakeMetricsSnapshot();
+std::string FormatPrometheus(const MetricsSnapshot& snapshot);
+
+// Periodically copies the registry into a named shared-memory block
+// (Local\BlackScreenAppMetrics.<pid> on Windows, /black_screen_app_metrics.<pid>
+// elsewhere) and, if a path is given, a Prometheus text file replaced atomically.
+class MetricsPublisher {
+public:
+    MetricsPublisher() = default;
+    MetricsPublisher(const MetricsPublisher&) = delete;
+    MetricsPublisher& operator=(const MetricsPublisher&) = delete;
+    ~MetricsPublisher();
+
+    void start(std::string textFile, std::chrono::milliseconds interval);
+    // Publishes once more so the final numbers survive, then stops the thread
+    void stop();
+
+private:
+    void publish();
+    bool openSharedMemory();
+    void closeSharedMemory();
+
+    std::string m_textFile;
+    std::chrono::milliseconds m_interval{ 0 };
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    MetricsSnapshot* m_shared = nullptr;
+    void* m_mapping = nullptr;          // file mapping handle on Windows
+    uint64_t m_sequence = 0;
+};
+
+#endif // METRICS_HPP
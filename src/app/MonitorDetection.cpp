@@ -1,8 +1,14 @@
 #include "MonitorDetection.hpp"
+#ifdef _WIN32
 #include <setupapi.h>
+#endif
 #include <algorithm>
 #include <cctype>
 
+#include "DisplayCapture.hpp"
+
+#ifdef _WIN32
+
 // Get friendly monitor name from target
 std::string GetFriendlyNameFromTarget(LUID adapterId, UINT32 targetId) {
     DISPLAYCONFIG_TARGET_DEVICE_NAME deviceName = { };
@@ -26,18 +32,16 @@ std::string GetFriendlyNameFromTarget(LUID adapterId, UINT32 targetId) {
     return "Unknown Monitor";
 }
 
-// Helper function to compare LUIDs
-bool operator==(const LUID& a, const LUID& b) {
-    return a.LowPart == b.LowPart && a.HighPart == b.HighPart;
+namespace {
+    uint64_t PackLuid(const LUID& luid) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(luid.HighPart)) << 32 | luid.LowPart;
+    }
 }
 
-std::vector<MonitorData> EnumerateMonitorsWithNames() {
-    std::vector<MonitorData> result;
-
-    // Step 1: Get monitor names using DisplayConfig
-    std::vector<std::string> friendlyNames;
-    std::vector<POINT> configPositions;
+DisplayCapture CaptureDisplay() {
+    DisplayCapture capture;
 
+    // Step 1: every DisplayConfig path and mode, and the names of active targets
     UINT32 num_paths = 0, num_modes = 0;
     LONG result_code = GetDisplayConfigBufferSizes(QDC_ALL_PATHS, &num_paths, &num_modes);
     if (result_code == ERROR_SUCCESS) {
@@ -46,94 +50,45 @@ std::vector<MonitorData> EnumerateMonitorsWithNames() {
 
         result_code = QueryDisplayConfig(QDC_ALL_PATHS, &num_paths, paths.data(), &num_modes, modes.data(), nullptr);
         if (result_code == ERROR_SUCCESS) {
-            // Collect friendly names and positions for active targets
             for (UINT32 i = 0; i < num_paths; i++) {
-                if (paths[i].flags & DISPLAYCONFIG_PATH_ACTIVE) {
-                    auto& targetInfo = paths[i].targetInfo;
-                    auto& sourceInfo = paths[i].sourceInfo;  // Use this!
-
-                    // Get name
-                    std::string name = GetFriendlyNameFromTarget(targetInfo.adapterId, targetInfo.id);
-                    friendlyNames.push_back(name);
-
-                    // Get source position using the sourceInfo from path
-                    DISPLAYCONFIG_SOURCE_MODE* sourceMode = nullptr;
-                    if (sourceInfo.modeInfoIdx < num_modes &&
-                        modes[sourceInfo.modeInfoIdx].infoType == DISPLAYCONFIG_MODE_INFO_TYPE_SOURCE &&
-                        modes[sourceInfo.modeInfoIdx].adapterId == targetInfo.adapterId) {
-                        sourceMode = &modes[sourceInfo.modeInfoIdx].sourceMode;
-                    }
-
-                    if (sourceMode) {
-                        POINT pos = {
-                            static_cast<LONG>(sourceMode->position.x),
-                            static_cast<LONG>(sourceMode->position.y)
-                        };
-                        configPositions.push_back(pos);
-                    }
-                    else {
-                        // Fallback - try to find matching source mode
-                        for (UINT32 j = 0; j < num_modes; j++) {
-                            if (modes[j].infoType == DISPLAYCONFIG_MODE_INFO_TYPE_SOURCE &&
-                                modes[j].adapterId == targetInfo.adapterId &&
-                                modes[j].id == sourceInfo.id) {  // Match by ID, not by modeInfoIdx
-                                sourceMode = &modes[j].sourceMode;
-                                break;
-                            }
-                        }
-
-                        if (sourceMode) {
-                            POINT pos = {
-                                static_cast<LONG>(sourceMode->position.x),
-                                static_cast<LONG>(sourceMode->position.y)
-                            };
-                            configPositions.push_back(pos);
-                        }
-                        else {
-                            // Final fallback - use dummy position (this should be rare)
-                            configPositions.push_back({ 0, 0 });
-                        }
-                    }
+                const auto& targetInfo = paths[i].targetInfo;
+                const auto& sourceInfo = paths[i].sourceInfo;
+                const bool active = (paths[i].flags & DISPLAYCONFIG_PATH_ACTIVE) != 0;
+                capture.paths.push_back({ PackLuid(targetInfo.adapterId), targetInfo.id, sourceInfo.id,
+                    sourceInfo.modeInfoIdx, paths[i].flags,
+                    active ? GetFriendlyNameFromTarget(targetInfo.adapterId, targetInfo.id) : std::string() });
+            }
+            for (UINT32 j = 0; j < num_modes; j++) {
+                DisplayCapture::Mode mode = { static_cast<uint32_t>(modes[j].infoType), modes[j].id,
+                    PackLuid(modes[j].adapterId), 0, 0, 0, 0 };
+                if (modes[j].infoType == DISPLAYCONFIG_MODE_INFO_TYPE_SOURCE) {
+                    mode.x = modes[j].sourceMode.position.x;
+                    mode.y = modes[j].sourceMode.position.y;
+                    mode.width = modes[j].sourceMode.width;
+                    mode.height = modes[j].sourceMode.height;
                 }
+                capture.modes.push_back(mode);
             }
         }
     }
 
     // Step 2: Get actual active monitors with EnumDisplayMonitors
-    struct MatchData {
-        const std::vector<std::string>* names;
-        const std::vector<POINT>* positions;
-        std::vector<MonitorData>* results;
-    };
-
-    MatchData data = { &friendlyNames, &configPositions, &result };
-
     EnumDisplayMonitors(nullptr, nullptr, [](HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor, LPARAM dwData) -> BOOL {
         MONITORINFO mi = { sizeof(MONITORINFO) };
         if (GetMonitorInfo(hMonitor, &mi)) {
-            MatchData* data = reinterpret_cast<MatchData*>(dwData);
-
-            std::string monitorName = "Monitor " + std::to_string(data->results->size() + 1);
-
-            // Match by top-left position
-            POINT monitorPos = { mi.rcMonitor.left, mi.rcMonitor.top };
-
-            for (size_t i = 0; i < data->positions->size(); i++) {
-                if ((*data->positions)[i].x == monitorPos.x && (*data->positions)[i].y == monitorPos.y) {
-                    if (i < data->names->size()) {
-                        monitorName = (*data->names)[i];
-                        break;
-                    }
-                }
-            }
-
-            data->results->push_back({ hMonitor, mi.rcMonitor, static_cast<int>(data->results->size()), monitorName });
+            reinterpret_cast<DisplayCapture*>(dwData)->monitors.push_back(
+                { mi.rcMonitor, (mi.dwFlags & MONITORINFOF_PRIMARY) != 0, hMonitor });
         }
         return TRUE;
-        }, reinterpret_cast<LPARAM>(&data));
+        }, reinterpret_cast<LPARAM>(&capture));
 
-    return result;
+    return capture;
+}
+
+std::vector<MonitorData> EnumerateMonitorsWithNames() {
+    return MatchDisplayCapture(CaptureDisplay());
 }
+#endif // _WIN32
 
 // Helper function for case-insensitive comparison
 std::string ToLower(const std::string& str) {
@@ -5,9 +5,13 @@
 
 #include <vector>
 #include <string>
-#include <windows.h>
+
+#include "DisplayTypes.hpp"
+
+#ifdef _WIN32
 #include <winuser.h>
 #include <wingdi.h>
+#endif
 
 // Structure to hold matched monitor information
 struct MonitorData {
@@ -15,12 +19,17 @@ struct MonitorData {
     RECT rect;
     int index;
     std::string name;
+    bool primary = false;
+    int adapter = 0;        // 1-based adapter ordinal, 0 when unknown
 };
 
 
 
 
+#ifdef _WIN32
 std::string GetFriendlyNameFromTarget(LUID adapterId, UINT32 targetId);
+#endif
+// Implemented per platform: DisplayConfig on Windows, RandR on X11
 std::vector<MonitorData> EnumerateMonitorsWithNames();
 std::vector<MonitorData> FindMonitorsByName(const std::vector<MonitorData>& allMonitors, const std::string& pattern);
 MonitorData* FindMonitorByIndex(std::vector<MonitorData>& allMonitors, int index);
@@ -0,0 +1,385 @@
+#include "MonitorSelector.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+
+extern std::string ToLower(const std::string& str);
+
+namespace {
+    // Keep the grid small enough that building it never dominates a query
+    constexpr long kMaxCells = 1 << 16;
+
+    bool overlaps(const RECT& a, const RECT& b) {
+        return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+    }
+
+    // Shares at least an edge segment (corners alone do not count)
+    bool touches(const RECT& a, const RECT& b) {
+        const long overlapX = (std::min)(a.right, b.right) - (std::max)(a.left, b.left);
+        const long overlapY = (std::min)(a.bottom, b.bottom) - (std::max)(a.top, b.top);
+        return overlapX >= 0 && overlapY >= 0 && (overlapX > 0 || overlapY > 0);
+    }
+}
+
+SpatialIndex::SpatialIndex(const std::vector<MonitorData>& monitors) {
+    if (monitors.empty()) return;
+
+    m_rects.reserve(monitors.size());
+    m_bounds = monitors.front().rect;
+    long long totalWidth = 0, totalHeight = 0;
+    for (const auto& monitor : monitors) {
+        const RECT& r = monitor.rect;
+        m_rects.push_back(r);
+        m_bounds.left = (std::min)(m_bounds.left, r.left);
+        m_bounds.top = (std::min)(m_bounds.top, r.top);
+        m_bounds.right = (std::max)(m_bounds.right, r.right);
+        m_bounds.bottom = (std::max)(m_bounds.bottom, r.bottom);
+        totalWidth += r.right - r.left;
+        totalHeight += r.bottom - r.top;
+    }
+
+    // Cells roughly the size of an average monitor: each monitor lands in a handful of cells
+    const long width = (std::max)(1L, static_cast<long>(m_bounds.right - m_bounds.left));
+    const long height = (std::max)(1L, static_cast<long>(m_bounds.bottom - m_bounds.top));
+    m_cellWidth = (std::max)(1L, static_cast<long>(totalWidth / static_cast<long long>(monitors.size())));
+    m_cellHeight = (std::max)(1L, static_cast<long>(totalHeight / static_cast<long long>(monitors.size())));
+    while (((width + m_cellWidth - 1) / m_cellWidth) * ((height + m_cellHeight - 1) / m_cellHeight) > kMaxCells) {
+        m_cellWidth *= 2;
+        m_cellHeight *= 2;
+    }
+    m_columns = static_cast<int>((width + m_cellWidth - 1) / m_cellWidth);
+    m_rows = static_cast<int>((height + m_cellHeight - 1) / m_cellHeight);
+    m_cells.resize(static_cast<size_t>(m_columns) * m_rows);
+
+    for (size_t i = 0; i < m_rects.size(); ++i) {
+        const RECT& r = m_rects[i];
+        if (r.right <= r.left || r.bottom <= r.top) continue;
+        const int firstColumn = static_cast<int>((r.left - m_bounds.left) / m_cellWidth);
+        const int lastColumn = static_cast<int>((r.right - 1 - m_bounds.left) / m_cellWidth);
+        const int firstRow = static_cast<int>((r.top - m_bounds.top) / m_cellHeight);
+        const int lastRow = static_cast<int>((r.bottom - 1 - m_bounds.top) / m_cellHeight);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                m_cells[static_cast<size_t>(row) * m_columns + column].push_back(static_cast<int>(i));
+            }
+        }
+    }
+}
+
+std::vector<int> SpatialIndex::collect(const RECT& area, bool includeEdges) const {
+    std::vector<int> result;
+    if (m_cells.empty()) return result;
+
+    // Edge contact can sit on the neighbouring cell, so widen the cell scan by one pixel
+    const long grow = includeEdges ? 1 : 0;
+    const long left = (std::max)(static_cast<long>(area.left) - grow, static_cast<long>(m_bounds.left));
+    const long top = (std::max)(static_cast<long>(area.top) - grow, static_cast<long>(m_bounds.top));
+    const long right = (std::min)(static_cast<long>(area.right) + grow, static_cast<long>(m_bounds.right));
+    const long bottom = (std::min)(static_cast<long>(area.bottom) + grow, static_cast<long>(m_bounds.bottom));
+    if (right <= left || bottom <= top) return result;
+
+    const int firstColumn = static_cast<int>((left - m_bounds.left) / m_cellWidth);
+    const int lastColumn = static_cast<int>((right - 1 - m_bounds.left) / m_cellWidth);
+    const int firstRow = static_cast<int>((top - m_bounds.top) / m_cellHeight);
+    const int lastRow = static_cast<int>((bottom - 1 - m_bounds.top) / m_cellHeight);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            for (int candidate : m_cells[static_cast<size_t>(row) * m_columns + column]) {
+                const RECT& r = m_rects[candidate];
+                if (includeEdges ? touches(r, area) : overlaps(r, area)) {
+                    result.push_back(candidate);
+                }
+            }
+        }
+    }
+
+    std::ranges::sort(result);
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::vector<int> SpatialIndex::query(const RECT& area) const {
+    return collect(area, false);
+}
+
+std::vector<int> SpatialIndex::touching(const RECT& area) const {
+    return collect(area, true);
+}
+
+class MonitorQuery::Parser {
+public:
+    Parser(MonitorQuery& query, const std::string& text) : m_query(query), m_text(text) {}
+
+    int parseExpression() {
+        int node = parseTerm();
+        while (accept('|')) {
+            node = add({ .op = Op::Or, .lhs = node, .rhs = parseTerm() });
+        }
+        return node;
+    }
+
+    void expectEnd() {
+        skipSpaces();
+        if (m_pos != m_text.size()) fail("unexpected '" + std::string(1, m_text[m_pos]) + "'");
+    }
+
+private:
+    int parseTerm() {
+        int node = parseFactor();
+        while (accept('&')) {
+            node = add({ .op = Op::And, .lhs = node, .rhs = parseFactor() });
+        }
+        return node;
+    }
+
+    int parseFactor() {
+        if (accept('!')) {
+            return add({ .op = Op::Not, .lhs = parseFactor() });
+        }
+        if (accept('(')) {
+            int node = parseExpression();
+            if (!accept(')')) fail("expected ')'");
+            return node;
+        }
+        return parseAtom();
+    }
+
+    int parseAtom() {
+        skipSpaces();
+        if (accept('*')) return add({ .op = Op::All });
+
+        if (m_pos < m_text.size() && std::isdigit(static_cast<unsigned char>(m_text[m_pos]))) {
+            return add({ .op = Op::Index, .value = parseNumber() });
+        }
+
+        const std::string keyword = ToLower(parseWord());
+        if (keyword.empty()) fail("expected a selector");
+
+        if (keyword == "all") return add({ .op = Op::All });
+        if (keyword == "primary") return add({ .op = Op::Primary });
+        if (keyword == "left") return add({ .op = Op::Edge, .value = 0 });
+        if (keyword == "top") return add({ .op = Op::Edge, .value = 1 });
+        if (keyword == "right") return add({ .op = Op::Edge, .value = 2 });
+        if (keyword == "bottom") return add({ .op = Op::Edge, .value = 3 });
+
+        if (keyword == "adjacent") {
+            if (!accept('(')) fail("expected '(' after adjacent");
+            int inner = parseExpression();
+            if (!accept(')')) fail("expected ')'");
+            return add({ .op = Op::Adjacent, .lhs = inner });
+        }
+
+        if (!accept(':')) fail("unknown selector '" + keyword + "'");
+
+        if (keyword == "index") return add({ .op = Op::Index, .value = parseNumber() });
+        if (keyword == "adapter") return add({ .op = Op::Adapter, .value = parseNumber() });
+        if (keyword == "name") {
+            const std::string name = ToLower(parseText());
+            if (name.empty()) fail("expected a name after name:");
+            return add({ .op = Op::Name, .name = name });
+        }
+        if (keyword == "rect") {
+            const long x = parseNumber(); expect(',');
+            const long y = parseNumber(); expect(',');
+            const long w = parseNumber(); expect(',');
+            const long h = parseNumber();
+            return add({ .op = Op::Rect, .rect = { x, y, x + w, y + h } });
+        }
+        if (keyword == "point") {
+            const long x = parseNumber(); expect(',');
+            const long y = parseNumber();
+            return add({ .op = Op::Rect, .rect = { x, y, x + 1, y + 1 } });
+        }
+        fail("unknown selector '" + keyword + "'");
+        return -1;
+    }
+
+    int add(Node node) {
+        m_query.m_nodes.push_back(std::move(node));
+        return static_cast<int>(m_query.m_nodes.size()) - 1;
+    }
+
+    void skipSpaces() {
+        while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) ++m_pos;
+    }
+
+    bool accept(char c) {
+        skipSpaces();
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!accept(c)) fail(std::string("expected '") + c + "'");
+    }
+
+    std::string parseWord() {
+        skipSpaces();
+        const size_t start = m_pos;
+        while (m_pos < m_text.size() && (std::isalpha(static_cast<unsigned char>(m_text[m_pos])) || m_text[m_pos] == '_')) ++m_pos;
+        return m_text.substr(start, m_pos - start);
+    }
+
+    long parseNumber() {
+        skipSpaces();
+        const size_t start = m_pos;
+        if (m_pos < m_text.size() && m_text[m_pos] == '-') ++m_pos;
+        while (m_pos < m_text.size() && std::isdigit(static_cast<unsigned char>(m_text[m_pos]))) ++m_pos;
+        if (m_pos == start || (m_pos == start + 1 && m_text[start] == '-')) fail("expected a number");
+        try {
+            return std::stol(m_text.substr(start, m_pos - start));
+        }
+        catch (...) {
+            fail("number out of range");
+            return 0;
+        }
+    }
+
+    std::string parseText() {
+        skipSpaces();
+        if (m_pos < m_text.size() && m_text[m_pos] == '"') {
+            const size_t end = m_text.find('"', m_pos + 1);
+            if (end == std::string::npos) fail("unterminated quote");
+            std::string text = m_text.substr(m_pos + 1, end - m_pos - 1);
+            m_pos = end + 1;
+            return text;
+        }
+        const size_t start = m_pos;
+        while (m_pos < m_text.size() && std::string_view(" \t&|()").find(m_text[m_pos]) == std::string_view::npos) ++m_pos;
+        return m_text.substr(start, m_pos - start);
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::invalid_argument("Invalid monitor query at position " + std::to_string(m_pos + 1) + ": " + message);
+    }
+
+    MonitorQuery& m_query;
+    const std::string& m_text;
+    size_t m_pos = 0;
+};
+
+MonitorQuery MonitorQuery::compile(const std::string& expression) {
+    MonitorQuery query;
+    query.m_text = expression;
+    Parser parser(query, query.m_text);
+    query.m_root = parser.parseExpression();
+    parser.expectEnd();
+    return query;
+}
+
+std::vector<int> MonitorQuery::evaluate(const std::vector<MonitorData>& monitors, const SpatialIndex& index) const {
+    if (m_root < 0) return {};
+    return evaluateNode(m_root, monitors, index, nullptr);
+}
+
+// Answered by the spatial index without visiting the whole table
+bool MonitorQuery::spatial(int node) const {
+    const Op op = m_nodes[node].op;
+    return op == Op::Index || op == Op::Rect || op == Op::Edge;
+}
+
+std::vector<int> MonitorQuery::evaluateNode(int node, const std::vector<MonitorData>& monitors, const SpatialIndex& index,
+    const std::vector<int>* candidates) const {
+    const Node& n = m_nodes[node];
+    std::vector<int> selected;
+
+    // Visits the candidates, or the whole table when unrestricted
+    auto scan = [&](auto&& predicate) {
+        if (candidates) {
+            for (int position : *candidates) {
+                if (predicate(monitors[position])) selected.push_back(position);
+            }
+            return;
+        }
+        for (size_t i = 0; i < monitors.size(); ++i) {
+            if (predicate(monitors[i])) selected.push_back(static_cast<int>(i));
+        }
+    };
+    auto restrict = [&](std::vector<int> positions) {
+        std::erase_if(positions, [&](int position) { return position >= static_cast<int>(monitors.size()); });
+        if (!candidates) return positions;
+        std::vector<int> kept;
+        std::ranges::set_intersection(positions, *candidates, std::back_inserter(kept));
+        return kept;
+    };
+
+    switch (n.op) {
+        case Op::All:
+            if (candidates) return *candidates;
+            scan([](const MonitorData&) { return true; });
+            break;
+        case Op::Primary:
+            scan([](const MonitorData& monitor) { return monitor.primary; });
+            break;
+        case Op::Index:
+            if (n.value >= 1 && n.value <= static_cast<long>(monitors.size())) {
+                selected = restrict({ static_cast<int>(n.value - 1) });
+            }
+            break;
+        case Op::Name:
+            scan([&n](const MonitorData& monitor) { return ToLower(monitor.name).find(n.name) != std::string::npos; });
+            break;
+        case Op::Adapter:
+            scan([&n](const MonitorData& monitor) { return monitor.adapter == n.value; });
+            break;
+        case Op::Rect:
+            selected = restrict(index.query(n.rect));
+            break;
+        case Op::Edge: {
+            // One-pixel strip along the matching side of the desktop bounds
+            RECT strip = index.bounds();
+            switch (n.value) {
+                case 0: strip.right = strip.left + 1; break;
+                case 1: strip.bottom = strip.top + 1; break;
+                case 2: strip.left = strip.right - 1; break;
+                default: strip.top = strip.bottom - 1; break;
+            }
+            selected = restrict(index.query(strip));
+            break;
+        }
+        case Op::Adjacent: {
+            // Neighbours may lie outside the candidates, so the inner selection is unrestricted
+            const std::vector<int> inner = evaluateNode(n.lhs, monitors, index, nullptr);
+            std::vector<int> touching;
+            for (int position : inner) {
+                const std::vector<int> around = index.touching(monitors[position].rect);
+                touching.insert(touching.end(), around.begin(), around.end());
+            }
+            std::ranges::sort(touching);
+            touching.erase(std::unique(touching.begin(), touching.end()), touching.end());
+            std::vector<int> outside;
+            std::ranges::set_difference(touching, inner, std::back_inserter(outside));
+            selected = restrict(std::move(outside));
+            break;
+        }
+        case Op::Not: {
+            const std::vector<int> inner = evaluateNode(n.lhs, monitors, index, candidates);
+            scan([&](const MonitorData& monitor) {
+                return !std::ranges::binary_search(inner, static_cast<int>(&monitor - monitors.data()));
+            });
+            break;
+        }
+        case Op::And: {
+            // Evaluate the side the index answers first and scan the other over its result only
+            const bool swap = spatial(n.rhs) && !spatial(n.lhs);
+            const std::vector<int> first = evaluateNode(swap ? n.rhs : n.lhs, monitors, index, candidates);
+            if (first.empty()) break;
+            selected = evaluateNode(swap ? n.lhs : n.rhs, monitors, index, &first);
+            break;
+        }
+        case Op::Or: {
+            const std::vector<int> lhs = evaluateNode(n.lhs, monitors, index, candidates);
+            const std::vector<int> rhs = evaluateNode(n.rhs, monitors, index, candidates);
+            std::ranges::set_union(lhs, rhs, std::back_inserter(selected));
+            break;
+        }
+    }
+    return selected;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef MONITORSELECTOR_HPP
+#define MONITORSELECTOR_HPP
+
+#include <string>
+#include <vector>
+
+#include "MonitorDetection.hpp"
+
+// Uniform grid over the virtual desktop. Each cell lists the monitors whose
+// rect overlaps it, so rect queries only visit the cells they cover instead of
+// the whole monitor table.
+class SpatialIndex {
+public:
+    SpatialIndex() = default;
+    explicit SpatialIndex(const std::vector<MonitorData>& monitors);
+
+    // Table positions of monitors overlapping area (sorted, unique)
+    std::vector<int> query(const RECT& area) const;
+    // Table positions of monitors overlapping or sharing an edge with area
+    std::vector<int> touching(const RECT& area) const;
+
+    const RECT& bounds() const { return m_bounds; }
+    bool empty() const { return m_rects.empty(); }
+
+private:
+    std::vector<int> collect(const RECT& area, bool includeEdges) const;
+
+    std::vector<RECT> m_rects;
+    std::vector<std::vector<int>> m_cells;
+    RECT m_bounds = {};
+    long m_cellWidth = 1;
+    long m_cellHeight = 1;
+    int m_columns = 0;
+    int m_rows = 0;
+};
+
+// Selection expression compiled once and evaluated against a monitor table.
+//
+//   expr    := term ('|' term)*
+//   term    := factor ('&' factor)*
+//   factor  := '!' factor | '(' expr ')' | atom
+//   atom    := all | * | primary | left | right | top | bottom | <n>
+//            | index:<n> | name:<text> | adapter:<n>
+//            | rect:<x>,<y>,<w>,<h> | point:<x>,<y> | adjacent(<expr>)
+//
+// left/right/top/bottom select the outermost column/row of the desktop,
+// rect selects monitors intersecting the rectangle and adjacent selects the
+// monitors sharing an edge with the inner selection. Indices are 1-based as
+// with -m. Names may be quoted: name:"Dell U2720".
+class MonitorQuery {
+public:
+    // Throws std::invalid_argument describing the first syntax error
+    static MonitorQuery compile(const std::string& expression);
+
+    // Table positions of the selected monitors, in table order
+    std::vector<int> evaluate(const std::vector<MonitorData>& monitors, const SpatialIndex& index) const;
+
+    const std::string& text() const { return m_text; }
+
+private:
+    enum class Op { All, Primary, Index, Name, Adapter, Rect, Edge, Adjacent, Not, And, Or };
+
+    struct Node {
+        Op op = Op::All;
+        int lhs = -1;           // child node for Not/Adjacent, left operand for And/Or
+        int rhs = -1;
+        long value = 0;         // index/adapter number, edge id
+        RECT rect = {};
+        std::string name = {};  // lower-cased name pattern
+    };
+
+    class Parser;
+
+    // Sorted table positions selected by node, restricted to candidates when
+    // given so a spatial operand narrows the scan of the other side of an And
+    std::vector<int> evaluateNode(int node, const std::vector<MonitorData>& monitors, const SpatialIndex& index,
+        const std::vector<int>* candidates) const;
+    bool spatial(int node) const;
+
+    std::vector<Node> m_nodes;
+    int m_root = -1;
+    std::string m_text;
+};
+
+#endif // MONITORSELECTOR_HPP
@@ -0,0 +1,286 @@
+#include "OcclusionGuard.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    bool Overlaps(const Rect& a, const Rect& b) {
+        return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+    }
+}
+
+bool CanOcclude(const ObservedWindow& window) {
+    return !window.ownProcess && window.visible && !window.cloaked && window.topmost && !window.rect.empty();
+}
+
+bool IsOccluded(const Rect& own, const std::vector<ObservedWindow>& above) {
+    return std::ranges::any_of(above, [&own](const ObservedWindow& window) { return CanOcclude(window) && Overlaps(own, window.rect); });
+}
+
+void OcclusionGuard::setWindows(std::vector<Rect> windows) {
+    m_windows = std::move(windows);
+    // Indices changed meaning, so a pending storm covers every new window
+    m_touched.assign(m_windows.size(), m_deadline != 0);
+    if (m_windows.empty()) m_deadline = 0;
+}
+
+bool OcclusionGuard::note(const Rect& rect, uint64_t now) {
+    bool touched = false;
+    for (size_t k = 0; k < m_windows.size(); ++k) {
+        if (rect.empty() || Overlaps(rect, m_windows[k])) {
+            m_touched[k] = 1;
+            touched = true;
+        }
+    }
+    if (!touched) return false;
+
+    const bool armed = m_deadline == 0;
+    if (armed) {
+        m_first = now;
+        if (m_lastSettle && now - m_lastSettle < m_settings.comebackNanos) {
+            m_backoff = std::clamp(m_backoff * 2, m_settings.quietNanos, m_settings.maxBackoffNanos);
+        }
+        else if (!m_lastSettle || now - m_lastSettle > m_settings.maxBackoffNanos) {
+            m_backoff = 0;
+        }
+    }
+    m_last = now;
+    schedule();
+    return armed;
+}
+
+bool OcclusionGuard::settle(uint64_t now, std::vector<size_t>& affected) {
+    affected.clear();
+    if (m_deadline == 0 || now < m_deadline) return false;
+
+    for (size_t k = 0; k < m_windows.size(); ++k) {
+        if (m_touched[k]) affected.push_back(k);
+        m_touched[k] = 0;
+    }
+    m_deadline = 0;
+    m_lastSettle = now;
+    return true;
+}
+
+// Trailing edge of the storm, capped so a steady trickle is still answered
+void OcclusionGuard::schedule() {
+    m_deadline = (std::min)(m_last + m_settings.quietNanos, m_first + m_settings.maxDelayNanos) + m_backoff;
+}
+
+namespace {
+    constexpr uint64_t kMillis = 1'000'000;
+    constexpr uint64_t kPollNanos = 250 * kMillis;
+    constexpr uint64_t kFightReplyNanos = 30 * kMillis;     // how fast the fighting window raises itself again
+    constexpr uint64_t kFightNanos = 10'000 * kMillis;
+
+    // xorshift64: the same stream on every run
+    class Random {
+    public:
+        uint64_t next() {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 7;
+            m_state ^= m_state << 17;
+            return m_state;
+        }
+        long below(long bound) { return static_cast<long>(next() % static_cast<uint64_t>(bound)); }
+        uint64_t between(uint64_t low, uint64_t high) { return low + next() % (high - low); }
+
+    private:
+        uint64_t m_state = 0x2545F4914F6CDD1D;
+    };
+
+    struct SimEvent {
+        uint64_t at;
+        Rect rect;
+    };
+
+    // A random window somewhere on monitor
+    Rect WindowOn(Random& random, const Rect& monitor) {
+        const long width = (std::min)(monitor.width(), 400 + random.below(801));
+        const long height = (std::min)(monitor.height(), 300 + random.below(501));
+        const long left = monitor.left + random.below(monitor.width() - width + 1);
+        const long top = monitor.top + random.below(monitor.height() - height + 1);
+        return { left, top, left + width, top + height };
+    }
+
+    // Background apps taking the foreground and showing windows, mostly on the
+    // monitors in use, now and then a desktop-wide reorder that says nowhere in
+    // particular; and a toast sliding in over the first blanked monitor every
+    // few minutes
+    std::vector<SimEvent> EventStream(const std::vector<Rect>& monitors, size_t blanked, uint64_t end) {
+        Random random;
+        std::vector<SimEvent> events;
+        const size_t inUse = monitors.size() - blanked;
+        for (uint64_t t = random.between(500 * kMillis, 6000 * kMillis); t < end; t += random.between(500 * kMillis, 6000 * kMillis)) {
+            const size_t monitor = inUse && random.below(10) != 0 ? blanked + random.below(static_cast<long>(inUse))
+                : static_cast<size_t>(random.below(static_cast<long>(monitors.size())));
+            const Rect window = WindowOn(random, monitors[monitor]);
+            uint64_t at = t;
+            for (long k = 1 + random.below(5); k > 0; --k) {
+                events.push_back({ at, window });
+                at += random.between(5 * kMillis, 30 * kMillis);
+            }
+            if (random.below(100) < 15) events.push_back({ at, {} });
+        }
+
+        const Rect& first = monitors.front();
+        const Rect toast = { first.right - 380, first.bottom - 160, first.right - 16, first.bottom - 50 };
+        for (uint64_t t = random.between(180'000 * kMillis, 360'000 * kMillis); t < end; t += random.between(180'000 * kMillis, 360'000 * kMillis)) {
+            for (uint64_t k = 0; k < 24; ++k) events.push_back({ t + k * 16 * kMillis, toast });
+        }
+
+        std::sort(events.begin(), events.end(), [](const SimEvent& a, const SimEvent& b) { return a.at < b.at; });
+        return events;
+    }
+
+    // Replays the stream into one strategy. A topmost window in the middle of
+    // the first monitor fights for ten seconds halfway through: it raises
+    // itself again kFightReplyNanos after each re-assert that covers it.
+    template <typename OnEvent, typename OnTimer, typename NextTimer>
+    void Simulate(const std::vector<SimEvent>& stream, uint64_t end, const Rect& fighter, uint64_t fightStart,
+        OnEvent onEvent, OnTimer onTimer, NextTimer nextTimer) {
+        constexpr uint64_t kNever = UINT64_MAX;
+        uint64_t fight = fightStart;
+        size_t next = 0;
+        for (;;) {
+            const uint64_t streamAt = next < stream.size() ? stream[next].at : kNever;
+            const uint64_t timerAt = nextTimer();
+            const uint64_t at = (std::min)({ streamAt, fight, timerAt });
+            if (at >= end) return;
+
+            if (at == timerAt) {
+                if (onTimer(at) && at >= fightStart && at < fightStart + kFightNanos && fight == kNever) {
+                    fight = at + kFightReplyNanos;
+                }
+            }
+            else if (at == fight) {
+                fight = kNever;
+                if (onEvent(at, fighter) && at < fightStart + kFightNanos) fight = at + kFightReplyNanos;
+            }
+            else {
+                onEvent(at, stream[next++].rect);
+            }
+        }
+    }
+
+    std::string Milliseconds(uint64_t nanos) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.0f ms", static_cast<double>(nanos) / 1e6);
+        return text;
+    }
+
+    std::string Describe(const char* name, const OcclusionStrategyReport& r) {
+        const LatencyHistogram::Summary& s = r.reaction;
+        return std::string(name) + std::to_string(r.timerWakeups) + " timer wakeups, " + std::to_string(r.reasserts) +
+            " windows re-asserted\n    reaction p50 " + Milliseconds(s.p50) + ", p99 " + Milliseconds(s.p99) +
+            ", max " + Milliseconds(s.max) + "\n";
+    }
+}
+
+OcclusionStressReport RunOcclusionStress(const OcclusionStressOptions& options) {
+    std::vector<Rect> monitors = options.monitors;
+    if (monitors.empty()) {
+        for (long k = 0; k < 4; ++k) monitors.push_back({ k * 1920, 0, (k + 1) * 1920, 1080 });
+    }
+    const size_t blanked = (monitors.size() + 1) / 2;
+    const std::vector<Rect> windows(monitors.begin(), monitors.begin() + static_cast<long>(blanked));
+    const uint64_t end = static_cast<uint64_t>(options.minutes) * 60'000 * kMillis;
+    const std::vector<SimEvent> stream = EventStream(monitors, blanked, end);
+
+    const Rect& first = monitors.front();
+    const Rect fighter = { first.left + first.width() / 2 - 200, first.top + first.height() / 2 - 150,
+        first.left + first.width() / 2 + 200, first.top + first.height() / 2 + 150 };
+    const uint64_t fightStart = end / 2;
+    auto touches = [&windows](const Rect& rect) {
+        return static_cast<uint64_t>(rect.empty() ? windows.size()
+            : std::ranges::count_if(windows, [&rect](const Rect& w) { return Overlaps(rect, w); }));
+    };
+
+    OcclusionStressReport report;
+    report.minutes = options.minutes;
+    report.monitors = monitors.size();
+    report.blanked = blanked;
+
+    // The guard: one-shot timer at each deadline
+    {
+        OcclusionGuard guard;
+        guard.setWindows(windows);
+        LatencyHistogram reaction;
+        uint64_t timer = UINT64_MAX;
+        uint64_t firstTouch = 0;
+        std::vector<size_t> affected;
+        Simulate(stream, end, fighter, fightStart,
+            [&](uint64_t at, const Rect& rect) {
+                ++report.events;
+                if (touches(rect)) {
+                    ++report.touching;
+                    if (!firstTouch) firstTouch = at;
+                }
+                if (guard.note(rect, at)) timer = guard.deadline();
+                return false;
+            },
+            [&](uint64_t at) {
+                ++report.guard.timerWakeups;
+                timer = UINT64_MAX;
+                if (!guard.settle(at, affected)) {
+                    if (guard.deadline()) timer = guard.deadline();
+                    return false;
+                }
+                report.guard.reasserts += affected.size();
+                reaction.record(at - firstTouch);
+                firstTouch = 0;
+                return std::ranges::any_of(affected, [&](size_t k) { return Overlaps(windows[k], fighter); });
+            },
+            [&] { return timer; });
+        report.guard.reaction = reaction.summarize();
+    }
+
+    // Re-assert on every event: immediate, and every event costs a restack
+    {
+        LatencyHistogram reaction;
+        Simulate(stream, end, fighter, fightStart,
+            [&](uint64_t, const Rect& rect) {
+                const uint64_t count = touches(rect);
+                report.perEvent.reasserts += count;
+                if (count) reaction.record(0);
+                return count > 0 && Overlaps(rect, fighter);
+            },
+            [](uint64_t) { return false; },
+            [] { return UINT64_MAX; });
+        report.perEvent.reaction = reaction.summarize();
+    }
+
+    // Polling: blind to events, so every tick restacks every window
+    {
+        LatencyHistogram reaction;
+        uint64_t tick = kPollNanos;
+        uint64_t firstTouch = 0;
+        Simulate(stream, end, fighter, fightStart,
+            [&](uint64_t at, const Rect& rect) {
+                if (touches(rect) && !firstTouch) firstTouch = at;
+                return false;
+            },
+            [&](uint64_t at) {
+                ++report.polling.timerWakeups;
+                report.polling.reasserts += windows.size();
+                tick += kPollNanos;
+                if (firstTouch) reaction.record(at - firstTouch);
+                firstTouch = 0;
+                return true;
+            },
+            [&] { return tick; });
+        report.polling.reaction = reaction.summarize();
+    }
+    return report;
+}
+
+std::string FormatOcclusionStressReport(const OcclusionStressReport& report) {
+    std::string text = "Occlusion stress: " + std::to_string(report.minutes) + " simulated minutes, " +
+        std::to_string(report.blanked) + " of " + std::to_string(report.monitors) + " monitors blanked\n" +
+        std::to_string(report.events) + " foreground/show/z-order events, " + std::to_string(report.touching) +
+        " over a blanking window (a 10 s fight with a self-raising topmost window included)\n";
+    text += Describe("Guard (40 ms quiet, 200 ms cap): ", report.guard);
+    text += Describe("Re-assert per event: ", report.perEvent);
+    text += Describe("Poll every 250 ms: ", report.polling);
+    return text;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#ifndef OCCLUSIONGUARD_HPP
+#define OCCLUSIONGUARD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Metrics.hpp"
+#include "RectSet.hpp"
+
+struct OcclusionGuardSettings {
+    uint64_t quietNanos = 40'000'000;           // settle once events stop for this long
+    uint64_t maxDelayNanos = 200'000'000;       // but no later than this after the first one
+    uint64_t comebackNanos = 250'000'000;       // an event this soon after a settle is a window fighting back
+    uint64_t maxBackoffNanos = 2'000'000'000;   // how slowly a fight is answered at worst
+};
+
+// Decides when and which blanking windows to put back on top. The platform
+// side reports foreground, show and z-order events of other windows; the
+// guard drops those that miss every blanking window, coalesces a storm into
+// one deadline and, when the caller's one-shot timer fires, names only the
+// windows the storm touched. Nothing wakes while nothing happens. A window
+// that keeps coming back over ours doubles the delay, up to maxBackoffNanos,
+// until it has been quiet for that long.
+class OcclusionGuard {
+public:
+    explicit OcclusionGuard(OcclusionGuardSettings settings = {}) : m_settings(settings) {}
+
+    // The shown blanking windows, in the caller's order. A pending storm then
+    // touches all of them; none drops it.
+    void setWindows(std::vector<Rect> windows);
+
+    // Another window was shown, came to the front or covered one of ours over
+    // rect, empty when the event does not say where. True only when this arms
+    // the guard: the caller then sets its timer for deadline().
+    bool note(const Rect& rect, uint64_t now);
+    uint64_t deadline() const { return m_deadline; }   // 0 while idle
+
+    // When the timer fires: true with the windows to re-assert once the
+    // storm has settled; false while events keep coming or nothing is
+    // pending, and the caller re-arms for deadline() unless it is 0.
+    bool settle(uint64_t now, std::vector<size_t>& affected);
+
+private:
+    void schedule();
+
+    OcclusionGuardSettings m_settings;
+    std::vector<Rect> m_windows;
+    std::vector<char> m_touched;        // per window, since the last settle
+    uint64_t m_first = 0;               // first and last event of the pending storm
+    uint64_t m_last = 0;
+    uint64_t m_deadline = 0;
+    uint64_t m_lastSettle = 0;
+    uint64_t m_backoff = 0;
+};
+
+// What the platform reports about another window, for deciding whether it
+// can cover a blanking window
+struct ObservedWindow {
+    Rect rect;
+    bool ownProcess = false;    // ours, or another window of this process
+    bool visible = true;
+    bool cloaked = false;       // kept off screen by the compositor, e.g. on another virtual desktop
+    bool topmost = true;        // only topmost windows can rise above ours
+};
+
+// Whether an event about window is worth noting: it is on screen, not ours
+// and in the topmost band our windows live in
+bool CanOcclude(const ObservedWindow& window);
+
+// The restack decision for one blanking window at own, given the windows
+// above it in z-order: true when one of them can occlude it and overlaps it
+bool IsOccluded(const Rect& own, const std::vector<ObservedWindow>& above);
+
+// --stress-occlusion: a simulated day at a desk, no windows involved
+struct OcclusionStressOptions {
+    size_t minutes = 60;
+    std::vector<Rect> monitors;     // empty for four 1080p ones side by side; the first half is blanked
+};
+
+struct OcclusionStrategyReport {
+    uint64_t timerWakeups = 0;      // wakeups besides the hook events themselves
+    uint64_t reasserts = 0;         // windows put back on top
+    LatencyHistogram::Summary reaction;     // first occluding event to re-assert
+};
+
+struct OcclusionStressReport {
+    size_t minutes = 0;
+    size_t monitors = 0;
+    size_t blanked = 0;
+    uint64_t events = 0;            // hook events, the same count for every strategy but polling
+    uint64_t touching = 0;          // of those, events over a blanking window
+    OcclusionStrategyReport guard;
+    OcclusionStrategyReport perEvent;   // re-assert on every touching event
+    OcclusionStrategyReport polling;    // re-assert every window on a 250 ms timer
+};
+
+OcclusionStressReport RunOcclusionStress(const OcclusionStressOptions& options);
+
+std::string FormatOcclusionStressReport(const OcclusionStressReport& report);
+
+#endif // OCCLUSIONGUARD_HPP
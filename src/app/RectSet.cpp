@@ -0,0 +1,226 @@
+#include "RectSet.hpp"
+
+#include <algorithm>
+
+RectSet::RectSet(const Rect& rect) {
+    if (!rect.empty()) {
+        m_bands.push_back({ rect.top, rect.bottom, { { rect.left, rect.right } } });
+    }
+}
+
+RectSet RectSet::fromRects(const std::vector<Rect>& rects) {
+    RectSet result;
+
+    std::vector<const Rect*> byTop;
+    std::vector<long> edges;
+    byTop.reserve(rects.size());
+    edges.reserve(rects.size() * 2);
+    for (const Rect& r : rects) {
+        if (r.empty()) continue;
+        byTop.push_back(&r);
+        edges.push_back(r.top);
+        edges.push_back(r.bottom);
+    }
+    if (byTop.empty()) return result;
+
+    std::ranges::sort(byTop, {}, &Rect::top);
+    std::ranges::sort(edges);
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // Sweep the horizontal slabs between consecutive edges, keeping the rects that span the slab
+    std::vector<const Rect*> active;
+    std::vector<Span> spans;
+    size_t next = 0;
+    for (size_t k = 0; k + 1 < edges.size(); ++k) {
+        const long top = edges[k];
+        const long bottom = edges[k + 1];
+
+        std::erase_if(active, [top](const Rect* r) { return r->bottom <= top; });
+        while (next < byTop.size() && byTop[next]->top <= top) {
+            active.push_back(byTop[next++]);
+        }
+        if (active.empty()) continue;
+
+        spans.clear();
+        for (const Rect* r : active) spans.push_back({ r->left, r->right });
+        std::ranges::sort(spans, {}, &Span::left);
+
+        std::vector<Span> merged;
+        for (const Span& s : spans) {
+            if (!merged.empty() && s.left <= merged.back().right) {
+                merged.back().right = (std::max)(merged.back().right, s.right);
+            }
+            else {
+                merged.push_back(s);
+            }
+        }
+        result.appendBand(top, bottom, std::move(merged));
+    }
+    return result;
+}
+
+RectSet RectSet::unite(const RectSet& other) const {
+    return combine(*this, other, Op::Union);
+}
+
+RectSet RectSet::subtract(const RectSet& other) const {
+    return combine(*this, other, Op::Subtract);
+}
+
+RectSet RectSet::intersect(const RectSet& other) const {
+    return combine(*this, other, Op::Intersect);
+}
+
+RectSet RectSet::combine(const RectSet& a, const RectSet& b, Op op) {
+    RectSet result;
+
+    // Cheap exits keep the common "nothing to subtract" cases allocation free
+    if (a.empty() && b.empty()) return result;
+    if (b.empty()) return op == Op::Intersect ? result : a;
+    if (a.empty()) return op == Op::Union ? b : result;
+
+    std::vector<long> edges;
+    edges.reserve((a.m_bands.size() + b.m_bands.size()) * 2);
+    for (const Band& band : a.m_bands) { edges.push_back(band.top); edges.push_back(band.bottom); }
+    for (const Band& band : b.m_bands) { edges.push_back(band.top); edges.push_back(band.bottom); }
+    std::ranges::sort(edges);
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    static const std::vector<Span> none;
+    size_t i = 0, j = 0;
+    for (size_t k = 0; k + 1 < edges.size(); ++k) {
+        const long top = edges[k];
+        const long bottom = edges[k + 1];
+
+        while (i < a.m_bands.size() && a.m_bands[i].bottom <= top) ++i;
+        while (j < b.m_bands.size() && b.m_bands[j].bottom <= top) ++j;
+        const auto& spansA = (i < a.m_bands.size() && a.m_bands[i].top <= top) ? a.m_bands[i].spans : none;
+        const auto& spansB = (j < b.m_bands.size() && b.m_bands[j].top <= top) ? b.m_bands[j].spans : none;
+        if (spansA.empty() && (spansB.empty() || op != Op::Union)) continue;
+
+        std::vector<Span> spans;
+        combineSpans(spansA, spansB, op, spans);
+        result.appendBand(top, bottom, std::move(spans));
+    }
+    return result;
+}
+
+void RectSet::combineSpans(const std::vector<Span>& a, const std::vector<Span>& b, Op op, std::vector<Span>& out) {
+    // Walk both sorted span lists edge by edge, tracking whether we are inside each
+    size_t i = 0, j = 0;
+    bool insideA = false, insideB = false;
+    long x = 0;
+    while (i < a.size() || j < b.size()) {
+        const long nextA = i < a.size() ? (insideA ? a[i].right : a[i].left) : 0;
+        const long nextB = j < b.size() ? (insideB ? b[j].right : b[j].left) : 0;
+        const bool takeA = i < a.size() && (j >= b.size() || nextA <= nextB);
+        const bool takeB = j < b.size() && (i >= a.size() || nextB <= nextA);
+        const long edge = takeA ? nextA : nextB;
+
+        bool covered = false;
+        switch (op) {
+            case Op::Union: covered = insideA || insideB; break;
+            case Op::Subtract: covered = insideA && !insideB; break;
+            case Op::Intersect: covered = insideA && insideB; break;
+        }
+        if (covered && edge > x) {
+            if (!out.empty() && out.back().right == x) {
+                out.back().right = edge;
+            }
+            else {
+                out.push_back({ x, edge });
+            }
+        }
+        x = edge;
+
+        if (takeA) {
+            if (insideA) ++i;
+            insideA = !insideA;
+        }
+        if (takeB) {
+            if (insideB) ++j;
+            insideB = !insideB;
+        }
+    }
+}
+
+void RectSet::appendBand(long top, long bottom, std::vector<Span>&& spans) {
+    if (spans.empty() || bottom <= top) return;
+    if (!m_bands.empty() && m_bands.back().bottom == top && m_bands.back().spans == spans) {
+        m_bands.back().bottom = bottom;
+        return;
+    }
+    m_bands.push_back({ top, bottom, std::move(spans) });
+}
+
+long long RectSet::area() const {
+    long long total = 0;
+    for (const Band& band : m_bands) {
+        for (const Span& span : band.spans) {
+            total += static_cast<long long>(span.right - span.left) * (band.bottom - band.top);
+        }
+    }
+    return total;
+}
+
+Rect RectSet::bounds() const {
+    if (m_bands.empty()) return {};
+    Rect result = { m_bands.front().spans.front().left, m_bands.front().top,
+                    m_bands.front().spans.back().right, m_bands.back().bottom };
+    for (const Band& band : m_bands) {
+        result.left = (std::min)(result.left, band.spans.front().left);
+        result.right = (std::max)(result.right, band.spans.back().right);
+    }
+    return result;
+}
+
+bool RectSet::contains(long x, long y) const {
+    auto band = std::ranges::upper_bound(m_bands, y, {}, &Band::top);
+    if (band == m_bands.begin()) return false;
+    --band;
+    if (y >= band->bottom) return false;
+    auto span = std::ranges::upper_bound(band->spans, x, {}, &Span::left);
+    if (span == band->spans.begin()) return false;
+    --span;
+    return x < span->right;
+}
+
+std::vector<Rect> RectSet::rects() const {
+    std::vector<Rect> result;
+    for (const Band& band : m_bands) {
+        for (const Span& span : band.spans) {
+            result.push_back({ span.left, band.top, span.right, band.bottom });
+        }
+    }
+    return result;
+}
+
+std::vector<Rect> RectSet::coveringRects() const {
+    std::vector<Rect> result;
+    // Rects still growing downwards, matched to the previous band's spans by position
+    std::vector<size_t> open, nextOpen;
+    const Band* previous = nullptr;
+
+    for (const Band& band : m_bands) {
+        nextOpen.clear();
+        size_t p = 0;
+        for (const Span& span : band.spans) {
+            bool extended = false;
+            if (previous && previous->bottom == band.top) {
+                while (p < previous->spans.size() && previous->spans[p].left < span.left) ++p;
+                if (p < previous->spans.size() && previous->spans[p] == span) {
+                    result[open[p]].bottom = band.bottom;
+                    nextOpen.push_back(open[p]);
+                    extended = true;
+                }
+            }
+            if (!extended) {
+                result.push_back({ span.left, band.top, span.right, band.bottom });
+                nextOpen.push_back(result.size() - 1);
+            }
+        }
+        open.swap(nextOpen);
+        previous = &band;
+    }
+    return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef RECTSET_HPP
+#define RECTSET_HPP
+
+#include <vector>
+
+#include "DisplayTypes.hpp"
+
+// Half-open rectangle [left, right) x [top, bottom) in desktop pixels.
+// Kept independent of windows.h so the mask logic builds on any platform.
+struct Rect {
+    long left = 0;
+    long top = 0;
+    long right = 0;
+    long bottom = 0;
+
+    bool empty() const { return right <= left || bottom <= top; }
+    long width() const { return right - left; }
+    long height() const { return bottom - top; }
+    bool operator==(const Rect&) const = default;
+};
+
+inline Rect toRect(const RECT& r) { return { r.left, r.top, r.right, r.bottom }; }
+inline RECT toRECT(const Rect& r) { return { r.left, r.top, r.right, r.bottom }; }
+
+// Set of pixels stored in canonical banded form: horizontal bands sorted top
+// to bottom, each holding sorted, disjoint x spans, with vertically touching
+// bands of identical spans merged. Two sets covering the same pixels always
+// have the same representation, so equality is a plain comparison.
+class RectSet {
+public:
+    struct Span {
+        long left;
+        long right;
+        bool operator==(const Span&) const = default;
+    };
+
+    struct Band {
+        long top;
+        long bottom;
+        std::vector<Span> spans;
+        bool operator==(const Band&) const = default;
+    };
+
+    RectSet() = default;
+    explicit RectSet(const Rect& rect);
+
+    // Union of arbitrary, possibly overlapping rectangles in one sweep
+    static RectSet fromRects(const std::vector<Rect>& rects);
+
+    RectSet unite(const RectSet& other) const;
+    RectSet subtract(const RectSet& other) const;
+    RectSet intersect(const RectSet& other) const;
+
+    bool empty() const { return m_bands.empty(); }
+    long long area() const;
+    Rect bounds() const;
+    bool contains(long x, long y) const;
+
+    // One rect per span of every band (non-overlapping, band order)
+    std::vector<Rect> rects() const;
+    // Non-overlapping cover that also merges spans running straight down
+    // through consecutive bands; this is the window count used for masks
+    std::vector<Rect> coveringRects() const;
+
+    const std::vector<Band>& bands() const { return m_bands; }
+    bool operator==(const RectSet&) const = default;
+
+private:
+    enum class Op { Union, Subtract, Intersect };
+
+    static RectSet combine(const RectSet& a, const RectSet& b, Op op);
+    static void combineSpans(const std::vector<Span>& a, const std::vector<Span>& b, Op op, std::vector<Span>& out);
+    void appendBand(long top, long bottom, std::vector<Span>&& spans);
+
+    std::vector<Band> m_bands;
+};
+
+#endif // RECTSET_HPP
@@ -0,0 +1,30 @@
+#include "Renderer.hpp"
+
+#include "ImageBackdrop.hpp"
+#include "TextOverlay.hpp"
+
+Rect CentredRect(long outerWidth, long outerHeight, long width, long height) {
+    const long left = (outerWidth - width) / 2;
+    const long top = (outerHeight - height) / 2;
+    return { left, top, left + width, top + height };
+}
+
+void PaintWindow(Renderer& renderer, const PaintScene& scene, const Rect& dirty) {
+    const RectSet area = RectSet({ 0, 0, scene.width, scene.height }).intersect(RectSet(dirty));
+    if (area.empty()) return;
+    if (!scene.backdrop && !scene.overlay) {
+        for (const Rect& r : area.rects()) renderer.fill(r, scene.color);
+        return;
+    }
+
+    const Rect picture = scene.backdrop
+        ? CentredRect(scene.width, scene.height, scene.backdrop->width, scene.backdrop->height) : Rect{};
+    const Rect block = scene.overlay
+        ? CentredRect(scene.width, scene.height, scene.overlay->width(), scene.overlay->height()) : Rect{};
+    const RectSet blockArea = area.intersect(RectSet(block));
+    const RectSet pictureArea = area.intersect(RectSet(picture)).subtract(blockArea);
+
+    for (const Rect& r : area.subtract(pictureArea).subtract(blockArea).rects()) renderer.fill(r, scene.color);
+    for (const Rect& r : pictureArea.rects()) renderer.blit(r, picture, scene.backdrop->pixels.data());
+    for (const Rect& r : blockArea.rects()) renderer.blit(r, block, scene.overlay->pixels());
+}
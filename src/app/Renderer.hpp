@@ -0,0 +1,48 @@
+#pragma once
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include <cstdint>
+#include <tuple>
+
+#include "RectSet.hpp"
+
+class TextOverlay;
+struct Backdrop;
+
+// Drawing target of one blanking window, in window coordinates. Colors and
+// pixels are 0x00RRGGBB, the layout of DIB sections and the overlay buffers.
+class Renderer {
+public:
+    virtual ~Renderer() = default;
+
+    virtual void fill(const Rect& area, uint32_t color) = 0;
+    // Copies area out of an image of top-down rows whose top-left corner sits
+    // at placed.left/top; area lies within placed
+    virtual void blit(const Rect& area, const Rect& placed, const uint32_t* pixels) = 0;
+};
+
+// What a window shows: a flat color, then the --image picture and the text
+// block, both centred
+struct PaintScene {
+    long width;
+    long height;
+    uint32_t color;
+    const Backdrop* backdrop;       // may be null
+    const TextOverlay* overlay;     // may be null
+};
+
+// A width x height rect centred in an outerWidth x outerHeight window
+Rect CentredRect(long outerWidth, long outerHeight, long width, long height);
+
+// Repaints the part of the window inside dirty. Fills around the picture and
+// the text block, then copies each of them, so every pixel is written once.
+void PaintWindow(Renderer& renderer, const PaintScene& scene, const Rect& dirty);
+
+inline uint32_t PackColor(const std::tuple<int, int, int>& color) {
+    const auto [red, green, blue] = color;
+    return (static_cast<uint32_t>(red & 0xFF) << 16) | (static_cast<uint32_t>(green & 0xFF) << 8) |
+        static_cast<uint32_t>(blue & 0xFF);
+}
+
+#endif // RENDERER_HPP
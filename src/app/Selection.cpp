@@ -0,0 +1,185 @@
+#include "Selection.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+#include "Topology.hpp"
+
+RectSet BlankMask::cover(const std::vector<MonitorData>& monitors) const {
+    std::vector<Rect> monitorRects;
+    for (const auto& monitor : monitors) {
+        monitorRects.push_back(toRect(monitor.rect));
+    }
+    RectSet result = RectSet::fromRects(monitorRects);
+
+    if (!regions.empty() || !monitorRegions.empty()) {
+        std::vector<Rect> wanted = regions;
+        for (const Rect& m : monitorRects) {
+            for (const Rect& r : monitorRegions) {
+                const long left = r.left < 0 ? m.right + r.left : m.left + r.left;
+                const long top = r.top < 0 ? m.bottom + r.top : m.top + r.top;
+                const long right = r.width() == 0 ? m.right : left + r.width();
+                const long bottom = r.height() == 0 ? m.bottom : top + r.height();
+                wanted.push_back({ left, top, right, bottom });
+            }
+        }
+        result = result.intersect(RectSet::fromRects(wanted));
+    }
+
+    return result.subtract(RectSet::fromRects(exceptions));
+}
+
+bool SelectMonitors(const Topology& topology,
+    const std::vector<int>& monitorIndices,
+    const std::vector<std::string>& monitorPatterns,
+    const std::vector<MonitorQuery>& monitorQueries,
+    std::vector<MonitorData>& targetMonitors,
+    std::vector<std::string>& warnings,
+    std::string& error) {
+    const std::vector<MonitorData>& monitors = topology.monitors;
+    const SpatialIndex& index = topology.index;
+
+    if (!monitorQueries.empty()) {
+        // Handle selection queries (-q), answered through the spatial index
+        for (const MonitorQuery& query : monitorQueries) {
+            const std::vector<int> positions = query.evaluate(monitors, index);
+            if (positions.empty()) {
+                warnings.push_back("No monitor matches query: '" + query.text() + "'");
+            }
+            for (int position : positions) {
+                targetMonitors.push_back(monitors[position]);
+            }
+        }
+    }
+    else if (monitorPatterns.size() > 0) {
+        // Handle string patterns (-M)
+        if (monitorPatterns.size() == 1 && monitorPatterns[0] == "*") {
+            // Use all monitors
+            targetMonitors = monitors;
+        }
+        else {
+            // Match patterns
+            for (const std::string& pattern : monitorPatterns) {
+                bool matched = false;
+                for (const auto& monitor : monitors) {
+                    std::string monitorNameLower = monitor.name;
+                    std::string patternLower = pattern;
+                    std::ranges::transform(monitorNameLower, monitorNameLower.begin(), ::tolower);
+                    std::ranges::transform(patternLower, patternLower.begin(), ::tolower);                
+
+                    if (monitorNameLower.find(patternLower) != std::string::npos) {
+                        targetMonitors.push_back(monitor);
+                        matched = true;
+                        break; // greedy match
+                    }
+                }
+                if (!matched) {
+                    warnings.push_back("No monitor found matching pattern: '" + pattern + "'");
+                }
+            }
+        }
+    }
+    else {
+        // Handle numeric indices (-m) — existing logic
+        if (monitorIndices.size() == 1 && monitorIndices[0] == -1) {
+            // Use all monitors
+            targetMonitors = monitors;
+        }
+        else {
+            for (int idx : monitorIndices) {
+                if (idx == -1) {
+                    // If -1 is included, add all monitors
+                    for (const auto& m : monitors) {
+                        targetMonitors.push_back(m);
+                    }
+                }
+                else {
+                    if (idx >= 0 && idx < static_cast<int>(monitors.size())) {
+                        targetMonitors.push_back(monitors[idx]);
+                    }
+                    else {
+                        error = "Invalid monitor index: " + std::to_string(idx);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    // Remove duplicates
+    std::sort(targetMonitors.begin(), targetMonitors.end(), [](const MonitorData& a, const MonitorData& b) {
+        return a.index < b.index;
+        });
+    targetMonitors.erase(std::unique(targetMonitors.begin(), targetMonitors.end(), [](const MonitorData& a, const MonitorData& b) {
+        return a.index == b.index;
+        }), targetMonitors.end());
+
+    return true;
+}
+
+std::vector<WindowTarget> BuildLayout(const Topology& topology,
+    const std::vector<MonitorData>& targetMonitors,
+    const BlankMask& mask,
+    const std::vector<MonitorStyle>& styles,
+    const std::tuple<int, int, int>& defaultColor,
+    int defaultOpacity,
+    const std::vector<MonitorPattern>& patterns) {
+    // Resolve -s styles and --pattern to monitor positions; later ones win
+    std::vector<int> styleOf(topology.monitors.size(), -1);
+    for (size_t k = 0; k < styles.size(); ++k) {
+        for (int position : styles[k].selector.evaluate(topology.monitors, topology.index)) {
+            styleOf[position] = static_cast<int>(k);
+        }
+    }
+    std::vector<TestPattern> patternOf(topology.monitors.size(), TestPattern::Off);
+    for (const MonitorPattern& pattern : patterns) {
+        for (int position : pattern.selector.evaluate(topology.monitors, topology.index)) {
+            patternOf[position] = pattern.pattern;
+        }
+    }
+
+    auto makeTarget = [&](int key, const Rect& rect, int monitor) {
+        const bool known = monitor >= 0 && monitor < static_cast<int>(styleOf.size());
+        const int style = known ? styleOf[monitor] : -1;
+        return WindowTarget{
+            .key = key,
+            .rect = rect,
+            .monitor = monitor,
+            .color = style >= 0 ? styles[style].color : defaultColor,
+            .opacity = style >= 0 && styles[style].opacity >= 0 ? styles[style].opacity : defaultOpacity,
+            .pattern = known ? patternOf[monitor] : TestPattern::Off
+        };
+    };
+
+    std::vector<WindowTarget> targets;
+    if (mask.empty()) {
+        for (const auto& monitor : targetMonitors) {
+            targets.push_back(makeTarget(monitor.index, toRect(monitor.rect), monitor.index));
+        }
+    }
+    else {
+        auto looksAlike = [&](int a, int b) { return styleOf[a] == styleOf[b] && patternOf[a] == patternOf[b]; };
+        for (const Rect& r : mask.cover(targetMonitors).coveringRects()) {
+            const std::vector<int> owners = topology.index.query(toRECT(r));
+            if (owners.empty()) {
+                targets.push_back(makeTarget(static_cast<int>(targets.size()), r, -1));
+                continue;
+            }
+            if (std::ranges::all_of(owners, [&](int owner) { return looksAlike(owner, owners.front()); })) {
+                targets.push_back(makeTarget(static_cast<int>(targets.size()), r, owners.front()));
+                continue;
+            }
+
+            // A merged rect spanning differently styled monitors: one piece per monitor
+            RectSet remaining(r);
+            for (int owner : owners) {
+                const RectSet piece = remaining.intersect(RectSet(toRect(topology.monitors[owner].rect)));
+                for (const Rect& part : piece.coveringRects()) {
+                    targets.push_back(makeTarget(static_cast<int>(targets.size()), part, owner));
+                }
+                remaining = remaining.subtract(piece);
+            }
+        }
+    }
+    return targets;
+}
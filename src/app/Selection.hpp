@@ -0,0 +1,66 @@
+#pragma once
+#ifndef SELECTION_HPP
+#define SELECTION_HPP
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "MonitorDetection.hpp"
+#include "MonitorSelector.hpp"
+#include "RectSet.hpp"
+#include "TestPattern.hpp"
+#include "WindowBackend.hpp"
+
+struct Topology;
+
+// Partial-screen blanking. Regions are x,y,w,h in desktop coordinates;
+// monitor regions are relative to each selected monitor, with negative x/y
+// counted from the right/bottom edge and a zero w/h running to the edge.
+struct BlankMask {
+    std::vector<Rect> regions;          // --region: blank only these areas
+    std::vector<Rect> monitorRegions;   // --monitor-region
+    std::vector<Rect> exceptions;       // --except: keep these areas visible
+
+    bool empty() const { return regions.empty() && monitorRegions.empty() && exceptions.empty(); }
+    RectSet cover(const std::vector<MonitorData>& monitors) const;
+};
+
+// Color/opacity override for the monitors matched by selector (-s)
+struct MonitorStyle {
+    MonitorQuery selector;
+    std::tuple<int, int, int> color;
+    int opacity = -1;                   // percent, -1 inherits -o
+};
+
+// Calibration pattern for the monitors matched by selector (--pattern)
+struct MonitorPattern {
+    MonitorQuery selector;
+    TestPattern pattern;
+};
+
+// Resolves -q queries, else -M patterns, else -m indices (0-based, -1 = all)
+// against the topology, sorted by index without duplicates. Selections that
+// match nothing add a warning; an out-of-range index fails with error set.
+bool SelectMonitors(const Topology& topology,
+    const std::vector<int>& monitorIndices,
+    const std::vector<std::string>& monitorPatterns,
+    const std::vector<MonitorQuery>& monitorQueries,
+    std::vector<MonitorData>& targetMonitors,
+    std::vector<std::string>& warnings,
+    std::string& error);
+
+// One window per selected monitor, or the fewest non-overlapping rects
+// covering the mask, each carrying the color/opacity of the monitor it sits
+// on (later -s styles win over earlier ones and over the defaults), and the
+// pattern of the last --pattern matching that monitor. Mask rects spanning
+// monitors that differ in style or pattern are split at monitor edges.
+std::vector<WindowTarget> BuildLayout(const Topology& topology,
+    const std::vector<MonitorData>& targetMonitors,
+    const BlankMask& mask,
+    const std::vector<MonitorStyle>& styles,
+    const std::tuple<int, int, int>& defaultColor,
+    int defaultOpacity,
+    const std::vector<MonitorPattern>& patterns);
+
+#endif // SELECTION_HPP
@@ -0,0 +1,127 @@
+#pragma once
+#ifndef SNAPSHOTPUBLISHER_HPP
+#define SNAPSHOTPUBLISHER_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Publishes immutable snapshots of T through an atomic pointer. Readers
+// protect the snapshot they load with a hazard slot (one CAS, no lock), so
+// they never wait on a writer. Writers are serialized among themselves, swap
+// the pointer and free replaced snapshots once no hazard slot refers to them.
+//
+// Up to Slots snapshots may be held at once; beyond that acquire() spins
+// until one is released.
+template <typename T, size_t Slots = 64>
+class SnapshotPublisher {
+public:
+    // Read-only handle that keeps its snapshot alive until destroyed
+    class Snapshot {
+    public:
+        Snapshot() = default;
+        Snapshot(Snapshot&& other) noexcept : m_slot(other.m_slot), m_value(other.m_value) {
+            other.m_slot = nullptr;
+            other.m_value = nullptr;
+        }
+        Snapshot& operator=(Snapshot&& other) noexcept {
+            if (this != &other) {
+                release();
+                m_slot = std::exchange(other.m_slot, nullptr);
+                m_value = std::exchange(other.m_value, nullptr);
+            }
+            return *this;
+        }
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        ~Snapshot() { release(); }
+
+        const T* get() const { return m_value; }
+        const T* operator->() const { return m_value; }
+        const T& operator*() const { return *m_value; }
+        explicit operator bool() const { return m_value != nullptr; }
+
+    private:
+        friend class SnapshotPublisher;
+        Snapshot(std::atomic<const T*>* slot, const T* value) : m_slot(slot), m_value(value) {}
+
+        void release() {
+            if (m_slot) m_slot->store(nullptr, std::memory_order_release);
+            m_slot = nullptr;
+            m_value = nullptr;
+        }
+
+        std::atomic<const T*>* m_slot = nullptr;
+        const T* m_value = nullptr;
+    };
+
+    SnapshotPublisher() = default;
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+    // Callers must have released every snapshot before destruction
+    ~SnapshotPublisher() {
+        delete m_current.load(std::memory_order_relaxed);
+        for (const T* retired : m_retired) delete retired;
+    }
+
+    // Empty handle until the first publish()
+    Snapshot acquire() const {
+        const T* value = m_current.load(std::memory_order_acquire);
+        if (!value) return {};
+
+        static thread_local const size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id()) % Slots;
+        for (;;) {
+            for (size_t k = 0; k < Slots; ++k) {
+                auto& slot = m_hazards[(start + k) % Slots];
+                const T* expected = nullptr;
+                if (!slot.compare_exchange_strong(expected, value)) continue;
+
+                // Re-check after the hazard is visible: a writer that swapped in between
+                // may already have scanned the slots, so follow the newer pointer
+                for (;;) {
+                    const T* now = m_current.load();
+                    if (now == value) return Snapshot(&slot, value);
+                    value = now;
+                    slot.store(value);
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void publish(std::unique_ptr<T> value) {
+        std::lock_guard lock(m_writerMutex);
+        const T* previous = m_current.exchange(value.release());
+        if (previous) m_retired.push_back(previous);
+        reclaim();
+    }
+
+private:
+    // Frees every retired snapshot that no reader currently protects
+    void reclaim() {
+        std::array<const T*, Slots> protectedValues;
+        for (size_t k = 0; k < Slots; ++k) {
+            protectedValues[k] = m_hazards[k].load();
+        }
+        std::erase_if(m_retired, [&protectedValues](const T* retired) {
+            if (std::ranges::find(protectedValues, retired) != protectedValues.end()) return false;
+            delete retired;
+            return true;
+        });
+    }
+
+    mutable std::array<std::atomic<const T*>, Slots> m_hazards{};
+    std::atomic<const T*> m_current{ nullptr };
+    std::mutex m_writerMutex;
+    std::vector<const T*> m_retired;
+};
+
+#endif // SNAPSHOTPUBLISHER_HPP
@@ -0,0 +1,346 @@
+#include "Socket.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef _WIN32
+    using NativeSocket = SOCKET;
+    using PollEntry = WSAPOLLFD;
+
+    bool WouldBlock() {
+        const int code = WSAGetLastError();
+        return code == WSAEWOULDBLOCK || code == WSAEINPROGRESS;
+    }
+
+    std::string LastError() {
+        return "socket error " + std::to_string(WSAGetLastError());
+    }
+#else
+    using NativeSocket = int;
+    using PollEntry = pollfd;
+
+    bool WouldBlock() {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS;
+    }
+
+    std::string LastError() {
+        return std::strerror(errno);
+    }
+#endif
+
+#ifdef MSG_NOSIGNAL
+    constexpr int kSendFlags = MSG_NOSIGNAL;    // a vanished peer is an error, not SIGPIPE
+#else
+    constexpr int kSendFlags = 0;
+#endif
+
+    NativeSocket Native(SocketHandle socket) {
+        return static_cast<NativeSocket>(socket);
+    }
+
+    void EnsureStartup() {
+#ifdef _WIN32
+        static std::once_flag once;
+        std::call_once(once, [] {
+            WSADATA data;
+            WSAStartup(MAKEWORD(2, 2), &data);
+        });
+#endif
+    }
+
+    bool SetNonBlocking(NativeSocket socket) {
+#ifdef _WIN32
+        u_long enabled = 1;
+        return ioctlsocket(socket, FIONBIO, &enabled) == 0;
+#else
+        const int flags = fcntl(socket, F_GETFL, 0);
+        return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    }
+
+    // The first address getaddrinfo offers; fine for the literal addresses fleets use
+    addrinfo* Resolve(const Endpoint& endpoint, bool passive, std::string& error) {
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = passive ? AI_PASSIVE : 0;
+        const char* host = endpoint.host.empty() || endpoint.host == "*" ? nullptr : endpoint.host.c_str();
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host, endpoint.port.c_str(), &hints, &result) != 0 || !result) {
+            error = "Cannot resolve '" + endpoint.host + ":" + endpoint.port + "'";
+            return nullptr;
+        }
+        return result;
+    }
+
+#ifndef _WIN32
+    bool UnixAddress(const Endpoint& endpoint, sockaddr_un& address, std::string& error) {
+        address = {};
+        address.sun_family = AF_UNIX;
+        if (endpoint.path.size() >= sizeof(address.sun_path)) {
+            error = "Unix socket path too long: " + endpoint.path;
+            return false;
+        }
+        std::memcpy(address.sun_path, endpoint.path.c_str(), endpoint.path.size() + 1);
+        return true;
+    }
+#endif
+}
+
+bool ParseEndpoint(const std::string& text, Endpoint& endpoint, std::string& error) {
+    endpoint = {};
+    if (text.starts_with("unix:")) {
+#ifdef _WIN32
+        error = "Unix socket endpoints are not supported on Windows: " + text;
+        return false;
+#else
+        endpoint.path = text.substr(5);
+        if (endpoint.path.empty()) {
+            error = "Missing path in endpoint '" + text + "'";
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    const size_t colon = text.rfind(':');
+    if (colon == std::string::npos) {
+        endpoint.host = "127.0.0.1";
+        endpoint.port = text;
+    }
+    else {
+        endpoint.host = text.substr(0, colon);
+        endpoint.port = text.substr(colon + 1);
+        if (endpoint.host.size() >= 2 && endpoint.host.front() == '[' && endpoint.host.back() == ']') {
+            endpoint.host = endpoint.host.substr(1, endpoint.host.size() - 2);
+        }
+    }
+    if (endpoint.port.empty() || endpoint.port.find_first_not_of("0123456789") != std::string::npos) {
+        error = "Invalid endpoint '" + text + "'. Expected host:port or unix:/path";
+        return false;
+    }
+    return true;
+}
+
+bool Endpoint::loopback() const {
+    return local() || host == "localhost" || host == "::1" || host.starts_with("127.");
+}
+
+SocketHandle Listen(const Endpoint& endpoint, std::string& error) {
+    EnsureStartup();
+#ifndef _WIN32
+    if (endpoint.local()) {
+        sockaddr_un address;
+        if (!UnixAddress(endpoint, address, error)) return kInvalidSocket;
+        const int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(endpoint.path.c_str());      // a stale socket from a previous run
+        if (socket < 0 || bind(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(socket, SOMAXCONN) != 0 || !SetNonBlocking(socket)) {
+            error = "Cannot listen on unix:" + endpoint.path + ": " + LastError();
+            if (socket >= 0) ::close(socket);
+            return kInvalidSocket;
+        }
+        return socket;
+    }
+#endif
+
+    addrinfo* address = Resolve(endpoint, true, error);
+    if (!address) return kInvalidSocket;
+    const NativeSocket socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    bool listening = Native(kInvalidSocket) != socket;
+    if (listening) {
+        const int enabled = 1;
+#ifdef _WIN32
+        setsockopt(socket, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, reinterpret_cast<const char*>(&enabled), sizeof(enabled));
+#else
+        setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+#endif
+        listening = bind(socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0 &&
+            listen(socket, SOMAXCONN) == 0 && SetNonBlocking(socket);
+    }
+    freeaddrinfo(address);
+    if (!listening) {
+        error = "Cannot listen on " + endpoint.host + ":" + endpoint.port + ": " + LastError();
+        CloseSocket(static_cast<SocketHandle>(socket));
+        return kInvalidSocket;
+    }
+    return static_cast<SocketHandle>(socket);
+}
+
+SocketHandle Connect(const Endpoint& endpoint, std::string& error) {
+    EnsureStartup();
+#ifndef _WIN32
+    if (endpoint.local()) {
+        sockaddr_un address;
+        if (!UnixAddress(endpoint, address, error)) return kInvalidSocket;
+        const int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socket < 0 || !SetNonBlocking(socket) ||
+            (connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 && errno != EINPROGRESS)) {
+            error = LastError();
+            if (socket >= 0) ::close(socket);
+            return kInvalidSocket;
+        }
+        return socket;
+    }
+#endif
+
+    addrinfo* address = Resolve(endpoint, false, error);
+    if (!address) return kInvalidSocket;
+    const NativeSocket socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    bool started = Native(kInvalidSocket) != socket && SetNonBlocking(socket);
+    if (started) {
+        // Requests are small and pipelined; Nagle would hold them back
+        const int enabled = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enabled), sizeof(enabled));
+        started = connect(socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0 || WouldBlock();
+    }
+    freeaddrinfo(address);
+    if (!started) {
+        error = LastError();
+        CloseSocket(static_cast<SocketHandle>(socket));
+        return kInvalidSocket;
+    }
+    return static_cast<SocketHandle>(socket);
+}
+
+bool ConnectFinished(SocketHandle socket, std::string& error) {
+    int code = 0;
+#ifdef _WIN32
+    int length = sizeof(code);
+    const bool queried = getsockopt(Native(socket), SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&code), &length) == 0;
+#else
+    socklen_t length = sizeof(code);
+    const bool queried = getsockopt(Native(socket), SOL_SOCKET, SO_ERROR, &code, &length) == 0;
+#endif
+    if (!queried) {
+        error = LastError();
+        return false;
+    }
+    if (code != 0) {
+#ifdef _WIN32
+        error = "socket error " + std::to_string(code);
+#else
+        error = std::strerror(code);
+#endif
+        return false;
+    }
+    return true;
+}
+
+SocketHandle Accept(SocketHandle listener) {
+    const NativeSocket socket = accept(Native(listener), nullptr, nullptr);
+    if (socket == Native(kInvalidSocket)) return kInvalidSocket;
+    if (!SetNonBlocking(socket)) {
+        CloseSocket(static_cast<SocketHandle>(socket));
+        return kInvalidSocket;
+    }
+    return static_cast<SocketHandle>(socket);
+}
+
+void CloseSocket(SocketHandle socket) {
+    if (socket == kInvalidSocket) return;
+#ifdef _WIN32
+    closesocket(Native(socket));
+#else
+    ::close(Native(socket));
+#endif
+}
+
+long SendSome(SocketHandle socket, const char* data, size_t size) {
+    const auto sent = send(Native(socket), data, static_cast<int>((std::min)(size, size_t{ 1 } << 30)), kSendFlags);
+    if (sent >= 0) return static_cast<long>(sent);
+    return WouldBlock() ? kSocketWouldBlock : -1;
+}
+
+long ReceiveSome(SocketHandle socket, char* data, size_t size) {
+    const auto received = recv(Native(socket), data, static_cast<int>((std::min)(size, size_t{ 1 } << 30)), 0);
+    if (received >= 0) return static_cast<long>(received);
+    return WouldBlock() ? kSocketWouldBlock : -1;
+}
+
+int PollSockets(std::vector<SocketPoll>& sockets, int timeoutMs) {
+    if (sockets.empty()) {
+        // WSAPoll rejects an empty set
+        if (timeoutMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        return 0;
+    }
+
+    std::vector<PollEntry> entries(sockets.size());
+    for (size_t k = 0; k < sockets.size(); ++k) {
+        entries[k].fd = Native(sockets[k].socket);
+        entries[k].events = static_cast<short>((sockets[k].wantRead ? POLLIN : 0) | (sockets[k].wantWrite ? POLLOUT : 0));
+    }
+#ifdef _WIN32
+    const int ready = WSAPoll(entries.data(), static_cast<ULONG>(entries.size()), timeoutMs);
+#else
+    const int ready = poll(entries.data(), entries.size(), timeoutMs);
+#endif
+    for (size_t k = 0; k < sockets.size(); ++k) {
+        const short events = ready > 0 ? entries[k].revents : 0;
+        sockets[k].readable = (events & (POLLIN | POLLHUP)) != 0;
+        sockets[k].writable = (events & POLLOUT) != 0;
+        sockets[k].failed = (events & (POLLERR | POLLNVAL)) != 0;
+    }
+    return (std::max)(ready, 0);
+}
+
+bool SocketWaker::open(std::string& error) {
+    EnsureStartup();
+    const NativeSocket socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+#ifdef _WIN32
+    int length = sizeof(address);
+#else
+    socklen_t length = sizeof(address);
+#endif
+    // Bound to an ephemeral loopback port and connected to that same port
+    if (socket == Native(kInvalidSocket) ||
+        bind(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        getsockname(socket, reinterpret_cast<sockaddr*>(&address), &length) != 0 ||
+        connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        !SetNonBlocking(socket)) {
+        error = "Cannot create wake socket: " + LastError();
+        CloseSocket(static_cast<SocketHandle>(socket));
+        return false;
+    }
+    m_socket = static_cast<SocketHandle>(socket);
+    return true;
+}
+
+void SocketWaker::close() {
+    CloseSocket(m_socket);
+    m_socket = kInvalidSocket;
+}
+
+void SocketWaker::wake() {
+    // A full buffer already guarantees a wake-up
+    const char signal = 1;
+    send(Native(m_socket), &signal, 1, kSendFlags);
+}
+
+void SocketWaker::drain() {
+    char buffer[64];
+    while (recv(Native(m_socket), buffer, sizeof(buffer), 0) > 0) {
+    }
+}
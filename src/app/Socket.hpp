@@ -0,0 +1,78 @@
+#pragma once
+#ifndef SOCKET_HPP
+#define SOCKET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Thin non-blocking socket layer over Winsock and BSD sockets, enough for
+// the fleet server and controller. Windows headers stay in the .cpp so this
+// can be included after <windows.h>.
+
+// SOCKET on Windows, a file descriptor elsewhere
+using SocketHandle = intptr_t;
+constexpr SocketHandle kInvalidSocket = -1;
+
+// ReceiveSome/SendSome result when nothing can be transferred right now
+constexpr long kSocketWouldBlock = -2;
+
+// "host:port", "[v6 address]:port", a bare port on 127.0.0.1, or (not on
+// Windows) "unix:/path". Listening on "*:port" accepts on every interface.
+struct Endpoint {
+    std::string host;
+    std::string port;
+    std::string path;   // Unix socket path, empty for TCP
+
+    bool local() const { return !path.empty(); }
+    // Reachable from this machine only: a Unix socket, localhost, 127.x.x.x or ::1
+    bool loopback() const;
+};
+
+bool ParseEndpoint(const std::string& text, Endpoint& endpoint, std::string& error);
+
+// Both return a non-blocking socket, or kInvalidSocket with error filled in.
+// Connect only starts the connection; poll for writable, then ConnectFinished.
+SocketHandle Listen(const Endpoint& endpoint, std::string& error);
+SocketHandle Connect(const Endpoint& endpoint, std::string& error);
+bool ConnectFinished(SocketHandle socket, std::string& error);
+SocketHandle Accept(SocketHandle listener);
+void CloseSocket(SocketHandle socket);
+
+// Bytes moved, 0 once the peer closed (receive only), -1 on error or kSocketWouldBlock
+long SendSome(SocketHandle socket, const char* data, size_t size);
+long ReceiveSome(SocketHandle socket, char* data, size_t size);
+
+struct SocketPoll {
+    SocketHandle socket;
+    bool wantRead = false;
+    bool wantWrite = false;
+    bool readable = false;      // also set on hang-up, so the next receive reports it
+    bool writable = false;
+    bool failed = false;
+};
+
+// poll()/WSAPoll(); returns the number of ready sockets, 0 on timeout
+int PollSockets(std::vector<SocketPoll>& sockets, int timeoutMs);
+
+// Loopback datagram socket connected to itself: wake() from any thread makes
+// it readable, so a thread blocked in PollSockets can be interrupted
+class SocketWaker {
+public:
+    SocketWaker() = default;
+    SocketWaker(const SocketWaker&) = delete;
+    SocketWaker& operator=(const SocketWaker&) = delete;
+    ~SocketWaker() { close(); }
+
+    bool open(std::string& error);
+    void close();
+    void wake();
+    void drain();
+    SocketHandle handle() const { return m_socket; }
+
+private:
+    SocketHandle m_socket = kInvalidSocket;
+};
+
+#endif // SOCKET_HPP
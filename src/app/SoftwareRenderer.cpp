@@ -0,0 +1,51 @@
+#include "SoftwareRenderer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+SoftwareRenderer::SoftwareRenderer(long width, long height) {
+    m_frame.width = (std::max)(width, 0L);
+    m_frame.height = (std::max)(height, 0L);
+    m_frame.pixels.resize(static_cast<size_t>(m_frame.width) * m_frame.height);
+}
+
+Rect SoftwareRenderer::clip(const Rect& area) const {
+    return { (std::max)(area.left, 0L), (std::max)(area.top, 0L),
+             (std::min)(area.right, m_frame.width), (std::min)(area.bottom, m_frame.height) };
+}
+
+void SoftwareRenderer::fill(const Rect& area, uint32_t color) {
+    const Rect r = clip(area);
+    ++m_stats.fills;
+    if (r.empty()) return;
+
+    uint32_t* row = m_frame.pixels.data() + static_cast<size_t>(r.top) * m_frame.width + r.left;
+    for (long y = r.top; y < r.bottom; ++y, row += m_frame.width) {
+        std::fill_n(row, r.width(), color);
+    }
+    m_stats.bytes += static_cast<uint64_t>(r.width()) * r.height() * sizeof(uint32_t);
+}
+
+void SoftwareRenderer::blit(const Rect& area, const Rect& placed, const uint32_t* pixels) {
+    // The source rows are placed.width() long; anything outside placed or the surface is skipped
+    const Rect bounded = { (std::max)(area.left, placed.left), (std::max)(area.top, placed.top),
+                           (std::min)(area.right, placed.right), (std::min)(area.bottom, placed.bottom) };
+    const Rect r = clip(bounded);
+    ++m_stats.blits;
+    if (r.empty()) return;
+
+    const size_t rowBytes = static_cast<size_t>(r.width()) * sizeof(uint32_t);
+    const uint32_t* source = pixels + static_cast<size_t>(r.top - placed.top) * placed.width() + (r.left - placed.left);
+    uint32_t* row = m_frame.pixels.data() + static_cast<size_t>(r.top) * m_frame.width + r.left;
+    for (long y = r.top; y < r.bottom; ++y, row += m_frame.width, source += placed.width()) {
+        std::memcpy(row, source, rowBytes);
+    }
+    m_stats.bytes += rowBytes * static_cast<uint64_t>(r.height());
+}
+
+void SoftwareRenderer::paint(PaintScene scene, const Rect& dirty) {
+    scene.width = m_frame.width;
+    scene.height = m_frame.height;
+    ++m_stats.paints;
+    PaintWindow(*this, scene, dirty);
+}
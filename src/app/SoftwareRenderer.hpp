@@ -0,0 +1,54 @@
+#pragma once
+#ifndef SOFTWARERENDERER_HPP
+#define SOFTWARERENDERER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Renderer.hpp"
+
+// A captured surface: top-down rows, 0x00RRGGBB (BGRX bytes in memory).
+// Comparing two frames is pixel-exact.
+struct Frame {
+    long width = 0;
+    long height = 0;
+    std::vector<uint32_t> pixels;
+
+    bool operator==(const Frame&) const = default;
+    uint32_t at(long x, long y) const { return pixels[static_cast<size_t>(y) * width + x]; }
+};
+
+// Offscreen renderer: one in-memory surface per window, so the paint path
+// runs and can be measured without a desktop
+class SoftwareRenderer : public Renderer {
+public:
+    struct Stats {
+        uint64_t paints = 0;        // paint() calls
+        uint64_t fills = 0;
+        uint64_t blits = 0;
+        uint64_t bytes = 0;         // surface bytes written
+    };
+
+    SoftwareRenderer(long width, long height);
+
+    void fill(const Rect& area, uint32_t color) override;
+    void blit(const Rect& area, const Rect& placed, const uint32_t* pixels) override;
+
+    // PaintWindow onto this surface, counted as one paint; scene is sized to the surface
+    void paint(PaintScene scene, const Rect& dirty);
+    void paint(const PaintScene& scene) { paint(scene, { 0, 0, m_frame.width, m_frame.height }); }
+
+    const Frame& frame() const { return m_frame; }
+    Frame capture() const { return m_frame; }
+    const Stats& stats() const { return m_stats; }
+    void resetStats() { m_stats = {}; }
+
+private:
+    Rect clip(const Rect& area) const;
+
+    Frame m_frame;
+    Stats m_stats;
+};
+
+#endif // SOFTWARERENDERER_HPP
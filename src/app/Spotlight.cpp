@@ -0,0 +1,272 @@
+#include "Spotlight.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "MonitorDetection.hpp"
+#include "Selection.hpp"
+#include "Topology.hpp"
+#include "WindowPool.hpp"
+
+namespace {
+    bool Overlaps(const Rect& a, const Rect& b) {
+        return !a.empty() && !b.empty() && a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+    }
+}
+
+std::vector<WindowTarget> Spotlight::reset(const std::vector<WindowTarget>& bases) {
+    m_bases = bases;
+    m_sides.clear();
+    for (const WindowTarget& base : m_bases) {
+        const std::array<Rect, kSides> sides = split(base.rect, m_hole);
+        for (int k = 0; k < kSides; ++k) {
+            WindowTarget side = base;
+            side.key = base.key * kSides + k;
+            side.rect = sides[k];
+            m_sides.push_back(side);
+        }
+    }
+    return m_sides;
+}
+
+std::vector<int> Spotlight::sideKeys(const std::vector<int>& baseKeys) {
+    std::vector<int> keys;
+    for (int key : baseKeys) {
+        for (int k = 0; k < kSides; ++k) keys.push_back(key * kSides + k);
+    }
+    return keys;
+}
+
+std::vector<WindowTarget> Spotlight::move(const Rect& hole) {
+    const Rect next = hole.empty() ? Rect{} : hole;
+    if (next == m_hole) return {};
+
+    // The pixels that changed hands (old hole minus new, new minus old) lie
+    // within the two holes, so a base meeting neither keeps its sides
+    const Rect previous = m_hole;
+    m_hole = next;
+
+    std::vector<WindowTarget> result;
+    for (size_t b = 0; b < m_bases.size(); ++b) {
+        if (!Overlaps(m_bases[b].rect, previous) && !Overlaps(m_bases[b].rect, next)) continue;
+        const std::array<Rect, kSides> sides = split(m_bases[b].rect, m_hole);
+        for (int k = 0; k < kSides; ++k) {
+            WindowTarget& side = m_sides[b * kSides + k];
+            if (side.rect == sides[k]) continue;
+            side.rect = sides[k];
+            result.push_back(side);
+        }
+    }
+    return result;
+}
+
+// The same pixels as RectSet(base).subtract(RectSet(hole)), cut into fixed
+// sides so each keeps its window; empty sides are normalised to {}
+std::array<Rect, Spotlight::kSides> Spotlight::split(const Rect& base, const Rect& hole) {
+    const Rect clip = {
+        (std::max)(base.left, hole.left), (std::max)(base.top, hole.top),
+        (std::min)(base.right, hole.right), (std::min)(base.bottom, hole.bottom)
+    };
+    if (hole.empty() || clip.empty()) return { base, Rect{}, Rect{}, Rect{} };
+
+    std::array<Rect, kSides> sides = { {
+        { base.left, base.top, base.right, clip.top },
+        { base.left, clip.top, clip.left, clip.bottom },
+        { clip.right, clip.top, base.right, clip.bottom },
+        { base.left, clip.bottom, base.right, base.bottom }
+    } };
+    for (Rect& side : sides) {
+        if (side.empty()) side = {};
+    }
+    return sides;
+}
+
+bool ScriptedWindowEvents::start(Listener listener) {
+    m_listener = std::move(listener);
+    m_next = 0;
+    return step();
+}
+
+bool ScriptedWindowEvents::step() {
+    if (!m_listener || m_next >= m_path.size()) return false;
+    m_listener(m_path[m_next++]);
+    return true;
+}
+
+namespace {
+    // Windows that only exist in memory, counting what the pool asks of them
+    class CountingBackend : public WindowBackend {
+    public:
+        Handle create(const WindowTarget&) override {
+            ++m_calls;
+            return reinterpret_cast<Handle>(++m_lastHandle);
+        }
+        void destroy(Handle) override { ++m_calls; }
+        void move(Handle, const Rect&) override { ++m_calls; }
+        void show(Handle) override { ++m_calls; }
+        void hide(Handle) override { ++m_calls; }
+
+        uint64_t calls() const { return m_calls; }
+
+    private:
+        uint64_t m_calls = 0;
+        uintptr_t m_lastHandle = 0;
+    };
+
+    // xorshift64: the same path on every run
+    class Random {
+    public:
+        uint64_t next() {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 7;
+            m_state ^= m_state << 17;
+            return m_state;
+        }
+        long below(long bound) { return static_cast<long>(next() % static_cast<uint64_t>(bound)); }
+
+    private:
+        uint64_t m_state = 0x9E3779B97F4A7C15;
+    };
+
+    // A 1280x800 window dragged in small jittery steps, bouncing off the
+    // desktop edges, now and then resized or minimized for a few steps
+    std::vector<Rect> DragPath(const Rect& desktop, size_t moves) {
+        Random random;
+        std::vector<Rect> path;
+        path.reserve(moves + 1);
+        long width = 1280, height = 800;
+        long x = desktop.left + desktop.width() / 2 - width / 2, y = desktop.top + desktop.height() / 2 - height / 2;
+        long dx = 12, dy = 3;
+        int minimized = 0;
+        path.push_back({ x, y, x + width, y + height });
+        while (path.size() <= moves) {
+            if (minimized > 0) {
+                --minimized;
+                path.push_back({});
+                continue;
+            }
+            if (random.below(2000) == 0) {
+                minimized = 5;
+                continue;
+            }
+            if (random.below(50) == 0) {
+                width = std::clamp(width + random.below(81) - 40, 320L, desktop.width());
+                height = std::clamp(height + random.below(81) - 40, 240L, desktop.height());
+            }
+            x += dx + random.below(9) - 4;
+            y += dy + random.below(9) - 4;
+            if (x < desktop.left - width / 2 || x + width / 2 > desktop.right) dx = -dx;
+            if (y < desktop.top - height / 2 || y + height / 2 > desktop.bottom) dy = -dy;
+            path.push_back({ x, y, x + width, y + height });
+        }
+        return path;
+    }
+
+    std::string Microseconds(uint64_t nanos) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.2f us", static_cast<double>(nanos) / 1e3);
+        return text;
+    }
+
+    std::string Percentiles(const LatencyHistogram::Summary& s) {
+        return "p50 " + Microseconds(s.p50) + ", p90 " + Microseconds(s.p90) + ", p99 " + Microseconds(s.p99) +
+            ", p99.9 " + Microseconds(s.p999) + ", max " + Microseconds(s.max);
+    }
+}
+
+SpotlightStressReport RunSpotlightStress(const SpotlightStressOptions& options) {
+    std::vector<Rect> rects = options.monitors;
+    if (rects.empty()) {
+        for (long k = 0; k < 4; ++k) rects.push_back({ k * 1920, 0, (k + 1) * 1920, 1080 });
+    }
+    std::vector<MonitorData> monitors;
+    std::vector<WindowTarget> bases;
+    std::vector<int> baseKeys;
+    for (size_t k = 0; k < rects.size(); ++k) {
+        monitors.push_back({ nullptr, toRECT(rects[k]), static_cast<int>(k), "Monitor " + std::to_string(k + 1) });
+        bases.push_back({ static_cast<int>(k), rects[k], static_cast<int>(k), { 0, 0, 0 } });
+        baseKeys.push_back(static_cast<int>(k));
+    }
+    const std::vector<Rect> path = DragPath(RectSet::fromRects(rects).bounds(), options.moves);
+
+    SpotlightStressReport report;
+    report.monitors = rects.size();
+
+    // Incremental: what the initiators do on every window event
+    {
+        CountingBackend backend;
+        WindowPool pool(backend, {});
+        Spotlight spotlight;
+        pool.sync(spotlight.reset(bases));
+        pool.blank(Spotlight::sideKeys(baseKeys));
+
+        LatencyHistogram times;
+        uint64_t callsBefore = 0;
+        bool first = true;
+        ScriptedWindowEvents events(path);
+        events.start([&](const Rect& rect) {
+            const uint64_t start = MetricsClock();
+            const std::vector<WindowTarget> changed = spotlight.move(rect);
+            if (!changed.empty()) pool.reshape(changed);
+            if (first) {
+                callsBefore = backend.calls();
+                first = false;
+                return;
+            }
+            times.record(MetricsClock() - start);
+            report.changedSides += changed.size();
+        });
+        while (events.step()) {
+        }
+        report.incremental = times.summarize();
+        report.incrementalWindowCalls = backend.calls() - callsBefore;
+        report.moves = report.incremental.count;
+    }
+
+    // Rebuild: what rebuildPool would do with the hole as an -x mask
+    {
+        Topology topology;
+        topology.monitors = monitors;
+        topology.index = SpatialIndex(monitors);
+        CountingBackend backend;
+        WindowPool pool(backend, {});
+        LatencyHistogram times;
+        uint64_t callsBefore = 0;
+        bool first = true;
+        ScriptedWindowEvents events(path);
+        events.start([&](const Rect& rect) {
+            const uint64_t start = MetricsClock();
+            BlankMask mask;
+            mask.exceptions.push_back(rect);
+            pool.sync(BuildLayout(topology, monitors, mask, {}, { 0, 0, 0 }, 100, {}));
+            pool.blankAll();
+            if (first) {
+                callsBefore = backend.calls();
+                first = false;
+                return;
+            }
+            times.record(MetricsClock() - start);
+        });
+        while (events.step()) {
+        }
+        report.rebuild = times.summarize();
+        report.rebuildWindowCalls = backend.calls() - callsBefore;
+    }
+    return report;
+}
+
+std::string FormatSpotlightStressReport(const SpotlightStressReport& report) {
+    char line[256];
+    std::string text = "Spotlight stress: " + std::to_string(report.monitors) + " monitors, " +
+        std::to_string(report.moves) + " window events\n";
+    const double moves = report.moves ? static_cast<double>(report.moves) : 1.0;
+    snprintf(line, sizeof(line), "Incremental: %.2f sides changed and %.2f window calls per event\n",
+        static_cast<double>(report.changedSides) / moves, static_cast<double>(report.incrementalWindowCalls) / moves);
+    text += line;
+    text += "  " + Percentiles(report.incremental) + "\n";
+    snprintf(line, sizeof(line), "Rebuild (-x mask per event): %.2f window calls per event\n",
+        static_cast<double>(report.rebuildWindowCalls) / moves);
+    text += line;
+    text += "  " + Percentiles(report.rebuild) + "\n";
+    return text;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef SPOTLIGHT_HPP
+#define SPOTLIGHT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Metrics.hpp"
+#include "RectSet.hpp"
+#include "WindowBackend.hpp"
+
+// --spotlight: blank everything but one application window and follow it
+struct SpotlightOptions {
+    bool enabled = false;
+    std::string title;      // first visible top-level window containing this; empty for the foreground one
+};
+
+// Splits every window of a layout into the four sides around a hole, the
+// tracked window's rect. Side k of base b is keyed b.key * kSides + k, so a
+// move keeps every key and the pool only moves windows. A side the hole
+// leaves no room for has an empty rect.
+class Spotlight {
+public:
+    static constexpr int kSides = 4;    // above, left, right, below
+
+    // Adopts a new layout, split around the current hole
+    std::vector<WindowTarget> reset(const std::vector<WindowTarget>& bases);
+    // The side keys of the given base keys
+    static std::vector<int> sideKeys(const std::vector<int>& baseKeys);
+
+    // Moves the hole and returns only the sides whose rect changed. Bases the
+    // changed pixels (old hole minus new, new minus old) miss are not visited.
+    std::vector<WindowTarget> move(const Rect& hole);
+
+    const Rect& hole() const { return m_hole; }
+
+private:
+    static std::array<Rect, kSides> split(const Rect& base, const Rect& hole);
+
+    std::vector<WindowTarget> m_bases;
+    std::vector<WindowTarget> m_sides;  // kSides per base, in base order
+    Rect m_hole;
+};
+
+// Reports the tracked window's desktop rect: once on start, then after every
+// move, resize, minimize, hide or show. The rect is empty while the window is
+// minimized, hidden or gone. Listeners are called on the UI thread.
+class WindowEventSource {
+public:
+    using Listener = std::function<void(const Rect& rect)>;
+
+    virtual ~WindowEventSource() = default;
+
+    virtual bool start(Listener listener) = 0;
+    virtual void stop() = 0;
+};
+
+// Replays a fixed path, one rect per step(); the stand-in for the window
+// event hooks in --stress-spotlight
+class ScriptedWindowEvents : public WindowEventSource {
+public:
+    explicit ScriptedWindowEvents(std::vector<Rect> path) : m_path(std::move(path)) {}
+
+    bool start(Listener listener) override;
+    void stop() override { m_listener = {}; }
+
+    // Reports the next rect; false once the path is used up
+    bool step();
+
+private:
+    std::vector<Rect> m_path;
+    size_t m_next = 0;
+    Listener m_listener;
+};
+
+// --stress-spotlight: a jittery drag of a tracked window across the monitors
+struct SpotlightStressOptions {
+    size_t moves = 100'000;
+    std::vector<Rect> monitors;     // empty for four 1080p ones side by side
+};
+
+struct SpotlightStressReport {
+    size_t monitors = 0;
+    uint64_t moves = 0;
+    // Per move: Spotlight::move plus WindowPool::reshape
+    LatencyHistogram::Summary incremental;
+    uint64_t incrementalWindowCalls = 0;    // backend creates, destroys, moves, shows and hides
+    uint64_t changedSides = 0;
+    // Per move: the -x mask rebuilt around the hole and synced into the pool
+    LatencyHistogram::Summary rebuild;
+    uint64_t rebuildWindowCalls = 0;
+};
+
+// Drives a blanked pool of in-memory windows from ScriptedWindowEvents, once
+// incrementally and once by rebuilding the layout. Runs anywhere; nothing
+// touches a display.
+SpotlightStressReport RunSpotlightStress(const SpotlightStressOptions& options);
+
+std::string FormatSpotlightStressReport(const SpotlightStressReport& report);
+
+#endif // SPOTLIGHT_HPP
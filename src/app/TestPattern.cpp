@@ -0,0 +1,180 @@
+#include "TestPattern.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if !defined(BLACKSCREEN_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PATTERN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    constexpr uint32_t kWhite = 0xFFFFFF;
+    constexpr uint32_t kBlack = 0x000000;
+
+    constexpr std::array<std::tuple<int, int, int>, 6> kSolidCycleColors = { {
+        { 255, 255, 255 }, { 255, 0, 0 }, { 0, 255, 0 }, { 0, 0, 255 }, { 128, 128, 128 }, { 0, 0, 0 }
+    } };
+
+    void FillRow(uint32_t* out, long count, uint32_t color, [[maybe_unused]] bool simd) {
+        long x = 0;
+#ifdef PATTERN_SSE2
+        const __m128i value = _mm_set1_epi32(static_cast<int>(color));
+        for (; simd && x + 4 <= count; x += 4) _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), value);
+#endif
+        for (; x < count; ++x) out[x] = color;
+    }
+
+    // Gray level x * 255 / (width - 1), rounded, in 16.16 fixed point
+    void GradientRow(uint32_t* out, long width, [[maybe_unused]] bool simd) {
+        const uint32_t step = width > 1 ? static_cast<uint32_t>((255u << 16) / static_cast<uint32_t>(width - 1)) : 0;
+        long x = 0;
+#ifdef PATTERN_SSE2
+        // Four levels at once, stepped by addition since SSE2 has no 32-bit multiply
+        __m128i level = _mm_set_epi32(static_cast<int>(step * 3 + (1u << 15)), static_cast<int>(step * 2 + (1u << 15)),
+            static_cast<int>(step + (1u << 15)), static_cast<int>(1u << 15));
+        const __m128i advance = _mm_set1_epi32(static_cast<int>(step * 4));
+        for (; simd && x + 4 <= width; x += 4) {
+            const __m128i gray = _mm_srli_epi32(level, 16);
+            const __m128i pixel = _mm_or_si128(gray, _mm_or_si128(_mm_slli_epi32(gray, 8), _mm_slli_epi32(gray, 16)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), pixel);
+            level = _mm_add_epi32(level, advance);
+        }
+#endif
+        for (; x < width; ++x) {
+            const uint32_t gray = (static_cast<uint32_t>(x) * step + (1u << 15)) >> 16;
+            out[x] = gray * 0x010101;
+        }
+    }
+
+    // kRampSteps runs of constant level, scaled into one channel (or all three for gray)
+    void RampRow(uint32_t* out, long width, uint32_t channels, bool simd) {
+        for (long s = 0; s < kRampSteps; ++s) {
+            const long start = width * s / kRampSteps;
+            const long end = width * (s + 1) / kRampSteps;
+            const uint32_t level = static_cast<uint32_t>(s * 255 / (kRampSteps - 1));
+            FillRow(out + start, end - start, (level * 0x010101) & channels, simd);
+        }
+    }
+
+    // The bulk of the work: streaming stores keep a 4K/8K bitmap from
+    // evicting everything else on its way to memory
+    void CopyRow(uint32_t* out, const uint32_t* row, long count, [[maybe_unused]] bool simd) {
+#ifdef PATTERN_SSE2
+        if (!simd) {
+            std::memcpy(out, row, static_cast<size_t>(count) * sizeof(uint32_t));
+            return;
+        }
+        long x = 0;
+        for (; x < count && (reinterpret_cast<uintptr_t>(out + x) & 15) != 0; ++x) out[x] = row[x];
+        for (; x + 16 <= count; x += 16) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 4));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 8));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 12));
+            _mm_stream_si128(reinterpret_cast<__m128i*>(out + x), a);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(out + x + 4), b);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(out + x + 8), c);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(out + x + 12), d);
+        }
+        for (; x < count; ++x) out[x] = row[x];
+#else
+        std::memcpy(out, row, static_cast<size_t>(count) * sizeof(uint32_t));
+#endif
+    }
+}
+
+bool ParseTestPattern(std::string_view name, TestPattern& pattern) {
+    if (name == "grid") pattern = TestPattern::Grid;
+    else if (name == "checker") pattern = TestPattern::Checker;
+    else if (name == "gradient") pattern = TestPattern::Gradient;
+    else if (name == "ramp") pattern = TestPattern::Ramp;
+    else if (name == "solid-cycle") pattern = TestPattern::SolidCycle;
+    else return false;
+    return true;
+}
+
+std::tuple<int, int, int> SolidCycleColor(std::time_t now) {
+    return kSolidCycleColors[static_cast<size_t>(now / kSolidCycleSeconds) % kSolidCycleColors.size()];
+}
+
+void GeneratePattern(TestPattern pattern, long width, long height, uint32_t* out, bool simd) {
+    if (width <= 0 || height <= 0) return;
+
+    // The distinct rows, and which one each output row copies
+    std::vector<uint32_t> rows;
+    auto row = [&rows, width](size_t kind) { return rows.data() + kind * static_cast<size_t>(width); };
+    size_t (*kindOf)(long y, long height) = nullptr;
+
+    switch (pattern) {
+        case TestPattern::Grid:
+            rows.resize(2 * static_cast<size_t>(width));
+            FillRow(row(0), width, kWhite, simd);
+            FillRow(row(1), width, kBlack, simd);
+            for (long x = 0; x < width; x += kPatternCell) row(1)[x] = kWhite;
+            row(1)[width - 1] = kWhite;
+            kindOf = [](long y, long height) -> size_t { return y % kPatternCell == 0 || y == height - 1 ? 0 : 1; };
+            break;
+        case TestPattern::Checker:
+            rows.resize(2 * static_cast<size_t>(width));
+            for (long x = 0; x < width; x += kPatternCell) {
+                const long run = (std::min)(kPatternCell, width - x);
+                const bool white = (x / kPatternCell) % 2 == 0;
+                FillRow(row(0) + x, run, white ? kWhite : kBlack, simd);
+                FillRow(row(1) + x, run, white ? kBlack : kWhite, simd);
+            }
+            kindOf = [](long y, long) -> size_t { return static_cast<size_t>((y / kPatternCell) % 2); };
+            break;
+        case TestPattern::Gradient:
+            rows.resize(static_cast<size_t>(width));
+            GradientRow(row(0), width, simd);
+            kindOf = [](long, long) -> size_t { return 0; };
+            break;
+        case TestPattern::Ramp:
+            rows.resize(4 * static_cast<size_t>(width));
+            RampRow(row(0), width, 0xFFFFFF, simd);
+            RampRow(row(1), width, 0xFF0000, simd);
+            RampRow(row(2), width, 0x00FF00, simd);
+            RampRow(row(3), width, 0x0000FF, simd);
+            kindOf = [](long y, long height) -> size_t { return static_cast<size_t>(y * 4 / height); };
+            break;
+        case TestPattern::Off:
+        case TestPattern::SolidCycle:
+            FillRow(out, width * height, kBlack, simd);
+            return;
+    }
+
+    for (long y = 0; y < height; ++y) {
+        CopyRow(out + static_cast<size_t>(y) * width, row(kindOf(y, height)), width, simd);
+    }
+#ifdef PATTERN_SSE2
+    if (simd) _mm_sfence();
+#endif
+}
+
+void PatternCache::prepare(TestPattern pattern, long width, long height) {
+    if (pattern == TestPattern::Off || pattern == TestPattern::SolidCycle || width <= 0 || height <= 0 ||
+        find(pattern, width, height)) {
+        return;
+    }
+    auto backdrop = std::make_unique<Backdrop>();
+    backdrop->width = width;
+    backdrop->height = height;
+    backdrop->pixels.resize(static_cast<size_t>(width) * height);
+    GeneratePattern(pattern, width, height, backdrop->pixels.data());
+    m_patterns.emplace_back(pattern, std::move(backdrop));
+}
+
+const Backdrop* PatternCache::find(TestPattern pattern, long width, long height) const {
+    for (const auto& [cached, backdrop] : m_patterns) {
+        if (cached == pattern && backdrop->width == width && backdrop->height == height) return backdrop.get();
+    }
+    return nullptr;
+}
+
+size_t PatternCache::bytes() const {
+    size_t total = 0;
+    for (const auto& [pattern, backdrop] : m_patterns) total += backdrop->pixels.size() * sizeof(uint32_t);
+    return total;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef TESTPATTERN_HPP
+#define TESTPATTERN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "ImageBackdrop.hpp"
+
+// Calibration patterns for --pattern. SolidCycle has no bitmap: the window
+// color steps through white, red, green, blue, gray and black instead.
+enum class TestPattern { Off, Grid, Checker, Gradient, Ramp, SolidCycle };
+
+bool ParseTestPattern(std::string_view name, TestPattern& pattern);
+
+// Grid lines and checker squares are this many pixels apart
+constexpr long kPatternCell = 64;
+constexpr long kRampSteps = 32;
+constexpr int kSolidCycleSeconds = 3;
+
+// Color a solid-cycle window shows at time now; all windows step together
+std::tuple<int, int, int> SolidCycleColor(std::time_t now);
+
+// Writes width x height top-down 0x00RRGGBB pixels:
+//   grid      white 1px lines every kPatternCell on black, closed at the right/bottom edge
+//   checker   kPatternCell squares, white at the top-left
+//   gradient  black to white, left to right
+//   ramp      gray, red, green and blue bands of kRampSteps steps each
+// Every pattern repeats a few distinct rows, so those are built once (SSE2
+// when available) and copied down with cache-bypassing stores. simd false
+// keeps to scalar loops and plain copies, which write the same pixels.
+void GeneratePattern(TestPattern pattern, long width, long height, uint32_t* out, bool simd = true);
+
+// One bitmap per pattern and window size, generated on first prepare()
+class PatternCache {
+public:
+    void prepare(TestPattern pattern, long width, long height);
+    const Backdrop* find(TestPattern pattern, long width, long height) const;
+    size_t bytes() const;
+
+private:
+    std::vector<std::pair<TestPattern, std::unique_ptr<Backdrop>>> m_patterns;
+};
+
+#endif // TESTPATTERN_HPP
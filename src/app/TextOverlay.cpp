@@ -0,0 +1,244 @@
+#include "TextOverlay.hpp"
+
+#include <algorithm>
+
+namespace {
+    uint32_t Pack(const std::tuple<int, int, int>& color) {
+        const auto [red, green, blue] = color;
+        return (static_cast<uint32_t>(red & 0xFF) << 16) | (static_cast<uint32_t>(green & 0xFF) << 8) |
+            static_cast<uint32_t>(blue & 0xFF);
+    }
+
+    // dst + (src - dst) * alpha, per 8-bit channel
+    uint32_t Blend(uint32_t dst, uint32_t src, uint32_t alpha) {
+        uint32_t result = 0;
+        for (int shift = 0; shift <= 16; shift += 8) {
+            const int d = static_cast<int>((dst >> shift) & 0xFF);
+            const int s = static_cast<int>((src >> shift) & 0xFF);
+            const int c = d + ((s - d) * static_cast<int>(alpha) + (s >= d ? 127 : -127)) / 255;
+            result |= static_cast<uint32_t>(c) << shift;
+        }
+        return result;
+    }
+
+    Rect Intersect(const Rect& a, const Rect& b) {
+        return { (std::max)(a.left, b.left), (std::max)(a.top, b.top),
+                 (std::min)(a.right, b.right), (std::min)(a.bottom, b.bottom) };
+    }
+
+    bool IsDigit(char32_t codePoint) {
+        return codePoint >= U'0' && codePoint <= U'9';
+    }
+}
+
+GlyphAtlas::GlyphAtlas(GlyphRasterizer& rasterizer, int pixelHeight)
+    : m_rasterizer(rasterizer), m_pixelHeight(pixelHeight) {
+}
+
+const Glyph& GlyphAtlas::glyph(char32_t codePoint) {
+    if (auto it = m_glyphs.find(codePoint); it != m_glyphs.end()) return it->second;
+
+    Glyph result;
+    std::vector<uint8_t> coverage;
+    if (m_rasterizer.rasterize(codePoint, m_pixelHeight, result, coverage) &&
+        coverage.size() == static_cast<size_t>(result.width) * static_cast<size_t>(result.height)) {
+        result.offset = m_coverage.size();
+        m_coverage.insert(m_coverage.end(), coverage.begin(), coverage.end());
+    }
+    else if (codePoint != U'?') {
+        result = glyph(U'?');
+    }
+    else {
+        result = { .advance = m_pixelHeight / 2 };
+    }
+    return m_glyphs.emplace(codePoint, result).first->second;
+}
+
+int GlyphAtlas::digitAdvance() {
+    if (m_digitAdvance < 0) {
+        m_digitAdvance = 0;
+        for (char32_t digit = U'0'; digit <= U'9'; ++digit) {
+            m_digitAdvance = (std::max)(m_digitAdvance, glyph(digit).advance);
+        }
+    }
+    return m_digitAdvance;
+}
+
+GlyphAtlas& GlyphAtlasCache::atlasFor(int pointSize, int dpi) {
+    auto& atlas = m_atlases[{ pointSize, dpi }];
+    if (!atlas) {
+        atlas = std::make_unique<GlyphAtlas>(m_rasterizer, (std::max)(1, pointSize * dpi / 72));
+    }
+    return *atlas;
+}
+
+std::vector<std::string> OverlayOptions::lines(std::time_t now) const {
+    std::vector<std::string> result;
+    if (!text.empty()) {
+        // A literal "\n" breaks the line too, since shells make real newlines awkward
+        std::string line;
+        for (size_t k = 0; k < text.size(); ++k) {
+            if (text[k] == '\n' || (text[k] == '\\' && k + 1 < text.size() && text[k + 1] == 'n')) {
+                result.push_back(std::move(line));
+                line.clear();
+                if (text[k] == '\\') ++k;
+            }
+            else {
+                line += text[k];
+            }
+        }
+        result.push_back(std::move(line));
+    }
+    if (!clockFormat.empty()) {
+        result.push_back(FormatClock(clockFormat, now));
+    }
+    return result;
+}
+
+TextOverlay::TextOverlay(GlyphAtlas& atlas, const std::tuple<int, int, int>& foreground, const std::tuple<int, int, int>& background)
+    : m_atlas(atlas), m_foreground(Pack(foreground)), m_background(Pack(background)) {
+}
+
+std::vector<Rect> TextOverlay::update(const std::vector<std::string>& lines) {
+    std::vector<std::u32string> decoded;
+    for (const std::string& line : lines) decoded.push_back(DecodeUtf8(line));
+
+    long width = 0, height = 0;
+    std::vector<Cell> cells = layout(decoded, width, height);
+
+    // Same cells in the same places: only the changed characters need composing
+    const bool sameLayout = width == m_width && height == m_height && cells.size() == m_cells.size() &&
+        std::ranges::equal(cells, m_cells, [](const Cell& a, const Cell& b) {
+            return a.penX == b.penX && a.lineTop == b.lineTop && a.cellWidth == b.cellWidth;
+        });
+
+    m_resized = !sameLayout;
+    if (!sameLayout) {
+        m_cells = std::move(cells);
+        m_width = width;
+        m_height = height;
+        m_pixels.assign(static_cast<size_t>(width) * static_cast<size_t>(height), m_background);
+        const Rect all = { 0, 0, width, height };
+        compose(all);
+        return { all };
+    }
+
+    std::vector<Rect> dirty;
+    for (size_t k = 0; k < cells.size(); ++k) {
+        if (cells[k].codePoint == m_cells[k].codePoint) continue;
+        // The old ink has to go as well as the new ink going in
+        dirty.push_back(m_cells[k].bounds);
+        dirty.push_back(cells[k].bounds);
+    }
+    m_cells = std::move(cells);
+    if (dirty.empty()) return {};
+
+    std::vector<Rect> changed = RectSet::fromRects(dirty).coveringRects();
+    for (const Rect& area : changed) compose(area);
+    return changed;
+}
+
+std::vector<TextOverlay::Cell> TextOverlay::layout(const std::vector<std::u32string>& lines, long& width, long& height) {
+    const long lineHeight = m_atlas.pixelHeight();
+    const long padding = lineHeight / 4;
+
+    std::vector<long> lineWidths;
+    long widest = 0;
+    for (const std::u32string& line : lines) {
+        long lineWidth = 0;
+        for (char32_t codePoint : line) {
+            lineWidth += IsDigit(codePoint) ? m_atlas.digitAdvance() : m_atlas.glyph(codePoint).advance;
+        }
+        lineWidths.push_back(lineWidth);
+        widest = (std::max)(widest, lineWidth);
+    }
+    width = widest + 2 * padding;
+    height = static_cast<long>(lines.size()) * lineHeight + 2 * padding;
+
+    std::vector<Cell> cells;
+    const Rect buffer = { 0, 0, width, height };
+    for (size_t l = 0; l < lines.size(); ++l) {
+        const long lineTop = padding + static_cast<long>(l) * lineHeight;
+        long penX = padding + (widest - lineWidths[l]) / 2;
+        for (char32_t codePoint : lines[l]) {
+            const Glyph& g = m_atlas.glyph(codePoint);
+            const long cellWidth = IsDigit(codePoint) ? m_atlas.digitAdvance() : g.advance;
+            const long inkLeft = penX + (cellWidth - g.advance) / 2 + g.left;
+            const Rect bounds = {
+                (std::min)(penX, inkLeft), (std::min)(lineTop, lineTop + g.top),
+                (std::max)(penX + cellWidth, inkLeft + g.width), (std::max)(lineTop + lineHeight, lineTop + g.top + g.height)
+            };
+            cells.push_back({ codePoint, penX, lineTop, cellWidth, Intersect(bounds, buffer) });
+            penX += cellWidth;
+        }
+    }
+    return cells;
+}
+
+void TextOverlay::compose(const Rect& area) {
+    for (long y = area.top; y < area.bottom; ++y) {
+        std::fill_n(m_pixels.begin() + y * m_width + area.left, area.width(), m_background);
+    }
+    // Neighbouring ink may reach into the area, so every overlapping cell is drawn, clipped to it
+    for (const Cell& cell : m_cells) {
+        const Rect clip = Intersect(cell.bounds, area);
+        if (!clip.empty()) drawCell(cell, clip);
+    }
+}
+
+void TextOverlay::drawCell(const Cell& cell, const Rect& clip) {
+    const Glyph& g = m_atlas.glyph(cell.codePoint);
+    if (g.width == 0 || g.height == 0) return;
+
+    const long inkLeft = cell.penX + (cell.cellWidth - g.advance) / 2 + g.left;
+    const long inkTop = cell.lineTop + g.top;
+    const Rect ink = Intersect({ inkLeft, inkTop, inkLeft + g.width, inkTop + g.height }, clip);
+    if (ink.empty()) return;
+
+    const uint8_t* coverage = m_atlas.coverage(g);
+    for (long y = ink.top; y < ink.bottom; ++y) {
+        const uint8_t* row = coverage + (y - inkTop) * g.width;
+        uint32_t* out = m_pixels.data() + y * m_width;
+        for (long x = ink.left; x < ink.right; ++x) {
+            if (const uint8_t alpha = row[x - inkLeft]) {
+                out[x] = alpha == 255 ? m_foreground : Blend(out[x], m_foreground, alpha);
+            }
+        }
+    }
+}
+
+std::u32string DecodeUtf8(const std::string& text) {
+    std::u32string result;
+    for (size_t k = 0; k < text.size();) {
+        const auto lead = static_cast<unsigned char>(text[k]);
+        const int length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+        if (length == 0 || k + length > text.size()) {
+            result += U'\uFFFD';
+            ++k;
+            continue;
+        }
+
+        char32_t codePoint = length == 1 ? lead : lead & (0x7F >> length);
+        bool valid = true;
+        for (int n = 1; n < length; ++n) {
+            const auto next = static_cast<unsigned char>(text[k + n]);
+            valid = valid && (next & 0xC0) == 0x80;
+            codePoint = (codePoint << 6) | (next & 0x3F);
+        }
+        result += valid ? codePoint : U'\uFFFD';
+        k += valid ? length : 1;
+    }
+    return result;
+}
+
+std::string FormatClock(const std::string& format, std::time_t time) {
+    std::tm local = {};
+#ifdef _WIN32
+    localtime_s(&local, &time);
+#else
+    localtime_r(&time, &local);
+#endif
+    char buffer[256];
+    const size_t length = std::strftime(buffer, sizeof(buffer), format.c_str(), &local);
+    return std::string(buffer, length);
+}
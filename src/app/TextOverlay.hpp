@@ -0,0 +1,129 @@
+#pragma once
+#ifndef TEXTOVERLAY_HPP
+#define TEXTOVERLAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "RectSet.hpp"
+
+// One rasterized glyph. Coverage is width*height bytes (0-255, rows top-down)
+// stored in the atlas at offset; left/top place it relative to the pen
+// position and the top of the line.
+struct Glyph {
+    int width = 0;
+    int height = 0;
+    int left = 0;
+    int top = 0;
+    int advance = 0;
+    size_t offset = 0;
+};
+
+// Platform font hook (GDI on Windows, core fonts on X11)
+class GlyphRasterizer {
+public:
+    virtual ~GlyphRasterizer() = default;
+
+    // Fills glyph metrics and its coverage for a line pixelHeight tall;
+    // false if the font has no such glyph
+    virtual bool rasterize(char32_t codePoint, int pixelHeight, Glyph& glyph, std::vector<uint8_t>& coverage) = 0;
+};
+
+// Coverage of every glyph used so far at one pixel height. Each glyph is
+// rasterized once, on first use, and appended to a single coverage store.
+class GlyphAtlas {
+public:
+    GlyphAtlas(GlyphRasterizer& rasterizer, int pixelHeight);
+
+    // Missing glyphs fall back to '?', then to an empty cell
+    const Glyph& glyph(char32_t codePoint);
+    const uint8_t* coverage(const Glyph& glyph) const { return m_coverage.data() + glyph.offset; }
+    int pixelHeight() const { return m_pixelHeight; }
+    // Widest of 0-9, so clock digits keep fixed cells as they change
+    int digitAdvance();
+
+private:
+    GlyphRasterizer& m_rasterizer;
+    int m_pixelHeight;
+    int m_digitAdvance = -1;
+    std::unordered_map<char32_t, Glyph> m_glyphs;
+    std::vector<uint8_t> m_coverage;
+};
+
+// Atlases per point size and DPI, shared by every window on such a monitor
+class GlyphAtlasCache {
+public:
+    explicit GlyphAtlasCache(GlyphRasterizer& rasterizer) : m_rasterizer(rasterizer) {}
+
+    GlyphAtlas& atlasFor(int pointSize, int dpi);
+
+private:
+    GlyphRasterizer& m_rasterizer;
+    std::map<std::pair<int, int>, std::unique_ptr<GlyphAtlas>> m_atlases;
+};
+
+// --text / --clock: a message and/or a clock centred on each blanking window
+struct OverlayOptions {
+    std::string text;                               // UTF-8, '\n' separates lines
+    std::string clockFormat;                        // strftime format, empty for no clock
+    std::tuple<int, int, int> color = { 96, 96, 96 };
+    int pointSize = 24;
+
+    bool enabled() const { return !text.empty() || !clockFormat.empty(); }
+    // The text lines followed by the clock formatted for now
+    std::vector<std::string> lines(std::time_t now) const;
+};
+
+// A centred block of text composed into a small BGRA back buffer over a
+// solid background. Every character owns a cell; an update recomposes only
+// the cells whose character changed and reports their rects, so a ticking
+// clock redraws a digit or two instead of the whole block.
+class TextOverlay {
+public:
+    TextOverlay(GlyphAtlas& atlas, const std::tuple<int, int, int>& foreground, const std::tuple<int, int, int>& background);
+
+    // Returns the buffer rects that changed; the whole buffer when the block
+    // was laid out again (see resized())
+    std::vector<Rect> update(const std::vector<std::string>& lines);
+
+    bool resized() const { return m_resized; }
+    long width() const { return m_width; }
+    long height() const { return m_height; }
+    // Top-down rows of width() pixels, 0x00RRGGBB
+    const uint32_t* pixels() const { return m_pixels.data(); }
+
+private:
+    struct Cell {
+        char32_t codePoint;
+        long penX;
+        long lineTop;
+        long cellWidth;     // fixed digit width or the glyph advance
+        Rect bounds;        // advance box united with the ink, clipped to the buffer
+    };
+
+    std::vector<Cell> layout(const std::vector<std::u32string>& lines, long& width, long& height);
+    void compose(const Rect& area);
+    void drawCell(const Cell& cell, const Rect& clip);
+
+    GlyphAtlas& m_atlas;
+    uint32_t m_foreground;
+    uint32_t m_background;
+    std::vector<Cell> m_cells;
+    std::vector<uint32_t> m_pixels;
+    long m_width = 0;
+    long m_height = 0;
+    bool m_resized = false;
+};
+
+std::u32string DecodeUtf8(const std::string& text);
+std::string FormatClock(const std::string& format, std::time_t time);
+
+#endif // TEXTOVERLAY_HPP
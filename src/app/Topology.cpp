@@ -0,0 +1,83 @@
+#include "Topology.hpp"
+
+#include "FlightRecorder.hpp"
+#include "Metrics.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+    SnapshotPublisher<Topology> g_topology;
+    std::atomic<uint64_t> g_generation{ 0 };
+
+    std::mutex g_refreshMutex;
+    std::condition_variable g_refreshWake;
+    std::thread g_refresher;
+    bool g_refreshPending = false;
+    bool g_refresherStopping = false;
+}
+
+TopologySnapshot TopologyStore::current() {
+    return g_topology.acquire();
+}
+
+void TopologyStore::publish(std::vector<MonitorData> monitors) {
+    auto topology = std::make_unique<Topology>();
+    topology->index = SpatialIndex(monitors);
+    topology->monitors = std::move(monitors);
+    topology->generation = ++g_generation;
+    if (topology->generation > 1) {
+        g_metrics.topologyChanges.fetch_add(1, std::memory_order_relaxed);
+    }
+    g_topology.publish(std::move(topology));
+}
+
+void TopologyStore::refresh() {
+    const uint64_t start = MetricsClock();
+    std::vector<MonitorData> monitors = EnumerateMonitorsWithNames();
+    const uint64_t elapsed = MetricsClock() - start;
+    g_metrics.enumerations.fetch_add(1, std::memory_order_relaxed);
+    g_metrics.enumerationTime.record(elapsed);
+    g_flightRecorder.record(FlightEvent::Enumeration, monitors.size(), elapsed);
+    publish(std::move(monitors));
+}
+
+void TopologyStore::startRefresher(std::function<void()> onPublished) {
+    std::lock_guard lock(g_refreshMutex);
+    if (g_refresher.joinable()) return;
+
+    g_refresherStopping = false;
+    g_refresher = std::thread([onPublished = std::move(onPublished)] {
+        std::unique_lock lock(g_refreshMutex);
+        for (;;) {
+            g_refreshWake.wait(lock, [] { return g_refreshPending || g_refresherStopping; });
+            if (g_refresherStopping) return;
+            g_refreshPending = false;
+
+            // Enumerate without the lock so new requests queue up as a single follow-up refresh
+            lock.unlock();
+            refresh();
+            if (onPublished) onPublished();
+            lock.lock();
+        }
+    });
+}
+
+void TopologyStore::requestRefresh() {
+    {
+        std::lock_guard lock(g_refreshMutex);
+        g_refreshPending = true;
+    }
+    g_refreshWake.notify_one();
+}
+
+void TopologyStore::stopRefresher() {
+    {
+        std::lock_guard lock(g_refreshMutex);
+        if (!g_refresher.joinable()) return;
+        g_refresherStopping = true;
+    }
+    g_refreshWake.notify_one();
+    g_refresher.join();
+}
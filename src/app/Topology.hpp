@@ -0,0 +1,42 @@
+#pragma once
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "MonitorDetection.hpp"
+#include "MonitorSelector.hpp"
+#include "SnapshotPublisher.hpp"
+
+// Immutable view of the display layout. A new Topology is built for every
+// change and never modified after it is published.
+struct Topology {
+    std::vector<MonitorData> monitors;
+    SpatialIndex index;
+    uint64_t generation = 0;
+};
+
+using TopologySnapshot = SnapshotPublisher<Topology>::Snapshot;
+
+// Owner of the current Topology. Readers (window procedure, listing,
+// selection) call current() from any thread without blocking; refreshes run
+// on a background thread and swap in a complete new snapshot.
+class TopologyStore {
+public:
+    static TopologySnapshot current();
+
+    // Builds the index and publishes monitors as the next generation
+    static void publish(std::vector<MonitorData> monitors);
+    // Enumerates synchronously on the calling thread and publishes the result
+    static void refresh();
+
+    // onPublished runs on the refresher thread after each new snapshot
+    static void startRefresher(std::function<void()> onPublished = {});
+    // Wakes the refresher; requests arriving during a rebuild are coalesced
+    static void requestRefresh();
+    static void stopRefresher();
+};
+
+#endif // TOPOLOGY_HPP
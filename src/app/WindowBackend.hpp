@@ -0,0 +1,46 @@
+#pragma once
+#ifndef WINDOWBACKEND_HPP
+#define WINDOWBACKEND_HPP
+
+#include <tuple>
+#include <vector>
+
+#include "RectSet.hpp"
+#include "TestPattern.hpp"
+
+// One blanking window the layout asks for. key identifies it across
+// topology changes (the monitor index, or the mask rect ordinal); monitor is
+// the table position it sits on, -1 if none. Color and opacity are resolved
+// from the -c/-o defaults and -s styles by the layout, the pattern from --pattern.
+struct WindowTarget {
+    int key;
+    Rect rect;
+    int monitor;
+    std::tuple<int, int, int> color;
+    int opacity = 100;      // percent
+    TestPattern pattern = TestPattern::Off;
+};
+
+// Window operations used by the pool, kept abstract so the pool logic does not
+// depend on Win32. Handles are opaque to callers.
+class WindowBackend {
+public:
+    using Handle = void*;
+
+    virtual ~WindowBackend() = default;
+
+    // Creates a hidden window already sized and colored for target; nullptr on failure
+    virtual Handle create(const WindowTarget& target) = 0;
+    virtual void destroy(Handle window) = 0;
+    virtual void move(Handle window, const Rect& rect) = 0;
+    virtual void show(Handle window) = 0;
+    virtual void hide(Handle window) = 0;
+
+    // Shows a batch of windows that should turn black together. The default
+    // shows them in order; backends that can batch the visibility change do.
+    virtual void reveal(const std::vector<Handle>& windows) {
+        for (Handle window : windows) show(window);
+    }
+};
+
+#endif // WINDOWBACKEND_HPP
@@ -5,39 +5,65 @@
 #include "WindowInitiator.hpp"
 
 #include <algorithm>
-#include <regex>
 #include <utility>
 #include <ranges>
 #include <algorithm>
 #include <iostream>
 #include <iterator>
+#include <chrono>
+#include <ctime>
+#include <shellscalingapi.h>
+#include <dwmapi.h>
 
 
-#include "ColorHandler.hpp"
+#include "FleetServer.hpp"
+#include "FlightRecorder.hpp"
+#include "Metrics.hpp"
+#include "Renderer.hpp"
+#include "TextOverlay.hpp"
+#include "Topology.hpp"
+#include "WindowInput.hpp"
+#include "WindowPool.hpp"
 
 LRESULT CALLBACK HandleWindowMessages(HWND windowHandle, UINT messageType, WPARAM windowParameterValue, LPARAM messageData);
 
 std::vector<HWND> g_windowHandles;
-std::vector<DISPLAY_DEVICEW> g_devices;
-std::vector<MonitorData> g_monitors;
 
-std::string WindowInitiator::m_color = "black";
-bool WindowInitiator::disableKeyExit = false;
+// When the current unblank was requested (key press/close), 0 if none; UI thread only
+static uint64_t g_unblankRequestedAt = 0;
 
+extern std::string ToLower(const std::string& str);
 
-WindowInitiator::WindowInitiator(std::string color, const bool& disableKeyExit,
-    std::vector<int> monitorIndices,
-    std::vector<std::string> monitorPatterns)
-    : m_monitorIndices(std::move(monitorIndices)),
-    m_monitorPatterns(std::move(monitorPatterns))
+WindowInitiator::WindowInitiator(InitiatorOptions options)
+    : m_color(options.color),
+    m_opacity(options.opacity),
+    m_disableKeyExit(options.disableKeyExit),
+    m_monitorIndices(std::move(options.monitorIndices)),
+    m_monitorPatterns(std::move(options.monitorPatterns)),
+    m_monitorQueries(std::move(options.monitorQueries)),
+    m_mask(std::move(options.mask)),
+    m_styles(std::move(options.styles)),
+    m_resident(std::move(options.resident)),
+    m_overlay(std::move(options.overlay)),
+    m_image(std::move(options.image)),
+    m_patterns(std::move(options.patterns)),
+    m_spotlight(std::move(options.spotlight)),
+    m_solidCycle(std::ranges::any_of(m_patterns, [](const MonitorPattern& pattern) {
+        return pattern.pattern == TestPattern::SolidCycle;
+    }))
     {
-    WindowInitiator::disableKeyExit = disableKeyExit;
+}
 
-    std::ranges::transform(color, color.begin(),
-        [](const unsigned char stringCharacter) { return std::tolower(stringCharacter); });
+HBRUSH WindowInitiator::brushFor(const std::tuple<int, int, int>& color) {
+    const auto [red, green, blue] = color;
+    const COLORREF rgb = RGB(red, green, blue);
+    for (const auto& [cached, brush] : m_brushes) {
+        if (cached == rgb) return brush;
+    }
 
-    m_color = color == "black" ? std::move(color) :
-        ColorHandler::colorMap.contains(color) ? ColorHandler::colorMap[color] : std::move(color);
+    HBRUSH brush = rgb == RGB(0, 0, 0) ? static_cast<HBRUSH>(GetStockObject(BLACK_BRUSH)) : CreateSolidBrush(rgb);
+    m_brushes.emplace_back(rgb, brush);
+    return brush;
 }
 
 
@@ -46,164 +72,571 @@ WindowInitiator::WindowInitiator(std::string color, const bool& disableKeyExit,
 
 
 
-// Structure to store monitor info with adapter/target IDs
-struct ExtendedMonitorInfo {
-    HMONITOR hMonitor;
-    RECT rect;
-    int index;
-    std::string name;
-    LUID adapterId;
-    UINT32 targetId;
+// Glyph coverage from GetGlyphOutline, one anti-aliased font per pixel height
+class WindowInitiator::GdiRasterizer : public GlyphRasterizer {
+public:
+    GdiRasterizer() : m_dc(CreateCompatibleDC(nullptr)) {}
+    ~GdiRasterizer() override {
+        for (const auto& [height, font] : m_fonts) DeleteObject(font);
+        DeleteDC(m_dc);
+    }
+
+    bool rasterize(char32_t codePoint, int pixelHeight, Glyph& glyph, std::vector<uint8_t>& coverage) override {
+        if (codePoint > 0xFFFF) return false;   // GetGlyphOutlineW takes a single UTF-16 unit
+
+        SelectObject(m_dc, fontFor(pixelHeight));
+        TEXTMETRICW metrics;
+        GetTextMetricsW(m_dc, &metrics);
+
+        const MAT2 identity = { { 0, 1 }, { 0, 0 }, { 0, 0 }, { 0, 1 } };
+        GLYPHMETRICS glyphMetrics = {};
+        const DWORD size = GetGlyphOutlineW(m_dc, static_cast<UINT>(codePoint), GGO_GRAY8_BITMAP, &glyphMetrics, 0, nullptr, &identity);
+        if (size == GDI_ERROR) return false;
+
+        glyph.advance = glyphMetrics.gmCellIncX;
+        glyph.left = glyphMetrics.gmptGlyphOrigin.x;
+        glyph.top = metrics.tmAscent - glyphMetrics.gmptGlyphOrigin.y;
+        coverage.clear();
+        if (size == 0) {
+            // Blank glyphs such as space only advance
+            glyph.width = glyph.height = 0;
+            return true;
+        }
+
+        std::vector<BYTE> bits(size);
+        GetGlyphOutlineW(m_dc, static_cast<UINT>(codePoint), GGO_GRAY8_BITMAP, &glyphMetrics, size, bits.data(), &identity);
+        glyph.width = static_cast<int>(glyphMetrics.gmBlackBoxX);
+        glyph.height = static_cast<int>(glyphMetrics.gmBlackBoxY);
+
+        // Rows are DWORD aligned and hold 65 levels (0-64)
+        const size_t stride = (static_cast<size_t>(glyph.width) + 3) & ~size_t{ 3 };
+        coverage.resize(static_cast<size_t>(glyph.width) * glyph.height);
+        for (int y = 0; y < glyph.height; ++y) {
+            for (int x = 0; x < glyph.width; ++x) {
+                coverage[static_cast<size_t>(y) * glyph.width + x] = static_cast<uint8_t>(bits[y * stride + x] * 255 / 64);
+            }
+        }
+        return true;
+    }
+
+private:
+    HFONT fontFor(int pixelHeight) {
+        for (const auto& [height, font] : m_fonts) {
+            if (height == pixelHeight) return font;
+        }
+        // Positive height asks for the cell height, so a line is exactly pixelHeight tall
+        HFONT font = CreateFontW(pixelHeight, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+            OUT_TT_ONLY_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY, VARIABLE_PITCH | FF_SWISS, L"Segoe UI");
+        m_fonts.emplace_back(pixelHeight, font);
+        return font;
+    }
+
+    HDC m_dc;
+    std::vector<std::pair<int, HFONT>> m_fonts;
+};
+
+// Where a window shows its overlay: centred in the client area
+static RECT OverlayRect(const WindowState& state) {
+    return toRECT(CentredRect(state.client.right, state.client.bottom, state.overlay->width(), state.overlay->height()));
+}
+
+// PaintWindow onto a window DC. Fills use the window's brush, which already
+// holds the scene color, so the paint path creates no GDI objects.
+class GdiRenderer : public Renderer {
+public:
+    GdiRenderer(HDC deviceContext, HBRUSH brush) : m_deviceContext(deviceContext), m_brush(brush) {}
+
+    void fill(const Rect& area, uint32_t) override {
+        const RECT r = toRECT(area);
+        FillRect(m_deviceContext, &r, m_brush);
+    }
+    void blit(const Rect& area, const Rect& placed, const uint32_t* pixels) override {
+        BITMAPINFO bitmapInfo = {};
+        bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bitmapInfo.bmiHeader.biWidth = placed.width();
+        bitmapInfo.bmiHeader.biHeight = -placed.height();     // top-down rows
+        bitmapInfo.bmiHeader.biPlanes = 1;
+        bitmapInfo.bmiHeader.biBitCount = 32;
+        bitmapInfo.bmiHeader.biCompression = BI_RGB;
+        SetDIBitsToDevice(m_deviceContext, area.left, area.top, area.width(), area.height(),
+            area.left - placed.left, area.top - placed.top, 0, placed.height(), pixels, &bitmapInfo, DIB_RGB_COLORS);
+    }
+
+private:
+    HDC m_deviceContext;
+    HBRUSH m_brush;
 };
 
+// GetMessage that tells the flight recorder's watchdog the UI thread is
+// waiting, not stuck, until the next message arrives
+static BOOL GetMessageWatched(MSG& message) {
+    g_flightRecorder.idle();
+    const BOOL result = GetMessage(&message, nullptr, 0, 0);
+    g_flightRecorder.busy();
+    return result;
+}
+
+// --spotlight target: the foreground window, or the first visible unowned
+// top-level window of another process whose title contains title (any case)
+static HWND FindSpotlightWindow(const std::string& title) {
+    if (title.empty()) return GetForegroundWindow();
 
+    struct Search {
+        std::string title;
+        HWND found;
+    } search = { ToLower(title), nullptr };
+    EnumWindows([](HWND window, LPARAM data) -> BOOL {
+        auto* search = reinterpret_cast<Search*>(data);
+        DWORD processId = 0;
+        GetWindowThreadProcessId(window, &processId);
+        if (!IsWindowVisible(window) || GetWindow(window, GW_OWNER) || processId == GetCurrentProcessId()) return TRUE;
 
+        wchar_t text[512];
+        const int length = GetWindowTextW(window, text, static_cast<int>(std::size(text)));
+        char utf8[1536];
+        const int bytes = length > 0
+            ? WideCharToMultiByte(CP_UTF8, 0, text, length, utf8, static_cast<int>(sizeof(utf8)), nullptr, nullptr) : 0;
+        if (bytes <= 0 || ToLower(std::string(utf8, bytes)).find(search->title) == std::string::npos) return TRUE;
+        search->found = window;
+        return FALSE;
+    }, reinterpret_cast<LPARAM>(&search));
+    return search.found;
+}
+
+// Follows one top-level window through out-of-context WinEvent hooks, which
+// this thread's message loop delivers between other messages: location
+// changes for moves and resizes, minimize and show/hide/destroy for the rect
+// going empty or coming back. Hook callbacks carry no context, hence the global.
+class WinEventWindowEvents;
+static WinEventWindowEvents* g_spotlightEvents = nullptr;
 
-std::vector<ExtendedMonitorInfo> g_extendedMonitorList;
+class WinEventWindowEvents : public WindowEventSource {
+public:
+    explicit WinEventWindowEvents(HWND window) : m_window(window) {}
+    ~WinEventWindowEvents() override { stop(); }
 
-void EnumerateDisplayConfig() {
-    g_extendedMonitorList.clear();
+    bool start(Listener listener) override {
+        DWORD processId = 0;
+        const DWORD threadId = GetWindowThreadProcessId(m_window, &processId);
+        if (!threadId) return false;
+
+        m_listener = std::move(listener);
+        g_spotlightEvents = this;
+        const std::pair<DWORD, DWORD> ranges[] = {
+            { EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE },
+            { EVENT_OBJECT_DESTROY, EVENT_OBJECT_HIDE },
+            { EVENT_SYSTEM_MINIMIZESTART, EVENT_SYSTEM_MINIMIZEEND }
+        };
+        for (const auto& [first, last] : ranges) {
+            if (HWINEVENTHOOK hook = SetWinEventHook(first, last, nullptr, HandleWinEvent, processId, threadId, WINEVENT_OUTOFCONTEXT)) {
+                m_hooks.push_back(hook);
+            }
+        }
+        if (m_hooks.size() != std::size(ranges)) {
+            stop();
+            return false;
+        }
+        m_listener(currentRect());
+        return true;
+    }
 
-    UINT32 num_paths = 0;
-    UINT32 num_modes = 0;
+    void stop() override {
+        for (HWINEVENTHOOK hook : m_hooks) UnhookWinEvent(hook);
+        m_hooks.clear();
+        if (g_spotlightEvents == this) g_spotlightEvents = nullptr;
+        m_listener = {};
+    }
+
+private:
+    static void CALLBACK HandleWinEvent(HWINEVENTHOOK, DWORD event, HWND window, LONG object, LONG child, DWORD, DWORD) {
+        WinEventWindowEvents* self = g_spotlightEvents;
+        if (!self || window != self->m_window || object != OBJID_WINDOW || child != CHILDID_SELF) return;
+        self->m_listener(event == EVENT_OBJECT_DESTROY ? Rect{} : self->currentRect());
+    }
+
+    Rect currentRect() const {
+        if (!IsWindow(m_window) || !IsWindowVisible(m_window) || IsIconic(m_window)) return {};
+        // The visible frame; GetWindowRect also counts the invisible resize borders
+        RECT frame;
+        if (FAILED(DwmGetWindowAttribute(m_window, DWMWA_EXTENDED_FRAME_BOUNDS, &frame, sizeof(frame))) &&
+            !GetWindowRect(m_window, &frame)) {
+            return {};
+        }
+        return toRect(frame);
+    }
+
+    HWND m_window;
+    std::vector<HWINEVENTHOOK> m_hooks;
+    Listener m_listener;
+};
 
-    // Get required buffer sizes
-    LONG result = GetDisplayConfigBufferSizes(QDC_ALL_PATHS, &num_paths, &num_modes);
-    if (result != ERROR_SUCCESS) return;
+// Hook callbacks carry no context; the initiator whose windows are guarded
+static WindowInitiator* g_occlusionOwner = nullptr;
 
-    // Allocate buffers
-    std::vector<DISPLAYCONFIG_PATH_INFO> paths(num_paths);
-    std::vector<DISPLAYCONFIG_MODE_INFO> modes(num_modes);
+// True when a visible window of another process above window in z-order overlaps it
+static ObservedWindow Observe(HWND window) {
+    ObservedWindow observed;
+    RECT rect;
+    if (GetWindowRect(window, &rect)) observed.rect = toRect(rect);
+    DWORD processId = 0;
+    GetWindowThreadProcessId(window, &processId);
+    observed.ownProcess = processId == GetCurrentProcessId();
+    observed.visible = IsWindowVisible(window) != FALSE;
+    BOOL cloaked = FALSE;
+    observed.cloaked = SUCCEEDED(DwmGetWindowAttribute(window, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked;
+    observed.topmost = (GetWindowLongPtr(window, GWL_EXSTYLE) & WS_EX_TOPMOST) != 0;
+    return observed;
+}
+
+static bool IsCovered(HWND window) {
+    RECT own;
+    if (!GetWindowRect(window, &own)) return false;
+    std::vector<ObservedWindow> above;
+    for (HWND higher = GetWindow(window, GW_HWNDPREV); higher; higher = GetWindow(higher, GW_HWNDPREV)) {
+        above.push_back(Observe(higher));
+    }
+    return IsOccluded(toRect(own), above);
+}
+
+// Pool backend on top of the blanking window class
+class WindowInitiator::Win32Backend : public WindowBackend {
+public:
+    explicit Win32Backend(WindowInitiator& owner) : m_owner(owner) {}
+
+    Handle create(const WindowTarget& target) override {
+        return m_owner.openWindow(target);
+    }
+    void destroy(Handle window) override {
+        m_owner.closeWindow(static_cast<HWND>(window));
+    }
+    void move(Handle window, const Rect& rect) override {
+        auto* state = reinterpret_cast<WindowState*>(GetWindowLongPtr(static_cast<HWND>(window), GWLP_USERDATA));
+        state->client = { 0, 0, rect.width(), rect.height() };
+        state->backdrop = m_owner.backdropFor(state->pattern, rect.width(), rect.height());
+        SetWindowPos(static_cast<HWND>(window), nullptr, rect.left, rect.top, rect.width(), rect.height(),
+            SWP_NOZORDER | SWP_NOACTIVATE);
+    }
+    void show(Handle window) override {
+        // Without activating: reveal() decides who gets the focus
+        ShowWindow(static_cast<HWND>(window), SW_SHOWNA);
+        UpdateWindow(static_cast<HWND>(window));
+    }
+    void hide(Handle window) override {
+        ShowWindow(static_cast<HWND>(window), SW_HIDE);
+    }
+
+    // Cloaked windows are shown and painted without DWM composing them, so
+    // uncloaking them back to back lands every monitor in the same frame
+    void reveal(const std::vector<Handle>& windows) override {
+        RevealTracker tracker;
+        tracker.begin(windows);
+        std::vector<HWND> cloaked;
+        for (Handle window : windows) {
+            const BOOL cloak = TRUE;
+            if (SUCCEEDED(DwmSetWindowAttribute(static_cast<HWND>(window), DWMWA_CLOAK, &cloak, sizeof(cloak)))) {
+                cloaked.push_back(static_cast<HWND>(window));
+            }
+        }
 
-    // Query display config
-    result = QueryDisplayConfig(QDC_ALL_PATHS, &num_paths, paths.data(), &num_modes, modes.data(), nullptr);
-    if (result != ERROR_SUCCESS) return;
+        // One visibility change for the whole batch; window by window if the batch cannot be built
+        HDWP batch = BeginDeferWindowPos(static_cast<int>(windows.size()));
+        for (Handle window : windows) {
+            if (!batch) break;
+            batch = DeferWindowPos(batch, static_cast<HWND>(window), HWND_TOP, 0, 0, 0, 0,
+                SWP_SHOWWINDOW | SWP_NOMOVE | SWP_NOSIZE);
+        }
+        if (!batch || !EndDeferWindowPos(batch)) {
+            for (Handle window : windows) ShowWindow(static_cast<HWND>(window), SW_SHOW);
+        }
 
-    // Collect target info (monitors)
-    std::vector<std::pair<LUID, UINT32>> targets; // adapterId, targetId
-    for (UINT32 i = 0; i < num_modes; i++) {
-        if (modes[i].infoType == DISPLAYCONFIG_MODE_INFO_TYPE_TARGET) {
-            targets.push_back({ modes[i].adapterId, modes[i].id });
+        for (Handle window : windows) {
+            UpdateWindow(static_cast<HWND>(window));
+            if (std::ranges::find(cloaked, static_cast<HWND>(window)) == cloaked.end()) {
+                tracker.mark(window, MetricsClock());
+            }
+        }
+        for (HWND windowHandle : cloaked) {
+            const BOOL cloak = FALSE;
+            DwmSetWindowAttribute(windowHandle, DWMWA_CLOAK, &cloak, sizeof(cloak));
+            tracker.mark(windowHandle, MetricsClock());
+        }
+        if (!windows.empty()) {
+            // Key exit needs one of them focused, as ShowWindow used to leave it;
+            // a spotlight leaves the focus with the tracked window
+            if (!m_owner.m_spotlight.enabled) SetForegroundWindow(static_cast<HWND>(windows.back()));
+            g_metrics.revealSkew.record(tracker.skew());
         }
     }
 
-    // Now enumerate actual monitors to get positions
-    std::vector<RECT> monitorRects;
-    std::vector<std::string> monitorNames;
+private:
+    WindowInitiator& m_owner;
+};
+
+// Defined after Win32Backend, which m_backend needs complete to delete
+WindowInitiator::~WindowInitiator() = default;
 
-    // Get friendly names for targets
-    for (const auto& [adapterId, targetId] : targets) {
-        std::string name = GetFriendlyNameFromTarget(adapterId, targetId);
-        monitorNames.push_back(name);
+bool WindowInitiator::selectMonitors(const Topology& topology, std::vector<MonitorData>& targetMonitors) const {
+    std::vector<std::string> warnings;
+    std::string error;
+    const bool selected = SelectMonitors(topology, m_monitorIndices, m_monitorPatterns, m_monitorQueries,
+        targetMonitors, warnings, error);
+    g_flightRecorder.record(FlightEvent::Selection, selected ? targetMonitors.size() : 0, topology.monitors.size());
+    if (!selected) g_flightRecorder.recordText(FlightEvent::Error, error);
+    if (m_embedded) return selected;
+    for (const std::string& warning : warnings) {
+        MessageBoxA(nullptr, warning.c_str(), "Warning", MB_ICONWARNING);
+    }
+    if (!selected) {
+        MessageBoxA(nullptr, error.c_str(), "Error", MB_ICONERROR);
+    }
+    return selected;
+}
+
+std::vector<WindowTarget> WindowInitiator::layout(const Topology& topology, const std::vector<MonitorData>& targetMonitors) const {
+    return BuildLayout(topology, targetMonitors, m_mask, m_styles, m_color, m_opacity, m_patterns);
+}
+
+HWND WindowInitiator::openWindow(const WindowTarget& target) {
+    UINT dpiX = 96, dpiY = 96;
+    if (m_overlay.enabled()) {
+        const RECT area = toRECT(target.rect);
+        if (GetDpiForMonitor(MonitorFromRect(&area, MONITOR_DEFAULTTONEAREST), MDT_EFFECTIVE_DPI, &dpiX, &dpiY) != S_OK) {
+            dpiY = 96;
+        }
     }
 
-    // Now match with EnumDisplayMonitors
-    g_monitors.clear();
-    EnumDisplayMonitors(nullptr, nullptr, [](HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor, LPARAM dwData) -> BOOL {
-        MONITORINFO mi = { sizeof(MONITORINFO) };
-        if (GetMonitorInfo(hMonitor, &mi)) {
-            std::string name = "Monitor " + std::to_string(g_monitors.size() + 1);
+    const std::tuple<int, int, int> color = target.pattern == TestPattern::SolidCycle
+        ? SolidCycleColor(std::time(nullptr)) : target.color;
 
-            // Try to match with our collected names (simplified - you may need more complex matching)
-            //if (g_monitorList.size() < monitorNames.size()) {
-                //name = monitorNames[g_monitorList.size()];
-            //}
+    // Heap-allocated so the address handed out through lpParam survives later windows
+    auto state = std::make_unique<WindowState>(WindowState{
+        .brush = brushFor(color),
+        .color = PackColor(color),
+        .client = { 0, 0, target.rect.width(), target.rect.height() },
+        .alpha = static_cast<BYTE>(std::clamp(target.opacity, 0, 100) * 255 / 100),
+        .exitOnKey = !m_disableKeyExit,
+        .resident = m_resident.enabled,
+        .monitor = target.monitor,
+        .overlay = m_overlay.enabled() ? overlayFor(dpiY, target.color) : nullptr,
+        .backdrop = backdropFor(target.pattern, target.rect.width(), target.rect.height()),
+        .pattern = target.pattern
+    });
 
-            g_monitors.push_back({ hMonitor, mi.rcMonitor, static_cast<int>(g_monitors.size()), name });
+    const auto windowHandle = CreateWindowEx(
+        (state->alpha < 255 ? WS_EX_LAYERED : 0) | WS_EX_TOPMOST,
+        L"BlackWindowClass",
+        L"Black Screen Application",
+        WS_POPUP,
+        target.rect.left,
+        target.rect.top,
+        target.rect.width(),
+        target.rect.height(),
+        nullptr,
+        nullptr,
+        GetModuleHandle(nullptr),
+        state.get()
+    );
+
+    g_flightRecorder.record(FlightEvent::WindowCreated, static_cast<uint64_t>(target.monitor),
+        PackFlightRect(target.rect.left, target.rect.top, target.rect.width(), target.rect.height()));
+    if (!windowHandle) {
+        g_flightRecorder.recordText(FlightEvent::Error, "CreateWindowEx");
+    }
+    else {
+        if (state->alpha < 255) {
+            SetLayeredWindowAttributes(windowHandle, 0, state->alpha, LWA_ALPHA);
         }
-        return TRUE;
-        }, 0);
+        g_windowHandles.push_back(windowHandle);
+        m_windowStates.push_back(std::move(state));
+    }
+    return windowHandle;
 }
 
+const TextOverlay* WindowInitiator::overlayFor(UINT dpi, const std::tuple<int, int, int>& background) {
+    for (const OverlaySlot& slot : m_overlays) {
+        if (slot.dpi == dpi && slot.background == background) return slot.overlay.get();
+    }
 
+    if (!m_atlases) {
+        m_rasterizer = std::make_unique<GdiRasterizer>();
+        m_atlases = std::make_unique<GlyphAtlasCache>(*m_rasterizer);
+    }
+    auto overlay = std::make_unique<TextOverlay>(m_atlases->atlasFor(m_overlay.pointSize, static_cast<int>(dpi)),
+        m_overlay.color, background);
+    overlay->update(m_overlay.lines(std::time(nullptr)));
+    m_overlays.push_back({ dpi, background, std::move(overlay) });
+    return m_overlays.back().overlay.get();
+}
 
+void WindowInitiator::tickOverlays() {
+    if (m_solidCycle) {
+        // Solid-cycle windows step together; each one repaints once per step
+        const std::tuple<int, int, int> color = SolidCycleColor(std::time(nullptr));
+        for (HWND windowHandle : g_windowHandles) {
+            auto* state = reinterpret_cast<WindowState*>(GetWindowLongPtr(windowHandle, GWLP_USERDATA));
+            if (!state || state->pattern != TestPattern::SolidCycle || state->color == PackColor(color)) continue;
+            state->brush = brushFor(color);
+            state->color = PackColor(color);
+            InvalidateRect(windowHandle, nullptr, TRUE);
+        }
+    }
 
+    const std::vector<std::string> lines = m_overlay.lines(std::time(nullptr));
+    for (const OverlaySlot& slot : m_overlays) {
+        const std::vector<Rect> changed = slot.overlay->update(lines);
+        if (changed.empty()) continue;
 
+        // Only the changed cells are invalidated; WM_ERASEBKGND repaints within that clip
+        for (HWND windowHandle : g_windowHandles) {
+            const auto* state = reinterpret_cast<const WindowState*>(GetWindowLongPtr(windowHandle, GWLP_USERDATA));
+            if (!state || state->overlay != slot.overlay.get()) continue;
+            if (slot.overlay->resized()) {
+                InvalidateRect(windowHandle, nullptr, TRUE);
+                continue;
+            }
+            const RECT block = OverlayRect(*state);
+            for (const Rect& r : changed) {
+                const RECT area = { block.left + r.left, block.top + r.top, block.left + r.right, block.top + r.bottom };
+                InvalidateRect(windowHandle, &area, TRUE);
+            }
+        }
+    }
+    scheduleOverlayTick();
+}
 
+void WindowInitiator::scheduleOverlayTick() {
+    if (m_overlay.clockFormat.empty() && !m_solidCycle) return;
 
+    // Fire just after the next second boundary so the clock and solid-cycle turn over on time
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const UINT delay = static_cast<UINT>(1000 - now % 1000 + 5);
+    m_overlayTimer = SetTimer(nullptr, m_overlayTimer, delay, nullptr);
+}
 
-// Helper function for case-insensitive comparison
-extern std::string ToLower(const std::string& str);
+void WindowInitiator::closeWindow(HWND windowHandle) {
+    const auto* state = reinterpret_cast<const WindowState*>(GetWindowLongPtr(windowHandle, GWLP_USERDATA));
+    DestroyWindow(windowHandle);
+    std::erase(g_windowHandles, windowHandle);
+    std::erase_if(m_windowStates, [state](const std::unique_ptr<WindowState>& owned) { return owned.get() == state; });
+}
 
-void WindowInitiator::createWindow() {
+// Generates the --pattern bitmaps and scales --image for every window size in
+// targets that has none yet
+bool WindowInitiator::prepareBackdrops(const std::vector<WindowTarget>& targets) {
+    for (const WindowTarget& target : targets) {
+        m_patternCache.prepare(target.pattern, target.rect.width(), target.rect.height());
+    }
+    if (!m_image.enabled()) return true;
 
+    std::vector<std::pair<long, long>> sizes;
+    for (const WindowTarget& target : targets) sizes.emplace_back(target.rect.width(), target.rect.height());
+    std::string error;
+    if (!m_backdrops.prepare(sizes, error)) {
+        g_flightRecorder.recordText(FlightEvent::Error, error);
+        MessageBoxA(nullptr, error.c_str(), "Error", MB_ICONERROR);
+        return false;
+    }
+    return true;
+}
 
+// The pattern bitmap when the window has one (none for solid-cycle), else the --image backdrop
+const Backdrop* WindowInitiator::backdropFor(TestPattern pattern, long width, long height) const {
+    if (pattern != TestPattern::Off) return m_patternCache.find(pattern, width, height);
+    return m_image.enabled() ? m_backdrops.find(width, height) : nullptr;
+}
 
-    if (g_monitors.empty()) {
+void WindowInitiator::createWindow() {
+    // Held for the whole session: a background refresh publishes a new snapshot
+    // without invalidating the monitors and index used here
+    const TopologySnapshot topology = TopologyStore::current();
+    if (!topology || topology->monitors.empty()) {
+        g_flightRecorder.recordText(FlightEvent::Error, "No monitors");
         MessageBox(nullptr, L"No monitors detected.", L"Error", MB_ICONERROR);
         return;
     }
 
     std::vector<MonitorData> targetMonitors;
+    if (!selectMonitors(*topology, targetMonitors)) {
+        return;
+    }
 
-    if (m_monitorPatterns.size() > 0) {
-        // Handle string patterns (-M)
-        if (m_monitorPatterns.size() == 1 && m_monitorPatterns[0] == "*") {
-            // Use all monitors
-            targetMonitors = g_monitors;
-        }
-        else {
-            // Match patterns
-            for (const std::string& pattern : m_monitorPatterns) {
-                bool matched = false;
-                for (const auto& monitor : g_monitors) {
-                    std::string monitorNameLower = monitor.name;
-                    std::string patternLower = pattern;
-                    std::ranges::transform(monitorNameLower, monitorNameLower.begin(), ::tolower);
-                    std::ranges::transform(patternLower, patternLower.begin(), ::tolower);                
-
-                    if (monitorNameLower.find(patternLower) != std::string::npos) {
-                        targetMonitors.push_back(monitor);
-                        matched = true;
-                        break; // greedy match
-                    }
-                }
-                if (!matched) {
-                    char msg[512];
-                    sprintf_s(msg, "No monitor found matching pattern: '%s'", pattern.c_str());
-                    MessageBoxA(nullptr, msg, "Warning", MB_ICONWARNING);
-                }
-            }
+    // Decoded, scaled and generated before any window exists, so the first paint already has the picture
+    if (m_image.enabled()) {
+        std::string error;
+        if (!m_backdrops.open(m_image, error)) {
+            g_flightRecorder.recordText(FlightEvent::Error, error);
+            MessageBoxA(nullptr, error.c_str(), "Error", MB_ICONERROR);
+            return;
         }
     }
+    if (!prepareBackdrops(layout(*topology, targetMonitors))) {
+        return;
+    }
+
+    registerWindowClass();
+
+    if (m_resident.enabled) {
+        runResident();
+    }
     else {
-        // Handle numeric indices (-m) — existing logic
-        if (m_monitorIndices.size() == 1 && m_monitorIndices[0] == -1) {
-            // Use all monitors
-            targetMonitors = g_monitors;
+        const uint64_t blankStart = MetricsClock();
+        ShowCursor(FALSE);
+
+        // Every window is created hidden before any is shown, then they are revealed together
+        Win32Backend backend(*this);
+        std::vector<WindowBackend::Handle> windows;
+        for (const WindowTarget& target : layout(*topology, targetMonitors)) {
+            if (HWND windowHandle = openWindow(target)) {
+                windows.push_back(windowHandle);
+            }
         }
-        else {
-            for (int idx : m_monitorIndices) {
-                if (idx == -1) {
-                    // If -1 is included, add all monitors
-                    for (const auto& m : g_monitors) {
-                        targetMonitors.push_back(m);
-                    }
-                }
-                else {
-                    if (idx >= 0 && idx < static_cast<int>(g_monitors.size())) {
-                        targetMonitors.push_back(g_monitors[idx]);
-                    }
-                    else {
-                        char msg[256];
-                        sprintf_s(msg, "Invalid monitor index: %d", idx);
-                        MessageBoxA(nullptr, msg, "Error", MB_ICONERROR);
-                        return;
-                    }
-                }
+        backend.reveal(windows);
+        startOcclusionGuard();
+        g_flightRecorder.record(FlightEvent::Blank, windows.size());
+        g_metrics.blanks.fetch_add(1, std::memory_order_relaxed);
+        g_metrics.timeToBlack.record(MetricsClock() - blankStart);
+
+        // No refresher: a one-shot run keeps the windows it opened, so a new
+        // topology would have nothing to rebuild
+        scheduleOverlayTick();
+
+        // Message loop
+        MSG message;
+        while (GetMessageWatched(message)) {
+            if (message.hwnd == nullptr && message.message == WM_TIMER && message.wParam == m_overlayTimer) {
+                tickOverlays();
+                continue;
             }
+            if (message.hwnd == nullptr && message.message == WM_TIMER && message.wParam == m_occlusionTimer) {
+                settleOcclusion();
+                continue;
+            }
+            TranslateMessage(&message);
+            DispatchMessage(&message);
+            if (message.message == WM_QUIT) break;
         }
+
+        stopOcclusionGuard();
     }
 
-    // Remove duplicates
-    std::sort(targetMonitors.begin(), targetMonitors.end(), [](const MonitorData& a, const MonitorData& b) {
-        return a.index < b.index;
-        });
-    targetMonitors.erase(std::unique(targetMonitors.begin(), targetMonitors.end(), [](const MonitorData& a, const MonitorData& b) {
-        return a.index == b.index;
-        }), targetMonitors.end());
+    // Cleanup
+    const uint64_t unblankStart = g_unblankRequestedAt ? g_unblankRequestedAt : MetricsClock();
+    const bool wasBlanked = !m_resident.enabled && !g_windowHandles.empty();
+    for (auto hwnd : g_windowHandles) {
+        DestroyWindow(hwnd);
+    }
+    g_windowHandles.clear();
+    if (wasBlanked) {
+        g_flightRecorder.record(FlightEvent::Unblank);
+        g_metrics.unblanks.fetch_add(1, std::memory_order_relaxed);
+        g_metrics.timeToUnblank.record(MetricsClock() - unblankStart);
+    }
+    g_unblankRequestedAt = 0;
+    releaseResources();
+}
 
-    // Create windows (same as before)
+void WindowInitiator::registerWindowClass() {
     const WNDCLASS windowClass = {
         .lpfnWndProc = HandleWindowMessages,
         .hInstance = GetModuleHandle(nullptr),
@@ -213,88 +646,429 @@ void WindowInitiator::createWindow() {
     if (!GetClassInfo(GetModuleHandle(nullptr), L"BlackWindowClass", const_cast<WNDCLASS*>(&windowClass))) {
         RegisterClass(&windowClass);
     }
+}
+
+// Everything the windows shared, once the last of them is gone
+void WindowInitiator::releaseResources() {
+    if (m_overlayTimer) {
+        KillTimer(nullptr, m_overlayTimer);
+        m_overlayTimer = 0;
+    }
+    m_windowStates.clear();
+    m_overlays.clear();
+    for (const auto& [rgb, brush] : m_brushes) {
+        if (rgb != RGB(0, 0, 0)) DeleteObject(brush);
+    }
+    m_brushes.clear();
+    UnregisterClass(L"BlackWindowClass", GetModuleHandle(nullptr));
+}
+
+// Whole-monitor layouts pool every monitor so any selection can be served by a flip;
+// mask layouts only exist for the selected monitors
+void WindowInitiator::rebuildPool() {
+    const TopologySnapshot topology = TopologyStore::current();
+    std::vector<MonitorData> targetMonitors;
+    if (!topology || !selectMonitors(*topology, targetMonitors)) {
+        targetMonitors.clear();
+    }
 
-    ShowCursor(FALSE);
-
-    for (const auto& monitor : targetMonitors) {
-        const auto windowHandle = CreateWindowEx(
-            0,
-            L"BlackWindowClass",
-            L"Black Screen Application",
-            WS_POPUP | WS_VISIBLE,
-            monitor.rect.left,
-            monitor.rect.top,
-            monitor.rect.right - monitor.rect.left,
-            monitor.rect.bottom - monitor.rect.top,
-            nullptr,
-            nullptr,
-            GetModuleHandle(nullptr),
-            nullptr
-        );
-
-        if (windowHandle) {
-            g_windowHandles.push_back(windowHandle);
-            ShowWindow(windowHandle, SW_SHOW);
-            UpdateWindow(windowHandle);
+    m_blankKeys.clear();
+    std::vector<WindowTarget> targets;
+    if (topology && m_mask.empty()) {
+        targets = layout(*topology, topology->monitors);
+        for (const auto& monitor : targetMonitors) m_blankKeys.push_back(monitor.index);
+    }
+    else if (topology) {
+        targets = layout(*topology, targetMonitors);
+        for (const auto& target : targets) m_blankKeys.push_back(target.key);
+    }
+    if (m_spotlight.enabled) {
+        // Window events then only reshape the sides around the tracked window
+        targets = m_spotlightLayout.reset(targets);
+        m_blankKeys = Spotlight::sideKeys(m_blankKeys);
+    }
+    prepareBackdrops(targets);
+    m_pool->sync(targets);
+    guardWindows();
+}
+
+void WindowInitiator::setPoolBlanked(bool blanked) {
+    if (blanked == m_pool->blanked()) return;
+    if (blanked) {
+        const uint64_t start = MetricsClock();
+        ShowCursor(FALSE);
+        m_pool->blank(m_blankKeys);
+        g_flightRecorder.record(FlightEvent::Blank, m_blankKeys.size());
+        g_metrics.blanks.fetch_add(1, std::memory_order_relaxed);
+        g_metrics.timeToBlack.record(MetricsClock() - start);
+    }
+    else {
+        const uint64_t start = g_unblankRequestedAt ? g_unblankRequestedAt : MetricsClock();
+        m_pool->unblank();
+        ShowCursor(TRUE);
+        g_flightRecorder.record(FlightEvent::Unblank);
+        g_metrics.unblanks.fetch_add(1, std::memory_order_relaxed);
+        g_metrics.timeToUnblank.record(MetricsClock() - start);
+    }
+    g_unblankRequestedAt = 0;
+    guardWindows();
+}
+
+void WindowInitiator::runResident() {
+    m_backend = std::make_unique<Win32Backend>(*this);
+    m_pool = std::make_unique<WindowPool>(*m_backend, m_resident.pool);
+    auto setBlanked = [this](bool blanked) { setPoolBlanked(blanked); };
+
+    // --listen: requests are queued by the server thread and answered here, between other messages
+    const DWORD uiThread = GetCurrentThreadId();
+    FleetServer fleet([uiThread] {
+        PostThreadMessage(uiThread, WM_APP_FLEET, 0, 0);
+    });
+    const FleetActions fleetActions = { [this] { return m_pool->blanked(); }, setBlanked };
+    if (!m_resident.listen.empty()) {
+        std::string error;
+        if (!fleet.start(m_resident.listen, m_resident.token, error)) {
+            g_flightRecorder.recordText(FlightEvent::Error, error);
+            MessageBoxA(nullptr, ("Error: " + error).c_str(), "Error", MB_ICONERROR);
+            m_pool.reset();
+            m_backend.reset();
+            return;
         }
     }
+    if (m_spotlight.enabled && !startSpotlight()) {
+        fleet.stop();
+        m_pool.reset();
+        m_backend.reset();
+        return;
+    }
+
+    rebuildPool();
+    setBlanked(true);
+    startOcclusionGuard();
+    scheduleOverlayTick();
 
-    // Message loop
+    RegisterHotKey(nullptr, kHotkeyToggle, MOD_CONTROL | MOD_ALT | MOD_NOREPEAT, 'B');
+    RegisterHotKey(nullptr, kHotkeyQuit, MOD_CONTROL | MOD_ALT | MOD_NOREPEAT, 'Q');
+
+    TopologyStore::startRefresher([uiThread] {
+        PostThreadMessage(uiThread, WM_APP_TOPOLOGY, 0, 0);
+    });
+
+    // Message loop; thread messages (hwnd == nullptr) drive the pool
     MSG message;
-    while (GetMessage(&message, nullptr, 0, 0)) {
+    while (GetMessageWatched(message)) {
+        if (message.hwnd == nullptr) {
+            if (message.message == WM_HOTKEY && message.wParam == kHotkeyToggle) {
+                setBlanked(!m_pool->blanked());
+                continue;
+            }
+            if (message.message == WM_HOTKEY && message.wParam == kHotkeyQuit) {
+                PostQuitMessage(0);
+                continue;
+            }
+            if (message.message == WM_APP_UNBLANK) {
+                setBlanked(false);
+                continue;
+            }
+            if (message.message == WM_APP_TOPOLOGY) {
+                rebuildPool();
+                continue;
+            }
+            if (message.message == WM_APP_FLEET) {
+                FleetCall call;
+                while (fleet.takeCall(call)) fleet.reply(call.connection, AnswerFleetRequest(call.request, fleetActions));
+                continue;
+            }
+            if (message.message == WM_TIMER && message.wParam == m_overlayTimer) {
+                tickOverlays();
+                continue;
+            }
+            if (message.message == WM_TIMER && message.wParam == m_occlusionTimer) {
+                settleOcclusion();
+                continue;
+            }
+        }
         TranslateMessage(&message);
         DispatchMessage(&message);
-        if (message.message == WM_QUIT) break;
     }
 
-    // Cleanup
-    for (auto hwnd : g_windowHandles) {
-        DestroyWindow(hwnd);
+    TopologyStore::stopRefresher();
+    fleet.stop();
+    UnregisterHotKey(nullptr, kHotkeyToggle);
+    UnregisterHotKey(nullptr, kHotkeyQuit);
+    stopSpotlight();
+    stopOcclusionGuard();
+    setBlanked(false);
+    m_pool.reset();
+    m_backend.reset();
+}
+
+bool WindowInitiator::startSpotlight() {
+    std::string error;
+    if (const HWND window = FindSpotlightWindow(m_spotlight.title)) {
+        m_spotlightEvents = std::make_unique<WinEventWindowEvents>(window);
+        if (m_spotlightEvents->start([this](const Rect& hole) { moveSpotlight(hole); })) return true;
+        m_spotlightEvents.reset();
+        error = "Cannot follow the spotlight window";
     }
-    g_windowHandles.clear();
-    UnregisterClass(L"BlackWindowClass", GetModuleHandle(nullptr));
+    else {
+        error = m_spotlight.title.empty() ? "No foreground window to spotlight"
+            : "No window title contains '" + m_spotlight.title + "'";
+    }
+    g_flightRecorder.recordText(FlightEvent::Error, error);
+    MessageBoxA(nullptr, error.c_str(), "Error", MB_ICONERROR);
+    return false;
+}
+
+void WindowInitiator::stopSpotlight() {
+    if (m_spotlightEvents) m_spotlightEvents->stop();
+    m_spotlightEvents.reset();
 }
+
+// Called from the hooks; only the sides whose rect changed are moved, shown or hidden
+void WindowInitiator::moveSpotlight(const Rect& hole) {
+    const std::vector<WindowTarget> changed = m_spotlightLayout.move(hole);
+    if (changed.empty() || !m_pool) return;
+    m_pool->reshape(changed);
+    guardWindows();
+}
+
+void WindowInitiator::startOcclusionGuard() {
+    if (!m_occlusionHooks.empty()) return;
+    // Skipping our own process keeps the guard's restacking from feeding back into it
+    g_occlusionOwner = this;
+    for (DWORD event : { EVENT_SYSTEM_FOREGROUND, EVENT_OBJECT_SHOW, EVENT_OBJECT_REORDER }) {
+        if (HWINEVENTHOOK hook = SetWinEventHook(event, event, nullptr, HandleOcclusionEvent, 0, 0,
+            WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS)) {
+            m_occlusionHooks.push_back(hook);
+        }
+    }
+    if (m_occlusionHooks.empty()) {
+        // Still topmost, just not defended
+        g_flightRecorder.recordText(FlightEvent::Error, "SetWinEventHook");
+        g_occlusionOwner = nullptr;
+        return;
+    }
+    guardWindows();
+}
+
+void WindowInitiator::stopOcclusionGuard() {
+    for (HWINEVENTHOOK hook : m_occlusionHooks) UnhookWinEvent(hook);
+    m_occlusionHooks.clear();
+    if (g_occlusionOwner == this) g_occlusionOwner = nullptr;
+    if (m_occlusionTimer) {
+        KillTimer(nullptr, m_occlusionTimer);
+        m_occlusionTimer = 0;
+    }
+    m_guarded.clear();
+    m_occlusion.setWindows({});
+}
+
+void WindowInitiator::guardWindows() {
+    if (m_occlusionHooks.empty()) return;
+    m_guarded.clear();
+    std::vector<Rect> rects;
+    for (HWND windowHandle : g_windowHandles) {
+        RECT rect;
+        if (!IsWindowVisible(windowHandle) || !GetWindowRect(windowHandle, &rect)) continue;
+        m_guarded.push_back(windowHandle);
+        rects.push_back(toRect(rect));
+    }
+    m_occlusion.setWindows(std::move(rects));
+    if (!m_occlusion.deadline() && m_occlusionTimer) {
+        KillTimer(nullptr, m_occlusionTimer);
+        m_occlusionTimer = 0;
+    }
+}
+
+// Foreground changes and shown windows report the window that came forward;
+// z-order changes among top-level windows come from the desktop and say
+// nothing about where
+void CALLBACK WindowInitiator::HandleOcclusionEvent(HWINEVENTHOOK, DWORD event, HWND window, LONG object, LONG child, DWORD, DWORD) {
+    WindowInitiator* self = g_occlusionOwner;
+    if (!self || !window) return;
+    Rect rect;
+    if (event == EVENT_OBJECT_REORDER) {
+        if (window != GetDesktopWindow()) return;
+    }
+    else {
+        // Windows below the topmost band cannot come over ours however they are raised
+        if (object != OBJID_WINDOW || child != CHILDID_SELF || GetAncestor(window, GA_ROOT) != window) return;
+        const ObservedWindow observed = Observe(window);
+        if (!CanOcclude(observed)) return;
+        rect = observed.rect;
+    }
+    if (self->m_occlusion.note(rect, MetricsClock())) self->armOcclusionTimer();
+}
+
+void WindowInitiator::armOcclusionTimer() {
+    const uint64_t now = MetricsClock();
+    const uint64_t deadline = m_occlusion.deadline();
+    const UINT delay = static_cast<UINT>(deadline > now ? (deadline - now + 999'999) / 1'000'000 : 0);
+    m_occlusionTimer = SetTimer(nullptr, m_occlusionTimer, (std::max)(delay, static_cast<UINT>(USER_TIMER_MINIMUM)), nullptr);
+}
+
+// One timer tick per settled storm; of the windows it touched, only those
+// something actually covers are restacked
+void WindowInitiator::settleOcclusion() {
+    KillTimer(nullptr, m_occlusionTimer);
+    m_occlusionTimer = 0;
+    std::vector<size_t> affected;
+    if (!m_occlusion.settle(MetricsClock(), affected)) {
+        if (m_occlusion.deadline()) armOcclusionTimer();
+        return;
+    }
+    size_t restacked = 0;
+    for (size_t k : affected) {
+        if (!IsWindow(m_guarded[k]) || !IsCovered(m_guarded[k])) continue;
+        SetWindowPos(m_guarded[k], HWND_TOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE | SWP_NOOWNERZORDER);
+        ++restacked;
+    }
+    g_flightRecorder.record(FlightEvent::Reassert, restacked, affected.size());
+}
+
+bool WindowInitiator::openSession() {
+    if (m_pool) return true;
+    if (!TopologyStore::current()) TopologyStore::refresh();
+
+    // Key and close unblank like --resident; the pool keeps the windows for the next blank
+    m_embedded = true;
+    m_resident.enabled = true;
+    m_sessionThread = GetCurrentThreadId();
+    // Give the thread its message queue before anyone posts to it
+    MSG msg;
+    PeekMessage(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+    registerWindowClass();
+    m_backend = std::make_unique<Win32Backend>(*this);
+    m_pool = std::make_unique<WindowPool>(*m_backend, m_resident.pool);
+    rebuildPool();
+    startOcclusionGuard();
+
+    const DWORD sessionThread = m_sessionThread;
+    TopologyStore::startRefresher([sessionThread] {
+        PostThreadMessage(sessionThread, WM_APP_TOPOLOGY, 0, 0);
+    });
+    return true;
+}
+
+void WindowInitiator::refreshSession() {
+    if (m_pool) rebuildPool();
+}
+
+void WindowInitiator::setSessionBlanked(bool blanked) {
+    if (!m_pool) return;
+    setPoolBlanked(blanked);
+    if (blanked) scheduleOverlayTick();
+}
+
+bool WindowInitiator::sessionBlanked() const {
+    return m_pool && m_pool->blanked();
+}
+
+bool WindowInitiator::pumpSession(int timeoutMs) {
+    const ULONGLONG deadline = GetTickCount64() + static_cast<ULONGLONG>(timeoutMs < 0 ? 0 : timeoutMs);
+    for (;;) {
+        MSG message;
+        while (PeekMessage(&message, nullptr, 0, 0, PM_REMOVE)) {
+            if (message.hwnd == nullptr) {
+                if (message.message == WM_APP_CALL) return true;
+                if (message.message == WM_APP_UNBLANK) {
+                    setPoolBlanked(false);
+                    continue;
+                }
+                if (message.message == WM_APP_TOPOLOGY) {
+                    rebuildPool();
+                    continue;
+                }
+                if (message.message == WM_TIMER && message.wParam == m_overlayTimer) {
+                    tickOverlays();
+                    continue;
+                }
+                if (message.message == WM_TIMER && message.wParam == m_occlusionTimer) {
+                    settleOcclusion();
+                    continue;
+                }
+            }
+            TranslateMessage(&message);
+            DispatchMessage(&message);
+        }
+
+        const ULONGLONG now = GetTickCount64();
+        if (timeoutMs >= 0 && now >= deadline) return false;
+        const DWORD wait = timeoutMs < 0 ? INFINITE : static_cast<DWORD>(deadline - now);
+        g_flightRecorder.idle();
+        MsgWaitForMultipleObjectsEx(0, nullptr, wait, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+        g_flightRecorder.busy();
+    }
+}
+
+void WindowInitiator::wakeSession() {
+    PostThreadMessage(m_sessionThread, WM_APP_CALL, 0, 0);
+}
+
+void WindowInitiator::closeSession() {
+    if (!m_pool) return;
+    TopologyStore::stopRefresher();
+    stopOcclusionGuard();
+    setPoolBlanked(false);
+    m_pool.reset();
+    m_backend.reset();
+    releaseResources();
+}
+
 LRESULT CALLBACK HandleWindowMessages(const HWND windowHandle, const UINT messageType, const WPARAM windowParameterValue, const LPARAM messageData) { // NOLINT(*-misplaced-const)
     switch (messageType) {
+        case WM_NCCREATE: {
+            const auto* createInfo = reinterpret_cast<const CREATESTRUCT*>(messageData);
+            SetWindowLongPtr(windowHandle, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(createInfo->lpCreateParams));
+            return DefWindowProc(windowHandle, messageType, windowParameterValue, messageData);
+        }
+        case WM_DISPLAYCHANGE:
         case WM_CLOSE:
         case WM_DESTROY:
-            PostQuitMessage(0);
-            return 0;
         case WM_KEYDOWN: {
-            if (!WindowInitiator::disableKeyExit) {
-                PostQuitMessage(0);
+            g_flightRecorder.record(FlightEvent::Message, messageType, reinterpret_cast<uintptr_t>(windowHandle));
+            const auto* state = reinterpret_cast<const WindowState*>(GetWindowLongPtr(windowHandle, GWLP_USERDATA));
+            const WindowMessage message = messageType == WM_DISPLAYCHANGE ? WindowMessage::DisplayChange
+                : messageType == WM_CLOSE ? WindowMessage::Close
+                : messageType == WM_DESTROY ? WindowMessage::Destroy : WindowMessage::KeyDown;
+            const WindowResponse response = RespondTo(message, state && state->exitOnKey, state && state->resident);
+
+            // A key press or close starts the unblank clock; WM_DESTROY is already part of the teardown
+            if ((response == WindowResponse::Unblank || response == WindowResponse::Quit) &&
+                message != WindowMessage::Destroy && !g_unblankRequestedAt) {
+                g_unblankRequestedAt = MetricsClock();
+            }
+            switch (response) {
+                case WindowResponse::Unblank:
+                    PostMessage(nullptr, WM_APP_UNBLANK, 0, 0);
+                    return 0;
+                case WindowResponse::Quit:
+                    PostQuitMessage(0);
+                    return 0;
+                case WindowResponse::RefreshTopology:
+                    TopologyStore::requestRefresh();
+                    return DefWindowProc(windowHandle, messageType, windowParameterValue, messageData);
+                default:
+                    return 0;
             }
-            return 0;
         }
         case WM_ERASEBKGND: {
-            RECT clientRect;
-            GetClientRect(windowHandle, &clientRect);
-            HBRUSH colorBrush;
-
-            if (WindowInitiator::m_color == "black") {
-                colorBrush = static_cast<HBRUSH>(GetStockObject(BLACK_BRUSH));
-            } else {
-                if (std::regex_match(WindowInitiator::m_color, std::regex("^#([a-fA-F0-9]{6}|[a-fA-F0-9]{3})$"))) {
-                    auto [red, green, blue] = ColorHandler::convertHextoRGB(WindowInitiator::m_color);
-                    colorBrush = CreateSolidBrush(RGB(red, green, blue));
-                } else {
-                    const auto errorMessage = std::wstring(L"Invalid color argument. Expected a hex color code or color name.");
-                    MessageBox(nullptr, errorMessage.c_str(), L"Error - Black Screen Application", MB_ICONERROR | MB_OK);
-                    throw std::invalid_argument("Invalid color argument. Expected a hex color code or color name.");
-                }
-            }
-
-            FillRect(reinterpret_cast<HDC>(windowParameterValue), &clientRect, colorBrush);
-
-            if (WindowInitiator::m_color != "black") {
-                DeleteObject(colorBrush);
+            const auto* state = reinterpret_cast<const WindowState*>(GetWindowLongPtr(windowHandle, GWLP_USERDATA));
+            if (!state) {
+                return DefWindowProc(windowHandle, messageType, windowParameterValue, messageData);
             }
-
+            // Only what the clip box covers is repainted: the whole window, or the overlay cells a tick invalidated
+            const HDC deviceContext = reinterpret_cast<HDC>(windowParameterValue);
+            RECT clip;
+            if (GetClipBox(deviceContext, &clip) == NULLREGION) return 1;
+            GdiRenderer renderer(deviceContext, state->brush);
+            PaintWindow(renderer, { state->client.right, state->client.bottom, state->color, state->backdrop, state->overlay },
+                toRect(clip));
+            g_metrics.recordPaint(state->monitor);
             return 1;
         }
         default:
             return DefWindowProc(windowHandle, messageType, windowParameterValue, messageData);
     }
 }
-
-
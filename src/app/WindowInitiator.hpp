@@ -14,28 +14,139 @@
 #include <wingdi.h>
 #include <setupapi.h>
 #include <devguid.h>
+#include <memory>
+#include <tuple>
 
+#include "CommandLine.hpp"
+#include "ImageBackdrop.hpp"
 #include "MonitorDetection.hpp"
+#include "MonitorSelector.hpp"
+#include "OcclusionGuard.hpp"
+#include "RectSet.hpp"
+#include "Selection.hpp"
+#include "Spotlight.hpp"
+#include "TestPattern.hpp"
+#include "TextOverlay.hpp"
+#include "WindowBackend.hpp"
+#include "WindowPool.hpp"
+#include "WindowState.hpp"
+
+struct Topology;
 
 
 
 // Declare as extern � define in .cpp
 extern std::vector<HWND> g_windowHandles;
 
+// Thread messages driving a resident instance
+constexpr UINT WM_APP_UNBLANK = WM_APP + 1;
+constexpr UINT WM_APP_TOPOLOGY = WM_APP + 2;
+constexpr UINT WM_APP_FLEET = WM_APP + 3;
+constexpr UINT WM_APP_CALL = WM_APP + 4;       // wakeSession()
+
 
 
 class WindowInitiator {
 public:
-    static std::string m_color;
-    static bool disableKeyExit;
+    explicit WindowInitiator(InitiatorOptions options);
+    ~WindowInitiator();
+    void createWindow();
+
+    // In-process blanking for BlackScreen.h. The windows belong to the thread
+    // that calls openSession(); it must keep calling pumpSession() between
+    // the other calls. Errors never show a dialog in a session.
+    bool openSession();
+    void refreshSession();                  // after setColor() or setMonitorQueries()
+    // Session settings, applied by refreshSession()
+    void setColor(const std::tuple<int, int, int>& color) { m_color = color; }
+    void setMonitorQueries(std::vector<MonitorQuery> queries) { m_monitorQueries = std::move(queries); }
+    void setSessionBlanked(bool blanked);
+    bool sessionBlanked() const;
+    // Dispatches messages for up to timeoutMs (-1 = until woken); true when wakeSession() ended the wait
+    bool pumpSession(int timeoutMs);
+    void wakeSession();                     // any thread
+    void closeSession();
+
+private:
+    class Win32Backend;
+    class GdiRasterizer;
+
+    struct OverlaySlot {
+        UINT dpi;
+        std::tuple<int, int, int> background;
+        std::unique_ptr<TextOverlay> overlay;
+    };
+
+    std::tuple<int, int, int> m_color;
+    int m_opacity;
+    bool m_disableKeyExit;
     std::vector<int> m_monitorIndices;      // For -m
     std::vector<std::string> m_monitorPatterns; // For -M
-    
+    std::vector<MonitorQuery> m_monitorQueries; // For -q
+    BlankMask m_mask;
+    std::vector<MonitorStyle> m_styles;
+    ResidentOptions m_resident;
+    OverlayOptions m_overlay;
+    ImageOptions m_image;
+    std::vector<MonitorPattern> m_patterns; // For --pattern
+    SpotlightOptions m_spotlight;
 
-    explicit WindowInitiator(std::string color, const bool& disableKeyExit,
-        std::vector<int> monitorIndices = { -1 },
-        std::vector<std::string> monitorPatterns = {});
-    void createWindow();
+    static constexpr int kHotkeyToggle = 1;
+    static constexpr int kHotkeyQuit = 2;
+
+    void registerWindowClass();
+    void releaseResources();
+    void rebuildPool();
+    void setPoolBlanked(bool blanked);
+    bool selectMonitors(const Topology& topology, std::vector<MonitorData>& targetMonitors) const;
+    std::vector<WindowTarget> layout(const Topology& topology, const std::vector<MonitorData>& targetMonitors) const;
+    HWND openWindow(const WindowTarget& target);
+    void closeWindow(HWND windowHandle);
+    void runResident();
+    bool startSpotlight();
+    void stopSpotlight();
+    void moveSpotlight(const Rect& hole);
+    void startOcclusionGuard();
+    void stopOcclusionGuard();
+    void guardWindows();                // after the shown windows or their rects change
+    void settleOcclusion();
+    void armOcclusionTimer();
+    static void CALLBACK HandleOcclusionEvent(HWINEVENTHOOK hook, DWORD event, HWND window, LONG object, LONG child,
+        DWORD thread, DWORD time);
+    HBRUSH brushFor(const std::tuple<int, int, int>& color);
+    const TextOverlay* overlayFor(UINT dpi, const std::tuple<int, int, int>& background);
+    void tickOverlays();
+    void scheduleOverlayTick();
+    bool prepareBackdrops(const std::vector<WindowTarget>& targets);
+    const Backdrop* backdropFor(TestPattern pattern, long width, long height) const;
+
+    std::vector<std::unique_ptr<WindowState>> m_windowStates;
+    std::vector<std::pair<COLORREF, HBRUSH>> m_brushes;
+    std::unique_ptr<GdiRasterizer> m_rasterizer;
+    std::unique_ptr<GlyphAtlasCache> m_atlases;
+    std::vector<OverlaySlot> m_overlays;
+    UINT_PTR m_overlayTimer = 0;
+    BackdropCache m_backdrops;
+    PatternCache m_patternCache;
+    bool m_solidCycle = false;          // some --pattern is solid-cycle, so the tick steps colors
+
+    // Resident pool, for --resident and sessions; the backend outlives the pool
+    std::unique_ptr<Win32Backend> m_backend;
+    std::unique_ptr<WindowPool> m_pool;
+    std::vector<int> m_blankKeys;
+    bool m_embedded = false;            // a BlackScreen.h session
+    DWORD m_sessionThread = 0;
+
+    // --spotlight: the pool's layout split around the tracked window
+    Spotlight m_spotlightLayout;
+    std::unique_ptr<WindowEventSource> m_spotlightEvents;
+
+    // Topmost windows can still be covered by other topmost ones; WinEvent
+    // hooks report windows coming forward and the guard picks which to restack
+    OcclusionGuard m_occlusion;
+    std::vector<HWND> m_guarded;        // the shown windows, in the guard's order
+    std::vector<HWINEVENTHOOK> m_occlusionHooks;
+    UINT_PTR m_occlusionTimer = 0;
 };
 
 
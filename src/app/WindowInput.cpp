@@ -0,0 +1,22 @@
+#include "WindowInput.hpp"
+
+WindowResponse RespondTo(WindowMessage message, bool exitOnKey, bool resident) {
+    switch (message) {
+        case WindowMessage::KeyDown:
+            if (!exitOnKey) return WindowResponse::Ignore;
+            return resident ? WindowResponse::Unblank : WindowResponse::Quit;
+        case WindowMessage::Close:
+            // Resident windows only hide; the process lives on for the next blank
+            return resident ? WindowResponse::Unblank : WindowResponse::Quit;
+        case WindowMessage::Destroy:
+            // The pool destroys resident windows on topology changes
+            return resident ? WindowResponse::Ignore : WindowResponse::Quit;
+        case WindowMessage::DisplayChange:
+            return WindowResponse::RefreshTopology;
+        case WindowMessage::Paint:
+            return WindowResponse::Repaint;
+        case WindowMessage::MouseMove:
+            break;
+    }
+    return WindowResponse::Default;
+}
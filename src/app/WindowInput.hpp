@@ -0,0 +1,22 @@
+#pragma once
+#ifndef WINDOWINPUT_HPP
+#define WINDOWINPUT_HPP
+
+// Messages a blanking window reacts to, named after their Win32 counterparts
+enum class WindowMessage { KeyDown, Close, Destroy, DisplayChange, MouseMove, Paint };
+
+// What the window procedure does about one
+enum class WindowResponse {
+    Ignore,             // handled, nothing to do
+    Default,            // left to the platform default
+    Repaint,            // paint the invalidated area
+    Unblank,            // resident: hide the windows, keep running
+    Quit,               // leave the message loop and destroy the windows
+    RefreshTopology     // re-enumerate monitors, then the default
+};
+
+// The decision part of the window procedure, kept free of Win32 so floods of
+// messages can be replayed against it anywhere
+WindowResponse RespondTo(WindowMessage message, bool exitOnKey, bool resident);
+
+#endif // WINDOWINPUT_HPP
@@ -0,0 +1,199 @@
+#include "WindowPool.hpp"
+
+#include <algorithm>
+
+#include "Metrics.hpp"
+
+WindowPool::WindowPool(WindowBackend& backend, PoolPolicy policy)
+    : m_backend(backend), m_policy(policy) {
+}
+
+WindowPool::~WindowPool() {
+    for (const Slot& slot : m_slots) {
+        m_backend.destroy(slot.window);
+    }
+}
+
+void WindowPool::sync(const std::vector<WindowTarget>& targets) {
+    m_targets = targets;
+
+    std::erase_if(m_slots, [this](Slot& slot) {
+        const WindowTarget* target = findTarget(slot.target.key);
+        if (!target) {
+            m_backend.destroy(slot.window);
+            return true;
+        }
+        if (target->color != slot.target.color || target->opacity != slot.target.opacity || target->pattern != slot.target.pattern) {
+            // Color, opacity and pattern are fixed at creation, so restyling means a new window
+            const bool shown = slot.state == SlotState::Shown;
+            m_backend.destroy(slot.window);
+            if (target->rect.empty()) return true;
+            slot.window = m_backend.create(*target);
+            if (!slot.window) return true;
+            if (shown) m_backend.show(slot.window);
+            slot.target = *target;
+            return false;
+        }
+        place(slot, *target);
+        return false;
+    });
+    std::erase_if(m_blanked, [this](int key) { return !findTarget(key); });
+
+    rebalance();
+}
+
+void WindowPool::reshape(const std::vector<WindowTarget>& changed) {
+    for (const WindowTarget& target : changed) {
+        auto known = std::ranges::find(m_targets, target.key, &WindowTarget::key);
+        if (known == m_targets.end()) continue;
+        *known = target;
+
+        if (Slot* slot = find(target.key)) {
+            place(*slot, target);
+            continue;
+        }
+        // Empty when the blank started, so it never had a window
+        if (target.rect.empty() || std::ranges::find(m_blanked, target.key) == m_blanked.end()) continue;
+        WindowBackend::Handle window = m_backend.create(target);
+        if (!window) continue;
+        g_metrics.poolCreates.fetch_add(1, std::memory_order_relaxed);
+        m_slots.push_back({ target, window, SlotState::Shown });
+        m_backend.show(window);
+    }
+}
+
+// Moves the slot's window to target's rect; an empty rect hides a shown window instead
+void WindowPool::place(Slot& slot, const WindowTarget& target) {
+    const bool wasVisible = slot.state == SlotState::Shown && !slot.target.rect.empty();
+    const bool visible = slot.state == SlotState::Shown && !target.rect.empty();
+    if (!target.rect.empty() && target.rect != slot.target.rect) m_backend.move(slot.window, target.rect);
+    if (wasVisible && !visible) m_backend.hide(slot.window);
+    if (visible && !wasVisible) m_backend.show(slot.window);
+    slot.target = target;
+}
+
+void WindowPool::blank(const std::vector<int>& keys) {
+    // Nothing is shown until every window exists, so slow creates do not stagger the screens
+    std::vector<int> revealKeys;
+    for (int key : keys) {
+        const WindowTarget* target = findTarget(key);
+        if (!target) continue;
+        ++m_uses[key];
+        if (target->rect.empty()) {
+            // Nothing to show until reshape gives it an area
+            if (Slot* parked = find(key)) parked->state = SlotState::Shown;
+            if (std::ranges::find(m_blanked, key) == m_blanked.end()) m_blanked.push_back(key);
+            continue;
+        }
+
+        const Slot* slot = find(key);
+        if ((slot && slot->state == SlotState::Shown) || std::ranges::find(revealKeys, key) != revealKeys.end()) continue;
+        if (slot) {
+            g_metrics.poolFlips.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            const uint64_t start = MetricsClock();
+            WindowBackend::Handle window = m_backend.create(*target);
+            if (!window) continue;
+            m_slots.push_back({ *target, window, SlotState::Warm });
+            g_metrics.poolCreates.fetch_add(1, std::memory_order_relaxed);
+            g_metrics.poolCreateTime.record(MetricsClock() - start);
+        }
+        revealKeys.push_back(key);
+    }
+    if (revealKeys.empty()) return;
+
+    std::vector<WindowBackend::Handle> windows;
+    for (int key : revealKeys) {
+        Slot* slot = find(key);
+        windows.push_back(slot->window);
+        slot->state = SlotState::Shown;
+        if (std::ranges::find(m_blanked, key) == m_blanked.end()) m_blanked.push_back(key);
+    }
+    const uint64_t start = MetricsClock();
+    m_backend.reveal(windows);
+    g_metrics.poolRevealTime.record(MetricsClock() - start);
+}
+
+void WindowPool::blankAll() {
+    std::vector<int> keys;
+    for (const WindowTarget& target : m_targets) keys.push_back(target.key);
+    blank(keys);
+}
+
+void WindowPool::unblank() {
+    for (Slot& slot : m_slots) {
+        if (slot.state == SlotState::Shown) {
+            if (!slot.target.rect.empty()) m_backend.hide(slot.window);
+            slot.state = SlotState::Warm;
+        }
+    }
+    m_blanked.clear();
+    // Usage counts moved on, so the warm set may have changed
+    rebalance();
+}
+
+bool WindowPool::blanked() const {
+    return !m_blanked.empty();
+}
+
+std::vector<int> WindowPool::wantedKeys() const {
+    std::vector<int> keys;
+    for (const WindowTarget& target : m_targets) keys.push_back(target.key);
+    if (m_policy.mostUsed == 0 || keys.size() <= m_policy.mostUsed) return keys;
+
+    // Most blanked first; layout order breaks ties so the choice is stable
+    std::ranges::stable_sort(keys, [this](int a, int b) {
+        const auto usesA = m_uses.contains(a) ? m_uses.at(a) : 0;
+        const auto usesB = m_uses.contains(b) ? m_uses.at(b) : 0;
+        return usesA > usesB;
+    });
+    keys.resize(m_policy.mostUsed);
+    return keys;
+}
+
+void WindowPool::rebalance() {
+    const std::vector<int> wanted = wantedKeys();
+
+    // Shown windows stay until unblank; warm windows outside the policy go
+    std::erase_if(m_slots, [this, &wanted](const Slot& slot) {
+        if (slot.state == SlotState::Shown || std::ranges::find(wanted, slot.target.key) != wanted.end()) return false;
+        m_backend.destroy(slot.window);
+        return true;
+    });
+
+    for (int key : wanted) {
+        if (find(key)) continue;
+        const WindowTarget* target = findTarget(key);
+        if (target->rect.empty()) continue;
+        WindowBackend::Handle window = m_backend.create(*target);
+        if (window) {
+            m_slots.push_back({ *target, window, SlotState::Warm });
+        }
+    }
+}
+
+WindowPool::Slot* WindowPool::find(int key) {
+    auto it = std::ranges::find(m_slots, key, [](const Slot& slot) { return slot.target.key; });
+    return it == m_slots.end() ? nullptr : &*it;
+}
+
+const WindowTarget* WindowPool::findTarget(int key) const {
+    auto it = std::ranges::find(m_targets, key, &WindowTarget::key);
+    return it == m_targets.end() ? nullptr : &*it;
+}
+
+void RevealTracker::begin(const std::vector<WindowBackend::Handle>& windows) {
+    m_waiting = windows;
+    m_first = UINT64_MAX;
+    m_last = 0;
+}
+
+bool RevealTracker::mark(WindowBackend::Handle window, uint64_t nanos) {
+    auto it = std::ranges::find(m_waiting, window);
+    if (it == m_waiting.end()) return false;
+    m_waiting.erase(it);
+    m_first = (std::min)(m_first, nanos);
+    m_last = (std::max)(m_last, nanos);
+    return m_waiting.empty();
+}
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef WINDOWPOOL_HPP
+#define WINDOWPOOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "WindowBackend.hpp"
+
+// Which targets keep a hidden, pre-sized window between blank requests
+struct PoolPolicy {
+    size_t mostUsed = 0;        // 0 = every target, otherwise the N most blanked
+};
+
+// Keeps blanking windows warm (created, sized, hidden) so a blank request
+// only flips visibility. Each slot is either Warm (hidden) or Shown; targets
+// outside the policy get a window on demand that is dropped on unblank.
+// Flips, creates and their timings are counted in g_metrics.
+class WindowPool {
+public:
+    enum class SlotState { Warm, Shown };
+
+    struct Slot {
+        WindowTarget target;
+        WindowBackend::Handle window;
+        SlotState state;
+    };
+
+    WindowPool(WindowBackend& backend, PoolPolicy policy);
+    ~WindowPool();
+    WindowPool(const WindowPool&) = delete;
+    WindowPool& operator=(const WindowPool&) = delete;
+
+    // Adopts a new layout: drops vanished targets, moves or restyles changed ones, warms the rest
+    void sync(const std::vector<WindowTarget>& targets);
+    // Applies new rects to some targets of the last sync, touching only their
+    // windows. A target with an empty rect keeps its slot with the window
+    // hidden and gets it back, shown if blanked, once its rect is non-empty.
+    void reshape(const std::vector<WindowTarget>& changed);
+
+    // Creates whatever is missing hidden first, then reveals every window in one batch
+    void blank(const std::vector<int>& keys);
+    void blankAll();
+    void unblank();
+
+    bool blanked() const;
+    const std::vector<Slot>& slots() const { return m_slots; }
+
+private:
+    std::vector<int> wantedKeys() const;
+    void rebalance();
+    void place(Slot& slot, const WindowTarget& target);
+    Slot* find(int key);
+    const WindowTarget* findTarget(int key) const;
+
+    WindowBackend& m_backend;
+    PoolPolicy m_policy;
+    std::vector<WindowTarget> m_targets;
+    std::vector<Slot> m_slots;
+    std::vector<int> m_blanked;                 // keys of the current blank, windowless ones included
+    std::unordered_map<int, uint64_t> m_uses;   // per key, survives slot removal
+};
+
+// Times one batched reveal: when each window turned black, and the spread
+// between the first and the last. Backends mark windows as they learn of it
+// (after an uncloak, or on the first expose).
+class RevealTracker {
+public:
+    void begin(const std::vector<WindowBackend::Handle>& windows);
+    // true when window was the last one outstanding; unknown or repeated marks are ignored
+    bool mark(WindowBackend::Handle window, uint64_t nanos);
+
+    bool pending() const { return !m_waiting.empty(); }
+    uint64_t skew() const { return m_last > m_first ? m_last - m_first : 0; }
+
+private:
+    std::vector<WindowBackend::Handle> m_waiting;
+    uint64_t m_first = 0;
+    uint64_t m_last = 0;
+};
+
+#endif // WINDOWPOOL_HPP
@@ -0,0 +1,30 @@
+#pragma once
+#ifndef WINDOWSTATE_HPP
+#define WINDOWSTATE_HPP
+
+#include <cstdint>
+#include <windows.h>
+
+#include "TestPattern.hpp"
+
+class TextOverlay;
+struct Backdrop;
+
+// Everything the window procedure needs for one blanking window, resolved
+// before CreateWindowEx and handed over through lpParam. WM_NCCREATE stores
+// the pointer in GWLP_USERDATA, so painting is one pointer load away from
+// a ready brush. The owner keeps the record alive until the window is gone.
+struct WindowState {
+    HBRUSH brush;       // shared per color, owned by WindowInitiator
+    uint32_t color;     // the brush color, 0x00RRGGBB
+    RECT client;        // client area, updated when the pool moves the window
+    BYTE alpha;         // 255 = opaque, otherwise WS_EX_LAYERED alpha
+    bool exitOnKey;
+    bool resident;      // key/close unblanks instead of quitting
+    int monitor;        // table position for per-monitor metrics, -1 if none
+    const TextOverlay* overlay;     // text block centred on the window, shared per DPI and color; may be null
+    const Backdrop* backdrop;       // --pattern bitmap or --image scaled for the window size, centred; may be null
+    TestPattern pattern;            // solid-cycle windows get a new brush and color each step
+};
+
+#endif // WINDOWSTATE_HPP
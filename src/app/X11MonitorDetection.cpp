@@ -0,0 +1,70 @@
+#include "MonitorDetection.hpp"
+
+#include <X11/Xlib.h>
+#include <X11/extensions/Xrandr.h>
+
+#include "DisplayCapture.hpp"
+
+namespace {
+    // Single X screen: every monitor hangs off the same adapter, its source
+    // mode placed at the monitor's origin
+    void AddMonitor(DisplayCapture& capture, const RECT& rect, bool primary, const std::string& name) {
+        const uint32_t id = static_cast<uint32_t>(capture.monitors.size());
+        capture.paths.push_back({ 1, id, id, static_cast<uint32_t>(capture.modes.size()), DisplayCapture::kPathActive, name });
+        capture.modes.push_back({ DisplayCapture::kModeSource, id, 1, static_cast<int32_t>(rect.left), static_cast<int32_t>(rect.top),
+            static_cast<uint32_t>(rect.right - rect.left), static_cast<uint32_t>(rect.bottom - rect.top) });
+        capture.monitors.push_back({ rect, primary });
+    }
+}
+
+// RandR 1.5 monitors: one per active output group, including monitors defined
+// with xrandr --setmonitor, so synthetic layouts work on a plain Xvfb screen
+DisplayCapture CaptureDisplay() {
+    DisplayCapture capture;
+
+    // A private connection keeps enumeration safe on the refresher thread
+    Display* display = XOpenDisplay(nullptr);
+    if (!display) return capture;
+
+    const Window root = DefaultRootWindow(display);
+    int eventBase = 0, errorBase = 0, major = 0, minor = 0;
+    if (XRRQueryExtension(display, &eventBase, &errorBase) && XRRQueryVersion(display, &major, &minor) &&
+        (major > 1 || (major == 1 && minor >= 5))) {
+        int count = 0;
+        XRRMonitorInfo* monitors = XRRGetMonitors(display, root, True, &count);
+        XRRScreenResources* resources = nullptr;
+        for (int i = 0; i < count; ++i) {
+            const XRRMonitorInfo& m = monitors[i];
+            std::string name = "Unknown Monitor";
+            if (char* atomName = m.name != 0 ? XGetAtomName(display, m.name) : nullptr) {
+                name = atomName;
+                XFree(atomName);
+            }
+            else if (m.noutput > 0) {
+                // An unnamed monitor goes by its first output, so clones at one origin stay apart
+                if (!resources) resources = XRRGetScreenResourcesCurrent(display, root);
+                if (XRROutputInfo* output = resources ? XRRGetOutputInfo(display, resources, m.outputs[0]) : nullptr) {
+                    name.assign(output->name, static_cast<size_t>(output->nameLen));
+                    XRRFreeOutputInfo(output);
+                }
+            }
+            AddMonitor(capture, { m.x, m.y, m.x + m.width, m.y + m.height }, m.primary != 0, name);
+        }
+        if (resources) XRRFreeScreenResources(resources);
+        if (monitors) XRRFreeMonitors(monitors);
+    }
+
+    // No RandR 1.5: treat the whole screen as one monitor
+    if (capture.monitors.empty()) {
+        const int screen = DefaultScreen(display);
+        AddMonitor(capture, { 0, 0, DisplayWidth(display, screen), DisplayHeight(display, screen) }, true,
+            "Screen " + std::to_string(screen));
+    }
+
+    XCloseDisplay(display);
+    return capture;
+}
+
+std::vector<MonitorData> EnumerateMonitorsWithNames() {
+    return MatchDisplayCapture(CaptureDisplay());
+}
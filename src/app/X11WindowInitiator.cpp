@@ -0,0 +1,1067 @@
+#include "X11WindowInitiator.hpp"
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/Xrandr.h>
+#include <X11/keysym.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+#include "FleetServer.hpp"
+#include "FlightRecorder.hpp"
+#include "Metrics.hpp"
+#include "Topology.hpp"
+#include "WindowInput.hpp"
+#include "WindowPool.hpp"
+
+extern std::string ToLower(const std::string& str);
+
+namespace {
+    // Self-pipe waking the event loop: 't' after a topology refresh, 'f' for queued
+    // --listen requests, 'c' for a session call, 'q' on SIGINT/SIGTERM
+    int g_wakePipe[2] = { -1, -1 };
+
+    // When the current unblank was requested (key press), 0 if none; UI thread only
+    uint64_t g_unblankRequestedAt = 0;
+
+    void Wake(char reason) {
+        if (g_wakePipe[1] >= 0) {
+            [[maybe_unused]] const ssize_t written = write(g_wakePipe[1], &reason, 1);
+        }
+    }
+
+    void HandleQuitSignal(int) {
+        Wake('q');
+    }
+
+    // A failed grab or a window destroyed under us must not abort the process
+    int HandleXError(Display* display, XErrorEvent* error) {
+        char text[256];
+        XGetErrorText(display, error->error_code, text, sizeof(text));
+        g_flightRecorder.recordText(FlightEvent::Error, text);
+        std::cerr << "X error: " << text << " (request " << static_cast<int>(error->request_code) << ")\n";
+        return 0;
+    }
+
+    constexpr unsigned int kHotkeyModifiers = ControlMask | Mod1Mask;
+    // Lock modifiers that must not stop the hotkeys from matching
+    constexpr unsigned int kIgnoredModifiers[] = { 0, LockMask, Mod2Mask, LockMask | Mod2Mask };
+
+    // A 32-bit format property (window lists, the active window); empty if unset
+    std::vector<Window> WindowListProperty(Display* display, Window window, const char* name) {
+        Atom type = 0;
+        int format = 0;
+        unsigned long count = 0, remaining = 0;
+        unsigned char* data = nullptr;
+        std::vector<Window> windows;
+        if (XGetWindowProperty(display, window, XInternAtom(display, name, False), 0, 4096, False, XA_WINDOW,
+                &type, &format, &count, &remaining, &data) == Success && data) {
+            if (type == XA_WINDOW && format == 32) {
+                const auto* values = reinterpret_cast<const unsigned long*>(data);
+                windows.assign(values, values + count);
+            }
+            XFree(data);
+        }
+        return windows;
+    }
+
+    // _NET_WM_NAME (UTF-8), else WM_NAME
+    std::string WindowTitle(Display* display, Window window) {
+        std::string title;
+        Atom type = 0;
+        int format = 0;
+        unsigned long count = 0, remaining = 0;
+        unsigned char* data = nullptr;
+        if (XGetWindowProperty(display, window, XInternAtom(display, "_NET_WM_NAME", False), 0, 1024, False,
+                XInternAtom(display, "UTF8_STRING", False), &type, &format, &count, &remaining, &data) == Success && data) {
+            if (format == 8) title.assign(reinterpret_cast<const char*>(data), count);
+            XFree(data);
+        }
+        char* name = nullptr;
+        if (title.empty() && XFetchName(display, window, &name) && name) {
+            title = name;
+            XFree(name);
+        }
+        return title;
+    }
+
+    // --spotlight target: the active window, or the first managed window whose title contains title (any case)
+    Window FindSpotlightWindow(Display* display, const std::string& title) {
+        const Window root = DefaultRootWindow(display);
+        if (title.empty()) {
+            const std::vector<Window> active = WindowListProperty(display, root, "_NET_ACTIVE_WINDOW");
+            if (!active.empty() && active.front()) return active.front();
+            Window focus = 0;
+            int revert = 0;
+            XGetInputFocus(display, &focus, &revert);
+            return focus == PointerRoot ? 0 : focus;
+        }
+        const std::string wanted = ToLower(title);
+        for (Window window : WindowListProperty(display, root, "_NET_CLIENT_LIST")) {
+            if (ToLower(WindowTitle(display, window)).find(wanted) != std::string::npos) return window;
+        }
+        return 0;
+    }
+}
+
+// Glyph coverage from server-side core fonts, drawn into a 1-bit pixmap and
+// read back once per glyph. Core fonts are bitmaps, so coverage is 0 or 255.
+class X11WindowInitiator::CoreFontRasterizer : public GlyphRasterizer {
+public:
+    explicit CoreFontRasterizer(Display* display) : m_display(display) {}
+    ~CoreFontRasterizer() override {
+        for (const auto& [height, font] : m_fonts) {
+            if (font) XFreeFont(m_display, font);
+        }
+    }
+
+    bool rasterize(char32_t codePoint, int pixelHeight, Glyph& glyph, std::vector<uint8_t>& coverage) override {
+        XFontStruct* font = fontFor(pixelHeight);
+        if (!font || codePoint > 0xFFFF) return false;
+
+        const unsigned int high = codePoint >> 8;
+        const unsigned int low = codePoint & 0xFF;
+        if (!hasGlyph(font, high, low)) return false;
+
+        XChar2b character = { static_cast<unsigned char>(high), static_cast<unsigned char>(low) };
+        int direction = 0, ascent = 0, descent = 0;
+        XCharStruct extents = {};
+        XTextExtents16(font, &character, 1, &direction, &ascent, &descent, &extents);
+
+        // Centre the font's line in the requested height
+        const int lineOffset = (pixelHeight - (font->ascent + font->descent)) / 2;
+        glyph.advance = extents.width;
+        glyph.left = extents.lbearing;
+        glyph.top = lineOffset + font->ascent - extents.ascent;
+        glyph.width = (std::max)(0, extents.rbearing - extents.lbearing);
+        glyph.height = (std::max)(0, extents.ascent + extents.descent);
+        coverage.clear();
+        if (glyph.width == 0 || glyph.height == 0) {
+            glyph.width = glyph.height = 0;
+            return true;
+        }
+
+        const Pixmap pixmap = XCreatePixmap(m_display, DefaultRootWindow(m_display),
+            static_cast<unsigned int>(glyph.width), static_cast<unsigned int>(glyph.height), 1);
+        const GC gc = XCreateGC(m_display, pixmap, 0, nullptr);
+        XSetForeground(m_display, gc, 0);
+        XFillRectangle(m_display, pixmap, gc, 0, 0, static_cast<unsigned int>(glyph.width), static_cast<unsigned int>(glyph.height));
+        XSetForeground(m_display, gc, 1);
+        XSetFont(m_display, gc, font->fid);
+        XDrawString16(m_display, pixmap, gc, -extents.lbearing, extents.ascent, &character, 1);
+
+        XImage* image = XGetImage(m_display, pixmap, 0, 0, static_cast<unsigned int>(glyph.width),
+            static_cast<unsigned int>(glyph.height), 1, XYPixmap);
+        if (image) {
+            coverage.resize(static_cast<size_t>(glyph.width) * glyph.height);
+            for (int y = 0; y < glyph.height; ++y) {
+                for (int x = 0; x < glyph.width; ++x) {
+                    coverage[static_cast<size_t>(y) * glyph.width + x] = XGetPixel(image, x, y) ? 255 : 0;
+                }
+            }
+            XDestroyImage(image);
+        }
+        XFreeGC(m_display, gc);
+        XFreePixmap(m_display, pixmap);
+        return image != nullptr;
+    }
+
+private:
+    XFontStruct* fontFor(int pixelHeight) {
+        for (const auto& [height, font] : m_fonts) {
+            if (height == pixelHeight) return font;
+        }
+
+        // Scalable Unicode fonts first, then whatever the server calls "fixed"
+        char sans[128], any[128];
+        snprintf(sans, sizeof(sans), "-*-dejavu sans-medium-r-normal--%d-*-*-*-p-*-iso10646-1", pixelHeight);
+        snprintf(any, sizeof(any), "-*-*-medium-r-normal--%d-*-*-*-*-*-iso10646-1", pixelHeight);
+        XFontStruct* font = nullptr;
+        for (const char* pattern : { static_cast<const char*>(sans), static_cast<const char*>(any), "fixed" }) {
+            if ((font = XLoadQueryFont(m_display, pattern))) break;
+        }
+        m_fonts.emplace_back(pixelHeight, font);
+        return font;
+    }
+
+    static bool hasGlyph(const XFontStruct* font, unsigned int high, unsigned int low) {
+        if (high < font->min_byte1 || high > font->max_byte1 ||
+            low < font->min_char_or_byte2 || low > font->max_char_or_byte2) {
+            return false;
+        }
+        if (!font->per_char) return true;
+        const unsigned int columns = font->max_char_or_byte2 - font->min_char_or_byte2 + 1;
+        const XCharStruct& c = font->per_char[(high - font->min_byte1) * columns + (low - font->min_char_or_byte2)];
+        return c.width != 0 || c.ascent != 0 || c.descent != 0 || c.lbearing != 0 || c.rbearing != 0;
+    }
+
+    Display* m_display;
+    std::vector<std::pair<int, XFontStruct*>> m_fonts;
+};
+
+// Where a window shows its overlay: centred in the window
+static Rect OverlayBlock(long windowWidth, long windowHeight, const TextOverlay& overlay) {
+    const long left = (windowWidth - overlay.width()) / 2;
+    const long top = (windowHeight - overlay.height()) / 2;
+    return { left, top, left + overlay.width(), top + overlay.height() };
+}
+
+// Pool backend on top of override-redirect windows
+class X11WindowInitiator::X11Backend : public WindowBackend {
+public:
+    explicit X11Backend(X11WindowInitiator& owner) : m_owner(owner) {}
+
+    Handle create(const WindowTarget& target) override {
+        const unsigned long window = m_owner.openWindow(target);
+        return window ? reinterpret_cast<Handle>(window) : nullptr;
+    }
+    void destroy(Handle window) override {
+        m_owner.closeWindow(reinterpret_cast<unsigned long>(window));
+    }
+    void move(Handle window, const Rect& rect) override {
+        for (X11Window& entry : m_owner.m_windows) {
+            if (entry.window != reinterpret_cast<unsigned long>(window)) continue;
+            entry.rect = rect;
+            if (const unsigned long pixmap = m_owner.backdropPixmapFor(rect, entry.background, entry.pattern)) {
+                XSetWindowBackgroundPixmap(m_owner.m_display, entry.window, pixmap);
+            }
+        }
+        XMoveResizeWindow(m_owner.m_display, reinterpret_cast<unsigned long>(window), rect.left, rect.top,
+            static_cast<unsigned int>(rect.width()), static_cast<unsigned int>(rect.height()));
+    }
+    void show(Handle window) override {
+        XMapRaised(m_owner.m_display, reinterpret_cast<unsigned long>(window));
+    }
+    void hide(Handle window) override {
+        XUnmapWindow(m_owner.m_display, reinterpret_cast<unsigned long>(window));
+    }
+    // The maps leave in one request buffer, so the server handles them back to back
+    void reveal(const std::vector<Handle>& windows) override {
+        m_owner.m_reveal.begin(windows);
+        for (Handle window : windows) {
+            XMapRaised(m_owner.m_display, reinterpret_cast<unsigned long>(window));
+        }
+        XFlush(m_owner.m_display);
+    }
+
+private:
+    X11WindowInitiator& m_owner;
+};
+
+X11WindowInitiator::X11WindowInitiator(InitiatorOptions options)
+    : m_color(options.color),
+    m_opacity(options.opacity),
+    m_disableKeyExit(options.disableKeyExit),
+    m_monitorIndices(std::move(options.monitorIndices)),
+    m_monitorPatterns(std::move(options.monitorPatterns)),
+    m_monitorQueries(std::move(options.monitorQueries)),
+    m_mask(std::move(options.mask)),
+    m_styles(std::move(options.styles)),
+    m_resident(std::move(options.resident)),
+    m_overlay(std::move(options.overlay)),
+    m_image(std::move(options.image)),
+    m_patterns(std::move(options.patterns)),
+    m_spotlight(std::move(options.spotlight)),
+    m_solidCycle(std::ranges::any_of(m_patterns, [](const MonitorPattern& pattern) {
+        return pattern.pattern == TestPattern::SolidCycle;
+    }))
+    {
+}
+
+// Follows one client window: StructureNotify on it and on the window
+// manager's frame around it reports moves, resizes, maps, unmaps and
+// destruction, and the frame's rect (title bar included) is read back after each
+class X11WindowInitiator::X11WindowEvents : public WindowEventSource {
+public:
+    X11WindowEvents(Display* display, Window client) : m_display(display), m_client(client), m_frame(client) {}
+    ~X11WindowEvents() override { stop(); }
+
+    bool start(Listener listener) override {
+        // Window managers move the frame, the client's ancestor just below the root
+        const Window root = DefaultRootWindow(m_display);
+        for (Window window = m_client;;) {
+            Window rootReturn = 0, parent = 0;
+            Window* children = nullptr;
+            unsigned int count = 0;
+            if (!XQueryTree(m_display, window, &rootReturn, &parent, &children, &count)) return false;
+            if (children) XFree(children);
+            if (parent == root || !parent) {
+                m_frame = window;
+                break;
+            }
+            window = parent;
+        }
+        XSelectInput(m_display, m_client, StructureNotifyMask);
+        if (m_frame != m_client) XSelectInput(m_display, m_frame, StructureNotifyMask);
+        m_listener = std::move(listener);
+        m_listener(currentRect());
+        return true;
+    }
+
+    void stop() override {
+        if (m_listener && !m_gone) {
+            XSelectInput(m_display, m_client, NoEventMask);
+            if (m_frame != m_client) XSelectInput(m_display, m_frame, NoEventMask);
+        }
+        m_listener = {};
+    }
+
+    // true when event was about the tracked window
+    bool handle(const XEvent& event) {
+        if (!m_listener || m_gone || (event.xany.window != m_client && event.xany.window != m_frame)) return false;
+        switch (event.type) {
+            case DestroyNotify:
+                m_gone = true;
+                m_listener({});
+                return true;
+            case ConfigureNotify:
+            case MapNotify:
+            case UnmapNotify:
+                m_listener(currentRect());
+                return true;
+            default:
+                return false;
+        }
+    }
+
+private:
+    // Empty while the client is unmapped, e.g. minimized
+    Rect currentRect() const {
+        XWindowAttributes client = {}, frame = {};
+        if (!XGetWindowAttributes(m_display, m_client, &client) || client.map_state != IsViewable ||
+            !XGetWindowAttributes(m_display, m_frame, &frame)) {
+            return {};
+        }
+        int x = 0, y = 0;
+        Window child = 0;
+        XTranslateCoordinates(m_display, m_frame, DefaultRootWindow(m_display), 0, 0, &x, &y, &child);
+        const int border = frame.border_width;
+        return { x - border, y - border, x + frame.width + border, y + frame.height + border };
+    }
+
+    Display* m_display;
+    Window m_client;
+    Window m_frame;
+    bool m_gone = false;
+    Listener m_listener;
+};
+
+// Defined after X11WindowEvents, which m_spotlightEvents needs complete to delete
+X11WindowInitiator::~X11WindowInitiator() = default;
+
+bool X11WindowInitiator::selectMonitors(const Topology& topology, std::vector<MonitorData>& targetMonitors) const {
+    std::vector<std::string> warnings;
+    std::string error;
+    const bool selected = SelectMonitors(topology, m_monitorIndices, m_monitorPatterns, m_monitorQueries,
+        targetMonitors, warnings, error);
+    g_flightRecorder.record(FlightEvent::Selection, selected ? targetMonitors.size() : 0, topology.monitors.size());
+    if (!selected) g_flightRecorder.recordText(FlightEvent::Error, error);
+    if (m_embedded) return selected;
+    for (const std::string& warning : warnings) {
+        std::cerr << "Warning: " << warning << "\n";
+    }
+    if (!selected) {
+        std::cerr << "Error: " << error << "\n";
+    }
+    return selected;
+}
+
+std::vector<WindowTarget> X11WindowInitiator::layout(const Topology& topology, const std::vector<MonitorData>& targetMonitors) const {
+    return BuildLayout(topology, targetMonitors, m_mask, m_styles, m_color, m_opacity, m_patterns);
+}
+
+unsigned long X11WindowInitiator::pixelFor(const std::tuple<int, int, int>& color) {
+    for (const auto& [cached, pixel] : m_pixels) {
+        if (cached == color) return pixel;
+    }
+
+    const auto [red, green, blue] = color;
+    XColor xcolor = {};
+    xcolor.red = static_cast<unsigned short>(red * 257);
+    xcolor.green = static_cast<unsigned short>(green * 257);
+    xcolor.blue = static_cast<unsigned short>(blue * 257);
+    xcolor.flags = DoRed | DoGreen | DoBlue;
+    const int screen = DefaultScreen(m_display);
+    const unsigned long pixel = XAllocColor(m_display, DefaultColormap(m_display, screen), &xcolor)
+        ? xcolor.pixel : BlackPixel(m_display, screen);
+    m_pixels.emplace_back(color, pixel);
+    return pixel;
+}
+
+unsigned long X11WindowInitiator::openWindow(const WindowTarget& target) {
+    // Override-redirect keeps the window manager from decorating or moving it; the
+    // server fills the background pixel on expose, so no client painting is needed
+    XSetWindowAttributes attributes = {};
+    attributes.override_redirect = True;
+    attributes.background_pixel = pixelFor(target.pattern == TestPattern::SolidCycle
+        ? SolidCycleColor(std::time(nullptr)) : target.color);
+    attributes.cursor = m_blankCursor;
+    attributes.event_mask = ExposureMask | KeyPressMask | VisibilityChangeMask;
+
+    unsigned long valueMask = CWOverrideRedirect | CWBackPixel | CWCursor | CWEventMask;
+    if ((attributes.background_pixmap = backdropPixmapFor(target.rect, target.color, target.pattern))) {
+        valueMask = (valueMask & ~CWBackPixel) | CWBackPixmap;
+    }
+
+    const Window window = XCreateWindow(m_display, DefaultRootWindow(m_display),
+        target.rect.left, target.rect.top,
+        static_cast<unsigned int>(target.rect.width()), static_cast<unsigned int>(target.rect.height()),
+        0, CopyFromParent, InputOutput, CopyFromParent, valueMask, &attributes);
+    g_flightRecorder.record(FlightEvent::WindowCreated, static_cast<uint64_t>(target.monitor),
+        PackFlightRect(target.rect.left, target.rect.top, target.rect.width(), target.rect.height()));
+    if (!window) {
+        g_flightRecorder.recordText(FlightEvent::Error, "XCreateWindow");
+        return 0;
+    }
+
+    XStoreName(m_display, window, "Black Screen Application");
+    if (target.opacity < 100) {
+        // Honoured by compositing managers; without one the window stays opaque
+        const unsigned long opacity = static_cast<unsigned long>(
+            std::clamp(target.opacity, 0, 100) / 100.0 * 0xFFFFFFFFu);
+        const Atom opacityAtom = XInternAtom(m_display, "_NET_WM_WINDOW_OPACITY", False);
+        XChangeProperty(m_display, window, opacityAtom, XA_CARDINAL, 32, PropModeReplace,
+            reinterpret_cast<const unsigned char*>(&opacity), 1);
+    }
+
+    m_windows.push_back({ window, target.monitor, target.rect,
+        m_overlay.enabled() && m_overlaySupported ? overlayFor(target.color) : nullptr, target.color,
+        target.pattern, attributes.background_pixel });
+    return window;
+}
+
+void X11WindowInitiator::closeWindow(unsigned long window) {
+    XDestroyWindow(m_display, window);
+    std::erase_if(m_windows, [window](const X11Window& entry) { return entry.window == window; });
+}
+
+const TextOverlay* X11WindowInitiator::overlayFor(const std::tuple<int, int, int>& background) {
+    for (const OverlaySlot& slot : m_overlays) {
+        if (slot.background == background) return slot.overlay.get();
+    }
+
+    if (!m_atlases) {
+        m_rasterizer = std::make_unique<CoreFontRasterizer>(m_display);
+        m_atlases = std::make_unique<GlyphAtlasCache>(*m_rasterizer);
+    }
+    auto overlay = std::make_unique<TextOverlay>(m_atlases->atlasFor(m_overlay.pointSize, m_dpi), m_overlay.color, background);
+    overlay->update(m_overlay.lines(std::time(nullptr)));
+    m_overlays.push_back({ background, std::move(overlay) });
+    return m_overlays.back().overlay.get();
+}
+
+void X11WindowInitiator::putPixels(unsigned long drawable, const uint32_t* pixels, long width, long height,
+    long sourceX, long sourceY, const Rect& destination) {
+    // Wraps the caller's pixels; XPutImage sends only the requested part
+    const int screen = DefaultScreen(m_display);
+    XImage* image = XCreateImage(m_display, DefaultVisual(m_display, screen), static_cast<unsigned int>(DefaultDepth(m_display, screen)),
+        ZPixmap, 0, reinterpret_cast<char*>(const_cast<uint32_t*>(pixels)),
+        static_cast<unsigned int>(width), static_cast<unsigned int>(height), 32, 0);
+    if (!image) return;
+    image->byte_order = std::endian::native == std::endian::little ? LSBFirst : MSBFirst;
+    XPutImage(m_display, drawable, DefaultGC(m_display, screen), image,
+        sourceX, sourceY, destination.left, destination.top,
+        static_cast<unsigned int>(destination.width()), static_cast<unsigned int>(destination.height()));
+    image->data = nullptr;      // owned by the caller
+    XDestroyImage(image);
+}
+
+void X11WindowInitiator::drawOverlay(const X11Window& window, const Rect& area) {
+    const TextOverlay& overlay = *window.overlay;
+    const Rect block = OverlayBlock(window.rect.width(), window.rect.height(), overlay);
+    const Rect part = { (std::max)(block.left, area.left), (std::max)(block.top, area.top),
+                        (std::min)(block.right, area.right), (std::min)(block.bottom, area.bottom) };
+    if (part.empty()) return;
+
+    putPixels(window.window, overlay.pixels(), overlay.width(), overlay.height(),
+        part.left - block.left, part.top - block.top, part);
+}
+
+// Generates the --pattern bitmaps and scales --image for every window size in
+// targets that has none yet
+bool X11WindowInitiator::prepareBackdrops(const std::vector<WindowTarget>& targets) {
+    if (!m_overlaySupported) return true;
+    for (const WindowTarget& target : targets) {
+        m_patternCache.prepare(target.pattern, target.rect.width(), target.rect.height());
+    }
+    if (!m_image.enabled()) return true;
+
+    std::vector<std::pair<long, long>> sizes;
+    for (const WindowTarget& target : targets) sizes.emplace_back(target.rect.width(), target.rect.height());
+    std::string error;
+    if (!m_backdrops.prepare(sizes, error)) {
+        g_flightRecorder.recordText(FlightEvent::Error, error);
+        std::cerr << "Error: " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+unsigned long X11WindowInitiator::backdropPixmapFor(const Rect& rect, const std::tuple<int, int, int>& background,
+    TestPattern pattern) {
+    for (const BackdropPixmap& cached : m_backdropPixmaps) {
+        if (cached.width == rect.width() && cached.height == rect.height() && cached.background == background &&
+            cached.pattern == pattern) {
+            return cached.pixmap;
+        }
+    }
+    // A pattern replaces the picture; solid-cycle has no bitmap and stays on the background pixel
+    const Backdrop* backdrop = pattern != TestPattern::Off ? m_patternCache.find(pattern, rect.width(), rect.height())
+        : m_image.enabled() ? m_backdrops.find(rect.width(), rect.height()) : nullptr;
+    if (!backdrop) return 0;
+
+    // Uploaded once; letterbox bars keep the target color
+    const int screen = DefaultScreen(m_display);
+    const Pixmap pixmap = XCreatePixmap(m_display, DefaultRootWindow(m_display), static_cast<unsigned int>(rect.width()),
+        static_cast<unsigned int>(rect.height()), static_cast<unsigned int>(DefaultDepth(m_display, screen)));
+    const GC gc = XCreateGC(m_display, pixmap, 0, nullptr);
+    XSetForeground(m_display, gc, pixelFor(background));
+    XFillRectangle(m_display, pixmap, gc, 0, 0, static_cast<unsigned int>(rect.width()), static_cast<unsigned int>(rect.height()));
+    XFreeGC(m_display, gc);
+
+    const long left = (rect.width() - backdrop->width) / 2;
+    const long top = (rect.height() - backdrop->height) / 2;
+    putPixels(pixmap, backdrop->pixels.data(), backdrop->width, backdrop->height, 0, 0,
+        { left, top, left + backdrop->width, top + backdrop->height });
+    m_backdropPixmaps.push_back({ rect.width(), rect.height(), background, pattern, pixmap });
+    return pixmap;
+}
+
+void X11WindowInitiator::tickOverlays() {
+    if (m_solidCycle) {
+        // Solid-cycle windows step together; the server repaints the new background
+        const unsigned long pixel = pixelFor(SolidCycleColor(std::time(nullptr)));
+        for (X11Window& window : m_windows) {
+            if (window.pattern != TestPattern::SolidCycle || window.pixel == pixel) continue;
+            window.pixel = pixel;
+            XSetWindowBackground(m_display, window.window, pixel);
+            XClearArea(m_display, window.window, 0, 0, 0, 0, True);
+        }
+    }
+
+    const std::vector<std::string> lines = m_overlay.lines(std::time(nullptr));
+    for (const OverlaySlot& slot : m_overlays) {
+        const std::vector<Rect> changed = slot.overlay->update(lines);
+        if (changed.empty()) continue;
+
+        for (const X11Window& window : m_windows) {
+            if (window.overlay != slot.overlay.get()) continue;
+            if (slot.overlay->resized()) {
+                // The old block may be larger; the server clears it and the expose redraws
+                XClearArea(m_display, window.window, 0, 0, 0, 0, True);
+                continue;
+            }
+            const Rect block = OverlayBlock(window.rect.width(), window.rect.height(), *slot.overlay);
+            for (const Rect& r : changed) {
+                drawOverlay(window, { block.left + r.left, block.top + r.top, block.left + r.right, block.top + r.bottom });
+            }
+        }
+    }
+    XFlush(m_display);
+}
+
+void X11WindowInitiator::grabInput(bool grab) {
+    // A spotlight leaves the keyboard to the tracked window; the hotkeys still work
+    if (grab == m_keyboardGrabbed || m_disableKeyExit || (grab && m_spotlight.enabled)) return;
+    if (!grab) {
+        XUngrabKeyboard(m_display, CurrentTime);
+        m_keyboardGrabbed = false;
+        return;
+    }
+
+    // Override-redirect windows never get focus, so key exit needs a grab. The
+    // window manager may hold one briefly (e.g. while a launcher key is down)
+    for (int attempt = 0; attempt < 50 && !m_keyboardGrabbed; ++attempt) {
+        m_keyboardGrabbed = XGrabKeyboard(m_display, DefaultRootWindow(m_display), False,
+            GrabModeAsync, GrabModeAsync, CurrentTime) == GrabSuccess;
+        if (!m_keyboardGrabbed) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!m_keyboardGrabbed) {
+        std::cerr << "Warning: Could not grab the keyboard; key exit is unavailable.\n";
+    }
+}
+
+X11WindowInitiator::Command X11WindowInitiator::waitForCommand(int timeoutMs) {
+    const int connection = ConnectionNumber(m_display);
+    const uint64_t deadline = MetricsClock() + static_cast<uint64_t>(timeoutMs < 0 ? 0 : timeoutMs) * 1'000'000;
+    for (;;) {
+        while (XPending(m_display)) {
+            XEvent event;
+            XNextEvent(m_display, &event);
+
+            if (m_spotlightEvents && m_spotlightEvents->handle(event)) {
+                continue;
+            }
+            if (event.type == Expose) {
+                auto it = std::ranges::find(m_windows, event.xexpose.window, &X11Window::window);
+                if (it != m_windows.end() && it->overlay) {
+                    const XExposeEvent& e = event.xexpose;
+                    drawOverlay(*it, { e.x, e.y, e.x + e.width, e.y + e.height });
+                }
+                if (event.xexpose.count == 0) {
+                    g_flightRecorder.record(FlightEvent::Message, Expose, event.xexpose.window);
+                    g_metrics.recordPaint(it == m_windows.end() ? -1 : it->monitor);
+                    // The server painted the background before sending this, so it is the closest "went black" we see
+                    if (m_reveal.mark(reinterpret_cast<WindowBackend::Handle>(event.xexpose.window), MetricsClock())) {
+                        g_metrics.revealSkew.record(m_reveal.skew());
+                    }
+                }
+            }
+            else if (event.type == KeyPress) {
+                g_flightRecorder.record(FlightEvent::Message, KeyPress, event.xkey.window);
+                const KeySym key = XLookupKeysym(&event.xkey, 0);
+                const bool hotkey = (event.xkey.state & kHotkeyModifiers) == kHotkeyModifiers;
+                if (m_resident.enabled && hotkey && key == XK_b) return Command::Toggle;
+                if (m_resident.enabled && hotkey && key == XK_q) return Command::Quit;
+                const WindowResponse response = RespondTo(WindowMessage::KeyDown, !m_disableKeyExit, m_resident.enabled);
+                if (response == WindowResponse::Unblank || response == WindowResponse::Quit) {
+                    if (!g_unblankRequestedAt) g_unblankRequestedAt = MetricsClock();
+                    return response == WindowResponse::Unblank ? Command::Unblank : Command::Quit;
+                }
+            }
+            else if (event.type == VisibilityNotify) {
+                // Best effort under a compositing manager, which may report every window unobscured
+                auto it = std::ranges::find(m_windows, event.xvisibility.window, &X11Window::window);
+                if (it != m_windows.end() && event.xvisibility.state != VisibilityUnobscured) {
+                    m_occlusion.note(it->rect, MetricsClock());
+                }
+            }
+            else if (event.type == m_randrEventBase + RRScreenChangeNotify) {
+                g_flightRecorder.record(FlightEvent::Message, static_cast<uint64_t>(event.type), 0);
+                XRRUpdateConfiguration(&event);
+                TopologyStore::requestRefresh();
+            }
+        }
+
+        // A clock or solid-cycle wakes just after each second boundary
+        int timeout = -1;
+        if ((!m_overlay.clockFormat.empty() && !m_overlays.empty()) || m_solidCycle) {
+            const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            timeout = static_cast<int>(1000 - now % 1000 + 5);
+        }
+        // A pending occlusion storm wakes once, when it has settled
+        if (const uint64_t settleAt = m_occlusion.deadline()) {
+            const uint64_t now = MetricsClock();
+            const int remaining = settleAt > now ? static_cast<int>((settleAt - now + 999'999) / 1'000'000) : 0;
+            timeout = timeout < 0 ? remaining : (std::min)(timeout, remaining);
+        }
+        if (timeoutMs >= 0) {
+            const uint64_t now = MetricsClock();
+            if (now >= deadline) return Command::Idle;
+            const int remaining = static_cast<int>((deadline - now + 999'999) / 1'000'000);
+            timeout = timeout < 0 ? remaining : (std::min)(timeout, remaining);
+        }
+
+        pollfd fds[2] = { { connection, POLLIN, 0 }, { g_wakePipe[0], POLLIN, 0 } };
+        // Waiting here is idle time, not a hang
+        g_flightRecorder.idle();
+        const int ready = poll(fds, 2, timeout);
+        g_flightRecorder.busy();
+        if (m_occlusion.deadline() && MetricsClock() >= m_occlusion.deadline()) settleOcclusion();
+        if (ready == 0) tickOverlays();
+        if (ready <= 0) continue;
+        if (fds[1].revents & POLLIN) {
+            char reason = 0;
+            while (read(g_wakePipe[0], &reason, 1) == 1) {
+                if (reason == 'q') return Command::Quit;
+                if (reason == 't') return Command::Topology;
+                if (reason == 'f') return Command::Fleet;
+                if (reason == 'c') return Command::Call;
+            }
+        }
+    }
+}
+
+// Connection and everything the windows share; the wake pipe carries signals,
+// topology refreshes, fleet requests and session calls into waitForCommand
+bool X11WindowInitiator::openDisplay() {
+    m_display = XOpenDisplay(nullptr);
+    if (!m_display) {
+        g_flightRecorder.recordText(FlightEvent::Error, "No X display");
+        if (!m_embedded) std::cerr << "Error: Cannot open X display.\n";
+        return false;
+    }
+    XSetErrorHandler(HandleXError);
+
+    const int screen = DefaultScreen(m_display);
+    const Visual* visual = DefaultVisual(m_display, screen);
+    m_overlaySupported = DefaultDepth(m_display, screen) >= 24 &&
+        visual->red_mask == 0xFF0000 && visual->green_mask == 0xFF00 && visual->blue_mask == 0xFF;
+    if (DisplayHeightMM(m_display, screen) > 0) {
+        m_dpi = static_cast<int>(DisplayHeight(m_display, screen) * 25.4 / DisplayHeightMM(m_display, screen) + 0.5);
+    }
+
+    const Window root = DefaultRootWindow(m_display);
+    int randrErrorBase = 0;
+    if (XRRQueryExtension(m_display, &m_randrEventBase, &randrErrorBase)) {
+        XRRSelectInput(m_display, root, RRScreenChangeNotifyMask);
+    }
+
+    // Invisible cursor over the blanking windows, the X11 ShowCursor(FALSE)
+    static const char emptyBits[1] = {};
+    const Pixmap emptyPixmap = XCreateBitmapFromData(m_display, root, emptyBits, 1, 1);
+    XColor black = {};
+    m_blankCursor = XCreatePixmapCursor(m_display, emptyPixmap, emptyPixmap, &black, &black, 0, 0);
+    XFreePixmap(m_display, emptyPixmap);
+
+    if (pipe(g_wakePipe) == 0) {
+        fcntl(g_wakePipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(g_wakePipe[1], F_SETFL, O_NONBLOCK);
+    }
+    return true;
+}
+
+void X11WindowInitiator::closeDisplay() {
+    for (int& fd : g_wakePipe) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+    XFreeCursor(m_display, m_blankCursor);
+    m_pixels.clear();
+    m_overlays.clear();
+    for (const BackdropPixmap& cached : m_backdropPixmaps) {
+        XFreePixmap(m_display, cached.pixmap);
+    }
+    m_backdropPixmaps.clear();
+    m_atlases.reset();
+    m_rasterizer.reset();
+    XCloseDisplay(m_display);
+    m_display = nullptr;
+}
+
+void X11WindowInitiator::createWindow() {
+    // Held for the whole session: a background refresh publishes a new snapshot
+    // without invalidating the monitors and index used here
+    const TopologySnapshot topology = TopologyStore::current();
+    if (!topology || topology->monitors.empty()) {
+        g_flightRecorder.recordText(FlightEvent::Error, "No monitors");
+        std::cerr << "Error: No monitors detected.\n";
+        return;
+    }
+
+    std::vector<MonitorData> targetMonitors;
+    if (!selectMonitors(*topology, targetMonitors) || !openDisplay()) {
+        return;
+    }
+
+    if (m_overlay.enabled() && !m_overlaySupported) {
+        std::cerr << "Warning: Text overlay needs a 24-bit TrueColor visual; it is not shown.\n";
+    }
+    if (m_image.enabled() && !m_overlaySupported) {
+        std::cerr << "Warning: --image needs a 24-bit TrueColor visual; it is not shown.\n";
+    }
+    if (!m_patterns.empty() && !m_overlaySupported) {
+        std::cerr << "Warning: --pattern needs a 24-bit TrueColor visual; only solid-cycle is shown.\n";
+    }
+
+    // Decoded, scaled and generated before any window exists, so windows map with the picture
+    if (m_image.enabled() && m_overlaySupported) {
+        std::string error;
+        if (!m_backdrops.open(m_image, error)) {
+            g_flightRecorder.recordText(FlightEvent::Error, error);
+            std::cerr << "Error: " << error << "\n";
+            closeDisplay();
+            return;
+        }
+    }
+    if (!prepareBackdrops(layout(*topology, targetMonitors))) {
+        closeDisplay();
+        return;
+    }
+
+    struct sigaction quitAction = {};
+    quitAction.sa_handler = HandleQuitSignal;
+    sigaction(SIGINT, &quitAction, nullptr);
+    sigaction(SIGTERM, &quitAction, nullptr);
+
+    if (m_resident.enabled) {
+        runResident();
+    }
+    else {
+        const uint64_t blankStart = MetricsClock();
+
+        // Every window is created unmapped before any is mapped, then they are revealed together
+        X11Backend backend(*this);
+        std::vector<WindowBackend::Handle> windows;
+        for (const WindowTarget& target : layout(*topology, targetMonitors)) {
+            if (const unsigned long window = openWindow(target)) {
+                windows.push_back(reinterpret_cast<WindowBackend::Handle>(window));
+            }
+        }
+        backend.reveal(windows);
+        guardWindows();
+        g_flightRecorder.record(FlightEvent::Blank, windows.size());
+        XSync(m_display, False);
+        grabInput(true);
+        g_metrics.blanks.fetch_add(1, std::memory_order_relaxed);
+        g_metrics.timeToBlack.record(MetricsClock() - blankStart);
+
+        // No refresher: a one-shot run keeps the windows it opened, so a new
+        // topology would have nothing to rebuild
+        while (waitForCommand() != Command::Quit) {
+        }
+    }
+
+    // Cleanup
+    const uint64_t unblankStart = g_unblankRequestedAt ? g_unblankRequestedAt : MetricsClock();
+    const bool wasBlanked = !m_resident.enabled && !m_windows.empty();
+    grabInput(false);
+    while (!m_windows.empty()) {
+        closeWindow(m_windows.back().window);
+    }
+    XSync(m_display, False);
+    if (wasBlanked) {
+        g_flightRecorder.record(FlightEvent::Unblank);
+        g_metrics.unblanks.fetch_add(1, std::memory_order_relaxed);
+        g_metrics.timeToUnblank.record(MetricsClock() - unblankStart);
+    }
+    g_unblankRequestedAt = 0;
+
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    closeDisplay();
+}
+
+// Whole-monitor layouts pool every monitor so any selection can be served by a flip;
+// mask layouts only exist for the selected monitors
+void X11WindowInitiator::rebuildPool() {
+    const TopologySnapshot topology = TopologyStore::current();
+    std::vector<MonitorData> targetMonitors;
+    if (!topology || !selectMonitors(*topology, targetMonitors)) {
+        targetMonitors.clear();
+    }
+
+    m_blankKeys.clear();
+    std::vector<WindowTarget> targets;
+    if (topology && m_mask.empty()) {
+        targets = layout(*topology, topology->monitors);
+        for (const auto& monitor : targetMonitors) m_blankKeys.push_back(monitor.index);
+    }
+    else if (topology) {
+        targets = layout(*topology, targetMonitors);
+        for (const auto& target : targets) m_blankKeys.push_back(target.key);
+    }
+    if (m_spotlight.enabled) {
+        // Window events then only reshape the sides around the tracked window
+        targets = m_spotlightLayout.reset(targets);
+        m_blankKeys = Spotlight::sideKeys(m_blankKeys);
+    }
+    prepareBackdrops(targets);
+    m_pool->sync(targets);
+    guardWindows();
+    XFlush(m_display);
+}
+
+void X11WindowInitiator::setPoolBlanked(bool blanked) {
+    if (blanked == m_pool->blanked()) return;
+    if (blanked) {
+        const uint64_t start = MetricsClock();
+        m_pool->blank(m_blankKeys);
+        XSync(m_display, False);
+        g_flightRecorder.record(FlightEvent::Blank, m_blankKeys.size());
+        grabInput(true);
+        g_metrics.blanks.fetch_add(1, std::memory_order_relaxed);
+        g_metrics.timeToBlack.record(MetricsClock() - start);
+    }
+    else {
+        const uint64_t start = g_unblankRequestedAt ? g_unblankRequestedAt : MetricsClock();
+        grabInput(false);
+        m_pool->unblank();
+        XSync(m_display, False);
+        g_flightRecorder.record(FlightEvent::Unblank);
+        g_metrics.unblanks.fetch_add(1, std::memory_order_relaxed);
+        g_metrics.timeToUnblank.record(MetricsClock() - start);
+    }
+    g_unblankRequestedAt = 0;
+    guardWindows();
+}
+
+void X11WindowInitiator::runResident() {
+    m_backend = std::make_unique<X11Backend>(*this);
+    m_pool = std::make_unique<WindowPool>(*m_backend, m_resident.pool);
+    auto setBlanked = [this](bool blanked) { setPoolBlanked(blanked); };
+
+    // --listen: requests are queued by the server thread and answered here, between other events
+    FleetServer fleet([] {
+        Wake('f');
+    });
+    const FleetActions fleetActions = { [this] { return m_pool->blanked(); }, setBlanked };
+    if (!m_resident.listen.empty()) {
+        std::string error;
+        if (!fleet.start(m_resident.listen, m_resident.token, error)) {
+            g_flightRecorder.recordText(FlightEvent::Error, error);
+            std::cerr << "Error: " << error << "\n";
+            m_pool.reset();
+            m_backend.reset();
+            return;
+        }
+    }
+    if (m_spotlight.enabled && !startSpotlight()) {
+        fleet.stop();
+        m_pool.reset();
+        m_backend.reset();
+        return;
+    }
+
+    rebuildPool();
+    setBlanked(true);
+
+    // Ctrl+Alt+B / Ctrl+Alt+Q, whatever the Caps/Num Lock state
+    const Window root = DefaultRootWindow(m_display);
+    const KeyCode hotkeys[] = { XKeysymToKeycode(m_display, XK_b), XKeysymToKeycode(m_display, XK_q) };
+    for (KeyCode key : hotkeys) {
+        for (unsigned int ignored : kIgnoredModifiers) {
+            XGrabKey(m_display, key, kHotkeyModifiers | ignored, root, False, GrabModeAsync, GrabModeAsync);
+        }
+    }
+
+    TopologyStore::startRefresher([] {
+        Wake('t');
+    });
+
+    for (;;) {
+        const Command command = waitForCommand();
+        if (command == Command::Quit) break;
+        if (command == Command::Toggle) setBlanked(!m_pool->blanked());
+        if (command == Command::Unblank) setBlanked(false);
+        if (command == Command::Topology) rebuildPool();
+        if (command == Command::Fleet) {
+            FleetCall call;
+            while (fleet.takeCall(call)) fleet.reply(call.connection, AnswerFleetRequest(call.request, fleetActions));
+        }
+    }
+
+    TopologyStore::stopRefresher();
+    fleet.stop();
+    for (KeyCode key : hotkeys) {
+        for (unsigned int ignored : kIgnoredModifiers) {
+            XUngrabKey(m_display, key, kHotkeyModifiers | ignored, root);
+        }
+    }
+    stopSpotlight();
+    setBlanked(false);
+    m_pool.reset();
+    m_backend.reset();
+}
+
+bool X11WindowInitiator::startSpotlight() {
+    std::string error;
+    if (const Window window = FindSpotlightWindow(m_display, m_spotlight.title)) {
+        m_spotlightEvents = std::make_unique<X11WindowEvents>(m_display, window);
+        if (m_spotlightEvents->start([this](const Rect& hole) { moveSpotlight(hole); })) return true;
+        m_spotlightEvents.reset();
+        error = "Cannot follow the spotlight window";
+    }
+    else {
+        error = m_spotlight.title.empty() ? "No active window to spotlight"
+            : "No window title contains '" + m_spotlight.title + "'";
+    }
+    g_flightRecorder.recordText(FlightEvent::Error, error);
+    std::cerr << "Error: " << error << "\n";
+    return false;
+}
+
+void X11WindowInitiator::stopSpotlight() {
+    if (m_spotlightEvents) m_spotlightEvents->stop();
+    m_spotlightEvents.reset();
+}
+
+// Called from the event loop; only the sides whose rect changed are moved, mapped or unmapped
+void X11WindowInitiator::moveSpotlight(const Rect& hole) {
+    const std::vector<WindowTarget> changed = m_spotlightLayout.move(hole);
+    if (changed.empty() || !m_pool) return;
+    m_pool->reshape(changed);
+    guardWindows();
+}
+
+// Unmapped windows are never obscured, so listing every window costs nothing
+void X11WindowInitiator::guardWindows() {
+    m_guarded.clear();
+    std::vector<Rect> rects;
+    for (const X11Window& window : m_windows) {
+        m_guarded.push_back(window.window);
+        rects.push_back(window.rect);
+    }
+    m_occlusion.setWindows(std::move(rects));
+}
+
+// Once per settled storm: raise only the windows it obscured
+void X11WindowInitiator::settleOcclusion() {
+    std::vector<size_t> affected;
+    if (!m_occlusion.settle(MetricsClock(), affected)) return;
+    for (size_t k : affected) XRaiseWindow(m_display, m_guarded[k]);
+    XFlush(m_display);
+    g_flightRecorder.record(FlightEvent::Reassert, affected.size(), affected.size());
+}
+
+bool X11WindowInitiator::openSession() {
+    if (m_pool) return true;
+    if (!TopologyStore::current()) TopologyStore::refresh();
+
+    // Key presses unblank like --resident; the pool keeps the windows for the next blank
+    m_embedded = true;
+    m_resident.enabled = true;
+    if (!openDisplay()) return false;
+    m_backend = std::make_unique<X11Backend>(*this);
+    m_pool = std::make_unique<WindowPool>(*m_backend, m_resident.pool);
+    rebuildPool();
+
+    TopologyStore::startRefresher([] {
+        Wake('t');
+    });
+    return true;
+}
+
+void X11WindowInitiator::refreshSession() {
+    if (m_pool) rebuildPool();
+}
+
+void X11WindowInitiator::setSessionBlanked(bool blanked) {
+    if (m_pool) setPoolBlanked(blanked);
+}
+
+bool X11WindowInitiator::sessionBlanked() const {
+    return m_pool && m_pool->blanked();
+}
+
+bool X11WindowInitiator::pumpSession(int timeoutMs) {
+    for (;;) {
+        switch (waitForCommand(timeoutMs)) {
+            case Command::Call: return true;
+            case Command::Idle: return false;
+            case Command::Unblank: setPoolBlanked(false); break;
+            case Command::Toggle: setPoolBlanked(!m_pool->blanked()); break;
+            case Command::Topology: rebuildPool(); break;
+            case Command::Quit:
+            case Command::Fleet: break;
+        }
+        // Handled something; whatever is queued behind it gets no further wait
+        timeoutMs = 0;
+    }
+}
+
+void X11WindowInitiator::wakeSession() {
+    Wake('c');
+}
+
+void X11WindowInitiator::closeSession() {
+    if (!m_pool) return;
+    TopologyStore::stopRefresher();
+    setPoolBlanked(false);
+    m_pool.reset();
+    m_backend.reset();
+    closeDisplay();
+}
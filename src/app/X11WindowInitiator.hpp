@@ -0,0 +1,157 @@
+#pragma once
+#ifndef X11WINDOWINITIATOR_HPP
+#define X11WINDOWINITIATOR_HPP
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "CommandLine.hpp"
+#include "ImageBackdrop.hpp"
+#include "MonitorDetection.hpp"
+#include "MonitorSelector.hpp"
+#include "OcclusionGuard.hpp"
+#include "Selection.hpp"
+#include "Spotlight.hpp"
+#include "TestPattern.hpp"
+#include "TextOverlay.hpp"
+#include "WindowBackend.hpp"
+#include "WindowPool.hpp"
+
+struct Topology;
+typedef struct _XDisplay Display;
+
+// X11 counterpart of WindowInitiator: one override-redirect window per
+// target, painted by the server from its background pixel. Errors and
+// warnings go to stderr.
+class X11WindowInitiator {
+public:
+    explicit X11WindowInitiator(InitiatorOptions options);
+    ~X11WindowInitiator();
+    void createWindow();
+
+    // In-process blanking for BlackScreen.h. The windows belong to the thread
+    // that calls openSession(); it must keep calling pumpSession() between
+    // the other calls. Errors are not printed in a session.
+    bool openSession();
+    void refreshSession();                  // after setColor() or setMonitorQueries()
+    // Session settings, applied by refreshSession()
+    void setColor(const std::tuple<int, int, int>& color) { m_color = color; }
+    void setMonitorQueries(std::vector<MonitorQuery> queries) { m_monitorQueries = std::move(queries); }
+    void setSessionBlanked(bool blanked);
+    bool sessionBlanked() const;
+    // Handles events for up to timeoutMs (-1 = until woken); true when wakeSession() ended the wait
+    bool pumpSession(int timeoutMs);
+    void wakeSession();                     // any thread
+    void closeSession();
+
+private:
+    class X11Backend;
+    class CoreFontRasterizer;
+    class X11WindowEvents;
+
+    struct X11Window {
+        unsigned long window;
+        int monitor;                    // table position for paint metrics
+        Rect rect;                      // current geometry, for centring the overlay
+        const TextOverlay* overlay;     // may be null
+        std::tuple<int, int, int> background;   // target color, for the backdrop pixmap after a resize
+        TestPattern pattern;
+        unsigned long pixel;            // background pixel set now, stepped by solid-cycle
+    };
+
+    // --image centred on a window-sized pixmap of the background color, or a
+    // --pattern bitmap; the server paints it like a background pixel, shared
+    // by same-sized windows
+    struct BackdropPixmap {
+        long width;
+        long height;
+        std::tuple<int, int, int> background;
+        TestPattern pattern;
+        unsigned long pixmap;
+    };
+
+    struct OverlaySlot {
+        std::tuple<int, int, int> background;
+        std::unique_ptr<TextOverlay> overlay;
+    };
+
+    // What the event loop woke up for
+    enum class Command { Unblank, Toggle, Quit, Topology, Fleet, Call, Idle };
+
+    bool openDisplay();
+    void closeDisplay();
+    void rebuildPool();
+    void setPoolBlanked(bool blanked);
+    bool selectMonitors(const Topology& topology, std::vector<MonitorData>& targetMonitors) const;
+    std::vector<WindowTarget> layout(const Topology& topology, const std::vector<MonitorData>& targetMonitors) const;
+    unsigned long openWindow(const WindowTarget& target);
+    void closeWindow(unsigned long window);
+    unsigned long pixelFor(const std::tuple<int, int, int>& color);
+    void grabInput(bool grab);
+    const TextOverlay* overlayFor(const std::tuple<int, int, int>& background);
+    void putPixels(unsigned long drawable, const uint32_t* pixels, long width, long height,
+        long sourceX, long sourceY, const Rect& destination);
+    void drawOverlay(const X11Window& window, const Rect& area);
+    bool prepareBackdrops(const std::vector<WindowTarget>& targets);
+    unsigned long backdropPixmapFor(const Rect& rect, const std::tuple<int, int, int>& background, TestPattern pattern);
+    void tickOverlays();
+    void runResident();
+    bool startSpotlight();
+    void stopSpotlight();
+    void moveSpotlight(const Rect& hole);
+    void guardWindows();                // after windows are created, destroyed or moved
+    void settleOcclusion();
+    // Idle once timeoutMs (-1 = never) passes without a command
+    Command waitForCommand(int timeoutMs = -1);
+
+    std::tuple<int, int, int> m_color;
+    int m_opacity;
+    bool m_disableKeyExit;
+    std::vector<int> m_monitorIndices;      // For -m
+    std::vector<std::string> m_monitorPatterns; // For -M
+    std::vector<MonitorQuery> m_monitorQueries; // For -q
+    BlankMask m_mask;
+    std::vector<MonitorStyle> m_styles;
+    ResidentOptions m_resident;
+    OverlayOptions m_overlay;
+    ImageOptions m_image;
+    std::vector<MonitorPattern> m_patterns; // For --pattern
+    SpotlightOptions m_spotlight;
+
+    Display* m_display = nullptr;
+    int m_randrEventBase = 0;
+    unsigned long m_blankCursor = 0;
+    bool m_keyboardGrabbed = false;
+    std::vector<X11Window> m_windows;
+    RevealTracker m_reveal;             // the latest batched map, marked on each window's first expose
+    std::vector<std::pair<std::tuple<int, int, int>, unsigned long>> m_pixels;
+    bool m_overlaySupported = false;    // overlay, image and pattern need a 24-bit TrueColor visual for XPutImage
+    int m_dpi = 96;
+    std::unique_ptr<CoreFontRasterizer> m_rasterizer;
+    std::unique_ptr<GlyphAtlasCache> m_atlases;
+    std::vector<OverlaySlot> m_overlays;
+    BackdropCache m_backdrops;
+    PatternCache m_patternCache;
+    bool m_solidCycle = false;          // some --pattern is solid-cycle, so the tick steps colors
+
+    // Resident pool, for --resident and sessions; the backend outlives the pool
+    std::unique_ptr<X11Backend> m_backend;
+    std::unique_ptr<WindowPool> m_pool;
+    std::vector<int> m_blankKeys;
+    bool m_embedded = false;            // a BlackScreen.h session
+    std::vector<BackdropPixmap> m_backdropPixmaps;
+
+    // --spotlight: the pool's layout split around the tracked window
+    Spotlight m_spotlightLayout;
+    std::unique_ptr<X11WindowEvents> m_spotlightEvents;
+
+    // Other override-redirect windows can be stacked over ours; VisibilityNotify
+    // reports it and the guard picks which windows to raise
+    OcclusionGuard m_occlusion;
+    std::vector<unsigned long> m_guarded;   // the windows, in the guard's order
+};
+
+#endif // X11WINDOWINITIATOR_HPP
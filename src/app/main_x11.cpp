@@ -0,0 +1,110 @@
+#include "X11WindowInitiator.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#include "CommandLine.hpp"
+#include "FlightRecorder.hpp"
+#include "Metrics.hpp"
+#include "Topology.hpp"
+
+int main(int argc, char** argv) {
+    // Check for help or no args
+    if (argc == 1) {
+        std::cout << HelpText("black_screen_app_x11");
+        return 0;
+    }
+
+    const std::vector<std::string> args(argv + 1, argv + argc);
+
+    TopologyStore::refresh();
+    const TopologySnapshot topology = TopologyStore::current();
+    const std::vector<MonitorData>& monitors = topology->monitors;
+
+    CommandLineOptions options;
+    std::string error;
+    if (!ParseCommandLine(args, monitors.size(), options, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    if (options.action == CommandLineOptions::Action::List) {
+        std::cout << FormatMonitorList(monitors);
+        return 0;
+    }
+    if (options.action == CommandLineOptions::Action::Help) {
+        std::cout << HelpText("black_screen_app_x11");
+        return 0;
+    }
+    if (options.action == CommandLineOptions::Action::Control) {
+        const uint64_t start = MetricsClock();
+        const std::vector<FleetResult> results = RunFleet(options.fleet);
+        std::cout << FormatFleetReport(options.fleet, results, MetricsClock() - start);
+        return std::ranges::all_of(results, [](const FleetResult& result) {
+            return result.status == FleetResult::Status::Ok;
+        }) ? 0 : 1;
+    }
+
+    if (options.action == CommandLineOptions::Action::Stress) {
+        // Sized like the real monitors, unblanked the way --resident would
+        options.stress.resident = options.resident.enabled;
+        for (const MonitorData& monitor : monitors) options.stress.windows.push_back(toRect(monitor.rect));
+        std::cout << FormatStressReport(RunInputStress(options.stress));
+        return 0;
+    }
+
+    if (options.action == CommandLineOptions::Action::SpotlightStress) {
+        for (const MonitorData& monitor : monitors) options.spotlightStress.monitors.push_back(toRect(monitor.rect));
+        std::cout << FormatSpotlightStressReport(RunSpotlightStress(options.spotlightStress));
+        return 0;
+    }
+
+    if (options.action == CommandLineOptions::Action::OcclusionStress) {
+        for (const MonitorData& monitor : monitors) options.occlusionStress.monitors.push_back(toRect(monitor.rect));
+        std::cout << FormatOcclusionStressReport(RunOcclusionStress(options.occlusionStress));
+        return 0;
+    }
+
+    if (options.action == CommandLineOptions::Action::DecodeRecorder) {
+        std::string text;
+        if (!DecodeFlightRecording(options.recorderFile, text, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::cout << text;
+        return 0;
+    }
+
+    if (options.action == CommandLineOptions::Action::DumpTopology) {
+        DisplayCapture capture = CaptureDisplay();
+        capture.recorded = MatchDisplayCapture(capture);
+        if (!SaveDisplayCapture(options.topologyFile, capture, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::cout << "Saved " << capture.paths.size() << " paths, " << capture.modes.size() << " modes and "
+            << capture.monitors.size() << " monitors to " << options.topologyFile << "\n\n" << FormatMonitorList(capture.recorded);
+        return 0;
+    }
+    if (options.action == CommandLineOptions::Action::ReplayTopology) {
+        const std::vector<TopologyReplayResult> results = RunTopologyReplay(options.topologyReplay);
+        std::cout << FormatTopologyReplayReport(results);
+        return TopologyReplayPassed(results) ? 0 : 1;
+    }
+
+    // Before any thread exists: open() republishes the ring other threads record into
+    g_flightRecorder.open();
+
+    // Launch the black screen windows
+    X11WindowInitiator windowInitiator(options.initiator());
+    MetricsPublisher metricsPublisher;
+    if (options.publishMetrics) {
+        metricsPublisher.start(options.metricsFile, std::chrono::seconds(5));
+    }
+    windowInitiator.createWindow();
+    metricsPublisher.stop();
+    // createWindow() has joined the refresher, fleet and session threads
+    g_flightRecorder.close();
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+// Time to black in-process against starting the executable for every blank,
+// the way a kiosk shell did before the library: bs_blank/bs_unblank on an
+// open session, then spawn, wait for the child's flight recording to show
+// the blank, and stop it. Arguments: the iteration scale and the path of
+// the executable. Needs a display; exits 77 without one.
+#include "TestHarness.hpp"
+
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include "BlackScreen.h"
+#include "FlightRecorder.hpp"
+#include "Metrics.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <csignal>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr uint64_t kSpawnTimeoutNanos = 10'000'000'000;
+
+#ifdef _WIN32
+    using Child = PROCESS_INFORMATION;
+
+    bool Spawn(const std::string& exe, Child& child) {
+        std::string commandLine = "\"" + exe + "\"";
+        STARTUPINFOA startup = { sizeof(startup) };
+        return CreateProcessA(exe.c_str(), commandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &child) != 0;
+    }
+
+    uint64_t ChildId(const Child& child) { return child.dwProcessId; }
+
+    // No console to interrupt: terminate and wait
+    void Stop(Child& child) {
+        TerminateProcess(child.hProcess, 0);
+        WaitForSingleObject(child.hProcess, INFINITE);
+        CloseHandle(child.hThread);
+        CloseHandle(child.hProcess);
+    }
+#else
+    using Child = pid_t;
+
+    bool Spawn(const std::string& exe, Child& child) {
+        char* const args[] = { const_cast<char*>(exe.c_str()), nullptr };
+        return posix_spawn(&child, exe.c_str(), nullptr, nullptr, args, environ) == 0;
+    }
+
+    uint64_t ChildId(const Child& child) { return static_cast<uint64_t>(child); }
+
+    // SIGTERM unblanks and exits like a key press
+    void Stop(Child& child) {
+        kill(child, SIGTERM);
+        int status = 0;
+        waitpid(child, &status, 0);
+    }
+#endif
+
+    // Spawn to the child's Blank event, polled from its flight recording
+    bool TimeExeBlank(const std::string& exe, uint64_t& toBlack, uint64_t& cycle) {
+        const uint64_t start = MetricsClock();
+        Child child{};
+        if (!Spawn(exe, child)) return false;
+        std::error_code ignored;
+        const std::string path = (std::filesystem::temp_directory_path(ignored) /
+            ("black_screen_app." + std::to_string(ChildId(child)) + ".flight")).string();
+
+        bool blanked = false;
+        std::string text, error;
+        while (!blanked && MetricsClock() - start < kSpawnTimeoutNanos) {
+            blanked = DecodeFlightRecording(path, text, error) && text.find(" blank ") != std::string::npos;
+            if (!blanked) std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        toBlack = MetricsClock() - start;
+        Stop(child);
+        cycle = MetricsClock() - start;
+        std::filesystem::remove(path, ignored);
+        return blanked;
+    }
+
+    void Report(const char* name, const LatencyHistogram& histogram) {
+        const LatencyHistogram::Summary s = histogram.summarize();
+        printf("%-40s %10.2f %10.2f %10.2f  (%llu runs)\n", name, s.p50 / 1e6, s.p99 / 1e6, s.max / 1e6,
+            static_cast<unsigned long long>(s.count));
+    }
+}
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+    const std::string exe = argc > 2 ? argv[2] : "";
+
+    bs_session* session = nullptr;
+    const int opened = bs_open(BS_THREAD_INTERNAL, &session);
+    if (opened == BS_ERROR_DISPLAY) {
+        printf("No display to blank, skipping\n");
+        return 77;
+    }
+    if (opened != BS_OK) {
+        fprintf(stderr, "bs_open failed: %d\n", opened);
+        return 1;
+    }
+
+    printf("%-40s %10s %10s %10s\n", "", "p50 ms", "p99 ms", "max ms");
+    LatencyHistogram blank, unblank;
+    for (uint64_t k = testing::Iterations(200, scale); k > 0; --k) {
+        uint64_t start = MetricsClock();
+        bs_blank(session);
+        blank.record(MetricsClock() - start);
+        start = MetricsClock();
+        bs_unblank(session);
+        unblank.record(MetricsClock() - start);
+    }
+    bs_close(session);
+    Report("in-process bs_blank", blank);
+    Report("in-process bs_unblank", unblank);
+
+    if (exe.empty()) {
+        printf("No executable given, skipping the spawn comparison\n");
+        return 0;
+    }
+    LatencyHistogram toBlack, cycle;
+    for (uint64_t k = testing::Iterations(20, scale); k > 0; --k) {
+        uint64_t black = 0, total = 0;
+        if (!TimeExeBlank(exe, black, total)) {
+            fprintf(stderr, "%s did not blank within %llu s\n", exe.c_str(), static_cast<unsigned long long>(kSpawnTimeoutNanos / 1'000'000'000));
+            return 1;
+        }
+        toBlack.record(black);
+        cycle.record(total);
+    }
+    Report("spawn executable to black", toBlack);
+    Report("spawn, blank and exit", cycle);
+    return 0;
+}
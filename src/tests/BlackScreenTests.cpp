@@ -0,0 +1,114 @@
+// The C API of the black_screen library in both threading modes. Needs a
+// display; without one the binary exits 77 and CTest reports it skipped.
+#include "TestHarness.hpp"
+
+#include <thread>
+#include <vector>
+
+#include "BlackScreen.h"
+
+namespace {
+    // Runs fn on a thread of its own and returns its status
+    template <typename Fn>
+    int FromOtherThread(Fn fn) {
+        int status = -1;
+        std::thread([&] { status = fn(); }).join();
+        return status;
+    }
+
+    bool Blanked(bs_session* session) {
+        int blanked = -1;
+        return bs_is_blanked(session, &blanked) == BS_OK && blanked == 1;
+    }
+}
+
+TEST(ApiVersion) {
+    CHECK_EQ(bs_api_version(), static_cast<uint32_t>(BLACKSCREEN_API_VERSION));
+}
+
+TEST(RejectsNullArguments) {
+    size_t count = 0;
+    CHECK_EQ(bs_open(BS_THREAD_INTERNAL, nullptr), BS_ERROR_ARGUMENT);
+    CHECK_EQ(bs_close(nullptr), BS_ERROR_ARGUMENT);
+    CHECK_EQ(bs_enumerate(nullptr, 0, nullptr), BS_ERROR_ARGUMENT);
+    CHECK_EQ(bs_enumerate(nullptr, 1, &count), BS_ERROR_ARGUMENT);
+    CHECK_EQ(bs_blank(nullptr), BS_ERROR_ARGUMENT);
+    CHECK(bs_last_error(nullptr) != nullptr);
+}
+
+TEST(EnumeratesMonitors) {
+    size_t count = 0;
+    REQUIRE(bs_enumerate(nullptr, 0, &count) == BS_OK);
+    REQUIRE(count > 0);
+    std::vector<bs_monitor> monitors(count);
+    size_t again = 0;
+    REQUIRE(bs_enumerate(monitors.data(), monitors.size(), &again) == BS_OK);
+    CHECK_EQ(again, count);
+    for (size_t k = 0; k < count; ++k) {
+        CHECK_EQ(monitors[k].index, static_cast<int32_t>(k + 1));
+        CHECK(monitors[k].right > monitors[k].left);
+        CHECK(monitors[k].bottom > monitors[k].top);
+    }
+}
+
+TEST(InternalThread) {
+    bs_session* session = nullptr;
+    REQUIRE(bs_open(BS_THREAD_INTERNAL, &session) == BS_OK);
+    bs_session* second = nullptr;
+    CHECK_EQ(bs_open(BS_THREAD_INTERNAL, &second), BS_ERROR_BUSY);
+    CHECK(second == nullptr);
+
+    CHECK_EQ(bs_set_color(session, "not a color"), BS_ERROR_ARGUMENT);
+    CHECK(*bs_last_error(session) != '\0');
+    CHECK_EQ(bs_select(session, "primary |"), BS_ERROR_ARGUMENT);
+    CHECK_EQ(bs_select(session, "primary"), BS_OK);
+    CHECK_EQ(bs_set_color(session, "#102030"), BS_OK);
+
+    CHECK(!Blanked(session));
+    CHECK_EQ(bs_blank(session), BS_OK);
+    CHECK(Blanked(session));
+    // Any thread may call into an internal session
+    CHECK_EQ(FromOtherThread([session] { return bs_unblank(session); }), BS_OK);
+    CHECK(!Blanked(session));
+    CHECK_EQ(FromOtherThread([session] { return bs_blank(session); }), BS_OK);
+    CHECK(Blanked(session));
+    CHECK_EQ(bs_select(session, ""), BS_OK);
+    CHECK(Blanked(session));
+    CHECK_EQ(bs_pump(session, 0), BS_OK);
+
+    CHECK_EQ(FromOtherThread([session] { return bs_close(session); }), BS_OK);
+}
+
+TEST(CallerThread) {
+    bs_session* session = nullptr;
+    REQUIRE(bs_open(BS_THREAD_CALLER, &session) == BS_OK);
+
+    CHECK_EQ(bs_blank(session), BS_OK);
+    CHECK_EQ(bs_pump(session, 0), BS_OK);
+    CHECK(Blanked(session));
+    CHECK_EQ(bs_pump(session, -1), BS_ERROR_ARGUMENT);
+
+    // Other threads are turned away, close included, and the session survives
+    CHECK_EQ(FromOtherThread([session] { return bs_unblank(session); }), BS_ERROR_THREAD);
+    CHECK_EQ(FromOtherThread([session] { return bs_close(session); }), BS_ERROR_THREAD);
+    CHECK(*bs_last_error(session) != '\0');
+    CHECK(Blanked(session));
+    CHECK_EQ(bs_unblank(session), BS_OK);
+    CHECK_EQ(bs_pump(session, 10), BS_OK);
+    CHECK(!Blanked(session));
+    CHECK_EQ(bs_close(session), BS_OK);
+
+    // Closing released the process-wide session
+    REQUIRE(bs_open(BS_THREAD_CALLER, &session) == BS_OK);
+    CHECK_EQ(bs_close(session), BS_OK);
+}
+
+int main(int argc, char** argv) {
+    bs_session* probe = nullptr;
+    if (bs_open(BS_THREAD_INTERNAL, &probe) == BS_ERROR_DISPLAY) {
+        printf("No display to blank, skipping\n");
+        return 77;
+    }
+    bs_close(probe);
+    return testing::RunTests(argc, argv);
+}
@@ -0,0 +1,60 @@
+// Monitor selection flags: -m, -M and -q exclude each other in either order.
+#include "TestHarness.hpp"
+
+#include "CommandLine.hpp"
+
+namespace {
+    bool Parse(std::vector<std::string> args, CommandLineOptions& options, std::string& error) {
+        return ParseCommandLine(args, 2, options, error);
+    }
+
+    bool Rejected(std::vector<std::string> args) {
+        CommandLineOptions options;
+        std::string error;
+        return !Parse(std::move(args), options, error) && error.find("Cannot combine") != std::string::npos;
+    }
+}
+
+TEST(MonitorIndexAlone) {
+    CommandLineOptions options;
+    std::string error;
+    REQUIRE(Parse({ "-m", "1" }, options, error));
+    CHECK(options.monitorIndices == std::vector<int>{ 0 });
+    REQUIRE(Parse({ "-m", "0" }, options, error));
+    CHECK(options.monitorIndices == std::vector<int>{ -1 });
+}
+
+TEST(QueryAndNameAlone) {
+    CommandLineOptions query;
+    std::string error;
+    REQUIRE(Parse({ "-q", "left" }, query, error));
+    CHECK(query.monitorIndices.empty());
+    CHECK_EQ(query.monitorQueries.size(), 1u);
+
+    CommandLineOptions name;
+    REQUIRE(Parse({ "-M", "Dell" }, name, error));
+    CHECK(name.monitorIndices.empty());
+    CHECK(name.monitorPatterns == std::vector<std::string>{ "Dell" });
+}
+
+// "-m 1" parses to the same { 0 } as the default, which must not read as "not given"
+TEST(IndexWithQueryEitherOrder) {
+    CHECK(Rejected({ "-m", "1", "-q", "left" }));
+    CHECK(Rejected({ "-q", "left", "-m", "1" }));
+    CHECK(Rejected({ "-m", "0", "-q", "left" }));
+}
+
+TEST(IndexWithNameEitherOrder) {
+    CHECK(Rejected({ "-m", "1", "-M", "Dell" }));
+    CHECK(Rejected({ "-M", "Dell", "-m", "1" }));
+    CHECK(Rejected({ "-m", "2", "-M", "Dell" }));
+}
+
+TEST(NameWithQueryEitherOrder) {
+    CHECK(Rejected({ "-M", "Dell", "-q", "left" }));
+    CHECK(Rejected({ "-q", "left", "-M", "Dell" }));
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
@@ -0,0 +1,54 @@
+// --control throughput against 1,000 targets: stand-in instances on local
+// sockets, each serving a share of the connections, driven at several
+// --parallel settings. The optional argument scales the target count.
+#include "TestHarness.hpp"
+
+#include "FleetController.hpp"
+#include "FleetStandIn.hpp"
+#include "Metrics.hpp"
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+    const size_t targets = testing::Iterations(1000, scale);
+    // Each stand-in accepts up to 256 connections; 125 targets apiece keeps
+    // every connection of a --parallel 256 run open at once
+    const size_t instances = (targets + 124) / 125;
+
+    std::string error;
+    const auto standIns = StartStandIns(instances, "", error);
+    if (standIns.size() != instances) {
+        fprintf(stderr, "Cannot start stand-in instances: %s\n", error.c_str());
+        return 1;
+    }
+
+    printf("%zu targets over %zu stand-in instances\n", targets, instances);
+    printf("%-10s %-24s %12s %12s %12s %12s\n", "parallel", "commands", "total ms", "targets/s", "p50 ms", "p99 ms");
+    bool ok = true;
+    for (size_t parallel : { size_t{ 16 }, size_t{ 64 }, size_t{ 256 } }) {
+        for (const std::vector<std::string>& commands : { std::vector<std::string>{ "ping" },
+                                                          std::vector<std::string>{ "blank", "status", "unblank" } }) {
+            FleetOptions options;
+            options.commands = commands;
+            options.parallel = parallel;
+            options.timeoutMs = 10'000;
+            for (size_t k = 0; k < targets; ++k) options.targets.push_back(standIns[k % instances]->endpoint());
+
+            const uint64_t start = MetricsClock();
+            const std::vector<FleetResult> results = RunFleet(options);
+            const uint64_t elapsed = MetricsClock() - start;
+
+            LatencyHistogram latencies;
+            for (const FleetResult& result : results) {
+                ok = ok && result.status == FleetResult::Status::Ok;
+                latencies.record(result.latency);
+            }
+            const LatencyHistogram::Summary s = latencies.summarize();
+            std::string label;
+            for (const std::string& command : commands) label += (label.empty() ? "" : ",") + command;
+            printf("%-10zu %-24s %12.1f %12.0f %12.2f %12.2f\n", parallel, label.c_str(), elapsed / 1e6,
+                static_cast<double>(targets) / (elapsed / 1e9), s.p50 / 1e6, s.p99 / 1e6);
+        }
+    }
+    if (!ok) fprintf(stderr, "Some targets did not answer\n");
+    return ok ? 0 : 1;
+}
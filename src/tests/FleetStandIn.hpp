@@ -0,0 +1,111 @@
+#pragma once
+#ifndef FLEETSTANDIN_HPP
+#define FLEETSTANDIN_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FleetServer.hpp"
+
+// A resident instance without windows: a FleetServer whose calls are
+// answered on a worker thread standing in for the UI thread, with the blanked
+// state kept in memory. Many of them make a fleet on one machine.
+class FleetStandIn {
+public:
+    FleetStandIn() : m_server([this] { wake(); }) {}
+    FleetStandIn(const FleetStandIn&) = delete;
+    FleetStandIn& operator=(const FleetStandIn&) = delete;
+    ~FleetStandIn() { stop(); }
+
+    bool start(const std::string& endpoint, const std::string& token, std::string& error) {
+        if (!m_server.start(endpoint, token, error)) return false;
+        m_endpoint = endpoint;
+        m_worker = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        if (!m_worker.joinable()) return;
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_worker.join();
+        m_server.stop();
+    }
+
+    const std::string& endpoint() const { return m_endpoint; }
+    bool blanked() const { return m_blanked.load(); }
+    uint64_t calls() const { return m_calls.load(); }
+
+private:
+    void wake() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_pending = true;
+        }
+        m_wake.notify_one();
+    }
+
+    void run() {
+        const FleetActions actions{
+            .blanked = [this] { return m_blanked.load(); },
+            .setBlanked = [this](bool blanked) { m_blanked.store(blanked); },
+        };
+        for (;;) {
+            {
+                std::unique_lock lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_pending || m_stopping; });
+                if (m_stopping) return;
+                m_pending = false;
+            }
+            FleetCall call;
+            while (m_server.takeCall(call)) {
+                m_server.reply(call.connection, AnswerFleetRequest(call.request, actions));
+                m_calls.fetch_add(1);
+            }
+        }
+    }
+
+    FleetServer m_server;
+    std::string m_endpoint;
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_pending = false;
+    bool m_stopping = false;
+    std::atomic<bool> m_blanked{ false };
+    std::atomic<uint64_t> m_calls{ 0 };
+};
+
+// Endpoint number k of this run: a Unix socket in the temp directory, or a
+// loopback port on Windows where there are none
+inline std::string StandInEndpoint(size_t k) {
+    static const unsigned long run = std::random_device{}() % 10000;
+#ifdef _WIN32
+    return "127.0.0.1:" + std::to_string(30000 + (run * 7 + k) % 30000);
+#else
+    return "unix:" + (std::filesystem::temp_directory_path() / ("bs-fleet-" + std::to_string(run) + "-" + std::to_string(k))).string();
+#endif
+}
+
+// count stand-ins on consecutive endpoints, or none when one fails to listen
+inline std::vector<std::unique_ptr<FleetStandIn>> StartStandIns(size_t count, const std::string& token, std::string& error) {
+    std::vector<std::unique_ptr<FleetStandIn>> standIns;
+    for (size_t k = 0; k < count; ++k) {
+        auto standIn = std::make_unique<FleetStandIn>();
+        if (!standIn->start(StandInEndpoint(k), token, error)) return {};
+        standIns.push_back(std::move(standIn));
+    }
+    return standIns;
+}
+
+#endif // FLEETSTANDIN_HPP
@@ -0,0 +1,134 @@
+// The fleet controller against stand-in resident instances on loopback and
+// Unix sockets: many targets at once, tokens, and targets that are not there.
+#include "TestHarness.hpp"
+
+#include "CommandLine.hpp"
+#include "FleetController.hpp"
+#include "FleetStandIn.hpp"
+#include "Socket.hpp"
+
+namespace {
+    FleetOptions Options(const std::vector<std::unique_ptr<FleetStandIn>>& standIns, std::vector<std::string> commands) {
+        FleetOptions options;
+        for (const auto& standIn : standIns) options.targets.push_back(standIn->endpoint());
+        options.commands = std::move(commands);
+        return options;
+    }
+
+    bool Parses(std::vector<std::string> args, std::string& error) {
+        CommandLineOptions options;
+        return ParseCommandLine(args, 1, options, error);
+    }
+}
+
+TEST(BlanksAndUnblanksManyInstances) {
+    std::string error;
+    const auto standIns = StartStandIns(64, "", error);
+    REQUIRE(standIns.size() == 64);
+
+    const std::vector<FleetResult> blanked = RunFleet(Options(standIns, { "ping", "blank", "status" }));
+    REQUIRE(blanked.size() == standIns.size());
+    for (const FleetResult& result : blanked) {
+        CHECK(result.status == FleetResult::Status::Ok);
+        REQUIRE(result.responses.size() == 3);
+        CHECK(result.responses[0].text == "pong");
+        CHECK(result.responses[2].text == "blanked");
+    }
+    for (const auto& standIn : standIns) CHECK(standIn->blanked());
+
+    FleetOptions toggle = Options(standIns, { "toggle" });
+    toggle.parallel = 8;
+    for (const FleetResult& result : RunFleet(toggle)) {
+        CHECK(result.status == FleetResult::Status::Ok && result.responses[0].text == "unblanked");
+    }
+    for (const auto& standIn : standIns) CHECK(!standIn->blanked());
+}
+
+TEST(TokenGuardsEveryCommand) {
+    std::string error;
+    const auto standIns = StartStandIns(4, "s3cret", error);
+    REQUIRE(standIns.size() == 4);
+
+    FleetOptions options = Options(standIns, { "blank" });
+    for (const FleetResult& result : RunFleet(options)) {
+        CHECK(result.status != FleetResult::Status::Ok || !result.responses[0].ok);
+    }
+    for (const auto& standIn : standIns) CHECK(!standIn->blanked());
+
+    options.token = "s3cret";
+    for (const FleetResult& result : RunFleet(options)) CHECK(result.status == FleetResult::Status::Ok);
+    for (const auto& standIn : standIns) CHECK(standIn->blanked());
+}
+
+TEST(MissingTargetsAreReported) {
+    std::string error;
+    const auto standIns = StartStandIns(2, "", error);
+    REQUIRE(standIns.size() == 2);
+
+    FleetOptions options = Options(standIns, { "status" });
+    options.targets.insert(options.targets.begin() + 1, StandInEndpoint(999));
+    options.timeoutMs = 500;
+    const std::vector<FleetResult> results = RunFleet(options);
+    REQUIRE(results.size() == 3);
+    CHECK(results[0].status == FleetResult::Status::Ok);
+    CHECK(results[1].status == FleetResult::Status::Unreachable);
+    CHECK(results[2].status == FleetResult::Status::Ok);
+}
+
+TEST(NetworkListenerNeedsToken) {
+    FleetServer server([] {});
+    std::string error;
+    CHECK(!server.start("0.0.0.0:0", "", error));
+    CHECK(error.find("token") != std::string::npos);
+    CHECK(!server.start("*:0", "", error));
+
+    Endpoint endpoint;
+    for (const char* local : { "127.0.0.1:7070", "localhost:7070", "[::1]:7070", "7070" }) {
+        CHECK(ParseEndpoint(local, endpoint, error) && endpoint.loopback());
+    }
+    for (const char* remote : { "0.0.0.0:7070", "*:7070", "192.168.1.5:7070", "[::]:7070", "station.example:7070" }) {
+        CHECK(ParseEndpoint(remote, endpoint, error) && !endpoint.loopback());
+    }
+
+    CHECK(!Parses({ "--resident", "--listen", "0.0.0.0:7070" }, error));
+    CHECK(error.find("--token") != std::string::npos);
+    CHECK(Parses({ "--resident", "--listen", "0.0.0.0:7070", "--token", "s3cret" }, error));
+    CHECK(Parses({ "--resident", "--listen", "127.0.0.1:7070" }, error));
+}
+
+TEST(EndlessLineIsCutOff) {
+    std::string error;
+    const auto standIns = StartStandIns(1, "", error);
+    REQUIRE(standIns.size() == 1);
+    Endpoint endpoint;
+    REQUIRE(ParseEndpoint(standIns[0]->endpoint(), endpoint, error));
+    const SocketHandle socket = Connect(endpoint, error);
+    REQUIRE(socket != kInvalidSocket);
+
+    // No newline ever: the server must hang up long before 16 MiB
+    const std::string flood(64 * 1024, 'x');
+    size_t sent = 0;
+    bool cutOff = false;
+    while (!cutOff && sent < 16u << 20) {
+        std::vector<SocketPoll> polls = { { .socket = socket, .wantRead = true, .wantWrite = true } };
+        if (PollSockets(polls, 5000) <= 0) break;
+        char byte;
+        const long received = polls[0].readable ? ReceiveSome(socket, &byte, 1) : kSocketWouldBlock;
+        cutOff = polls[0].failed || received == 0 || received == -1;
+        if (!cutOff && polls[0].writable) {
+            const long written = SendSome(socket, flood.data(), flood.size());
+            cutOff = written == -1;
+            if (written > 0) sent += static_cast<size_t>(written);
+        }
+    }
+    CloseSocket(socket);
+    CHECK(cutOff);
+
+    const std::vector<FleetResult> results = RunFleet(Options(standIns, { "ping" }));
+    REQUIRE(results.size() == 1);
+    CHECK(results[0].status == FleetResult::Status::Ok);
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
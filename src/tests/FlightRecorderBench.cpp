@@ -0,0 +1,58 @@
+// Cost of one flight record: record() and recordText() into static memory
+// before open(), then into the mapped file, from one thread and from four
+// contending for the ring. The optional argument scales the record counts.
+#include "TestHarness.hpp"
+
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FlightRecorder.hpp"
+
+extern FlightRecorder g_flightRecorder;
+
+namespace {
+    // ns per record across threads recording count events each
+    void Contended(const char* name, int threads, uint64_t count, bool text) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([=] {
+                for (uint64_t k = 0; k < count; ++k) {
+                    if (text) g_flightRecorder.recordText(FlightEvent::Message, "monitor HDMI-1");
+                    else g_flightRecorder.record(FlightEvent::Message, k, static_cast<uint64_t>(t));
+                }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+        const double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        printf("%-48s %12.1f ns/op  (%d threads x %llu)\n", name, nanos / static_cast<double>(count * threads), threads,
+            static_cast<unsigned long long>(count));
+    }
+
+    void Run(const char* where, uint64_t count) {
+        const std::string record = std::string("record, ") + where;
+        const std::string recordText = std::string("recordText, ") + where;
+        testing::Bench(record.c_str(), count, [](uint64_t k) { g_flightRecorder.record(FlightEvent::Message, k, k); });
+        testing::Bench(recordText.c_str(), count, [](uint64_t) { g_flightRecorder.recordText(FlightEvent::Message, "monitor HDMI-1"); });
+        Contended((record + ", contended").c_str(), 4, count / 4, false);
+        Contended((recordText + ", contended").c_str(), 4, count / 4, true);
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint64_t count = testing::Iterations(20'000'000, testing::Scale(argc, argv));
+
+    Run("static", count);
+    if (!g_flightRecorder.open()) {
+        fprintf(stderr, "Cannot open the flight recording\n");
+        return 1;
+    }
+    const std::string path = g_flightRecorder.path();
+    Run("mapped", count);
+    g_flightRecorder.close();
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+    return 0;
+}
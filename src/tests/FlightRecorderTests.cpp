@@ -0,0 +1,122 @@
+// The process-wide recorder across open() and close(): what was recorded in
+// static memory moves into the file, threads keep recording up to close(),
+// and recording after close() lands back in static memory. The file is only
+// ever created: a planted link at its name makes open() fail.
+#include "TestHarness.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FlightRecorder.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+extern FlightRecorder g_flightRecorder;
+
+namespace {
+    constexpr int kThreads = 4;
+    constexpr int kRecordsPerThread = 1000;
+
+    // "N events written, K kept, U unreadable"
+    bool Counts(const std::string& text, unsigned long long& written, unsigned long long& kept, size_t& torn) {
+        const size_t line = text.find(" events written");
+        if (line == std::string::npos) return false;
+        const size_t start = text.rfind('\n', line) + 1;
+        return sscanf(text.c_str() + start, "%llu events written, %llu kept, %zu unreadable", &written, &kept, &torn) == 3;
+    }
+
+    std::filesystem::path OwnPath() {
+#ifdef _WIN32
+        const unsigned long pid = GetCurrentProcessId();
+#else
+        const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+        return std::filesystem::temp_directory_path() / ("black_screen_app." + std::to_string(pid) + ".flight");
+    }
+}
+
+TEST(CloseDeletesUnflagged) {
+    REQUIRE(g_flightRecorder.open());
+    const std::string path = g_flightRecorder.path();
+    CHECK(std::filesystem::exists(path));
+    g_flightRecorder.close();
+    CHECK(!std::filesystem::exists(path));
+}
+
+TEST(OpenRecordClose) {
+    g_flightRecorder.record(FlightEvent::Blank, 1);
+    REQUIRE(g_flightRecorder.open());
+    const std::string path = g_flightRecorder.path();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t] {
+            for (int k = 0; k < kRecordsPerThread; ++k) g_flightRecorder.record(FlightEvent::Message, static_cast<uint64_t>(t), k);
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    // Flag a dump so close() keeps the file for decoding
+    g_flightRecorder.dump(FlightEvent::Crash, 0, 0);
+    g_flightRecorder.close();
+    CHECK(std::filesystem::exists(path));
+
+    // The mapping is gone; this must go to static memory
+    g_flightRecorder.record(FlightEvent::Unblank);
+
+    std::string text, error;
+    REQUIRE(DecodeFlightRecording(path, text, error));
+    CHECK(text.find("kept after a crash") != std::string::npos);
+    CHECK(text.find(" blank ") != std::string::npos);      // carried over from static memory
+    CHECK(text.find("unblank") == std::string::npos);
+    unsigned long long written = 0, kept = 0;
+    size_t torn = 0;
+    REQUIRE(Counts(text, written, kept, torn));
+    // At least Start, Blank, the threads' records and the Crash
+    CHECK(written >= 3ull + kThreads * kRecordsPerThread);
+    CHECK_EQ(kept, written);
+    CHECK_EQ(torn, 0u);
+
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+}
+
+TEST(ReplacesOwnStaleFile) {
+    const std::filesystem::path path = OwnPath();
+    std::ofstream(path) << "left by an earlier process with this pid";
+    REQUIRE(g_flightRecorder.open());
+    CHECK(std::filesystem::file_size(path) > 1024);
+    g_flightRecorder.close();
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+}
+
+TEST(RefusesPlantedLink) {
+    const std::filesystem::path path = OwnPath();
+    const std::filesystem::path target = std::filesystem::temp_directory_path() / "black_screen_flight_target";
+    std::ofstream(target) << "victim";
+    std::error_code linked;
+    std::filesystem::create_symlink(target, path, linked);
+    if (!linked) {
+        CHECK(!g_flightRecorder.open());
+        g_flightRecorder.close();
+        CHECK(std::filesystem::file_size(target) == 6);
+        CHECK(std::filesystem::is_symlink(std::filesystem::symlink_status(path)));
+    }
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+    std::filesystem::remove(target, ignored);
+    // Recording carries on in static memory
+    g_flightRecorder.record(FlightEvent::Message);
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
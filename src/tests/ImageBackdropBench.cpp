@@ -0,0 +1,119 @@
+// --image preparation: decoding a 4K BMP and PPM, scaling with the SSE2 and
+// the scalar loops from 4K down to 1080p and up to 8K, and the whole
+// BackdropCache pass that feeds several window sizes from one decode. The
+// optional argument scales the iteration counts.
+#include "TestHarness.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ImageBackdrop.hpp"
+
+namespace {
+    constexpr long kSourceWidth = 3840;
+    constexpr long kSourceHeight = 2160;
+
+    // A bottom-up 24-bit BMP and a PPM of the same smooth picture
+    void WriteImages(const std::string& bmpPath, const std::string& ppmPath, std::vector<uint32_t>& pixels) {
+        pixels.resize(static_cast<size_t>(kSourceWidth) * kSourceHeight);
+        for (long y = 0; y < kSourceHeight; ++y) {
+            for (long x = 0; x < kSourceWidth; ++x) {
+                pixels[static_cast<size_t>(y) * kSourceWidth + x] = static_cast<uint32_t>(((x * 255 / kSourceWidth) << 16) | ((y * 255 / kSourceHeight) << 8) | ((x ^ y) & 0xFF));
+            }
+        }
+
+        const uint32_t stride = kSourceWidth * 3;
+        const uint32_t size = 54 + stride * kSourceHeight;
+        uint8_t header[54] = { 'B', 'M' };
+        auto put32 = [&](int at, uint32_t value) { for (int k = 0; k < 4; ++k) header[at + k] = static_cast<uint8_t>(value >> (8 * k)); };
+        put32(2, size);
+        put32(10, 54);
+        put32(14, 40);
+        put32(18, kSourceWidth);
+        put32(22, kSourceHeight);
+        header[26] = 1;
+        header[28] = 24;
+        std::vector<uint8_t> bgr(static_cast<size_t>(stride) * kSourceHeight);
+        std::vector<uint8_t> rgb(bgr.size());
+        for (long y = 0; y < kSourceHeight; ++y) {
+            for (long x = 0; x < kSourceWidth; ++x) {
+                const uint32_t pixel = pixels[static_cast<size_t>(y) * kSourceWidth + x];
+                uint8_t* out = bgr.data() + static_cast<size_t>(kSourceHeight - 1 - y) * stride + x * 3;
+                out[0] = static_cast<uint8_t>(pixel);
+                out[1] = static_cast<uint8_t>(pixel >> 8);
+                out[2] = static_cast<uint8_t>(pixel >> 16);
+                uint8_t* top = rgb.data() + static_cast<size_t>(y) * stride + x * 3;
+                top[0] = out[2];
+                top[1] = out[1];
+                top[2] = out[0];
+            }
+        }
+        std::ofstream bmp(bmpPath, std::ios::binary);
+        bmp.write(reinterpret_cast<const char*>(header), sizeof(header));
+        bmp.write(reinterpret_cast<const char*>(bgr.data()), static_cast<std::streamsize>(bgr.size()));
+        std::ofstream ppm(ppmPath, std::ios::binary);
+        ppm << "P6\n" << kSourceWidth << ' ' << kSourceHeight << "\n255\n";
+        ppm.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+    }
+
+    void Decode(const MappedFile& file, std::vector<uint32_t>& out) {
+        std::string error;
+        std::unique_ptr<ImageSource> source = OpenImage(file, error);
+        if (source) source->readRows(source->height(), out.data());
+    }
+}
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+    const std::string bmpPath = (std::filesystem::temp_directory_path() / "black_screen_image_bench.bmp").string();
+    const std::string ppmPath = (std::filesystem::temp_directory_path() / "black_screen_image_bench.ppm").string();
+    std::vector<uint32_t> source;
+    WriteImages(bmpPath, ppmPath, source);
+
+    {
+        MappedFile bmp, ppm;
+        if (!bmp.open(bmpPath) || !ppm.open(ppmPath)) {
+            fprintf(stderr, "Cannot map the bench images\n");
+            return 1;
+        }
+        std::vector<uint32_t> decoded(source.size());
+        const uint64_t decodes = testing::Iterations(50, scale);
+        testing::Bench("decode 4K BMP", decodes, [&](uint64_t) { Decode(bmp, decoded); });
+        testing::Bench("decode 4K PPM", decodes, [&](uint64_t) { Decode(ppm, decoded); });
+        testing::KeepAlive(decoded[0]);
+    }
+
+    const Rect whole = { 0, 0, kSourceWidth, kSourceHeight };
+    const struct { const char* name; long width, height; uint64_t iterations; } sizes[] = {
+        { "4K to 1080p", 1920, 1080, 20 },
+        { "4K to 1440p", 2560, 1440, 20 },
+        { "4K to 8K", 7680, 4320, 5 },
+    };
+    for (const auto& size : sizes) {
+        const uint64_t iterations = testing::Iterations(size.iterations, scale);
+        for (const bool simd : { true, false }) {
+            const std::string name = std::string("scale ") + size.name + (simd ? " SSE2" : " scalar");
+            testing::Bench(name.c_str(), iterations, [&](uint64_t) {
+                ImageScaler scaler(whole, size.width, size.height, simd);
+                for (long y = 0; y < kSourceHeight; ++y) scaler.pushRow(y, source.data() + static_cast<size_t>(y) * kSourceWidth);
+                testing::KeepAlive(scaler.take());
+            });
+        }
+    }
+
+    // A desk of mixed monitors: one decode feeds three sizes
+    testing::Bench("cache prepare 3 sizes", testing::Iterations(10, scale), [&](uint64_t) {
+        BackdropCache cache;
+        std::string error;
+        cache.open({ bmpPath, ImageFit::Fill }, error);
+        cache.prepare({ { 1920, 1080 }, { 2560, 1440 }, { 1920, 1200 } }, error);
+        testing::KeepAlive(cache.find(1920, 1080));
+    });
+
+    std::error_code ignored;
+    std::filesystem::remove(bmpPath, ignored);
+    std::filesystem::remove(ppmPath, ignored);
+    return 0;
+}
@@ -0,0 +1,210 @@
+// The portable BMP and PPM decoders on malformed and edge-case headers, and
+// the scaler's SSE2 loops against its scalar ones: both must produce the
+// same pixels for every size, odd widths and the unrolled tails included.
+#include "TestHarness.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ImageBackdrop.hpp"
+
+namespace {
+    std::string TempPath(const char* name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    void WriteFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    void Put32(std::vector<uint8_t>& bytes, size_t at, uint32_t value) {
+        for (int k = 0; k < 4; ++k) bytes[at + k] = static_cast<uint8_t>(value >> (8 * k));
+    }
+
+    // 24-bit BI_RGB; rows are given top to bottom and stored in the order the
+    // sign of height asks for, each padded to four bytes
+    std::vector<uint8_t> MakeBmp(long width, int32_t height, const std::vector<uint32_t>& pixels) {
+        const size_t stride = (static_cast<size_t>(width) * 3 + 3) & ~size_t{ 3 };
+        const long rows = height < 0 ? -height : height;
+        std::vector<uint8_t> bytes(54 + stride * rows, 0);
+        bytes[0] = 'B';
+        bytes[1] = 'M';
+        Put32(bytes, 2, static_cast<uint32_t>(bytes.size()));
+        Put32(bytes, 10, 54);
+        Put32(bytes, 14, 40);
+        Put32(bytes, 18, static_cast<uint32_t>(width));
+        Put32(bytes, 22, static_cast<uint32_t>(height));
+        bytes[26] = 1;
+        bytes[28] = 24;
+        for (long y = 0; y < rows; ++y) {
+            uint8_t* row = bytes.data() + 54 + stride * (height < 0 ? y : rows - 1 - y);
+            for (long x = 0; x < width; ++x) {
+                const uint32_t pixel = pixels[static_cast<size_t>(y) * width + x];
+                row[x * 3] = static_cast<uint8_t>(pixel);
+                row[x * 3 + 1] = static_cast<uint8_t>(pixel >> 8);
+                row[x * 3 + 2] = static_cast<uint8_t>(pixel >> 16);
+            }
+        }
+        return bytes;
+    }
+
+    std::vector<uint8_t> MakePpm(const std::string& header, size_t samples, uint8_t value) {
+        std::vector<uint8_t> bytes(header.begin(), header.end());
+        bytes.insert(bytes.end(), samples, value);
+        return bytes;
+    }
+
+    // Decodes the whole image, or returns false with error set
+    bool Decode(const std::vector<uint8_t>& bytes, long& width, long& height, std::vector<uint32_t>& pixels, std::string& error) {
+        const std::string path = TempPath("black_screen_image_test.img");
+        WriteFile(path, bytes);
+        bool ok = false;
+        {
+            MappedFile file;
+            if (file.open(path)) {
+                std::unique_ptr<ImageSource> source = OpenImage(file, error);
+                if (source) {
+                    width = source->width();
+                    height = source->height();
+                    pixels.assign(static_cast<size_t>(width) * height, 0);
+                    ok = source->readRows(height, pixels.data());
+                }
+            }
+        }
+        std::filesystem::remove(path);
+        return ok;
+    }
+
+    std::vector<uint32_t> RandomPixels(testing::Random& random, long width, long height) {
+        std::vector<uint32_t> pixels(static_cast<size_t>(width) * height);
+        for (uint32_t& pixel : pixels) pixel = static_cast<uint32_t>(random.below(1u << 24));
+        return pixels;
+    }
+
+    std::vector<uint32_t> Scale(const std::vector<uint32_t>& source, long sourceWidth, const Rect& crop, long width, long height, bool simd) {
+        ImageScaler scaler(crop, width, height, simd);
+        for (long y = 0; y < crop.bottom; ++y) scaler.pushRow(y, source.data() + static_cast<size_t>(y) * sourceWidth);
+        return scaler.take();
+    }
+}
+
+TEST(TruncatedBmp) {
+    const std::vector<uint8_t> whole = MakeBmp(4, 4, std::vector<uint32_t>(16, 0x123456));
+    long width = 0, height = 0;
+    std::vector<uint32_t> pixels;
+    std::string error;
+
+    // Header cut short, then the last pixel row missing
+    CHECK(!Decode(std::vector<uint8_t>(whole.begin(), whole.begin() + 40), width, height, pixels, error));
+    CHECK(!error.empty());
+    error.clear();
+    CHECK(!Decode(std::vector<uint8_t>(whole.begin(), whole.end() - 1), width, height, pixels, error));
+    CHECK(!error.empty());
+
+    // Pixel data offset past the end of the file
+    std::vector<uint8_t> offset = whole;
+    Put32(offset, 10, static_cast<uint32_t>(whole.size() + 1));
+    error.clear();
+    CHECK(!Decode(offset, width, height, pixels, error));
+    CHECK(!error.empty());
+}
+
+TEST(NegativeHeightBmpIsTopDown) {
+    const std::vector<uint32_t> image = { 0xFF0000, 0x00FF00, 0x0000FF, 0x102030, 0x405060, 0x708090 };
+    for (const int32_t height : { 2, -2 }) {
+        long width = 0, rows = 0;
+        std::vector<uint32_t> pixels;
+        std::string error;
+        REQUIRE(Decode(MakeBmp(3, height, image), width, rows, pixels, error));
+        CHECK_EQ(width, 3);
+        CHECK_EQ(rows, 2);
+        CHECK(pixels == image);
+    }
+
+    // INT32_MIN has no positive counterpart
+    long width = 0, rows = 0;
+    std::vector<uint32_t> pixels;
+    std::string error;
+    std::vector<uint8_t> bytes = MakeBmp(1, 1, { 0 });
+    Put32(bytes, 22, 0x80000000u);
+    CHECK(!Decode(bytes, width, rows, pixels, error));
+}
+
+TEST(OddWidthBmpRowPadding) {
+    // 1, 3, 5 and 7 pixels of 24 bits leave 1 to 3 bytes of padding per row
+    testing::Random random(7);
+    for (long width = 1; width <= 7; width += 2) {
+        const std::vector<uint32_t> image = RandomPixels(random, width, 3);
+        long decodedWidth = 0, rows = 0;
+        std::vector<uint32_t> pixels;
+        std::string error;
+        REQUIRE(Decode(MakeBmp(width, 3, image), decodedWidth, rows, pixels, error));
+        CHECK_EQ(decodedWidth, width);
+        CHECK(pixels == image);
+    }
+}
+
+TEST(PpmMaxValue) {
+    long width = 0, height = 0;
+    std::vector<uint32_t> pixels;
+    std::string error;
+
+    for (const char* header : { "P6\n2 2\n0\n", "P6\n2 2\n256\n", "P6\n2 2\n65535\n", "P6\n2 2\n\n" }) {
+        error.clear();
+        CHECK(!Decode(MakePpm(header, 12, 0), width, height, pixels, error));
+        CHECK(!error.empty());
+    }
+
+    // Samples below 255 scale up to full range
+    REQUIRE(Decode(MakePpm("P6\n# comment\n2 2\n15\n", 12, 15), width, height, pixels, error));
+    CHECK(pixels == std::vector<uint32_t>(4, 0xFFFFFF));
+    REQUIRE(Decode(MakePpm("P6 2 2 255\n", 12, 0x40), width, height, pixels, error));
+    CHECK(pixels == std::vector<uint32_t>(4, 0x404040));
+
+    error.clear();
+    CHECK(!Decode(MakePpm("P6\n2 2\n255\n", 11, 0), width, height, pixels, error));
+    CHECK(!error.empty());
+}
+
+TEST(ScalerSimdMatchesScalar) {
+    testing::Random random(11);
+    const struct { long sourceWidth, sourceHeight, width, height; } sizes[] = {
+        { 64, 48, 64, 48 },         // identity
+        { 640, 480, 7, 5 },         // heavy shrink, odd widths
+        { 33, 17, 101, 99 },        // enlarge, odd widths
+        { 1921, 1081, 1280, 720 },
+        { 3, 3, 1, 1 },
+    };
+    for (const auto& size : sizes) {
+        const std::vector<uint32_t> source = RandomPixels(random, size.sourceWidth, size.sourceHeight);
+        const Rect whole = { 0, 0, size.sourceWidth, size.sourceHeight };
+        const std::vector<uint32_t> simd = Scale(source, size.sourceWidth, whole, size.width, size.height, true);
+        const std::vector<uint32_t> scalar = Scale(source, size.sourceWidth, whole, size.width, size.height, false);
+        CHECK_EQ(simd.size(), static_cast<size_t>(size.width) * size.height);
+        CHECK(simd == scalar);
+    }
+
+    // Random crops and output sizes, even and odd
+    for (int round = 0; round < 50; ++round) {
+        const long sourceWidth = random.between(1, 200), sourceHeight = random.between(1, 200);
+        const std::vector<uint32_t> source = RandomPixels(random, sourceWidth, sourceHeight);
+        const long left = random.below(sourceWidth), top = random.below(sourceHeight);
+        const Rect crop = { left, top, random.between(left + 1, sourceWidth + 1), random.between(top + 1, sourceHeight + 1) };
+        const long width = random.between(1, 300), height = random.between(1, 300);
+        CHECK(Scale(source, sourceWidth, crop, width, height, true) == Scale(source, sourceWidth, crop, width, height, false));
+    }
+}
+
+TEST(ScalerFlatColorStaysFlat) {
+    const std::vector<uint32_t> source(99 * 77, 0x336699);
+    for (const bool simd : { true, false }) {
+        const std::vector<uint32_t> out = Scale(source, 99, { 0, 0, 99, 77 }, 37, 141, simd);
+        CHECK(out == std::vector<uint32_t>(out.size(), 0x336699));
+    }
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
@@ -0,0 +1,25 @@
+// The --stress-input replay as a benchmark: a mouse and paint flood through
+// the window procedure's decisions and the software paint path, then key
+// presses behind a backlog, for one-shot and resident windows. The optional
+// argument scales the flood length and the number of key presses.
+#include "TestHarness.hpp"
+
+#include "InputStress.hpp"
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+
+    for (const bool resident : { false, true }) {
+        StressOptions options;
+        options.events = testing::Iterations(1'000'000, scale);
+        options.rounds = static_cast<int>(testing::Iterations(200, scale));
+        options.resident = resident;
+        const StressReport report = RunInputStress(options);
+        printf("%s\n", FormatStressReport(report).c_str());
+        if (report.dispatched == 0 || report.keyToGone.count == 0) {
+            fprintf(stderr, "The replay dispatched nothing\n");
+            return 1;
+        }
+    }
+    return 0;
+}
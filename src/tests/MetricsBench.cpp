@@ -0,0 +1,55 @@
+// Cost of recording into the metrics registry from the hot paths: a paint
+// counter bump, a histogram sample, and both under contention from several
+// threads. The optional argument scales the iteration counts.
+#include "TestHarness.hpp"
+
+#include <thread>
+
+#include "Metrics.hpp"
+
+namespace {
+    // Mean nanoseconds per call with threads recording at once
+    template <typename Body>
+    double Contended(int threads, uint64_t iterations, Body body) {
+        std::vector<std::thread> workers;
+        const auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                for (uint64_t k = 0; k < iterations; ++k) body(t, k);
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+        const double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        return nanos / static_cast<double>(iterations * threads);
+    }
+}
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+    const uint64_t iterations = testing::Iterations(20'000'000, scale);
+
+    testing::Bench("MetricsClock", iterations, [](uint64_t) {
+        testing::KeepAlive(MetricsClock());
+    });
+    testing::Bench("recordPaint", iterations, [](uint64_t k) {
+        g_metrics.recordPaint(static_cast<int>(k & 3));
+    });
+    testing::Bench("LatencyHistogram::record", iterations, [](uint64_t k) {
+        g_metrics.timeToBlack.record(1'000 + (k & 0xFFFFF));
+    });
+    testing::Bench("clock + record (one timed section)", iterations, [](uint64_t) {
+        const uint64_t start = MetricsClock();
+        g_metrics.enumerationTime.record(MetricsClock() - start);
+    });
+    testing::Bench("summarize", testing::Iterations(20'000, scale), [](uint64_t) {
+        testing::KeepAlive(g_metrics.timeToBlack.summarize());
+    });
+
+    for (int threads : { 2, 4, 8 }) {
+        const uint64_t each = testing::Iterations(5'000'000, scale);
+        const double paint = Contended(threads, each, [](int t, uint64_t) { g_metrics.recordPaint(t); });
+        const double record = Contended(threads, each, [](int, uint64_t k) { g_metrics.timeToUnblank.record(1'000 + (k & 0xFFFFF)); });
+        printf("%d threads: recordPaint %.1f ns/op, record %.1f ns/op\n", threads, paint, record);
+    }
+    return 0;
+}
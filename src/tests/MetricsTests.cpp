@@ -0,0 +1,42 @@
+// Histogram bucketing and quantiles, and the Prometheus text of a snapshot.
+#include "TestHarness.hpp"
+
+#include "Metrics.hpp"
+
+TEST(BucketsAreMonotonic) {
+    size_t previous = 0;
+    for (uint64_t nanos = 1; nanos < (1ull << 39); nanos += nanos / 7 + 1) {
+        const size_t bucket = LatencyHistogram::bucketOf(nanos);
+        CHECK(bucket >= previous);
+        CHECK(bucket < LatencyHistogram::kBuckets);
+        CHECK(LatencyHistogram::bucketLowerBound(bucket) <= nanos);
+        previous = bucket;
+    }
+}
+
+TEST(QuantilesWithinBucketError) {
+    LatencyHistogram histogram;
+    for (uint64_t k = 1; k <= 10'000; ++k) histogram.record(k * 1'000);
+    const LatencyHistogram::Summary s = histogram.summarize();
+    CHECK_EQ(s.count, 10'000u);
+    CHECK_EQ(s.max, 10'000'000u);
+    auto near = [](uint64_t value, double expected) {
+        return value >= expected * 0.93 && value <= expected * 1.07;
+    };
+    CHECK(near(s.p50, 5e6));
+    CHECK(near(s.p90, 9e6));
+    CHECK(near(s.p99, 9.9e6));
+}
+
+TEST(PrometheusTextCarriesPoolMetrics) {
+    g_metrics.poolFlips.fetch_add(3);
+    g_metrics.poolCreateTime.record(2'000'000);
+    const std::string text = FormatPrometheus(TakeMetricsSnapshot());
+    CHECK(text.find("black_screen_pool_flips_total 3") != std::string::npos);
+    CHECK(text.find("black_screen_pool_create_seconds_count 1") != std::string::npos);
+    CHECK(text.find("# TYPE black_screen_blanks_total counter") != std::string::npos);
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
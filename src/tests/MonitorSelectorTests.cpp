@@ -0,0 +1,91 @@
+// Property tests for the monitor spatial index and selection queries: random
+// monitor tables on a small grid, checked against a linear scan.
+#include "TestHarness.hpp"
+
+#include <algorithm>
+
+#include "MonitorSelector.hpp"
+#include "RectSet.hpp"
+
+namespace {
+    constexpr long kGrid = 48;
+    constexpr int kRounds = 300;
+
+    Rect RandomRect(testing::Random& random) {
+        const long left = random.below(kGrid);
+        const long top = random.below(kGrid);
+        // Empty and degenerate rects on purpose now and then
+        return { left, top, left + random.below(kGrid / 2), top + random.below(kGrid / 2) };
+    }
+
+    std::vector<MonitorData> RandomMonitors(testing::Random& random) {
+        std::vector<MonitorData> monitors(static_cast<size_t>(1 + random.below(10)));
+        int index = 0;
+        for (MonitorData& m : monitors) {
+            const Rect r = RandomRect(random);
+            m.rect = toRECT({ r.left - kGrid / 2, r.top - kGrid / 2, r.right - kGrid / 2 + 1, r.bottom - kGrid / 2 + 1 });
+            m.index = index++;
+        }
+        return monitors;
+    }
+
+    bool Overlaps(const RECT& a, const RECT& b) {
+        return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+    }
+
+    bool Touches(const RECT& a, const RECT& b) {
+        const long overlapX = (std::min)(a.right, b.right) - (std::max)(a.left, b.left);
+        const long overlapY = (std::min)(a.bottom, b.bottom) - (std::max)(a.top, b.top);
+        return overlapX >= 0 && overlapY >= 0 && (overlapX > 0 || overlapY > 0);
+    }
+}
+
+TEST(SpatialIndexMatchesLinearScan) {
+    testing::Random random(5);
+    for (int round = 0; round < kRounds; ++round) {
+        const std::vector<MonitorData> monitors = RandomMonitors(random);
+        const SpatialIndex index(monitors);
+        for (int probe = 0; probe < 20; ++probe) {
+            const Rect r = RandomRect(random);
+            const RECT area = toRECT({ r.left - kGrid, r.top - kGrid, r.right, r.bottom });
+
+            std::vector<int> overlapping, touching;
+            for (size_t k = 0; k < monitors.size(); ++k) {
+                const RECT& m = monitors[k].rect;
+                if (m.right <= m.left || m.bottom <= m.top) continue;
+                if (Overlaps(m, area)) overlapping.push_back(static_cast<int>(k));
+                if (Touches(m, area)) touching.push_back(static_cast<int>(k));
+            }
+            CHECK(index.query(area) == overlapping);
+            CHECK(index.touching(area) == touching);
+        }
+    }
+}
+
+TEST(QueryRectAndEdgesMatchLinearScan) {
+    testing::Random random(6);
+    for (int round = 0; round < kRounds; ++round) {
+        std::vector<MonitorData> monitors = RandomMonitors(random);
+        std::erase_if(monitors, [](const MonitorData& m) { return m.rect.right <= m.rect.left || m.rect.bottom <= m.rect.top; });
+        if (monitors.empty()) continue;
+        const SpatialIndex index(monitors);
+        const RECT bounds = index.bounds();
+
+        std::vector<int> left, notLeft;
+        for (size_t k = 0; k < monitors.size(); ++k) {
+            (monitors[k].rect.left == bounds.left ? left : notLeft).push_back(static_cast<int>(k));
+        }
+        CHECK(MonitorQuery::compile("left").evaluate(monitors, index) == left);
+        CHECK(MonitorQuery::compile("!left").evaluate(monitors, index) == notLeft);
+        CHECK(MonitorQuery::compile("left | !left").evaluate(monitors, index).size() == monitors.size());
+        CHECK(MonitorQuery::compile("left & !left").evaluate(monitors, index).empty());
+
+        // adjacent() never selects its own operand
+        const std::vector<int> adjacent = MonitorQuery::compile("adjacent(left)").evaluate(monitors, index);
+        for (int position : adjacent) CHECK(!std::ranges::binary_search(left, position));
+    }
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
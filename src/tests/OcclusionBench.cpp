@@ -0,0 +1,34 @@
+// The --stress-occlusion day as a benchmark: timer wakeups and restacks of
+// the guard against re-asserting on every event and polling every 250 ms,
+// plus the cost of one note() on the hook path. The optional argument scales
+// the simulated minutes and the note count.
+#include "TestHarness.hpp"
+
+#include "OcclusionGuard.hpp"
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+
+    OcclusionStressOptions options;
+    options.minutes = testing::Iterations(8 * 60, scale);
+    const OcclusionStressReport report = RunOcclusionStress(options);
+    printf("%s\n", FormatOcclusionStressReport(report).c_str());
+    if (report.events == 0 || report.guard.timerWakeups > report.polling.timerWakeups) {
+        fprintf(stderr, "No events replayed, or the guard woke more often than polling\n");
+        return 1;
+    }
+
+    // Hook events over our windows and beside them, as they arrive during a storm
+    OcclusionGuard guard;
+    guard.setWindows({ { 0, 0, 1920, 1080 }, { 1920, 0, 3840, 1080 } });
+    const Rect rects[] = { { 100, 100, 500, 400 }, { 4000, 0, 4500, 400 }, { 1800, 200, 2100, 600 }, {} };
+    uint64_t now = 0;
+    std::vector<size_t> affected;
+    testing::Bench("note", testing::Iterations(20'000'000, scale), [&](uint64_t k) {
+        now += 1'000'000;
+        guard.note(rects[k % 4], now);
+        if ((k & 255) == 255) guard.settle(guard.deadline(), affected);
+    });
+    testing::KeepAlive(affected);
+    return 0;
+}
@@ -0,0 +1,147 @@
+// The occlusion guard's timing and filtering: the quiet-time deadline, the
+// cap on a steady trickle, backoff against a window that keeps fighting,
+// which reported windows count, and which blanking windows get restacked.
+#include "TestHarness.hpp"
+
+#include <algorithm>
+
+#include "OcclusionGuard.hpp"
+
+namespace {
+    constexpr uint64_t kMillis = 1'000'000;
+
+    // Two blanking monitors side by side
+    const std::vector<Rect> kWindows = { { 0, 0, 1920, 1080 }, { 1920, 0, 3840, 1080 } };
+    const Rect kOnFirst = { 100, 100, 500, 400 };
+    const Rect kOnSecond = { 2000, 100, 2400, 400 };
+
+    std::vector<size_t> Settle(OcclusionGuard& guard, uint64_t now) {
+        std::vector<size_t> affected;
+        guard.settle(now, affected);
+        return affected;
+    }
+}
+
+TEST(SettlesAfterQuiet) {
+    OcclusionGuard guard;
+    guard.setWindows(kWindows);
+    CHECK_EQ(guard.deadline(), 0u);
+
+    // Only the event that arms the guard asks for a timer; later ones push the deadline
+    CHECK(guard.note(kOnFirst, 1000 * kMillis));
+    CHECK_EQ(guard.deadline(), 1040 * kMillis);
+    CHECK(!guard.note(kOnFirst, 1010 * kMillis));
+    CHECK_EQ(guard.deadline(), 1050 * kMillis);
+
+    std::vector<size_t> affected;
+    CHECK(!guard.settle(1049 * kMillis, affected));
+    CHECK(affected.empty());
+    CHECK(guard.settle(1050 * kMillis, affected));
+    CHECK(affected == std::vector<size_t>{ 0 });
+    CHECK_EQ(guard.deadline(), 0u);
+
+    // Nothing pending: a stray timer does nothing
+    CHECK(!guard.settle(1100 * kMillis, affected));
+}
+
+TEST(SteadyTrickleIsCappedAt200Ms) {
+    OcclusionGuard guard;
+    guard.setWindows(kWindows);
+    CHECK(guard.note(kOnSecond, 5000 * kMillis));
+    for (uint64_t t = 5010; t < 5400; t += 10) {
+        guard.note(kOnSecond, t * kMillis);
+        CHECK(guard.deadline() <= 5200 * kMillis);
+    }
+    CHECK_EQ(guard.deadline(), 5200 * kMillis);
+    CHECK(Settle(guard, 5200 * kMillis) == std::vector<size_t>{ 1 });
+}
+
+TEST(ComebacksBackOffUpTo2s) {
+    OcclusionGuard guard;
+    guard.setWindows(kWindows);
+    uint64_t now = 10'000 * kMillis;
+    guard.note(kOnFirst, now);
+    now = guard.deadline();
+    CHECK(!Settle(guard, now).empty());
+
+    // Coming back within 250 ms of each settle doubles the extra delay: 40, 80, ... 2000 ms
+    uint64_t expected = 40 * kMillis;
+    for (int round = 0; round < 10; ++round) {
+        now += 100 * kMillis;
+        CHECK(guard.note(kOnFirst, now));
+        CHECK_EQ(guard.deadline(), now + 40 * kMillis + expected);
+        now = guard.deadline();
+        CHECK(!Settle(guard, now).empty());
+        expected = (std::min)(expected * 2, 2000 * kMillis);
+    }
+
+    // A comeback after 250 ms keeps the backoff; quiet for over 2 s drops it
+    now += 1000 * kMillis;
+    guard.note(kOnFirst, now);
+    CHECK_EQ(guard.deadline(), now + 40 * kMillis + 2000 * kMillis);
+    now = guard.deadline();
+    Settle(guard, now);
+    now += 2001 * kMillis;
+    guard.note(kOnFirst, now);
+    CHECK_EQ(guard.deadline(), now + 40 * kMillis);
+}
+
+TEST(IgnoresEventsMissingOurWindows) {
+    OcclusionGuard guard;
+    guard.setWindows(kWindows);
+    CHECK(!guard.note({ 4000, 0, 4500, 400 }, kMillis));
+    CHECK(!guard.note({ 1920, 1080, 2000, 1200 }, kMillis));    // touches a corner only
+    CHECK_EQ(guard.deadline(), 0u);
+
+    // An event that says nowhere in particular touches every window
+    CHECK(guard.note({}, kMillis));
+    CHECK(Settle(guard, guard.deadline()) == (std::vector<size_t>{ 0, 1 }));
+
+    // No windows shown, nothing to guard
+    guard.setWindows({});
+    CHECK(!guard.note({}, 2000 * kMillis));
+}
+
+TEST(OnlyForeignTopmostWindowsOcclude) {
+    const ObservedWindow foreign{ kOnFirst };
+    CHECK(CanOcclude(foreign));
+
+    ObservedWindow own = foreign;
+    own.ownProcess = true;
+    ObservedWindow hidden = foreign;
+    hidden.visible = false;
+    ObservedWindow cloaked = foreign;
+    cloaked.cloaked = true;
+    ObservedWindow normal = foreign;
+    normal.topmost = false;
+    ObservedWindow empty = foreign;
+    empty.rect = {};
+    for (const ObservedWindow& window : { own, hidden, cloaked, normal, empty }) CHECK(!CanOcclude(window));
+}
+
+TEST(RestacksOnlyCoveredWindows) {
+    const Rect first = kWindows[0];
+    // Our own windows and ones off to the side do not call for a restack
+    ObservedWindow sibling{ first };
+    sibling.ownProcess = true;
+    const ObservedWindow elsewhere{ kOnSecond };
+    CHECK(!IsOccluded(first, {}));
+    CHECK(!IsOccluded(first, { sibling, elsewhere }));
+    CHECK(IsOccluded(first, { sibling, elsewhere, ObservedWindow{ kOnFirst } }));
+
+    // Of a storm, settle names only the windows it touched
+    OcclusionGuard guard;
+    guard.setWindows({ kWindows[0], kWindows[1], { 3840, 0, 5760, 1080 } });
+    guard.note(kOnSecond, kMillis);
+    guard.note({ 5000, 100, 5400, 300 }, 2 * kMillis);
+    CHECK(Settle(guard, guard.deadline()) == (std::vector<size_t>{ 1, 2 }));
+
+    // New windows during a storm: their indices mean something else now, so all are named
+    guard.note(kOnFirst, 1000 * kMillis);
+    guard.setWindows(kWindows);
+    CHECK(Settle(guard, guard.deadline()) == (std::vector<size_t>{ 0, 1 }));
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
@@ -0,0 +1,44 @@
+// --pattern bitmaps from 1080p to 8K with the SSE2 loops and streaming
+// copies against the scalar loops and memcpy. Both must write the same
+// pixels; the report gives the bitmap size next to the time, since at 4K
+// and up it no longer fits in any cache. The optional argument scales the
+// generation counts.
+#include "TestHarness.hpp"
+
+#include <vector>
+
+#include "TestPattern.hpp"
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+    const struct { const char* name; long width, height; } sizes[] = {
+        { "1080p", 1920, 1080 }, { "1440p", 2560, 1440 }, { "4K", 3840, 2160 }, { "8K", 7680, 4320 },
+    };
+    const struct { const char* name; TestPattern pattern; } patterns[] = {
+        { "grid", TestPattern::Grid }, { "checker", TestPattern::Checker }, { "gradient", TestPattern::Gradient }, { "ramp", TestPattern::Ramp },
+    };
+
+    for (const auto& size : sizes) {
+        const size_t pixels = static_cast<size_t>(size.width) * size.height;
+        printf("%s, %.1f MB bitmap\n", size.name, static_cast<double>(pixels * sizeof(uint32_t)) / (1 << 20));
+        std::vector<uint32_t> simd(pixels), scalar(pixels);
+        const uint64_t iterations = testing::Iterations(static_cast<uint64_t>(2'000'000'000.0 / (static_cast<double>(pixels) * 4.0)), scale);
+        for (const auto& p : patterns) {
+            auto time = [&](std::vector<uint32_t>& out, bool useSimd) {
+                const auto start = std::chrono::steady_clock::now();
+                for (uint64_t k = 0; k < iterations; ++k) GeneratePattern(p.pattern, size.width, size.height, out.data(), useSimd);
+                return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(iterations);
+            };
+            const double simdNanos = time(simd, true);
+            const double scalarNanos = time(scalar, false);
+            const double bytes = static_cast<double>(pixels * sizeof(uint32_t));
+            printf("  %-10s SSE2 %8.2f ms %6.2f GB/s   scalar %8.2f ms %6.2f GB/s\n", p.name, simdNanos / 1e6, bytes / simdNanos,
+                scalarNanos / 1e6, bytes / scalarNanos);
+            if (simd != scalar) {
+                fprintf(stderr, "%s %s: SSE2 and scalar output differ\n", size.name, p.name);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
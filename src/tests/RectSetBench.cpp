@@ -0,0 +1,94 @@
+// Rect algebra and spatial index costs at desktop-like sizes. The optional
+// argument scales the iteration counts; CTest runs it at a small fraction.
+#include "TestHarness.hpp"
+
+#include "MonitorSelector.hpp"
+#include "RectSet.hpp"
+
+namespace {
+    // A wall of 1080p monitors with some exclusion holes, like a -x layout
+    std::vector<Rect> Wall(size_t count) {
+        std::vector<Rect> rects;
+        const long columns = 8;
+        for (size_t k = 0; k < count; ++k) {
+            const long column = static_cast<long>(k) % columns;
+            const long row = static_cast<long>(k) / columns;
+            rects.push_back({ column * 1920, row * 1080, (column + 1) * 1920, (row + 1) * 1080 });
+        }
+        return rects;
+    }
+
+    std::vector<Rect> Holes(size_t count, const Rect& bounds) {
+        testing::Random random(count);
+        std::vector<Rect> holes(count);
+        for (Rect& r : holes) {
+            const long left = bounds.left + random.below(bounds.width() - 800);
+            const long top = bounds.top + random.below(bounds.height() - 600);
+            r = { left, top, left + 200 + random.below(600), top + 150 + random.below(450) };
+        }
+        return holes;
+    }
+
+    std::vector<MonitorData> Monitors(const std::vector<Rect>& rects) {
+        std::vector<MonitorData> monitors(rects.size());
+        for (size_t k = 0; k < rects.size(); ++k) {
+            monitors[k].rect = toRECT(rects[k]);
+            monitors[k].index = static_cast<int>(k);
+        }
+        return monitors;
+    }
+}
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+
+    for (size_t monitors : { 4u, 16u, 64u }) {
+        const std::vector<Rect> wall = Wall(monitors);
+        const RectSet desktop = RectSet::fromRects(wall);
+        const std::vector<Rect> holes = Holes(monitors, desktop.bounds());
+        const RectSet excluded = RectSet::fromRects(holes);
+        const std::string suffix = " (" + std::to_string(monitors) + " monitors)";
+        const uint64_t iterations = testing::Iterations(200'000 / monitors, scale);
+
+        testing::Bench(("fromRects" + suffix).c_str(), iterations, [&](uint64_t) {
+            testing::KeepAlive(RectSet::fromRects(wall));
+        });
+        testing::Bench(("subtract holes" + suffix).c_str(), iterations, [&](uint64_t) {
+            testing::KeepAlive(desktop.subtract(excluded));
+        });
+        const RectSet mask = desktop.subtract(excluded);
+        testing::Bench(("coveringRects" + suffix).c_str(), iterations, [&](uint64_t) {
+            testing::KeepAlive(mask.coveringRects());
+        });
+    }
+
+    for (size_t count : { 4u, 64u, 1024u }) {
+        const std::vector<MonitorData> monitors = Monitors(Wall(count));
+        const std::string suffix = " (" + std::to_string(count) + " monitors)";
+        testing::Bench(("SpatialIndex build" + suffix).c_str(), testing::Iterations(200'000 / count, scale), [&](uint64_t) {
+            testing::KeepAlive(SpatialIndex(monitors));
+        });
+
+        const SpatialIndex index(monitors);
+        const std::vector<Rect> probes = Holes(256, toRect(index.bounds()));
+        const uint64_t iterations = testing::Iterations(1'000'000, scale);
+        testing::Bench(("SpatialIndex query" + suffix).c_str(), iterations, [&](uint64_t k) {
+            testing::KeepAlive(index.query(toRECT(probes[k % probes.size()])));
+        });
+        testing::Bench(("linear scan" + suffix).c_str(), iterations, [&](uint64_t k) {
+            const Rect& p = probes[k % probes.size()];
+            std::vector<int> hits;
+            for (size_t m = 0; m < monitors.size(); ++m) {
+                const RECT& r = monitors[m].rect;
+                if (r.left < p.right && p.left < r.right && r.top < p.bottom && p.top < r.bottom) hits.push_back(static_cast<int>(m));
+            }
+            testing::KeepAlive(hits);
+        });
+
+        const MonitorQuery query = MonitorQuery::compile("rect:100,100,4000,2000 & !primary | adjacent(index:1)");
+        testing::Bench(("MonitorQuery evaluate" + suffix).c_str(), testing::Iterations(200'000, scale), [&](uint64_t) {
+            testing::KeepAlive(query.evaluate(monitors, index));
+        });
+    }
+    return 0;
+}
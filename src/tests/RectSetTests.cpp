@@ -0,0 +1,160 @@
+// Property tests for the rect algebra: random inputs on a small grid, checked
+// pixel by pixel against a brute-force model.
+#include "TestHarness.hpp"
+
+#include <algorithm>
+
+#include "RectSet.hpp"
+
+namespace {
+    constexpr long kGrid = 48;
+    constexpr int kRounds = 300;
+
+    using Pixels = std::vector<char>;
+
+    Rect RandomRect(testing::Random& random) {
+        const long left = random.below(kGrid);
+        const long top = random.below(kGrid);
+        // Empty and degenerate rects on purpose now and then
+        return { left, top, left + random.below(kGrid / 2), top + random.below(kGrid / 2) };
+    }
+
+    std::vector<Rect> RandomRects(testing::Random& random) {
+        std::vector<Rect> rects(static_cast<size_t>(random.below(12)));
+        for (Rect& r : rects) r = RandomRect(random);
+        return rects;
+    }
+
+    Pixels Raster(const std::vector<Rect>& rects) {
+        Pixels pixels(static_cast<size_t>(kGrid * 2 * kGrid * 2), 0);
+        for (const Rect& r : rects) {
+            for (long y = r.top; y < r.bottom; ++y) {
+                for (long x = r.left; x < r.right; ++x) pixels[static_cast<size_t>(y * kGrid * 2 + x)] = 1;
+            }
+        }
+        return pixels;
+    }
+
+    Pixels Raster(const RectSet& set) {
+        Pixels pixels(static_cast<size_t>(kGrid * 2 * kGrid * 2), 0);
+        for (long y = 0; y < kGrid * 2; ++y) {
+            for (long x = 0; x < kGrid * 2; ++x) pixels[static_cast<size_t>(y * kGrid * 2 + x)] = set.contains(x, y);
+        }
+        return pixels;
+    }
+
+    template <typename Op>
+    Pixels Combine(const Pixels& a, const Pixels& b, Op op) {
+        Pixels out(a.size());
+        for (size_t k = 0; k < a.size(); ++k) out[k] = op(a[k] != 0, b[k] != 0);
+        return out;
+    }
+
+    long long Count(const Pixels& pixels) {
+        return std::ranges::count(pixels, 1);
+    }
+
+    // Canonical form: sorted bands with sorted disjoint spans, no mergeable neighbours
+    bool Canonical(const RectSet& set) {
+        const auto& bands = set.bands();
+        for (size_t b = 0; b < bands.size(); ++b) {
+            const RectSet::Band& band = bands[b];
+            if (band.top >= band.bottom || band.spans.empty()) return false;
+            for (size_t s = 0; s < band.spans.size(); ++s) {
+                if (band.spans[s].left >= band.spans[s].right) return false;
+                if (s > 0 && band.spans[s - 1].right >= band.spans[s].left) return false;
+            }
+            if (b > 0) {
+                if (bands[b - 1].bottom > band.top) return false;
+                if (bands[b - 1].bottom == band.top && bands[b - 1].spans == band.spans) return false;
+            }
+        }
+        return true;
+    }
+
+    bool Disjoint(const std::vector<Rect>& rects) {
+        for (size_t i = 0; i < rects.size(); ++i) {
+            for (size_t j = i + 1; j < rects.size(); ++j) {
+                const Rect& a = rects[i];
+                const Rect& b = rects[j];
+                if (a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom) return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST(FromRectsMatchesRaster) {
+    testing::Random random(1);
+    for (int round = 0; round < kRounds; ++round) {
+        const std::vector<Rect> rects = RandomRects(random);
+        const RectSet set = RectSet::fromRects(rects);
+        const Pixels expected = Raster(rects);
+        CHECK(Canonical(set));
+        CHECK(Raster(set) == expected);
+        CHECK_EQ(set.area(), Count(expected));
+        CHECK_EQ(set.empty(), Count(expected) == 0);
+    }
+}
+
+TEST(BooleanOpsMatchRaster) {
+    testing::Random random(2);
+    for (int round = 0; round < kRounds; ++round) {
+        const std::vector<Rect> ra = RandomRects(random);
+        const std::vector<Rect> rb = RandomRects(random);
+        const RectSet a = RectSet::fromRects(ra);
+        const RectSet b = RectSet::fromRects(rb);
+        const Pixels pa = Raster(ra);
+        const Pixels pb = Raster(rb);
+
+        const RectSet u = a.unite(b);
+        const RectSet s = a.subtract(b);
+        const RectSet i = a.intersect(b);
+        CHECK(Canonical(u) && Canonical(s) && Canonical(i));
+        CHECK(Raster(u) == Combine(pa, pb, [](bool x, bool y) { return x || y; }));
+        CHECK(Raster(s) == Combine(pa, pb, [](bool x, bool y) { return x && !y; }));
+        CHECK(Raster(i) == Combine(pa, pb, [](bool x, bool y) { return x && y; }));
+    }
+}
+
+TEST(AlgebraIdentities) {
+    testing::Random random(3);
+    for (int round = 0; round < kRounds; ++round) {
+        const RectSet a = RectSet::fromRects(RandomRects(random));
+        const RectSet b = RectSet::fromRects(RandomRects(random));
+        const RectSet c = RectSet::fromRects(RandomRects(random));
+
+        // Canonical form makes these plain comparisons
+        CHECK(a.unite(b) == b.unite(a));
+        CHECK(a.intersect(b) == b.intersect(a));
+        CHECK(a.unite(b).unite(c) == a.unite(b.unite(c)));
+        CHECK(a.subtract(b).unite(a.intersect(b)) == a);
+        CHECK(a.subtract(b).intersect(b).empty());
+        CHECK(a.intersect(b.unite(c)) == a.intersect(b).unite(a.intersect(c)));
+        CHECK(a.unite(a) == a && a.subtract(a).empty());
+        CHECK_EQ(a.unite(b).area() + a.intersect(b).area(), a.area() + b.area());
+    }
+}
+
+TEST(RectsAndCoverRoundTrip) {
+    testing::Random random(4);
+    for (int round = 0; round < kRounds; ++round) {
+        const RectSet set = RectSet::fromRects(RandomRects(random));
+        const std::vector<Rect> rects = set.rects();
+        const std::vector<Rect> cover = set.coveringRects();
+        CHECK(Disjoint(rects));
+        CHECK(Disjoint(cover));
+        CHECK(RectSet::fromRects(rects) == set);
+        CHECK(RectSet::fromRects(cover) == set);
+        CHECK(cover.size() <= rects.size());
+
+        Rect bounds = set.bounds();
+        for (const Rect& r : rects) {
+            CHECK(r.left >= bounds.left && r.top >= bounds.top && r.right <= bounds.right && r.bottom <= bounds.bottom);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
@@ -0,0 +1,59 @@
+// Full-window paints on the software renderer from 1080p to 8K: flat color,
+// a centred picture, text over color, and one clock tick. The optional
+// argument scales the paint counts.
+#include "TestHarness.hpp"
+
+#include "ImageBackdrop.hpp"
+#include "SoftwareRenderer.hpp"
+#include "SyntheticFont.hpp"
+
+namespace {
+    void Report(const char* what, long width, long height, double nanos, uint64_t bytes) {
+        printf("%-22s %5ldx%-5ld %10.2f ms/paint %8.2f GB/s\n", what, width, height, nanos / 1e6,
+            static_cast<double>(bytes) / nanos);
+    }
+}
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+    const struct { long width, height; } sizes[] = { { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 }, { 5120, 2880 }, { 7680, 4320 } };
+
+    SyntheticFont font;
+    GlyphAtlas atlas(font, 48);
+    TextOverlay overlay(atlas, { 96, 96, 96 }, { 0, 0, 0 });
+    overlay.update({ "Back in five minutes", "12:34" });
+
+    for (const auto& size : sizes) {
+        SoftwareRenderer surface(size.width, size.height);
+        Backdrop picture{ size.width / 2, size.height / 2, std::vector<uint32_t>(static_cast<size_t>(size.width / 2) * (size.height / 2), 0x336699) };
+        const uint64_t paints = testing::Iterations(static_cast<uint64_t>(4'000'000'000.0 / (size.width * size.height * 4.0)), scale);
+
+        const struct { const char* name; PaintScene scene; } scenes[] = {
+            { "flat color", { 0, 0, 0, nullptr, nullptr } },
+            { "picture", { 0, 0, 0, &picture, nullptr } },
+            { "text", { 0, 0, 0, nullptr, &overlay } },
+        };
+        for (const auto& s : scenes) {
+            surface.resetStats();
+            const auto start = std::chrono::steady_clock::now();
+            for (uint64_t k = 0; k < paints; ++k) surface.paint(s.scene);
+            const double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            Report(s.name, size.width, size.height, nanos / static_cast<double>(paints), surface.stats().bytes / paints);
+        }
+        testing::KeepAlive(surface.frame().pixels[0]);
+    }
+
+    // A clock tick: only the changed digit cell is recomposed and repainted
+    SoftwareRenderer surface(7680, 4320);
+    const PaintScene scene{ 0, 0, 0, nullptr, &overlay };
+    surface.paint(scene);
+    const Rect block = CentredRect(7680, 4320, overlay.width(), overlay.height());
+    int minute = 0;
+    testing::Bench("clock tick at 8K", testing::Iterations(200'000, scale), [&](uint64_t) {
+        const std::string now = "12:3" + std::to_string(minute = (minute + 1) % 10);
+        for (const Rect& r : overlay.update({ "Back in five minutes", now })) {
+            surface.paint(scene, { r.left + block.left, r.top + block.top, r.right + block.left, r.bottom + block.top });
+        }
+    });
+    return 0;
+}
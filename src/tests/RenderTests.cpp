@@ -0,0 +1,191 @@
+// Golden frames for PaintWindow on the software renderer: flat color,
+// centred picture, text block, calibration patterns and partial repaints.
+// Each frame is checked pixel by pixel where the expectation is simple and
+// against a recorded FNV-1a hash where it is not (text, patterns); a hash
+// change means the rendered pixels changed.
+#include "TestHarness.hpp"
+
+#include <algorithm>
+
+#include "ImageBackdrop.hpp"
+#include "SoftwareRenderer.hpp"
+#include "SyntheticFont.hpp"
+#include "TestPattern.hpp"
+
+namespace {
+    constexpr uint32_t kColor = 0x102030;
+    constexpr uint32_t kSentinel = 0xABCDEF;
+
+    uint64_t Hash(const Frame& frame) {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (uint32_t pixel : frame.pixels) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                hash ^= (pixel >> shift) & 0xFF;
+                hash *= 0x100000001B3ull;
+            }
+        }
+        return hash;
+    }
+
+    // Reports the actual hash so a deliberate rendering change can update the golden
+    bool MatchesGolden(const char* name, const Frame& frame, uint64_t golden) {
+        const uint64_t actual = Hash(frame);
+        if (actual != golden) fprintf(stderr, "%s: frame hash 0x%016llXull\n", name, static_cast<unsigned long long>(actual));
+        return actual == golden;
+    }
+
+    Backdrop Picture(long width, long height) {
+        Backdrop backdrop{ width, height, std::vector<uint32_t>(static_cast<size_t>(width) * height) };
+        for (long y = 0; y < height; ++y) {
+            for (long x = 0; x < width; ++x) {
+                backdrop.pixels[static_cast<size_t>(y) * width + x] = static_cast<uint32_t>(((x & 0xFF) << 16) | ((y & 0xFF) << 8) | ((x + y) & 0xFF));
+            }
+        }
+        return backdrop;
+    }
+
+    PaintScene Scene(uint32_t color, const Backdrop* backdrop = nullptr, const TextOverlay* overlay = nullptr) {
+        return { 0, 0, color, backdrop, overlay };
+    }
+}
+
+TEST(FlatColorWritesEveryPixelOnce) {
+    SoftwareRenderer surface(640, 360);
+    surface.paint(Scene(kColor));
+    CHECK(std::ranges::all_of(surface.frame().pixels, [](uint32_t p) { return p == kColor; }));
+    CHECK_EQ(surface.stats().bytes, 640u * 360u * 4u);
+}
+
+TEST(PictureIsCentredOverTheColor) {
+    SoftwareRenderer surface(640, 360);
+    const Backdrop picture = Picture(200, 100);
+    surface.paint(Scene(kColor, &picture));
+
+    const Frame& frame = surface.frame();
+    const Rect placed = CentredRect(640, 360, 200, 100);
+    for (long y = 0; y < 360; y += 7) {
+        for (long x = 0; x < 640; x += 5) {
+            const bool inside = x >= placed.left && x < placed.right && y >= placed.top && y < placed.bottom;
+            const uint32_t expected = inside ? picture.pixels[static_cast<size_t>(y - placed.top) * 200 + (x - placed.left)] : kColor;
+            if (frame.at(x, y) != expected) {
+                CHECK(frame.at(x, y) == expected);
+                return;
+            }
+        }
+    }
+    CHECK_EQ(surface.stats().bytes, 640u * 360u * 4u);
+}
+
+TEST(TextBlockGolden) {
+    SyntheticFont font;
+    GlyphAtlas atlas(font, 32);
+    TextOverlay overlay(atlas, { 200, 200, 200 }, { 16, 32, 48 });
+    overlay.update({ "Back at 12:34", "Hello, world" });
+
+    SoftwareRenderer surface(640, 360);
+    surface.paint(Scene(kColor, nullptr, &overlay));
+    const Frame& frame = surface.frame();
+    CHECK_EQ(frame.at(0, 0), kColor);
+    CHECK_EQ(surface.stats().bytes, 640u * 360u * 4u);
+    CHECK(MatchesGolden("TextBlockGolden", frame, 0x757497AFBFC59CFDull));
+}
+
+TEST(TextOverPictureGolden) {
+    SyntheticFont font;
+    GlyphAtlas atlas(font, 24);
+    TextOverlay overlay(atlas, { 255, 255, 255 }, { 0, 0, 0 });
+    overlay.update({ "Maintenance" });
+    const Backdrop picture = Picture(320, 180);
+
+    SoftwareRenderer surface(480, 270);
+    surface.paint(Scene(0, &picture, &overlay));
+    CHECK_EQ(surface.stats().bytes, 480u * 270u * 4u);
+    CHECK(MatchesGolden("TextOverPictureGolden", surface.frame(), 0xBC60418F07472460ull));
+}
+
+TEST(ClockTickRedrawsOnlyChangedCells) {
+    SyntheticFont font;
+    GlyphAtlas atlas(font, 32);
+    TextOverlay overlay(atlas, { 200, 200, 200 }, { 16, 32, 48 });
+    overlay.update({ "12:34" });
+
+    SoftwareRenderer incremental(640, 360);
+    incremental.paint(Scene(kColor, nullptr, &overlay));
+
+    // 12:34 -> 12:35: the last digit only, and a repaint of just that matches a full one
+    const std::vector<Rect> changed = overlay.update({ "12:35" });
+    REQUIRE(!overlay.resized());
+    REQUIRE(changed.size() == 1);
+    const Rect block = CentredRect(640, 360, overlay.width(), overlay.height());
+    incremental.resetStats();
+    for (const Rect& r : changed) {
+        incremental.paint(Scene(kColor, nullptr, &overlay), { r.left + block.left, r.top + block.top, r.right + block.left, r.bottom + block.top });
+    }
+    CHECK(incremental.stats().bytes < static_cast<uint64_t>(overlay.width()) * overlay.height() * 4 / 3);
+
+    SoftwareRenderer full(640, 360);
+    full.paint(Scene(kColor, nullptr, &overlay));
+    CHECK(incremental.frame() == full.frame());
+}
+
+TEST(PartialRepaintTouchesOnlyDirtyPixels) {
+    const Backdrop picture = Picture(200, 100);
+    SoftwareRenderer surface(640, 360);
+    surface.fill({ 0, 0, 640, 360 }, kSentinel);
+    const Rect dirty = { 100, 100, 300, 200 };
+    surface.paint(Scene(kColor, &picture), dirty);
+
+    const Frame& frame = surface.frame();
+    SoftwareRenderer reference(640, 360);
+    reference.paint(Scene(kColor, &picture));
+    bool ok = true;
+    for (long y = 0; y < 360 && ok; ++y) {
+        for (long x = 0; x < 640 && ok; ++x) {
+            const bool inside = x >= dirty.left && x < dirty.right && y >= dirty.top && y < dirty.bottom;
+            ok = frame.at(x, y) == (inside ? reference.frame().at(x, y) : kSentinel);
+        }
+    }
+    CHECK(ok);
+}
+
+TEST(PatternGoldens) {
+    const struct { TestPattern pattern; uint64_t golden; } cases[] = {
+        { TestPattern::Grid, 0x938390F2FE7C137Cull },
+        { TestPattern::Checker, 0x02DB3ACE5FE457FCull },
+        { TestPattern::Gradient, 0xBC0865E63134BFACull },
+        { TestPattern::Ramp, 0xE740B7A701E96B38ull },
+    };
+    for (const auto& c : cases) {
+        PatternCache patterns;
+        patterns.prepare(c.pattern, 333, 197);
+        const Backdrop* bitmap = patterns.find(c.pattern, 333, 197);
+        REQUIRE(bitmap);
+        SoftwareRenderer surface(333, 197);
+        surface.paint(Scene(0, bitmap));
+        CHECK(MatchesGolden(("PatternGoldens " + std::to_string(static_cast<int>(c.pattern))).c_str(), surface.frame(), c.golden));
+    }
+
+    // Spot checks that do not depend on the hash
+    PatternCache patterns;
+    patterns.prepare(TestPattern::Checker, 256, 128);
+    const Backdrop* checker = patterns.find(TestPattern::Checker, 256, 128);
+    REQUIRE(checker);
+    CHECK_EQ(checker->pixels[0], 0xFFFFFFu);
+    CHECK_EQ(checker->pixels[kPatternCell], 0u);
+}
+
+TEST(PatternSimdMatchesScalar) {
+    // Odd widths leave scalar tails after the four- and sixteen-pixel loops
+    for (const TestPattern pattern : { TestPattern::Grid, TestPattern::Checker, TestPattern::Gradient, TestPattern::Ramp, TestPattern::SolidCycle }) {
+        for (const long width : { 1L, 3L, 17L, 333L, 1920L }) {
+            std::vector<uint32_t> simd(static_cast<size_t>(width) * 37, 0x123456), scalar(simd);
+            GeneratePattern(pattern, width, 37, simd.data(), true);
+            GeneratePattern(pattern, width, 37, scalar.data(), false);
+            CHECK(simd == scalar);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
@@ -0,0 +1,101 @@
+// BuildLayout on hand-made topologies: which windows a layout produces and
+// what each of them carries.
+#include "TestHarness.hpp"
+
+#include "Selection.hpp"
+#include "Topology.hpp"
+
+namespace {
+    // Two 1080p monitors side by side, the right one primary
+    Topology SideBySide() {
+        Topology topology;
+        for (int k = 0; k < 2; ++k) {
+            MonitorData m{};
+            m.rect = { k * 1920L, 0, (k + 1) * 1920L, 1080 };
+            m.index = k;
+            m.name = "Monitor " + std::to_string(k + 1);
+            m.primary = k == 1;
+            topology.monitors.push_back(m);
+        }
+        topology.index = SpatialIndex(topology.monitors);
+        return topology;
+    }
+
+    // Region strip across both monitors: one merged cover rect unless split
+    BlankMask Strip() {
+        BlankMask mask;
+        mask.regions.push_back({ 0, 0, 3840, 200 });
+        return mask;
+    }
+
+    const std::tuple<int, int, int> kBlack = { 0, 0, 0 };
+    const std::tuple<int, int, int> kGray = { 128, 128, 128 };
+
+    bool Within(const Rect& r, const RECT& monitor) {
+        return r.left >= monitor.left && r.right <= monitor.right && r.top >= monitor.top && r.bottom <= monitor.bottom;
+    }
+}
+
+TEST(MonitorLayoutCarriesStyles) {
+    const Topology topology = SideBySide();
+    const std::vector<MonitorStyle> styles = { { MonitorQuery::compile("2"), kGray, 40 } };
+    const auto targets = BuildLayout(topology, topology.monitors, {}, styles, kBlack, 100, {});
+    REQUIRE(targets.size() == 2);
+    CHECK(targets[0].color == kBlack && targets[0].opacity == 100);
+    CHECK(targets[1].color == kGray && targets[1].opacity == 40);
+}
+
+TEST(MaskRectStaysMergedWhenMonitorsLookAlike) {
+    const Topology topology = SideBySide();
+    const auto targets = BuildLayout(topology, topology.monitors, Strip(), {}, kBlack, 100, {});
+    REQUIRE(targets.size() == 1);
+    CHECK(targets[0].rect == (Rect{ 0, 0, 3840, 200 }));
+}
+
+TEST(MaskRectSplitsAtDifferentlyStyledMonitors) {
+    const Topology topology = SideBySide();
+    const std::vector<MonitorStyle> styles = { { MonitorQuery::compile("primary"), kGray, 40 } };
+    const auto targets = BuildLayout(topology, topology.monitors, Strip(), styles, kBlack, 100, {});
+    REQUIRE(targets.size() == 2);
+    for (size_t k = 0; k < targets.size(); ++k) {
+        const WindowTarget& t = targets[k];
+        CHECK_EQ(t.key, static_cast<int>(k));
+        REQUIRE(t.monitor >= 0);
+        CHECK(Within(t.rect, topology.monitors[t.monitor].rect));
+        CHECK(t.color == (t.monitor == 1 ? kGray : kBlack));
+    }
+    CHECK(targets[0].monitor != targets[1].monitor);
+}
+
+TEST(MaskRectSplitsAtDifferentPatterns) {
+    const Topology topology = SideBySide();
+    const std::vector<MonitorPattern> patterns = { { MonitorQuery::compile("1"), TestPattern::Grid } };
+    const auto targets = BuildLayout(topology, topology.monitors, Strip(), {}, kBlack, 100, patterns);
+    REQUIRE(targets.size() == 2);
+    for (const WindowTarget& t : targets) {
+        CHECK(Within(t.rect, topology.monitors[t.monitor].rect));
+        CHECK(t.pattern == (t.monitor == 0 ? TestPattern::Grid : TestPattern::Off));
+    }
+}
+
+TEST(SplitPiecesCoverTheMaskExactly) {
+    const Topology topology = SideBySide();
+    BlankMask mask = Strip();
+    mask.exceptions.push_back({ 1800, 50, 200, 100 });
+    const std::vector<MonitorStyle> styles = { { MonitorQuery::compile("1"), kGray, -1 } };
+    const auto targets = BuildLayout(topology, topology.monitors, mask, styles, kBlack, 100, {});
+
+    std::vector<Rect> rects;
+    for (const WindowTarget& t : targets) {
+        CHECK(Within(t.rect, topology.monitors[t.monitor].rect));
+        rects.push_back(t.rect);
+    }
+    CHECK(RectSet::fromRects(rects) == mask.cover(topology.monitors));
+    long long area = 0;
+    for (const Rect& r : rects) area += static_cast<long long>(r.width()) * r.height();
+    CHECK_EQ(area, mask.cover(topology.monitors).area());
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
@@ -0,0 +1,88 @@
+// Reader throughput of SnapshotPublisher against a mutex-guarded shared_ptr,
+// with a writer publishing a new topology-sized snapshot every millisecond.
+// The optional argument scales the measuring time (1 = half a second per case).
+#include "TestHarness.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "SnapshotPublisher.hpp"
+
+namespace {
+    struct Payload {
+        std::vector<uint64_t> words = std::vector<uint64_t>(64, 1);
+    };
+
+    class MutexPublisher {
+    public:
+        std::shared_ptr<const Payload> acquire() const {
+            std::lock_guard lock(m_mutex);
+            return m_current;
+        }
+        void publish(std::shared_ptr<const Payload> value) {
+            std::lock_guard lock(m_mutex);
+            m_current = std::move(value);
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::shared_ptr<const Payload> m_current;
+    };
+
+    // Reads per second summed over all readers
+    template <typename Read, typename Write>
+    double Measure(int readers, std::chrono::milliseconds duration, Read read, Write write) {
+        std::atomic<bool> done{ false };
+        std::atomic<uint64_t> reads{ 0 };
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; ++r) {
+            threads.emplace_back([&] {
+                uint64_t count = 0, sum = 0;
+                while (!done.load(std::memory_order_relaxed)) {
+                    sum += read();
+                    ++count;
+                }
+                testing::KeepAlive(sum);
+                reads.fetch_add(count);
+            });
+        }
+        std::thread writer([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                write();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        const auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(duration);
+        done.store(true);
+        for (std::thread& thread : threads) thread.join();
+        writer.join();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return static_cast<double>(reads.load()) / seconds;
+    }
+}
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+    const auto duration = std::chrono::milliseconds(static_cast<long long>((std::max)(1.0, 500.0 * scale)));
+
+    SnapshotPublisher<Payload> snapshots;
+    snapshots.publish(std::make_unique<Payload>());
+    MutexPublisher locked;
+    locked.publish(std::make_shared<const Payload>());
+
+    printf("%-8s %18s %18s\n", "readers", "snapshot reads/s", "mutex reads/s");
+    for (int readers : { 1, 2, 4, 8 }) {
+        const double fast = Measure(readers, duration,
+            [&] { return snapshots.acquire()->words[0]; },
+            [&] { snapshots.publish(std::make_unique<Payload>()); });
+        const double slow = Measure(readers, duration,
+            [&] { return locked.acquire()->words[0]; },
+            [&] { locked.publish(std::make_shared<const Payload>()); });
+        printf("%-8d %18.0f %18.0f\n", readers, fast, slow);
+    }
+    return 0;
+}
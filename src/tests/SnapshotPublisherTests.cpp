@@ -0,0 +1,120 @@
+// One writer, many readers: every snapshot a reader sees must be complete,
+// never older than one it saw before, and freed exactly once. Built plain and,
+// where the compiler has them, under ThreadSanitizer and AddressSanitizer.
+#include "TestHarness.hpp"
+
+#include <atomic>
+#include <thread>
+
+#include "SnapshotPublisher.hpp"
+
+namespace {
+    std::atomic<long> g_live{ 0 };
+
+    // Every word holds the generation, so a torn or freed snapshot shows up
+    struct Payload {
+        explicit Payload(uint64_t generation) : generation(generation), words(64, generation) { g_live.fetch_add(1); }
+        ~Payload() {
+            std::ranges::fill(words, 0xDEADDEADDEADDEADull);
+            g_live.fetch_sub(1);
+        }
+        bool intact() const {
+            return std::ranges::all_of(words, [this](uint64_t word) { return word == generation; });
+        }
+
+        uint64_t generation;
+        std::vector<uint64_t> words;
+    };
+
+    // Readers stop once the writer is done; each returns false on the first bad snapshot
+    template <size_t Slots>
+    bool Stress(int readers, uint64_t publishes) {
+        bool ok = true;
+        {
+            SnapshotPublisher<Payload, Slots> publisher;
+            std::atomic<bool> done{ false };
+            std::atomic<int> failures{ 0 };
+            std::atomic<uint64_t> reads{ 0 };
+            std::atomic<int> started{ 0 };
+
+            std::vector<std::thread> threads;
+            for (int r = 0; r < readers; ++r) {
+                threads.emplace_back([&, r] {
+                    uint64_t last = 0, count = 0;
+                    started.fetch_add(1);
+                    while (!done.load(std::memory_order_acquire)) {
+                        auto outer = publisher.acquire();
+                        if (!outer) continue;
+                        if (!outer->intact() || outer->generation < last) failures.fetch_add(1);
+                        last = outer->generation;
+                        // Every few reads hold two at once, like a caller nesting current()
+                        if ((count + r) % 7 == 0) {
+                            auto inner = publisher.acquire();
+                            if (!inner || !inner->intact() || inner->generation < last) failures.fetch_add(1);
+                            std::this_thread::yield();
+                            if (!outer->intact()) failures.fetch_add(1);
+                        }
+                        ++count;
+                    }
+                    reads.fetch_add(count);
+                });
+            }
+
+            while (started.load() < readers) std::this_thread::yield();
+            for (uint64_t generation = 1; generation <= publishes; ++generation) {
+                publisher.publish(std::make_unique<Payload>(generation));
+                if (generation % 64 == 0) std::this_thread::yield();
+            }
+            done.store(true, std::memory_order_release);
+            for (std::thread& thread : threads) thread.join();
+
+            ok = failures.load() == 0 && reads.load() > 0;
+            printf("%d readers, %d slots: %llu reads over %llu publishes\n", readers, static_cast<int>(Slots),
+                static_cast<unsigned long long>(reads.load()), static_cast<unsigned long long>(publishes));
+            auto last = publisher.acquire();
+            ok = ok && last && last->generation == publishes;
+        }
+        return ok && g_live.load() == 0;
+    }
+}
+
+TEST(EmptyUntilFirstPublish) {
+    SnapshotPublisher<Payload> publisher;
+    CHECK(!publisher.acquire());
+    publisher.publish(std::make_unique<Payload>(1));
+    auto snapshot = publisher.acquire();
+    REQUIRE(snapshot);
+    CHECK_EQ(snapshot->generation, 1u);
+}
+
+TEST(HeldSnapshotOutlivesReplacement) {
+    {
+        SnapshotPublisher<Payload> publisher;
+        publisher.publish(std::make_unique<Payload>(1));
+        auto held = publisher.acquire();
+        for (uint64_t generation = 2; generation <= 100; ++generation) {
+            publisher.publish(std::make_unique<Payload>(generation));
+        }
+        CHECK(held->intact() && held->generation == 1);
+        // Only the held one and the current one survive reclaim
+        CHECK_EQ(g_live.load(), 2);
+        auto moved = std::move(held);
+        CHECK(!held && moved->generation == 1);
+        moved = publisher.acquire();
+        CHECK_EQ(moved->generation, 100u);
+    }
+    CHECK_EQ(g_live.load(), 0);
+}
+
+TEST(ManyReadersOneWriter) {
+    CHECK(Stress<64>(8, 20'000));
+}
+
+// More readers holding two snapshots each than there are hazard slots: acquire spins
+TEST(ReadersOutnumberSlots) {
+    CHECK(Stress<4>(6, 5'000));
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
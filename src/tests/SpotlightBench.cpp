@@ -0,0 +1,27 @@
+// The --stress-spotlight drag as a benchmark: per window event, the
+// incremental side update plus WindowPool::reshape against rebuilding the
+// layout with the hole as an -x mask, on four and on eight monitors. The
+// optional argument scales the number of events.
+#include "TestHarness.hpp"
+
+#include "Spotlight.hpp"
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+
+    for (const long count : { 4L, 8L }) {
+        SpotlightStressOptions options;
+        options.moves = testing::Iterations(100'000, scale);
+        for (long k = 0; k < count; ++k) {
+            // Two rows once there are more than four
+            options.monitors.push_back({ (k % 4) * 1920, (k / 4) * 1080, (k % 4 + 1) * 1920, (k / 4 + 1) * 1080 });
+        }
+        const SpotlightStressReport report = RunSpotlightStress(options);
+        printf("%s\n", FormatSpotlightStressReport(report).c_str());
+        if (report.moves == 0) {
+            fprintf(stderr, "The drag produced no window events\n");
+            return 1;
+        }
+    }
+    return 0;
+}
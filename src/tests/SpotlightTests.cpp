@@ -0,0 +1,211 @@
+// --spotlight: the four sides around the tracked window against a plain
+// rect subtraction, incremental moves against a fresh split, and a blanked
+// pool driven by ScriptedWindowEvents that creates each side's window once.
+#include "TestHarness.hpp"
+
+#include <map>
+
+#include "Spotlight.hpp"
+#include "WindowPool.hpp"
+
+namespace {
+    class MockBackend : public WindowBackend {
+    public:
+        struct Window {
+            Rect rect;
+            bool visible = false;
+        };
+
+        Handle create(const WindowTarget& target) override {
+            ++creates;
+            const auto handle = reinterpret_cast<Handle>(++m_next);
+            windows[handle] = { target.rect, false };
+            return handle;
+        }
+        void destroy(Handle window) override {
+            ++destroys;
+            if (!windows.erase(window)) ++misuse;
+        }
+        void move(Handle window, const Rect& rect) override {
+            ++moves;
+            if (!windows.contains(window)) ++misuse;
+            else windows[window].rect = rect;
+        }
+        void show(Handle window) override {
+            if (!windows.contains(window)) ++misuse;
+            else windows[window].visible = true;
+        }
+        void hide(Handle window) override {
+            if (!windows.contains(window)) ++misuse;
+            else windows[window].visible = false;
+        }
+
+        // What is on screen: the rects of the visible windows
+        RectSet covered() const {
+            std::vector<Rect> rects;
+            for (const auto& [handle, window] : windows) {
+                if (window.visible) rects.push_back(window.rect);
+            }
+            return RectSet::fromRects(rects);
+        }
+        long long visibleArea() const {
+            long long area = 0;
+            for (const auto& [handle, window] : windows) {
+                if (window.visible) area += static_cast<long long>(window.rect.width()) * window.rect.height();
+            }
+            return area;
+        }
+
+        std::map<Handle, Window> windows;
+        int creates = 0, destroys = 0, moves = 0;
+        int misuse = 0;
+
+    private:
+        uintptr_t m_next = 0;
+    };
+
+    // Three monitors of different heights, the middle one offset
+    std::vector<WindowTarget> Bases() {
+        return {
+            { 0, { 0, 0, 1920, 1080 }, 0, { 0, 0, 0 } },
+            { 1, { 1920, -200, 4480, 1240 }, 1, { 0, 0, 0 } },
+            { 2, { 4480, 0, 5760, 1024 }, 2, { 0, 0, 0 } },
+        };
+    }
+
+    std::vector<Rect> BaseRects(const std::vector<WindowTarget>& bases) {
+        std::vector<Rect> rects;
+        for (const WindowTarget& base : bases) rects.push_back(base.rect);
+        return rects;
+    }
+
+    // A path of holes across and beyond the desktop, with minimized steps
+    std::vector<Rect> RandomPath(testing::Random& random, size_t steps) {
+        std::vector<Rect> path;
+        for (size_t k = 0; k < steps; ++k) {
+            if (random.below(10) == 0) {
+                path.push_back({});
+                continue;
+            }
+            const long left = random.between(-400, 6000), top = random.between(-400, 1400);
+            path.push_back({ left, top, left + random.between(1, 2000), top + random.between(1, 1200) });
+        }
+        return path;
+    }
+
+    // The sides a fresh Spotlight makes for the hole, by key
+    std::map<int, Rect> FreshSides(const std::vector<WindowTarget>& bases, const Rect& hole) {
+        Spotlight fresh;
+        fresh.move(hole);
+        std::map<int, Rect> sides;
+        for (const WindowTarget& side : fresh.reset(bases)) sides[side.key] = side.rect;
+        return sides;
+    }
+}
+
+TEST(SidesAreTheBaseMinusTheHole) {
+    testing::Random random(3);
+    const std::vector<WindowTarget> bases = Bases();
+    for (const Rect& hole : RandomPath(random, 500)) {
+        const std::map<int, Rect> sides = FreshSides(bases, hole);
+        REQUIRE(sides.size() == bases.size() * Spotlight::kSides);
+        for (const WindowTarget& base : bases) {
+            std::vector<Rect> rects;
+            long long area = 0;
+            for (int k = 0; k < Spotlight::kSides; ++k) {
+                const Rect& side = sides.at(base.key * Spotlight::kSides + k);
+                CHECK(side.empty() == (side == Rect{}));
+                if (side.empty()) continue;
+                rects.push_back(side);
+                area += static_cast<long long>(side.width()) * side.height();
+            }
+            const RectSet expected = RectSet(base.rect).subtract(RectSet(hole));
+            // Same pixels, and no pixel in two sides
+            CHECK(RectSet::fromRects(rects) == expected);
+            CHECK_EQ(area, expected.area());
+        }
+    }
+}
+
+TEST(ScriptedMovesMatchAFreshSplit) {
+    testing::Random random(5);
+    const std::vector<WindowTarget> bases = Bases();
+    const std::vector<Rect> path = RandomPath(random, 2000);
+
+    Spotlight spotlight;
+    std::map<int, Rect> sides;
+    for (const WindowTarget& side : spotlight.reset(bases)) sides[side.key] = side.rect;
+
+    size_t events = 0;
+    ScriptedWindowEvents script(path);
+    REQUIRE(script.start([&](const Rect& rect) {
+        const Rect before = spotlight.hole();
+        const std::vector<WindowTarget> changed = spotlight.move(rect);
+        CHECK(spotlight.hole() == (rect.empty() ? Rect{} : rect));
+        if (spotlight.hole() == before) CHECK(changed.empty());
+        for (const WindowTarget& side : changed) {
+            // Only real changes are reported, each with its base's monitor
+            CHECK(sides.at(side.key) != side.rect);
+            CHECK_EQ(side.monitor, side.key / Spotlight::kSides);
+            sides[side.key] = side.rect;
+        }
+        CHECK(sides == FreshSides(bases, rect));
+        ++events;
+    }));
+    while (script.step()) {
+    }
+    CHECK_EQ(events, path.size());
+    CHECK(!script.step());
+}
+
+TEST(MovesWithinOneMonitorLeaveTheOthers) {
+    const std::vector<WindowTarget> bases = Bases();
+    Spotlight spotlight;
+    spotlight.reset(bases);
+    spotlight.move({ 100, 100, 900, 700 });
+    for (long step = 1; step <= 50; ++step) {
+        for (const WindowTarget& side : spotlight.move({ 100 + step * 10, 100 + step * 3, 900 + step * 10, 700 + step * 3 })) {
+            CHECK_EQ(side.key / Spotlight::kSides, 0);
+        }
+    }
+    // Repeating the hole changes nothing
+    CHECK(spotlight.move(spotlight.hole()).empty());
+}
+
+TEST(PoolFollowsTheHole) {
+    testing::Random random(9);
+    const std::vector<WindowTarget> bases = Bases();
+    const std::vector<Rect> path = RandomPath(random, 1000);
+    const RectSet desktop = RectSet::fromRects(BaseRects(bases));
+
+    MockBackend backend;
+    WindowPool pool(backend, {});
+    Spotlight spotlight;
+    pool.sync(spotlight.reset(bases));
+    pool.blank(Spotlight::sideKeys({ 0, 1, 2 }));
+    CHECK(backend.covered() == desktop);
+
+    ScriptedWindowEvents script(path);
+    script.start([&](const Rect& rect) {
+        const std::vector<WindowTarget> changed = spotlight.move(rect);
+        if (!changed.empty()) pool.reshape(changed);
+        // Everything but the hole is black, with no window over another
+        const RectSet expected = desktop.subtract(RectSet(spotlight.hole()));
+        CHECK(backend.covered() == expected);
+        CHECK_EQ(backend.visibleArea(), expected.area());
+    });
+    while (script.step()) {
+    }
+
+    // A drag moves, shows and hides; each side gets a window once, when it
+    // first has an area, and keeps it
+    CHECK(backend.creates <= static_cast<int>(bases.size()) * Spotlight::kSides);
+    CHECK_EQ(backend.destroys, 0);
+    CHECK(backend.moves > 0);
+    CHECK_EQ(backend.misuse, 0);
+    CHECK(pool.blanked());
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
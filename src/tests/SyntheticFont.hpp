@@ -0,0 +1,36 @@
+#pragma once
+#ifndef SYNTHETICFONT_HPP
+#define SYNTHETICFONT_HPP
+
+#include <algorithm>
+
+#include "TextOverlay.hpp"
+
+// Deterministic stand-in for the platform fonts: every printable character is
+// a box whose width and coverage pattern derive from its code point, with
+// anti-aliased edges, so text renders identically on every machine.
+class SyntheticFont : public GlyphRasterizer {
+public:
+    bool rasterize(char32_t codePoint, int pixelHeight, Glyph& glyph, std::vector<uint8_t>& coverage) override {
+        if (codePoint < 0x20 || codePoint > 0x7E) return false;
+        const int code = static_cast<int>(codePoint);
+        glyph.height = pixelHeight * 3 / 4;
+        glyph.width = (std::max)(1, pixelHeight / 3 + code % 5);
+        glyph.left = 1;
+        glyph.top = pixelHeight / 8;
+        glyph.advance = glyph.width + 2;
+        if (codePoint == U' ') glyph.width = glyph.height = 0;
+
+        coverage.assign(static_cast<size_t>(glyph.width) * glyph.height, 0);
+        for (int y = 0; y < glyph.height; ++y) {
+            for (int x = 0; x < glyph.width; ++x) {
+                const bool edge = x == 0 || y == 0 || x == glyph.width - 1 || y == glyph.height - 1;
+                const bool stripe = ((x + y * (code % 3 + 1)) / 3 + code) % 2 == 0;
+                coverage[static_cast<size_t>(y) * glyph.width + x] = edge ? 128 : stripe ? 255 : 0;
+            }
+        }
+        return true;
+    }
+};
+
+#endif // SYNTHETICFONT_HPP
@@ -0,0 +1,138 @@
+#pragma once
+#ifndef TESTHARNESS_HPP
+#define TESTHARNESS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Minimal test runner: TEST bodies register themselves, CHECK records a
+// failure and keeps going, REQUIRE stops the current test. RunTests runs
+// every test whose name contains the first argument, so one binary serves
+// a whole CTest target.
+namespace testing {
+    struct TestCase {
+        const char* name;
+        std::function<void()> body;
+    };
+
+    inline std::vector<TestCase>& Registry() {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    inline int& Failures() {
+        static int failures = 0;
+        return failures;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, std::function<void()> body) { Registry().push_back({ name, std::move(body) }); }
+    };
+
+    struct RequireFailed {};
+
+    inline void Fail(const char* file, int line, const std::string& what) {
+        ++Failures();
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what.c_str());
+    }
+
+    inline int RunTests(int argc, char** argv) {
+        const std::string filter = argc > 1 ? argv[1] : "";
+        int run = 0, failed = 0;
+        for (const TestCase& test : Registry()) {
+            if (!filter.empty() && std::string(test.name).find(filter) == std::string::npos) continue;
+            const int before = Failures();
+            try {
+                test.body();
+            }
+            catch (const RequireFailed&) {
+            }
+            catch (const std::exception& e) {
+                Fail(test.name, 0, std::string("unexpected exception: ") + e.what());
+            }
+            ++run;
+            if (Failures() != before) {
+                ++failed;
+                fprintf(stderr, "FAILED %s\n", test.name);
+            }
+        }
+        printf("%d tests, %d failed\n", run, failed);
+        return failed == 0 && run > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Benchmarks: iterations scale with the first argument so CTest can run
+    // them as quick smoke tests while a manual run measures for real
+    inline double Scale(int argc, char** argv) {
+        return argc > 1 ? std::atof(argv[1]) : 1.0;
+    }
+
+    inline uint64_t Iterations(uint64_t base, double scale) {
+        const double count = static_cast<double>(base) * scale;
+        return count < 1.0 ? 1 : static_cast<uint64_t>(count);
+    }
+
+    // Runs body iterations times and prints the mean cost of one call
+    template <typename Body>
+    double Bench(const char* name, uint64_t iterations, Body&& body) {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t k = 0; k < iterations; ++k) body(k);
+        const double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        const double perCall = nanos / static_cast<double>(iterations);
+        printf("%-48s %12.1f ns/op  (%llu iterations)\n", name, perCall, static_cast<unsigned long long>(iterations));
+        return perCall;
+    }
+
+    // Keeps the optimizer from dropping a result nobody reads
+    template <typename T>
+    void KeepAlive(const T& value) {
+#ifdef _MSC_VER
+        static const void* volatile sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "g"(&value) : "memory");
+#endif
+    }
+
+    // xorshift64: the same stream on every run
+    class Random {
+    public:
+        explicit Random(uint64_t seed = 0x2545F4914F6CDD1D) : m_state(seed ? seed : 1) {}
+        uint64_t next() {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 7;
+            m_state ^= m_state << 17;
+            return m_state;
+        }
+        long below(long bound) { return static_cast<long>(next() % static_cast<uint64_t>(bound)); }
+        long between(long low, long high) { return low + below(high - low); }
+
+    private:
+        uint64_t m_state;
+    };
+}
+
+#define TEST_CONCAT_INNER(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_INNER(a, b)
+
+#define TEST(name) \
+    static void name(); \
+    static ::testing::Registrar TEST_CONCAT(registrar_, name)(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { if (!(condition)) ::testing::Fail(__FILE__, __LINE__, #condition); } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { if (!((a) == (b))) ::testing::Fail(__FILE__, __LINE__, #a " == " #b); } while (0)
+
+#define REQUIRE(condition) \
+    do { if (!(condition)) { ::testing::Fail(__FILE__, __LINE__, #condition); throw ::testing::RequireFailed{}; } } while (0)
+
+#endif // TESTHARNESS_HPP
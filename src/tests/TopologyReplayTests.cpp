@@ -0,0 +1,76 @@
+// Monitor naming from captured topologies: the corpus in topologies/ must
+// replay to its recorded result (the report times each capture), and the
+// cases behind past naming bugs are pinned here as well.
+#include "TestHarness.hpp"
+
+#include <filesystem>
+
+#include "DisplayCapture.hpp"
+
+namespace {
+    // X11 shape: one active path per monitor with its source mode at the origin
+    void AddX11Monitor(DisplayCapture& capture, const char* name, RECT rect, bool primary) {
+        const uint32_t id = static_cast<uint32_t>(capture.monitors.size());
+        capture.paths.push_back({ 1, id, id, static_cast<uint32_t>(capture.modes.size()), DisplayCapture::kPathActive, name });
+        capture.modes.push_back({ DisplayCapture::kModeSource, id, 1, static_cast<int32_t>(rect.left), static_cast<int32_t>(rect.top),
+            static_cast<uint32_t>(rect.right - rect.left), static_cast<uint32_t>(rect.bottom - rect.top) });
+        capture.monitors.push_back({ rect, primary });
+    }
+}
+
+TEST(CorpusReplaysToRecorded) {
+    TopologyReplayOptions options;
+    options.path = TOPOLOGY_CORPUS;
+    options.iterations = 200;
+    const std::vector<TopologyReplayResult> results = RunTopologyReplay(options);
+    printf("%s", FormatTopologyReplayReport(results).c_str());
+    CHECK(results.size() >= 10);
+    CHECK(TopologyReplayPassed(results));
+}
+
+TEST(ClonesAtOneOriginKeepTheirNames) {
+    DisplayCapture capture;
+    AddX11Monitor(capture, "eDP-1", { 0, 0, 1920, 1080 }, true);
+    AddX11Monitor(capture, "HDMI-1", { 0, 0, 1920, 1080 }, false);
+    AddX11Monitor(capture, "DP-2", { 0, 0, 1280, 1024 }, false);
+    const std::vector<MonitorData> monitors = MatchDisplayCapture(capture);
+    REQUIRE(monitors.size() == 3);
+    CHECK_EQ(monitors[0].name, "eDP-1");
+    CHECK_EQ(monitors[1].name, "HDMI-1");
+    CHECK_EQ(monitors[2].name, "DP-2");
+}
+
+TEST(WindowsCloneTakesTheFirstPath) {
+    // Two targets showing one source: one monitor, named after the first path
+    DisplayCapture capture;
+    AddX11Monitor(capture, "Projector", { 0, 0, 1920, 1080 }, true);
+    capture.paths.push_back({ 1, 7, 0, 0, DisplayCapture::kPathActive, "Presenter Display" });
+    const std::vector<MonitorData> monitors = MatchDisplayCapture(capture);
+    REQUIRE(monitors.size() == 1);
+    CHECK_EQ(monitors[0].name, "Projector");
+}
+
+TEST(SaveLoadRoundTrip) {
+    DisplayCapture capture;
+    AddX11Monitor(capture, "LEFT", { -1920, 0, 0, 1080 }, false);
+    AddX11Monitor(capture, "RIGHT", { 0, 0, 2560, 1440 }, true);
+    capture.recorded = MatchDisplayCapture(capture);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "black_screen_roundtrip.topology").string();
+    std::string error;
+    REQUIRE(SaveDisplayCapture(path, capture, error));
+    DisplayCapture loaded;
+    const bool ok = LoadDisplayCapture(path, loaded, error);
+    std::filesystem::remove(path);
+    REQUIRE(ok);
+    CHECK_EQ(loaded.paths.size(), capture.paths.size());
+    CHECK_EQ(loaded.modes.size(), capture.modes.size());
+    REQUIRE(loaded.recorded.size() == 2);
+    CHECK_EQ(loaded.recorded[0].name, "LEFT");
+    CHECK_EQ(loaded.recorded[0].rect.left, -1920);
+    CHECK(loaded.recorded[1].primary);
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
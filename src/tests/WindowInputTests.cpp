@@ -0,0 +1,37 @@
+// The window procedure's decisions: which messages unblank or quit, in
+// one-shot and resident mode, with and without key exit.
+#include "TestHarness.hpp"
+
+#include "WindowInput.hpp"
+
+TEST(KeyPressUnblanksOnlyWithKeyExit) {
+    CHECK(RespondTo(WindowMessage::KeyDown, true, false) == WindowResponse::Quit);
+    CHECK(RespondTo(WindowMessage::KeyDown, true, true) == WindowResponse::Unblank);
+    // --disable-key-exit: keys do nothing in either mode
+    CHECK(RespondTo(WindowMessage::KeyDown, false, false) == WindowResponse::Ignore);
+    CHECK(RespondTo(WindowMessage::KeyDown, false, true) == WindowResponse::Ignore);
+}
+
+TEST(CloseAndDestroyKeepResidentAlive) {
+    for (const bool exitOnKey : { true, false }) {
+        CHECK(RespondTo(WindowMessage::Close, exitOnKey, false) == WindowResponse::Quit);
+        CHECK(RespondTo(WindowMessage::Close, exitOnKey, true) == WindowResponse::Unblank);
+        CHECK(RespondTo(WindowMessage::Destroy, exitOnKey, false) == WindowResponse::Quit);
+        CHECK(RespondTo(WindowMessage::Destroy, exitOnKey, true) == WindowResponse::Ignore);
+    }
+}
+
+TEST(OtherMessagesIgnoreTheMode) {
+    for (const bool exitOnKey : { true, false }) {
+        for (const bool resident : { true, false }) {
+            CHECK(RespondTo(WindowMessage::DisplayChange, exitOnKey, resident) == WindowResponse::RefreshTopology);
+            CHECK(RespondTo(WindowMessage::Paint, exitOnKey, resident) == WindowResponse::Repaint);
+            // Mouse moves never unblank
+            CHECK(RespondTo(WindowMessage::MouseMove, exitOnKey, resident) == WindowResponse::Default);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
@@ -0,0 +1,298 @@
+// WindowPool state machine against a mock backend: which windows exist, which
+// are visible and what each call cost, after sync/blank/unblank/reshape.
+#include "TestHarness.hpp"
+
+#include <algorithm>
+#include <map>
+
+#include "Metrics.hpp"
+#include "WindowPool.hpp"
+
+namespace {
+    class MockBackend : public WindowBackend {
+    public:
+        struct Window {
+            WindowTarget target;
+            Rect rect;
+            bool visible = false;
+        };
+
+        Handle create(const WindowTarget& target) override {
+            ++creates;
+            if (failCreates) return nullptr;
+            const auto handle = reinterpret_cast<Handle>(++m_next);
+            windows[handle] = { target, target.rect, false };
+            return handle;
+        }
+        void destroy(Handle window) override {
+            ++destroys;
+            if (!windows.erase(window)) ++misuse;
+        }
+        void move(Handle window, const Rect& rect) override {
+            ++moves;
+            if (!windows.contains(window)) ++misuse;
+            else windows[window].rect = rect;
+        }
+        void show(Handle window) override {
+            ++shows;
+            if (!windows.contains(window)) ++misuse;
+            else windows[window].visible = true;
+        }
+        void hide(Handle window) override {
+            ++hides;
+            if (!windows.contains(window)) ++misuse;
+            else windows[window].visible = false;
+        }
+        void reveal(const std::vector<Handle>& batch) override {
+            ++reveals;
+            lastReveal = batch;
+            for (Handle window : batch) {
+                if (!windows.contains(window)) ++misuse;
+                else windows[window].visible = true;
+            }
+        }
+
+        size_t visibleCount() const {
+            return static_cast<size_t>(std::ranges::count_if(windows, [](const auto& entry) { return entry.second.visible; }));
+        }
+        bool visibleAt(const Rect& rect) const {
+            return std::ranges::any_of(windows, [&rect](const auto& entry) { return entry.second.visible && entry.second.rect == rect; });
+        }
+
+        std::map<Handle, Window> windows;
+        std::vector<Handle> lastReveal;
+        bool failCreates = false;
+        int creates = 0, destroys = 0, moves = 0, shows = 0, hides = 0, reveals = 0;
+        int misuse = 0;         // calls on windows the backend never made or already destroyed
+
+    private:
+        uintptr_t m_next = 0;
+    };
+
+    std::vector<WindowTarget> Row(int count, std::tuple<int, int, int> color = { 0, 0, 0 }) {
+        std::vector<WindowTarget> targets;
+        for (int k = 0; k < count; ++k) {
+            targets.push_back({ k, { k * 1920L, 0, (k + 1) * 1920L, 1080 }, k, color });
+        }
+        return targets;
+    }
+
+    // Backend windows are exactly the pool's slots, visible exactly when Shown with an area
+    bool Consistent(const WindowPool& pool, const MockBackend& backend) {
+        if (backend.misuse != 0 || backend.windows.size() != pool.slots().size()) return false;
+        for (const WindowPool::Slot& slot : pool.slots()) {
+            auto it = backend.windows.find(slot.window);
+            if (it == backend.windows.end()) return false;
+            const bool shouldShow = slot.state == WindowPool::SlotState::Shown && !slot.target.rect.empty();
+            if (it->second.visible != shouldShow) return false;
+            if (!slot.target.rect.empty() && it->second.rect != slot.target.rect) return false;
+        }
+        return true;
+    }
+}
+
+TEST(SyncWarmsEveryTargetHidden) {
+    MockBackend backend;
+    WindowPool pool(backend, {});
+    pool.sync(Row(3));
+    CHECK_EQ(backend.windows.size(), 3u);
+    CHECK_EQ(backend.visibleCount(), 0u);
+    CHECK(!pool.blanked());
+    CHECK(Consistent(pool, backend));
+}
+
+TEST(BlankRevealsWarmWindowsInOneBatch) {
+    MockBackend backend;
+    WindowPool pool(backend, {});
+    pool.sync(Row(3));
+    const int createsBefore = backend.creates;
+    const uint64_t flipsBefore = g_metrics.poolFlips.load();
+
+    pool.blank({ 0, 2 });
+    CHECK_EQ(backend.creates, createsBefore);
+    CHECK_EQ(backend.reveals, 1);
+    CHECK_EQ(backend.lastReveal.size(), 2u);
+    CHECK_EQ(g_metrics.poolFlips.load() - flipsBefore, 2u);
+    CHECK(backend.visibleAt({ 0, 0, 1920, 1080 }) && backend.visibleAt({ 3840, 0, 5760, 1080 }));
+    CHECK(!backend.visibleAt({ 1920, 0, 3840, 1080 }));
+    CHECK(pool.blanked());
+    CHECK(Consistent(pool, backend));
+
+    // Blanking what is already shown reveals nothing new
+    pool.blank({ 0 });
+    CHECK_EQ(backend.reveals, 1);
+}
+
+TEST(UnblankHidesAndKeepsWindowsWarm) {
+    MockBackend backend;
+    WindowPool pool(backend, {});
+    pool.sync(Row(2));
+    pool.blankAll();
+    pool.unblank();
+    CHECK(!pool.blanked());
+    CHECK_EQ(backend.visibleCount(), 0u);
+    CHECK_EQ(backend.windows.size(), 2u);
+    CHECK_EQ(backend.destroys, 0);
+    CHECK(Consistent(pool, backend));
+}
+
+TEST(SyncRestylesMovesAndDrops) {
+    MockBackend backend;
+    WindowPool pool(backend, {});
+    pool.sync(Row(3));
+    pool.blankAll();
+
+    std::vector<WindowTarget> next = Row(2);
+    next[0].color = { 128, 128, 128 };              // restyle: a new window, still shown
+    next[1].rect = { 1920, 100, 3840, 1080 };       // move in place
+    pool.sync(next);
+
+    CHECK_EQ(backend.windows.size(), 2u);
+    CHECK_EQ(backend.destroys, 2);                  // the restyled one and the dropped third
+    CHECK_EQ(backend.moves, 1);
+    CHECK(backend.visibleAt({ 0, 0, 1920, 1080 }));
+    CHECK(backend.visibleAt({ 1920, 100, 3840, 1080 }));
+    CHECK(pool.blanked());
+    CHECK(Consistent(pool, backend));
+
+    pool.sync({});
+    CHECK(!pool.blanked());
+    CHECK(backend.windows.empty());
+}
+
+TEST(MostUsedPolicyCreatesColdWindowsOnDemand) {
+    MockBackend backend;
+    WindowPool pool(backend, { .mostUsed = 1 });
+    pool.sync(Row(3));
+    CHECK_EQ(backend.windows.size(), 1u);
+
+    const uint64_t createsBefore = g_metrics.poolCreates.load();
+    pool.blank({ 2 });
+    CHECK_EQ(g_metrics.poolCreates.load() - createsBefore, 1u);
+    CHECK(backend.visibleAt({ 3840, 0, 5760, 1080 }));
+    CHECK(Consistent(pool, backend));
+
+    // Target 2 is now the most used, so it is the one kept warm
+    pool.unblank();
+    REQUIRE(pool.slots().size() == 1);
+    CHECK_EQ(pool.slots()[0].target.key, 2);
+    CHECK(Consistent(pool, backend));
+}
+
+TEST(ReshapeParksAndRestoresWindows) {
+    MockBackend backend;
+    WindowPool pool(backend, {});
+    pool.sync(Row(2));
+    pool.blankAll();
+
+    WindowTarget parked = Row(2)[1];
+    parked.rect = {};
+    pool.reshape({ parked });
+    CHECK(!backend.visibleAt({ 1920, 0, 3840, 1080 }));
+    CHECK_EQ(backend.windows.size(), 2u);
+    CHECK(Consistent(pool, backend));
+
+    WindowTarget back = Row(2)[1];
+    back.rect = { 2000, 0, 3000, 1080 };
+    pool.reshape({ back });
+    CHECK(backend.visibleAt({ 2000, 0, 3000, 1080 }));
+    CHECK(Consistent(pool, backend));
+
+    // Unknown keys are ignored
+    pool.reshape({ { 99, { 0, 0, 10, 10 }, 0, {} } });
+    CHECK(Consistent(pool, backend));
+}
+
+TEST(ReshapeGivesABlankedEmptyTargetItsWindow) {
+    MockBackend backend;
+    WindowPool pool(backend, { .mostUsed = 1 });
+    std::vector<WindowTarget> targets = Row(2);
+    targets[1].rect = {};
+    pool.sync(targets);
+    pool.blankAll();
+    CHECK(pool.blanked());
+
+    targets[1].rect = { 1920, 0, 3840, 1080 };
+    pool.reshape({ targets[1] });
+    CHECK(backend.visibleAt({ 1920, 0, 3840, 1080 }));
+    CHECK(Consistent(pool, backend));
+}
+
+TEST(FailedCreatesAreSkipped) {
+    MockBackend backend;
+    backend.failCreates = true;
+    WindowPool pool(backend, {});
+    pool.sync(Row(2));
+    pool.blankAll();
+    CHECK(backend.windows.empty());
+    CHECK_EQ(backend.reveals, 0);
+    CHECK(Consistent(pool, backend));
+
+    backend.failCreates = false;
+    pool.blankAll();
+    CHECK_EQ(backend.visibleCount(), 2u);
+    CHECK(Consistent(pool, backend));
+}
+
+TEST(DestructorDestroysEveryWindow) {
+    MockBackend backend;
+    {
+        WindowPool pool(backend, {});
+        pool.sync(Row(4));
+        pool.blank({ 1 });
+    }
+    CHECK(backend.windows.empty());
+    CHECK_EQ(backend.misuse, 0);
+}
+
+// Random operation sequences: the backend never sees a stale handle and always
+// matches the pool's slots
+TEST(RandomOperationsStayConsistent) {
+    testing::Random random(36);
+    for (int round = 0; round < 200; ++round) {
+        MockBackend backend;
+        WindowPool pool(backend, { .mostUsed = static_cast<size_t>(random.below(4)) });
+        std::vector<WindowTarget> targets = Row(1 + static_cast<int>(random.below(5)));
+        pool.sync(targets);
+
+        for (int step = 0; step < 40; ++step) {
+            switch (random.below(6)) {
+                case 0: {
+                    std::vector<int> keys;
+                    for (const WindowTarget& t : targets) if (random.below(2)) keys.push_back(t.key);
+                    pool.blank(keys);
+                    break;
+                }
+                case 1:
+                    pool.unblank();
+                    break;
+                case 2:
+                    pool.blankAll();
+                    break;
+                case 3: {
+                    WindowTarget t = targets[static_cast<size_t>(random.below(static_cast<long>(targets.size())))];
+                    const long left = random.below(4000);
+                    t.rect = random.below(4) == 0 ? Rect{} : Rect{ left, 0, left + 1 + random.below(2000), 1080 };
+                    for (WindowTarget& known : targets) if (known.key == t.key) known = t;
+                    pool.reshape({ t });
+                    break;
+                }
+                case 4:
+                    targets = Row(1 + static_cast<int>(random.below(5)), random.below(3) == 0 ? std::tuple{ 9, 9, 9 } : std::tuple{ 0, 0, 0 });
+                    pool.sync(targets);
+                    break;
+                default:
+                    backend.failCreates = random.below(5) == 0;
+                    break;
+            }
+            if (!Consistent(pool, backend)) {
+                ::testing::Fail(__FILE__, __LINE__, "round " + std::to_string(round) + " step " + std::to_string(step));
+                return;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    return testing::RunTests(argc, argv);
+}
@@ -0,0 +1,104 @@
+// Per-window paint dispatch: the state record found through the window's
+// user data and painted as is, against the shared color string that every
+// paint used to compare, match and convert before it could fill. Small
+// dirty rects show the dispatch cost, a full 1080p window what it is worth
+// next to the fill. On Windows the lookup is GetWindowLongPtr on
+// message-only windows; elsewhere a slot table stands in for the window's
+// user data. The optional argument scales the paint counts.
+#include "TestHarness.hpp"
+
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "ColorHandler.hpp"
+#include "SoftwareRenderer.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace {
+    constexpr int kWindows = 8;
+
+    // The part of WindowState the paint reads
+    struct PaintState {
+        long width;
+        long height;
+        uint32_t color;
+    };
+
+#ifdef _WIN32
+    class UserData {
+    public:
+        UserData() {
+            WNDCLASSW windowClass = {};
+            windowClass.lpfnWndProc = DefWindowProcW;
+            windowClass.hInstance = GetModuleHandleW(nullptr);
+            windowClass.lpszClassName = L"WindowStateBench";
+            RegisterClassW(&windowClass);
+            for (int k = 0; k < kWindows; ++k) {
+                m_windows.push_back(CreateWindowExW(0, windowClass.lpszClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr,
+                    windowClass.hInstance, nullptr));
+            }
+        }
+        ~UserData() {
+            for (HWND window : m_windows) DestroyWindow(window);
+        }
+
+        void attach(int window, PaintState* state) { SetWindowLongPtrW(m_windows[window], GWLP_USERDATA, reinterpret_cast<LONG_PTR>(state)); }
+        PaintState* lookup(int window) const { return reinterpret_cast<PaintState*>(GetWindowLongPtrW(m_windows[window], GWLP_USERDATA)); }
+
+    private:
+        std::vector<HWND> m_windows;
+    };
+#else
+    class UserData {
+    public:
+        void attach(int window, PaintState* state) { m_slots[window] = state; }
+        PaintState* lookup(int window) const { return m_slots[window]; }
+
+    private:
+        PaintState* m_slots[kWindows] = {};
+    };
+#endif
+
+    // What the window procedure did before the state records
+    std::string g_color = "#102030";
+
+    uint32_t SharedColor() {
+        if (g_color == "black") return 0;
+        if (!std::regex_match(g_color, std::regex("^#([a-fA-F0-9]{6}|[a-fA-F0-9]{3})$"))) return 0;
+        return PackColor(ColorHandler::convertHextoRGB(g_color));
+    }
+}
+
+int main(int argc, char** argv) {
+    const double scale = testing::Scale(argc, argv);
+    const struct { const char* name; long width, height; uint64_t paints; } sizes[] = {
+        { "64x64 dirty", 64, 64, 2'000'000 },
+        { "1080p window", 1920, 1080, 2'000 },
+    };
+
+    for (const auto& size : sizes) {
+        std::vector<SoftwareRenderer> surfaces(kWindows, SoftwareRenderer(size.width, size.height));
+        std::vector<PaintState> states;
+        for (int k = 0; k < kWindows; ++k) states.push_back({ size.width, size.height, 0x102030u + static_cast<uint32_t>(k) });
+        UserData userData;
+        for (int k = 0; k < kWindows; ++k) userData.attach(k, &states[k]);
+        const uint64_t paints = testing::Iterations(size.paints, scale);
+
+        printf("%s\n", size.name);
+        testing::Bench("  state record", paints, [&](uint64_t k) {
+            const int window = static_cast<int>(k % kWindows);
+            const PaintState* state = userData.lookup(window);
+            surfaces[window].paint({ state->width, state->height, state->color, nullptr, nullptr });
+        });
+        testing::Bench("  shared color string", paints, [&](uint64_t k) {
+            const int window = static_cast<int>(k % kWindows);
+            surfaces[window].paint({ size.width, size.height, SharedColor(), nullptr, nullptr });
+        });
+        for (const SoftwareRenderer& surface : surfaces) testing::KeepAlive(surface.frame().pixels[0]);
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#!/bin/sh
+# Headless X11 check: a virtual Xvfb screen split into monitors with
+# xrandr --setmonitor, then monitor detection and a blank/unblank round trip
+# through a resident instance driven over --control, and a cloned monitor.
+#
+# usage: X11HeadlessTest.sh <black_screen_app_x11>
+# Exits 77 (skipped for CTest) when Xvfb or xrandr is not installed.
+
+APP=$1
+for tool in Xvfb xrandr; do
+    command -v "$tool" >/dev/null 2>&1 || { echo "skipped: $tool not installed"; exit 77; }
+done
+
+DISPLAY_NUMBER=$((90 + $$ % 100))
+PORT=$((20000 + $$ % 20000))
+export DISPLAY=":$DISPLAY_NUMBER"
+WORK=$(mktemp -d)
+XVFB_PID=
+APP_PID=
+
+cleanup() {
+    [ -n "$APP_PID" ] && kill "$APP_PID" 2>/dev/null
+    [ -n "$XVFB_PID" ] && kill "$XVFB_PID" 2>/dev/null
+    rm -rf "$WORK"
+}
+trap cleanup EXIT
+
+fail() {
+    echo "FAILED: $*"
+    exit 1
+}
+
+# Polls a command for up to five seconds
+wait_for() {
+    tries=50
+    until "$@" >/dev/null 2>&1; do
+        tries=$((tries - 1))
+        [ "$tries" -gt 0 ] || return 1
+        sleep 0.1
+    done
+}
+
+Xvfb "$DISPLAY" -screen 0 3840x1080x24 +extension RANDR -nolisten tcp >"$WORK/xvfb.log" 2>&1 &
+XVFB_PID=$!
+wait_for xrandr --query || fail "Xvfb did not start"
+
+# Two 1080p monitors side by side on the one virtual output
+xrandr --setmonitor LEFT 1920/508x1080/286+0+0 none || fail "xrandr --setmonitor LEFT"
+xrandr --setmonitor RIGHT 1920/508x1080/286+1920+0 none || fail "xrandr --setmonitor RIGHT"
+
+# Detection
+"$APP" --list >"$WORK/list.txt" 2>&1 || fail "--list exited with $?"
+cat "$WORK/list.txt"
+grep -Eq '^1 +0 +0 +1920 +1080 .*LEFT$' "$WORK/list.txt" || fail "LEFT monitor not listed at 0,0-1920,1080"
+grep -Eq '^2 +1920 +0 +3840 +1080 .*RIGHT$' "$WORK/list.txt" || fail "RIGHT monitor not listed at 1920,0-3840,1080"
+
+# Blank and unblank every monitor through a resident instance
+control() {
+    "$APP" --control "$1" --target "127.0.0.1:$PORT" --timeout 2000 2>&1
+}
+
+"$APP" -m 0 --resident --listen "127.0.0.1:$PORT" >"$WORK/app.log" 2>&1 &
+APP_PID=$!
+wait_for control ping || fail "resident instance did not answer: $(cat "$WORK/app.log")"
+
+control status | grep -q "status unblanked" || fail "resident instance should start unblanked"
+control blank | grep -q "blank blanked" || fail "blank was not acknowledged"
+control status | grep -q "status blanked" || fail "status after blank"
+if command -v xwininfo >/dev/null 2>&1; then
+    xwininfo -root -tree | grep -Eq '1920x1080\+1920\+0' || fail "no blanking window on RIGHT"
+fi
+control unblank | grep -q "unblank unblanked" || fail "unblank was not acknowledged"
+control status | grep -q "status unblanked" || fail "status after unblank"
+
+kill "$APP_PID"
+wait "$APP_PID" 2>/dev/null
+APP_PID=
+
+# A clone at LEFT's origin keeps its own name instead of taking LEFT's
+xrandr --setmonitor CLONE 1920/508x1080/286+0+0 none || fail "xrandr --setmonitor CLONE"
+"$APP" --list >"$WORK/clone.txt" 2>&1 || fail "--list with a clone exited with $?"
+cat "$WORK/clone.txt"
+grep -Eq ' +0 +0 +1920 +1080 .*LEFT$' "$WORK/clone.txt" || fail "LEFT not listed next to its clone"
+grep -Eq ' +0 +0 +1920 +1080 .*CLONE$' "$WORK/clone.txt" || fail "CLONE listed under another name"
+echo "passed"